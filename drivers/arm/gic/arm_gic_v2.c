@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -10,6 +10,10 @@
 #include <debug.h>
 #include <drivers/arm/gic_v2.h>
 
+/* MMIO accesses of the last global context save and restore */
+static unsigned int ctx_save_accesses;
+static unsigned int ctx_restore_accesses;
+
 void arm_gic_enable_interrupts_local(void)
 {
 	gicv2_enable_cpuif();
@@ -38,13 +42,20 @@ void arm_gic_restore_context_local(void)
 
 void arm_gic_save_context_global(void)
 {
-	gicv2_save_sgi_ppi_context();
+	ctx_save_accesses = gicv2_save_sgi_ppi_context();
 }
 
 void arm_gic_restore_context_global(void)
 {
 	gicv2_setup_distif();
-	gicv2_restore_sgi_ppi_context();
+	ctx_restore_accesses = gicv2_restore_sgi_ppi_context();
+}
+
+void arm_gic_get_context_mmio_accesses(unsigned int *save,
+				       unsigned int *restore)
+{
+	*save = ctx_save_accesses;
+	*restore = ctx_restore_accesses;
 }
 
 void arm_gic_setup_global(void)
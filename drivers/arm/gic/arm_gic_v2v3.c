@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -15,6 +15,10 @@
 /* Record whether a GICv3 was detected on the system */
 static unsigned int gicv3_detected;
 
+/* MMIO accesses of the last global context save and restore */
+static unsigned int ctx_save_accesses;
+static unsigned int ctx_restore_accesses;
+
 void arm_gic_enable_interrupts_local(void)
 {
 	if (gicv3_detected)
@@ -61,22 +65,29 @@ void arm_gic_restore_context_local(void)
 void arm_gic_save_context_global(void)
 {
 	if (gicv3_detected)
-		gicv3_save_sgi_ppi_context();
+		ctx_save_accesses = gicv3_save_sgi_ppi_context();
 	else
-		gicv2_save_sgi_ppi_context();
+		ctx_save_accesses = gicv2_save_sgi_ppi_context();
 }
 
 void arm_gic_restore_context_global(void)
 {
 	if (gicv3_detected) {
 		gicv3_setup_distif();
-		gicv3_restore_sgi_ppi_context();
+		ctx_restore_accesses = gicv3_restore_sgi_ppi_context();
 	} else {
 		gicv2_setup_distif();
-		gicv2_restore_sgi_ppi_context();
+		ctx_restore_accesses = gicv2_restore_sgi_ppi_context();
 	}
 }
 
+void arm_gic_get_context_mmio_accesses(unsigned int *save,
+				       unsigned int *restore)
+{
+	*save = ctx_save_accesses;
+	*restore = ctx_restore_accesses;
+}
+
 void arm_gic_setup_global(void)
 {
 	if (gicv3_detected)
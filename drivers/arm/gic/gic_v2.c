@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -13,6 +13,13 @@
 #include <mmio.h>
 #include <platform.h>
 
+/* Banked Distributor registers of the first 32 interrupts (SGIs and PPIs) */
+struct gicv2_sgi_ppi_regs {
+	unsigned int gicd_isenabler0;
+	unsigned int gicd_ipriorityr[NUM_PCPU_INTR >> IPRIORITYR_SHIFT];
+	unsigned int gicd_icfgr;
+};
+
 /*
  * Data structure to store the GIC per CPU context before entering
  * system suspend. Only the GIC context of first 32 interrupts (SGIs and PPIs)
@@ -22,9 +29,14 @@
  */
 struct gicv2_pcpu_ctx {
 	unsigned int gicc_ctlr;
-	unsigned int gicd_isenabler0;
-	unsigned int gicd_ipriorityr[NUM_PCPU_INTR >> IPRIORITYR_SHIFT];
-	unsigned int gicd_icfgr;
+	struct gicv2_sgi_ppi_regs saved;
+	/* Registers as configured by the firmware when the CPU first booted */
+	struct gicv2_sgi_ppi_regs boot;
+	unsigned int boot_valid;
+	/* GIC_PCPU_CTX_WARM_* behaviour of the firmware on warm boot */
+	unsigned int warm_boot;
+	/* GIC_PCPU_CTX_* registers written since the last save */
+	unsigned int dirty;
 };
 
 static struct gicv2_pcpu_ctx pcpu_gic_ctx[PLATFORM_CORE_COUNT];
@@ -106,6 +118,99 @@ void gicd_set_itargetsr(unsigned int base,
 	mmio_write_8(base + GICD_ITARGETSR + interrupt_id, (1 << iface));
 }
 
+/*******************************************************************************
+ * GIC Distributor SGI and PPI context accessors for the calling CPU. Only the
+ * registers in the GIC_PCPU_CTX_* `mask` are accessed, the number of accesses
+ * is returned.
+ ******************************************************************************/
+static unsigned int gicd_read_sgi_ppi_regs(struct gicv2_sgi_ppi_regs *regs,
+					   unsigned int mask)
+{
+	unsigned int i, accesses = 0U;
+
+	if (mask & GIC_PCPU_CTX_ISENABLER) {
+		regs->gicd_isenabler0 = gicd_read_isenabler(gicd_base_addr, 0);
+		accesses++;
+	}
+
+	/* Read the ipriority registers, 4 at a time */
+	for (i = 0; i < (NUM_PCPU_INTR >> IPRIORITYR_SHIFT); i++) {
+		if (mask & GIC_PCPU_CTX_IPRIORITYR(i)) {
+			regs->gicd_ipriorityr[i] = gicd_read_ipriorityr(
+					gicd_base_addr, i << IPRIORITYR_SHIFT);
+			accesses++;
+		}
+	}
+
+	if (mask & GIC_PCPU_CTX_ICFGR) {
+		regs->gicd_icfgr = gicd_read_icfgr(gicd_base_addr, MIN_PPI_ID);
+		accesses++;
+	}
+
+	return accesses;
+}
+
+static unsigned int gicd_write_sgi_ppi_regs(
+		const struct gicv2_sgi_ppi_regs *regs, unsigned int mask)
+{
+	unsigned int i, accesses = 0U;
+
+	/* Write the ipriority registers, 4 at a time */
+	for (i = 0; i < (NUM_PCPU_INTR >> IPRIORITYR_SHIFT); i++) {
+		if (mask & GIC_PCPU_CTX_IPRIORITYR(i)) {
+			gicd_write_ipriorityr(gicd_base_addr,
+					i << IPRIORITYR_SHIFT,
+					regs->gicd_ipriorityr[i]);
+			accesses++;
+		}
+	}
+
+	if (mask & GIC_PCPU_CTX_ICFGR) {
+		gicd_write_icfgr(gicd_base_addr, MIN_PPI_ID, regs->gicd_icfgr);
+		accesses++;
+	}
+
+	/* Enable the interrupts last, once they are configured */
+	if (mask & GIC_PCPU_CTX_ISENABLER) {
+		gicd_write_isenabler(gicd_base_addr, 0, regs->gicd_isenabler0);
+		accesses++;
+	}
+
+	return accesses;
+}
+
+/* Return the GIC_PCPU_CTX_* mask of the registers that differ */
+static unsigned int sgi_ppi_regs_diff(const struct gicv2_sgi_ppi_regs *a,
+				      const struct gicv2_sgi_ppi_regs *b)
+{
+	unsigned int i, mask = 0U;
+
+	if (a->gicd_isenabler0 != b->gicd_isenabler0)
+		mask |= GIC_PCPU_CTX_ISENABLER;
+
+	for (i = 0; i < (NUM_PCPU_INTR >> IPRIORITYR_SHIFT); i++) {
+		if (a->gicd_ipriorityr[i] != b->gicd_ipriorityr[i])
+			mask |= GIC_PCPU_CTX_IPRIORITYR(i);
+	}
+
+	if (a->gicd_icfgr != b->gicd_icfgr)
+		mask |= GIC_PCPU_CTX_ICFGR;
+
+	return mask;
+}
+
+/* Mark the banked registers of the SGI or PPI `interrupt_id` as written */
+static void gicv2_pcpu_ctx_set_dirty(unsigned int interrupt_id,
+				     unsigned int mask)
+{
+	unsigned int core_pos;
+
+	if (interrupt_id < MIN_SPI_ID) {
+		core_pos = platform_get_core_pos(read_mpidr_el1());
+		pcpu_gic_ctx[core_pos].dirty |= mask;
+	}
+}
+
 /******************************************************************************
  * GICv2 public driver API
  *****************************************************************************/
@@ -134,6 +239,25 @@ void gicv2_probe_gic_cpu_id(void)
 
 	/* Convert the bit pos returned by read of ITARGETSR0 to GIC CPU ID */
 	gic_cpu_id[core_pos] = __builtin_ctz(gicd_itargets_val);
+
+	/*
+	 * Snapshot the banked registers as the firmware configured them on cold
+	 * boot. The context restore assumes that the firmware programs them
+	 * back to these values on warm boot, so that only the registers the
+	 * TFTF changed need to be written. This is checked on the first restore
+	 * of the CPU, which falls back to a full restore if it does not hold.
+	 */
+	if (!pcpu_gic_ctx[core_pos].boot_valid) {
+		(void)gicd_read_sgi_ppi_regs(&pcpu_gic_ctx[core_pos].boot,
+				GIC_PCPU_CTX_ALL);
+		pcpu_gic_ctx[core_pos].boot_valid = 1;
+	}
+
+	/*
+	 * The banked registers may have been reset while the CPU was powered
+	 * down, save them all on the next system suspend.
+	 */
+	pcpu_gic_ctx[core_pos].dirty = GIC_PCPU_CTX_ALL;
 }
 
 void gicv2_setup_cpuif(void)
@@ -193,42 +317,49 @@ void gicv2_setup_distif(void)
 }
 
 /* Save the per-cpu GICD ISENABLER, IPRIORITYR and ICFGR registers */
-void gicv2_save_sgi_ppi_context(void)
+unsigned int gicv2_save_sgi_ppi_context(void)
 {
-	unsigned int i;
+	unsigned int accesses;
 	unsigned int core_pos = platform_get_core_pos(read_mpidr_el1());
 
 	assert(gicd_base_addr);
-	pcpu_gic_ctx[core_pos].gicd_isenabler0 =
-				gicd_read_isenabler(gicd_base_addr, 0);
 
-	/* Read the ipriority registers, 4 at a time */
-	for (i = 0; i < (NUM_PCPU_INTR >> IPRIORITYR_SHIFT); i++)
-		pcpu_gic_ctx[core_pos].gicd_ipriorityr[i] =
-			gicd_read_ipriorityr(gicd_base_addr, i << IPRIORITYR_SHIFT);
+	/* The registers not written since the last save are unchanged */
+	accesses = gicd_read_sgi_ppi_regs(&pcpu_gic_ctx[core_pos].saved,
+			pcpu_gic_ctx[core_pos].dirty);
+	pcpu_gic_ctx[core_pos].dirty = 0;
 
-	pcpu_gic_ctx[core_pos].gicd_icfgr =
-			gicd_read_icfgr(gicd_base_addr, MIN_PPI_ID);
+	return accesses;
 }
 
 /* Restore the per-cpu GICD ISENABLER, IPRIORITYR and ICFGR registers */
-void gicv2_restore_sgi_ppi_context(void)
+unsigned int gicv2_restore_sgi_ppi_context(void)
 {
-	unsigned int i;
 	unsigned int core_pos = platform_get_core_pos(read_mpidr_el1());
+	struct gicv2_pcpu_ctx *ctx = &pcpu_gic_ctx[core_pos];
+	struct gicv2_sgi_ppi_regs live;
+	unsigned int changed, accesses = 0U;
 
 	assert(gicd_base_addr);
 
-	/* Write the ipriority registers, 4 at a time */
-	for (i = 0; i < (NUM_PCPU_INTR >> IPRIORITYR_SHIFT); i++)
-		gicd_write_ipriorityr(gicd_base_addr, i << IPRIORITYR_SHIFT,
-			pcpu_gic_ctx[core_pos].gicd_ipriorityr[i]);
+	changed = sgi_ppi_regs_diff(&ctx->saved, &ctx->boot);
+
+	/*
+	 * Until the firmware is seen bringing the registers the TFTF changed
+	 * back to their boot values, check that the live registers hold them.
+	 */
+	if (ctx->warm_boot == GIC_PCPU_CTX_WARM_UNCHECKED) {
+		accesses = gicd_read_sgi_ppi_regs(&live, GIC_PCPU_CTX_ALL);
+		if (sgi_ppi_regs_diff(&live, &ctx->boot) != 0U)
+			ctx->warm_boot = GIC_PCPU_CTX_WARM_FULL_RESTORE;
+		else if (changed != 0U)
+			ctx->warm_boot = GIC_PCPU_CTX_WARM_BOOT_VALUES;
+	}
 
-	gicd_write_icfgr(gicd_base_addr, MIN_PPI_ID,
-			pcpu_gic_ctx[core_pos].gicd_icfgr);
+	if (ctx->warm_boot == GIC_PCPU_CTX_WARM_FULL_RESTORE)
+		changed = GIC_PCPU_CTX_ALL;
 
-	gicd_write_isenabler(gicd_base_addr, 0,
-			pcpu_gic_ctx[core_pos].gicd_isenabler0);
+	return accesses + gicd_write_sgi_ppi_regs(&ctx->saved, changed);
 }
 
 unsigned int gicv2_gicd_get_ipriorityr(unsigned int interrupt_id)
@@ -246,6 +377,8 @@ void gicv2_gicd_set_ipriorityr(unsigned int interrupt_id,
 	assert(IS_VALID_INTR_ID(interrupt_id));
 
 	gicd_set_ipriorityr(gicd_base_addr, interrupt_id, priority);
+	gicv2_pcpu_ctx_set_dirty(interrupt_id, GIC_PCPU_CTX_IPRIORITYR(
+			interrupt_id >> IPRIORITYR_SHIFT));
 }
 
 void gicv2_send_sgi(unsigned int sgi_id, unsigned int core_pos)
@@ -300,6 +433,7 @@ void gicv2_gicd_set_isenabler(unsigned int num)
 	assert(IS_VALID_INTR_ID(num));
 
 	gicd_set_isenabler(gicd_base_addr, num);
+	gicv2_pcpu_ctx_set_dirty(num, GIC_PCPU_CTX_ISENABLER);
 }
 
 void gicv2_gicd_set_icenabler(unsigned int num)
@@ -308,6 +442,7 @@ void gicv2_gicd_set_icenabler(unsigned int num)
 	assert(IS_VALID_INTR_ID(num));
 
 	gicd_set_icenabler(gicd_base_addr, num);
+	gicv2_pcpu_ctx_set_dirty(num, GIC_PCPU_CTX_ISENABLER);
 }
 
 unsigned int gicv2_gicc_read_iar(void)
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2020, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -27,6 +27,13 @@ static uintptr_t gicd_base_addr;
 	((mpidr) & ((MPIDR_AFFLVL_MASK << MPIDR_AFF2_SHIFT) | MPID_MASK))
 #endif
 
+/* Re-distributor registers of the first 32 interrupts (SGIs and PPIs) */
+struct gicv3_sgi_ppi_regs {
+	unsigned int gicr_isenabler;
+	unsigned int gicr_ipriorityr[NUM_PCPU_INTR >> IPRIORITYR_SHIFT];
+	unsigned int gicr_icfgr;
+};
+
 /*
  * Data structure to store the GIC per CPU context before entering
  * system suspend. Only the GIC context of first 32 interrupts (SGIs and PPIs)
@@ -37,9 +44,13 @@ struct gicv3_pcpu_ctx {
 	/* Flag to indicate whether the CPU is suspended */
 	unsigned int is_suspended;
 	unsigned int icc_igrpen1;
-	unsigned int gicr_isenabler;
-	unsigned int gicr_ipriorityr[NUM_PCPU_INTR >> IPRIORITYR_SHIFT];
-	unsigned int gicr_icfgr;
+	struct gicv3_sgi_ppi_regs saved;
+	/* Registers as configured by the firmware when the CPU first booted */
+	struct gicv3_sgi_ppi_regs boot;
+	/* GIC_PCPU_CTX_WARM_* behaviour of the firmware on warm boot */
+	unsigned int warm_boot;
+	/* GIC_PCPU_CTX_* registers written since the last save */
+	unsigned int dirty;
 };
 
 /* Array to store the per-cpu GICv3 context when being suspended.*/
@@ -123,6 +134,85 @@ static unsigned int gicr_read_ispendr0(uintptr_t base)
 	return mmio_read_32(base + GICR_ISPENDR0);
 }
 
+/******************************************************************************
+ * GIC Re-distributor SGI and PPI context accessors. Only the registers in the
+ * GIC_PCPU_CTX_* `mask` are accessed, the number of accesses is returned.
+ *****************************************************************************/
+static unsigned int gicr_read_sgi_ppi_regs(uintptr_t base,
+		struct gicv3_sgi_ppi_regs *regs, unsigned int mask)
+{
+	unsigned int i, accesses = 0U;
+
+	if (mask & GIC_PCPU_CTX_ISENABLER) {
+		regs->gicr_isenabler = gicr_read_isenabler0(base);
+		accesses++;
+	}
+
+	/* Read the ipriority registers, 4 at a time */
+	for (i = 0; i < (NUM_PCPU_INTR >> IPRIORITYR_SHIFT); i++) {
+		if (mask & GIC_PCPU_CTX_IPRIORITYR(i)) {
+			regs->gicr_ipriorityr[i] = gicr_read_ipriorityr(base,
+					i << IPRIORITYR_SHIFT);
+			accesses++;
+		}
+	}
+
+	if (mask & GIC_PCPU_CTX_ICFGR) {
+		regs->gicr_icfgr = gicr_read_icfgr1(base);
+		accesses++;
+	}
+
+	return accesses;
+}
+
+static unsigned int gicr_write_sgi_ppi_regs(uintptr_t base,
+		const struct gicv3_sgi_ppi_regs *regs, unsigned int mask)
+{
+	unsigned int i, accesses = 0U;
+
+	/* Write the ipriority registers, 4 at a time */
+	for (i = 0; i < (NUM_PCPU_INTR >> IPRIORITYR_SHIFT); i++) {
+		if (mask & GIC_PCPU_CTX_IPRIORITYR(i)) {
+			gicr_write_ipriorityr(base, i << IPRIORITYR_SHIFT,
+					regs->gicr_ipriorityr[i]);
+			accesses++;
+		}
+	}
+
+	if (mask & GIC_PCPU_CTX_ICFGR) {
+		gicr_write_icfgr1(base, regs->gicr_icfgr);
+		accesses++;
+	}
+
+	/* Enable the interrupts last, once they are configured */
+	if (mask & GIC_PCPU_CTX_ISENABLER) {
+		gicr_write_isenabler0(base, regs->gicr_isenabler);
+		accesses++;
+	}
+
+	return accesses;
+}
+
+/* Return the GIC_PCPU_CTX_* mask of the registers that differ */
+static unsigned int sgi_ppi_regs_diff(const struct gicv3_sgi_ppi_regs *a,
+		const struct gicv3_sgi_ppi_regs *b)
+{
+	unsigned int i, mask = 0U;
+
+	if (a->gicr_isenabler != b->gicr_isenabler)
+		mask |= GIC_PCPU_CTX_ISENABLER;
+
+	for (i = 0; i < (NUM_PCPU_INTR >> IPRIORITYR_SHIFT); i++) {
+		if (a->gicr_ipriorityr[i] != b->gicr_ipriorityr[i])
+			mask |= GIC_PCPU_CTX_IPRIORITYR(i);
+	}
+
+	if (a->gicr_icfgr != b->gicr_icfgr)
+		mask |= GIC_PCPU_CTX_ICFGR;
+
+	return mask;
+}
+
 /******************************************************************************
  * GIC Re-distributor interface accessors for individual interrupt
  * manipulation
@@ -202,9 +292,9 @@ void gicv3_restore_cpuif_context(void)
 	isb();
 }
 
-void gicv3_save_sgi_ppi_context(void)
+unsigned int gicv3_save_sgi_ppi_context(void)
 {
-	unsigned int i, core_pos;
+	unsigned int core_pos, accesses = 0U;
 	unsigned int my_core_pos = platform_get_core_pos(read_mpidr_el1());
 
 	/* Save the context for all the suspended cores */
@@ -219,24 +309,22 @@ void gicv3_save_sgi_ppi_context(void)
 
 		assert(rdist_pcpu_base[core_pos]);
 
-		pcpu_ctx[core_pos].gicr_isenabler =
-					gicr_read_isenabler0(rdist_pcpu_base[core_pos]);
-
-		/* Read the ipriority registers, 4 at a time */
-		for (i = 0; i < (NUM_PCPU_INTR >> IPRIORITYR_SHIFT); i++)
-			pcpu_ctx[core_pos].gicr_ipriorityr[i] =
-				gicr_read_ipriorityr(rdist_pcpu_base[core_pos],
-						i << IPRIORITYR_SHIFT);
-
-		pcpu_ctx[core_pos].gicr_icfgr =
-				gicr_read_icfgr1(rdist_pcpu_base[core_pos]);
+		/* The registers not written since the last save are unchanged */
+		accesses += gicr_read_sgi_ppi_regs(rdist_pcpu_base[core_pos],
+				&pcpu_ctx[core_pos].saved,
+				pcpu_ctx[core_pos].dirty);
+		pcpu_ctx[core_pos].dirty = 0;
 	}
+
+	return accesses;
 }
 
-void gicv3_restore_sgi_ppi_context(void)
+unsigned int gicv3_restore_sgi_ppi_context(void)
 {
-	unsigned int i, core_pos;
+	unsigned int core_pos, changed, accesses = 0U;
 	unsigned int my_core_pos = platform_get_core_pos(read_mpidr_el1());
+	struct gicv3_sgi_ppi_regs live;
+	struct gicv3_pcpu_ctx *ctx;
 
 	/* Restore the context for all the suspended cores */
 	for (core_pos = 0; core_pos < PLATFORM_CORE_COUNT; core_pos++) {
@@ -249,18 +337,32 @@ void gicv3_restore_sgi_ppi_context(void)
 			continue;
 
 		assert(rdist_pcpu_base[core_pos]);
+		ctx = &pcpu_ctx[core_pos];
+		changed = sgi_ppi_regs_diff(&ctx->saved, &ctx->boot);
+
+		/*
+		 * Until the firmware is seen bringing the registers the TFTF
+		 * changed back to their boot values, check that the live
+		 * registers hold them.
+		 */
+		if (ctx->warm_boot == GIC_PCPU_CTX_WARM_UNCHECKED) {
+			accesses += gicr_read_sgi_ppi_regs(
+					rdist_pcpu_base[core_pos], &live,
+					GIC_PCPU_CTX_ALL);
+			if (sgi_ppi_regs_diff(&live, &ctx->boot) != 0U)
+				ctx->warm_boot = GIC_PCPU_CTX_WARM_FULL_RESTORE;
+			else if (changed != 0U)
+				ctx->warm_boot = GIC_PCPU_CTX_WARM_BOOT_VALUES;
+		}
 
-		/* Read the ipriority registers, 4 at a time */
-		for (i = 0; i < (NUM_PCPU_INTR >> IPRIORITYR_SHIFT); i++)
-			gicr_write_ipriorityr(rdist_pcpu_base[core_pos],
-					i << IPRIORITYR_SHIFT,
-					pcpu_ctx[core_pos].gicr_ipriorityr[i]);
+		if (ctx->warm_boot == GIC_PCPU_CTX_WARM_FULL_RESTORE)
+			changed = GIC_PCPU_CTX_ALL;
 
-		gicr_write_icfgr1(rdist_pcpu_base[core_pos],
-				pcpu_ctx[core_pos].gicr_icfgr);
-		gicr_write_isenabler0(rdist_pcpu_base[core_pos],
-				pcpu_ctx[core_pos].gicr_isenabler);
+		accesses += gicr_write_sgi_ppi_regs(rdist_pcpu_base[core_pos],
+				&ctx->saved, changed);
 	}
+
+	return accesses;
 }
 
 unsigned int gicv3_get_ipriorityr(unsigned int interrupt_id)
@@ -292,6 +394,8 @@ void gicv3_set_ipriorityr(unsigned int interrupt_id,
 		assert(rdist_pcpu_base[core_pos]);
 		mmio_write_8(rdist_pcpu_base[core_pos] + GICR_IPRIORITYR
 				+ interrupt_id, priority & GIC_PRI_MASK);
+		pcpu_ctx[core_pos].dirty |= GIC_PCPU_CTX_IPRIORITYR(
+				interrupt_id >> IPRIORITYR_SHIFT);
 	} else {
 		mmio_write_8(gicd_base_addr + GICD_IPRIORITYR + interrupt_id,
 					priority & GIC_PRI_MASK);
@@ -383,6 +487,7 @@ void gicv3_set_isenabler(unsigned int interrupt_id)
 		core_pos = platform_get_core_pos(read_mpidr_el1());
 		assert(rdist_pcpu_base[core_pos]);
 		gicr_set_isenabler0(rdist_pcpu_base[core_pos], interrupt_id);
+		pcpu_ctx[core_pos].dirty |= GIC_PCPU_CTX_ISENABLER;
 	} else
 		gicd_set_isenabler(gicd_base_addr, interrupt_id);
 }
@@ -398,6 +503,7 @@ void gicv3_set_icenabler(unsigned int interrupt_id)
 		core_pos = platform_get_core_pos(read_mpidr_el1());
 		assert(rdist_pcpu_base[core_pos]);
 		gicr_set_icenabler0(rdist_pcpu_base[core_pos], interrupt_id);
+		pcpu_ctx[core_pos].dirty |= GIC_PCPU_CTX_ISENABLER;
 	} else
 		gicd_set_icenabler(gicd_base_addr, interrupt_id);
 }
@@ -446,6 +552,12 @@ void gicv3_probe_redistif_addr(void)
 
 	assert(gicr_base_addr);
 
+	/*
+	 * The Re-distributor may have been powered down with the CPU, save
+	 * its whole context on the next system suspend.
+	 */
+	pcpu_ctx[core_pos].dirty = GIC_PCPU_CTX_ALL;
+
 	/*
 	 * Return if the re-distributor base address is already populated
 	 * for this core.
@@ -461,6 +573,18 @@ void gicv3_probe_redistif_addr(void)
 		if (affinity == ((typer_val >> TYPER_AFF_VAL_SHIFT) & TYPER_AFF_VAL_MASK)) {
 			rdist_pcpu_base[core_pos] = rdistif_base;
 			mpidr_list[core_pos] = read_mpidr_el1() & MPIDR_AFFINITY_MASK;
+			/*
+			 * Snapshot the registers as the firmware configured
+			 * them on cold boot. The context restore assumes that
+			 * the firmware programs them back to these values on
+			 * warm boot, so that only the registers the TFTF
+			 * changed need to be written. This is checked on the
+			 * first restore of the CPU, which falls back to a full
+			 * restore if it does not hold.
+			 */
+			(void)gicr_read_sgi_ppi_regs(rdistif_base,
+					&pcpu_ctx[core_pos].boot,
+					GIC_PCPU_CTX_ALL);
 			return;
 		}
 		rdistif_base += (1 << GICR_PCPUBASE_SHIFT);
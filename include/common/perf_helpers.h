@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef PERF_HELPERS_H
+#define PERF_HELPERS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <tftf.h>
+
+/*
+ * Number of buckets in a latency histogram. Bucket 'i' (i > 0) accounts for
+ * samples in the range [2^(i-1), 2^i) ticks, bucket 0 for samples of 0 ticks.
+ * The last bucket also accounts for all samples beyond its upper bound.
+ */
+#define PERF_HIST_BUCKETS	32U
+
+/*
+ * Latency statistics, in system counter ticks.
+ */
+struct perf_stats {
+	uint64_t count;
+	uint64_t min;
+	uint64_t max;
+	uint64_t sum;
+	uint32_t hist[PERF_HIST_BUCKETS];
+};
+
+/* Reset the statistics in 'stats'. */
+void perf_stats_init(struct perf_stats *stats);
+
+/* Account for one sample of 'ticks' system counter ticks. */
+void perf_stats_add(struct perf_stats *stats, uint64_t ticks);
+
+/* Accumulate the samples of 'src' into 'dst'. */
+void perf_stats_merge(struct perf_stats *dst, const struct perf_stats *src);
+
+/* Return the average sample value, or 0 if there are no samples. */
+uint64_t perf_stats_avg(const struct perf_stats *stats);
+
+/*
+ * Return an upper bound of the 'pct' percentile of the samples (0 < pct <= 100),
+ * derived from the histogram. The value is clamped to the maximum sample.
+ */
+uint64_t perf_stats_percentile(const struct perf_stats *stats,
+			       unsigned int pct);
+
+/*
+ * Print a one line summary of 'stats' (in nanoseconds) to the console, and
+ * the non-empty histogram buckets if 'print_hist' is true.
+ */
+void perf_stats_print(const char *name, const struct perf_stats *stats,
+		      bool print_hist);
+
+/* Convert system counter ticks to nanoseconds. */
+uint64_t perf_ticks_to_ns(uint64_t ticks);
+
+/* Return the number of 'events' per second that occurred in 'ticks'. */
+uint64_t perf_rate_per_sec(uint64_t events, uint64_t ticks);
+
+/*
+ * Run 'fn' concurrently on the calling (lead) CPU and on 'cpu_count - 1'
+ * secondary CPUs. All CPUs are released together once every one of them has
+ * been powered on, and the function returns once they are all powered off
+ * again, so it can be called repeatedly with a growing 'cpu_count'.
+ *
+ * The result returned by 'fn' on secondary CPUs is collected by the framework.
+ * The result returned by 'fn' on the lead CPU is returned to the caller.
+ */
+test_result_t perf_run_on_cpus(unsigned int cpu_count, test_function_t fn);
+
+/*
+ * Return the CPU count that follows 'count' in a benchmark scaling from 1 CPU
+ * to 'max' CPUs, or 0 once 'count' reached 'max'. The count doubles each time
+ * and ends with 'max' itself.
+ */
+unsigned int perf_next_cpu_count(unsigned int count, unsigned int max);
+
+/* Iterate 'count' over the CPU counts from 'first' to 'max', as above. */
+#define for_each_perf_cpu_count(count, first, max)			\
+	for ((count) = (first); (count) != 0U;				\
+	     (count) = perf_next_cpu_count((count), (max)))
+
+/*
+ * Aggregate throughput of the CPUs of a run of perf_run_on_cpus(): the events
+ * they accounted for, from the first CPU starting to the last one finishing.
+ */
+struct perf_throughput {
+	uint64_t start;
+	uint64_t end;
+	uint64_t events;
+};
+
+/*
+ * Called by 'fn' on each CPU of perf_run_on_cpus() before and after the events
+ * it accounts for. CPUs that do not call perf_throughput_end(), or call it with
+ * no events, are not part of the aggregate throughput.
+ */
+void perf_throughput_start(void);
+void perf_throughput_end(uint64_t events);
+
+/* Collect the aggregate throughput of the last run of perf_run_on_cpus(). */
+void perf_throughput_collect(struct perf_throughput *tp);
+
+/*
+ * Return true if the CPU at 'core_pos' accounted for events in the last run of
+ * perf_run_on_cpus(), to merge the per-CPU results of a benchmark.
+ */
+bool perf_throughput_has_cpu(unsigned int core_pos);
+
+/* Return the number of events per second of 'tp'. */
+uint64_t perf_throughput_rate(const struct perf_throughput *tp);
+
+#endif /* PERF_HELPERS_H */
@@ -0,0 +1,31 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef PMF_HELPERS_H
+#define PMF_HELPERS_H
+
+#include <stdbool.h>
+
+#include <pmf.h>
+#include <tftf_lib.h>
+
+/*
+ * Read the timestamp 'tid' of the calling CPU from the EL3 firmware into 'ts'.
+ * Return 0 on success, else the error returned by PMF_SMC_GET_TIMESTAMP.
+ */
+u_register_t pmf_get_ts(u_register_t tid, u_register_t *ts);
+
+/*
+ * Read the first 'count' runtime instrumentation timestamps of the calling CPU
+ * into 'ts', indexed by PMF_RT_INSTR_* ID. Return 0 on success, -1 if one of
+ * them cannot be read.
+ */
+int pmf_rt_instr_get_ts(u_register_t *ts, unsigned int count);
+
+/* Return true if the EL3 firmware provides runtime instrumentation. */
+bool pmf_rt_instr_is_supported(void);
+
+#endif /* PMF_HELPERS_H */
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -150,4 +150,14 @@ void arm_gic_save_context_global(void);
  *****************************************************************************/
 void arm_gic_restore_context_global(void);
 
+/******************************************************************************
+ * Get the number of MMIO accesses made to the SGI and PPI registers by the
+ * last arm_gic_save_context_global() in `save` and by the last
+ * arm_gic_restore_context_global() in `restore`. Only the registers written
+ * since the last save are saved, and only those that differ from their boot
+ * value are restored once the firmware was seen resetting them to it.
+ *****************************************************************************/
+void arm_gic_get_context_mmio_accesses(unsigned int *save,
+				       unsigned int *restore);
+
 #endif /* __ARM_GIC_H__ */
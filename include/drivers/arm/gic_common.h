@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -44,6 +44,26 @@
  */
 #define NUM_PCPU_INTR	32
 
+/*
+ * Registers of the per-cpu interrupt context, as a mask of the registers
+ * written since the context was last saved or differing from their value at
+ * boot.
+ */
+#define GIC_PCPU_CTX_IPRIORITYR(n)	(1U << (n))
+#define GIC_PCPU_CTX_ISENABLER						\
+	GIC_PCPU_CTX_IPRIORITYR(NUM_PCPU_INTR >> IPRIORITYR_SHIFT)
+#define GIC_PCPU_CTX_ICFGR		(GIC_PCPU_CTX_ISENABLER << 1)
+#define GIC_PCPU_CTX_ALL		((GIC_PCPU_CTX_ICFGR << 1) - 1U)
+
+/*
+ * What the firmware was seen doing to the per-cpu interrupt context of a CPU
+ * on warm boot: not checked yet, bringing the registers the TFTF changed back
+ * to their boot values, or anything else, which requires a full restore.
+ */
+#define GIC_PCPU_CTX_WARM_UNCHECKED	0U
+#define GIC_PCPU_CTX_WARM_BOOT_VALUES	1U
+#define GIC_PCPU_CTX_WARM_FULL_RESTORE	2U
+
 #ifndef __ASSEMBLY__
 
 #include <mmio.h>
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -293,15 +293,18 @@ void gicv2_setup_distif(void);
 
 /*
  * Save the GICv2 SGI and PPI context prior to powering down the
- * GIC Distributor.
+ * GIC Distributor. Only the registers written since the last save are read.
+ * Return the number of MMIO accesses made.
  */
-void gicv2_save_sgi_ppi_context(void);
+unsigned int gicv2_save_sgi_ppi_context(void);
 
 /*
  * Restore the GICv2 SGI and PPI context after powering up the
- * GIC Distributor.
+ * GIC Distributor. Only the registers that differ from their value at boot
+ * are written, unless the firmware was not seen resetting them to it on warm
+ * boot. Return the number of MMIO accesses made.
  */
-void gicv2_restore_sgi_ppi_context(void);
+unsigned int gicv2_restore_sgi_ppi_context(void);
 
 /*
  * Disable the GIC CPU interface.
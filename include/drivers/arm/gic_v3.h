@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2020, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -175,15 +175,18 @@ void gicv3_set_ipriorityr(unsigned int interrupt_id, unsigned int priority);
 
 /*
  * Restore the GICv3 SGI and PPI context after powering up the
- * GIC Re-distributor.
+ * GIC Re-distributor. Only the registers that differ from their value at boot
+ * are written, unless the firmware was not seen resetting them to it on warm
+ * boot. Return the number of MMIO accesses made.
  */
-void gicv3_restore_sgi_ppi_context(void);
+unsigned int gicv3_restore_sgi_ppi_context(void);
 
 /*
  * Save the GICv3 SGI and PPI context prior to powering down the
- * GIC Re-distributor.
+ * GIC Re-distributor. Only the registers written since the last save are
+ * read. Return the number of MMIO accesses made.
  */
-void gicv3_save_sgi_ppi_context(void);
+unsigned int gicv3_save_sgi_ppi_context(void);
 
 /*
  * Restore the GICv3 CPU interface after powering up the CPU interface.
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2022, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2016-2023, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -106,6 +106,12 @@
 #define ID_DFR0_TRACEFILT_MASK		U(0xf)
 #define ID_DFR0_TRACEFILT_SUPPORTED	U(1)
 
+/* ID_DFR0_EL1 definitions */
+#define ID_DFR0_PERFMON_SHIFT		U(24)
+#define ID_DFR0_PERFMON_MASK		U(0xf)
+#define ID_DFR0_PERFMON_PMUV3		U(3)
+#define ID_DFR0_PERFMON_IMP_DEF		U(0xf)
+
 /* ID_DFR0_EL1 definitions */
 #define ID_DFR0_COPTRC_SHIFT		U(12)
 #define ID_DFR0_COPTRC_MASK		U(0xf)
@@ -433,7 +439,9 @@
 
 /* PMEVTYPER<n> definitions */
 #define PMEVTYPER_EL0_P_BIT		(U(1) << 31)
+#define PMEVTYPER_EL0_U_BIT		(U(1) << 30)
 #define PMEVTYPER_EL0_NSK_BIT		(U(1) << 29)
+#define PMEVTYPER_EL0_NSU_BIT		(U(1) << 28)
 #define PMEVTYPER_EL0_NSH_BIT		(U(1) << 27)
 #define PMEVTYPER_EL0_M_BIT		(U(1) << 26)
 #define PMEVTYPER_EL0_MT_BIT		(U(1) << 25)
@@ -442,14 +450,24 @@
 
 /* PMCCFILTR definitions */
 #define PMCCFILTR_EL0_P_BIT		(U(1) << 31)
+#define PMCCFILTR_EL0_U_BIT		(U(1) << 30)
 #define PMCCFILTR_EL0_NSK_BIT		(U(1) << 29)
+#define PMCCFILTR_EL0_NSU_BIT		(U(1) << 28)
 #define PMCCFILTR_EL0_NSH_BIT		(U(1) << 27)
 #define PMCCFILTR_EL0_M_BIT		(U(1) << 26)
 #define PMCCFILTR_EL0_MT_BIT		(U(1) << 25)
 #define PMCCFILTR_EL0_SH_BIT		(U(1) << 24)
 
 /* PMU event counter ID definitions */
+#define PMU_EV_L1I_CACHE_REFILL		U(0x0001)
+#define PMU_EV_L1I_TLB_REFILL		U(0x0002)
+#define PMU_EV_L1D_CACHE_REFILL		U(0x0003)
+#define PMU_EV_L1D_TLB_REFILL		U(0x0005)
+#define PMU_EV_INST_RETIRED		U(0x0008)
 #define PMU_EV_PC_WRITE_RETIRED		U(0x000C)
+#define PMU_EV_BR_MIS_PRED		U(0x0010)
+#define PMU_EV_CPU_CYCLES		U(0x0011)
+#define PMU_EV_L2D_CACHE_REFILL		U(0x0017)
 
 /* DBGDIDR definitions */
 #define DBGDIDR_VERSION_SHIFT	U(16)
@@ -547,6 +565,9 @@
  */
 #define ESR_ISS_EABORT_EA_BIT		U(9)
 
+/* Instruction Syndrome Valid bit in Data Abort synchronous exception syndromes */
+#define ESR_ISS_DABORT_ISV_BIT		U(24)
+
 #define EC_BITS(x)			(((x) >> ESR_EC_SHIFT) & ESR_EC_MASK)
 #define ISS_BITS(x)			(((x) >> ESR_ISS_SHIFT) & ESR_ISS_MASK)
 
@@ -608,6 +629,7 @@
 #define CCSIDR		p15, 1, c0, c0, 0
 #define HTCR		p15, 4, c2, c0, 2
 #define HMAIR0		p15, 4, c10, c2, 0
+#define HTPIDR		p15, 4, c13, c0, 2
 #define ATS1CPR		p15, 0, c7, c8, 0
 #define ATS1HR		p15, 4, c7, c8, 0
 #define DBGOSDLR	p14, 0, c1, c3, 4
@@ -617,10 +639,15 @@
 #define HDCR		p15, 4, c1, c1, 1
 #define PMCR		p15, 0, c9, c12, 0
 #define PMCNTENSET	p15, 0, c9, c12, 1
+#define PMCNTENCLR	p15, 0, c9, c12, 2
+#define PMOVSR		p15, 0, c9, c12, 3
+#define PMSELR		p15, 0, c9, c12, 5
 #define PMCCFILTR	p15, 0, c14, c15, 7
 #define PMCCNTR		p15, 0, c9, c13, 0
 #define PMEVTYPER0	p15, 0, c14, c12, 0
 #define PMEVCNTR0	p15, 0, c14, c8, 0
+#define PMXEVTYPER	p15, 0, c9, c13, 1
+#define PMXEVCNTR	p15, 0, c9, c13, 2
 #define DBGDIDR		p14, 0, c0, c0, 0
 #define CNTHP_TVAL	p15, 4, c14, c2, 0
 #define CNTHP_CTL	p15, 4, c14, c2, 1
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2022, Arm Limited and Contributors. All rights reserved.
+ * Copyright (c) 2016-2023, Arm Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -222,6 +222,7 @@ DEFINE_COPROCR_RW_FUNCS(ctr, CTR)
 DEFINE_COPROCR_RW_FUNCS(sctlr, SCTLR)
 DEFINE_COPROCR_RW_FUNCS(actlr, ACTLR)
 DEFINE_COPROCR_RW_FUNCS(hsctlr, HSCTLR)
+DEFINE_COPROCR_RW_FUNCS(htpidr, HTPIDR)
 DEFINE_COPROCR_RW_FUNCS(hcr, HCR)
 DEFINE_COPROCR_RW_FUNCS(hcptr, HCPTR)
 DEFINE_COPROCR_RW_FUNCS(cntfrq, CNTFRQ)
@@ -280,6 +281,11 @@ DEFINE_COPROCR_RW_FUNCS(hdcr, HDCR)
 DEFINE_COPROCR_RW_FUNCS(cnthp_ctl, CNTHP_CTL)
 DEFINE_COPROCR_RW_FUNCS(pmcr, PMCR)
 DEFINE_COPROCR_RW_FUNCS(pmcntenset, PMCNTENSET)
+DEFINE_COPROCR_RW_FUNCS(pmcntenclr, PMCNTENCLR)
+DEFINE_COPROCR_RW_FUNCS(pmovsr, PMOVSR)
+DEFINE_COPROCR_RW_FUNCS(pmselr, PMSELR)
+DEFINE_COPROCR_RW_FUNCS(pmxevtyper, PMXEVTYPER)
+DEFINE_COPROCR_RW_FUNCS(pmxevcntr, PMXEVCNTR)
 DEFINE_COPROCR_RW_FUNCS(pmccfiltr, PMCCFILTR)
 DEFINE_COPROCR_READ_FUNC(pmccntr, PMCCNTR)
 DEFINE_COPROCR_RW_FUNCS(pmevtyper0, PMEVTYPER0)
@@ -407,6 +413,21 @@ static inline unsigned int get_current_el(void)
 #define read_pmcntenset_el0()		read_pmcntenset()
 #define write_pmcntenset_el0(_v)	write_pmcntenset(_v)
 
+#define read_pmcntenclr_el0()		read_pmcntenclr()
+#define write_pmcntenclr_el0(_v)	write_pmcntenclr(_v)
+
+#define read_pmovsclr_el0()		read_pmovsr()
+#define write_pmovsclr_el0(_v)		write_pmovsr(_v)
+
+#define read_pmselr_el0()		read_pmselr()
+#define write_pmselr_el0(_v)		write_pmselr(_v)
+
+#define read_pmxevtyper_el0()		read_pmxevtyper()
+#define write_pmxevtyper_el0(_v)	write_pmxevtyper(_v)
+
+#define read_pmxevcntr_el0()		read_pmxevcntr()
+#define write_pmxevcntr_el0(_v)		write_pmxevcntr(_v)
+
 #define read_pmccfiltr_el0()		read_pmccfiltr()
 #define write_pmccfiltr_el0(_v)		write_pmccfiltr(_v)
 
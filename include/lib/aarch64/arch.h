@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2022, Arm Limited and Contributors. All rights reserved.
+ * Copyright (c) 2013-2023, Arm Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -156,6 +156,13 @@
 #define ID_AA64DFR0_PMS_LENGTH	U(4)
 #define ID_AA64DFR0_PMS_MASK	ULL(0xf)
 
+/* ID_AA64DFR0_EL1.PMUVer definitions */
+#define ID_AA64DFR0_PMUVER_SHIFT	U(8)
+#define ID_AA64DFR0_PMUVER_LENGTH	U(4)
+#define ID_AA64DFR0_PMUVER_MASK		ULL(0xf)
+#define ID_AA64DFR0_PMUVER_NOT_SUPPORTED	U(0)
+#define ID_AA64DFR0_PMUVER_IMP_DEF	U(0xf)
+
 /* ID_AA64DFR0_EL1.DEBUG definitions */
 #define ID_AA64DFR0_DEBUG_SHIFT			U(0)
 #define ID_AA64DFR0_DEBUG_LENGTH		U(4)
@@ -726,6 +733,9 @@
  */
 #define ESR_ISS_EABORT_EA_BIT		U(9)
 
+/* Instruction Syndrome Valid bit in Data Abort synchronous exception syndromes */
+#define ESR_ISS_DABORT_ISV_BIT		U(24)
+
 #define EC_BITS(x)			(((x) >> ESR_EC_SHIFT) & ESR_EC_MASK)
 #define ISS_BITS(x)			(((x) >> ESR_ISS_SHIFT) & ESR_ISS_MASK)
 
@@ -776,6 +786,7 @@
 #define PMCR_EL0_N_SHIFT	U(11)
 #define PMCR_EL0_N_MASK		U(0x1f)
 #define PMCR_EL0_N_BITS		(PMCR_EL0_N_MASK << PMCR_EL0_N_SHIFT)
+#define PMCR_EL0_LP_BIT		(U(1) << 7)
 #define PMCR_EL0_LC_BIT		(U(1) << 6)
 #define PMCR_EL0_DP_BIT		(U(1) << 5)
 #define PMCR_EL0_X_BIT		(U(1) << 4)
@@ -788,7 +799,9 @@
 
 /* PMEVTYPER<n>_EL0 definitions */
 #define PMEVTYPER_EL0_P_BIT		(U(1) << 31)
+#define PMEVTYPER_EL0_U_BIT		(U(1) << 30)
 #define PMEVTYPER_EL0_NSK_BIT		(U(1) << 29)
+#define PMEVTYPER_EL0_NSU_BIT		(U(1) << 28)
 #define PMEVTYPER_EL0_NSH_BIT		(U(1) << 27)
 #define PMEVTYPER_EL0_M_BIT		(U(1) << 26)
 #define PMEVTYPER_EL0_MT_BIT		(U(1) << 25)
@@ -797,14 +810,24 @@
 
 /* PMCCFILTR_EL0 definitions */
 #define PMCCFILTR_EL0_P_BIT		(U(1) << 31)
+#define PMCCFILTR_EL0_U_BIT		(U(1) << 30)
 #define PMCCFILTR_EL0_NSK_BIT		(U(1) << 29)
+#define PMCCFILTR_EL0_NSU_BIT		(U(1) << 28)
 #define PMCCFILTR_EL0_NSH_BIT		(U(1) << 27)
 #define PMCCFILTR_EL0_M_BIT		(U(1) << 26)
 #define PMCCFILTR_EL0_MT_BIT		(U(1) << 25)
 #define PMCCFILTR_EL0_SH_BIT		(U(1) << 24)
 
 /* PMU event counter ID definitions */
+#define PMU_EV_L1I_CACHE_REFILL		U(0x0001)
+#define PMU_EV_L1I_TLB_REFILL		U(0x0002)
+#define PMU_EV_L1D_CACHE_REFILL		U(0x0003)
+#define PMU_EV_L1D_TLB_REFILL		U(0x0005)
+#define PMU_EV_INST_RETIRED		U(0x0008)
 #define PMU_EV_PC_WRITE_RETIRED		U(0x000C)
+#define PMU_EV_BR_MIS_PRED		U(0x0010)
+#define PMU_EV_CPU_CYCLES		U(0x0011)
+#define PMU_EV_L2D_CACHE_REFILL		U(0x0017)
 
 /*******************************************************************************
  * Definitions for system register interface to SVE
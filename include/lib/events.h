@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -7,7 +7,10 @@
 #ifndef __EVENTS_H__
 #define __EVENTS_H__
 
+#include <cdefs.h>
+#include <platform_def.h>
 #include <spinlock.h>
+#include <stdint.h>
 
 typedef struct {
 	/*
@@ -79,4 +82,54 @@ void tftf_send_event_to(event_t *event, unsigned int cpus_count);
  */
 void tftf_wait_for_event(event_t *event);
 
+/*
+ * Barrier synchronising a set of CPUs.
+ *
+ * The participating CPUs are ranked and arranged in a tree of arity
+ * BARRIER_ARITY: each CPU waits for its children to arrive, tells its parent
+ * that its whole subtree has arrived, then waits for its parent to release it
+ * and releases its children in turn. So a barrier uses memory linear in the
+ * number of CPUs and wakes them up in a number of steps logarithmic in it.
+ * Each CPU only spins on flags of its own node or of its children's nodes,
+ * which are all on their own cache lines.
+ *
+ * A barrier can be reused for any number of synchronisations once initialised:
+ * each node flips the value it waits for on every synchronisation.
+ */
+#define BARRIER_ARITY	4
+
+typedef struct {
+	/* Written by the CPU once its subtree has arrived */
+	volatile unsigned int arrived;
+	/* Written by the parent of the CPU to release it */
+	volatile unsigned int released;
+	/* Value of the flags for the current synchronisation */
+	unsigned int sense;
+} __aligned(CACHE_WRITEBACK_GRANULE) barrier_node_t;
+
+typedef struct {
+	barrier_node_t nodes[PLATFORM_CORE_COUNT];
+	/* Rank in the tree of each core position */
+	uint16_t rank[PLATFORM_CORE_COUNT];
+	unsigned int cpus_count;
+} barrier_t;
+
+/*
+ * Initialise a barrier.
+ *   barrier: Address of the barrier to initialise
+ *   exclude_mpid: MPID of a CPU that does not take part in the barrier, or
+ *                 INVALID_MPID for a barrier between all the CPUs.
+ *
+ * Note: Like tftf_init_event(), this function is not MP-safe. It must be called
+ * before any of the participating CPUs waits on the barrier.
+ */
+void tftf_init_barrier(barrier_t *barrier, u_register_t exclude_mpid);
+
+/*
+ * Wait until all the CPUs taking part in the barrier have called this
+ * function.
+ *   barrier: Address of the barrier to wait on
+ */
+void tftf_barrier_wait(barrier_t *barrier);
+
 #endif /* __EVENTS_H__ */
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2017-2021, Arm Limited. All rights reserved.
+ * Copyright (c) 2017-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -7,6 +7,7 @@
 #ifndef AMU_H
 #define AMU_H
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #include <cassert.h>
@@ -16,6 +17,12 @@
 #define AMU_GROUP0_COUNTERS_MASK	U(0xf)
 #define AMU_GROUP0_NR_COUNTERS		U(4)
 
+/* Architected group 0 counters */
+#define AMU_GROUP0_CORE_CYCLES		U(0)
+#define AMU_GROUP0_CONST_CYCLES		U(1)
+#define AMU_GROUP0_INST_RETIRED		U(2)
+#define AMU_GROUP0_MEM_STALL_CYCLES	U(3)
+
 #ifdef PLAT_AMU_GROUP1_COUNTERS_MASK
 #define AMU_GROUP1_COUNTERS_MASK	PLAT_AMU_GROUP1_COUNTERS_MASK
 #else
@@ -77,4 +84,66 @@ void amu_group1_voffset_write(unsigned int idx, uint64_t val);
 #endif
 #endif
 
+/*
+ * Values of the group 0 counters of a CPU and of the system counter at the
+ * time they were read.
+ */
+struct amu_group0_snapshot {
+	uint64_t timestamp;
+	uint64_t cnt[AMU_GROUP0_NR_COUNTERS];
+};
+
+/*
+ * Activity of a CPU accumulated over a number of intervals, each delimited by
+ * two snapshots of its group 0 counters.
+ *
+ * The core and constant frequency cycle counters do not count while the CPU is
+ * in WFI, WFE or powered down. The constant frequency cycles counter counts at
+ * the frequency of the system counter, so the ratio of the two is the share of
+ * the interval the CPU was active, and the core cycles per constant cycle give
+ * its effective frequency while it was active.
+ */
+struct amu_activity {
+	uint64_t intervals;
+	uint64_t ticks;
+	uint64_t cnt[AMU_GROUP0_NR_COUNTERS];
+};
+
+/*
+ * Return true if the AMU is implemented and EL3 has enabled all the group 0
+ * counters.
+ */
+bool amu_group0_enabled(void);
+
+/* Read the group 0 counters of the calling CPU into 'snap'. */
+void amu_group0_snapshot(struct amu_group0_snapshot *snap);
+
+/* Reset the activity in 'act'. */
+void amu_activity_init(struct amu_activity *act);
+
+/*
+ * Account for the interval between the snapshots 'start' and 'end' of the same
+ * CPU in 'act'. An interval in which a counter went backwards, for instance
+ * because EL3 did not restore it on resume, is discarded and -1 is returned.
+ */
+int amu_activity_add(struct amu_activity *act,
+		     const struct amu_group0_snapshot *start,
+		     const struct amu_group0_snapshot *end);
+
+/* Accumulate the intervals of 'src' into 'dst'. */
+void amu_activity_merge(struct amu_activity *dst,
+			const struct amu_activity *src);
+
+/* Return the effective frequency in kHz while active, or 0 if unknown. */
+uint64_t amu_activity_freq_khz(const struct amu_activity *act);
+
+/* Return the share of the core cycles stalled on memory, in per mille. */
+unsigned int amu_activity_stall_permille(const struct amu_activity *act);
+
+/* Return the share of the elapsed time the CPU was active, in per mille. */
+unsigned int amu_activity_active_permille(const struct amu_activity *act);
+
+/* Print a one line summary of 'act' to the console. */
+void amu_activity_print(const char *name, const struct amu_activity *act);
+
 #endif /* AMU_H */
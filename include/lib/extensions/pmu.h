@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef PMU_H
+#define PMU_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <utils_def.h>
+
+/*
+ * Exception levels and security states in which a profile counts, to be
+ * combined in the 'filter' argument of pmu_profile_init().
+ */
+#define PMU_COUNT_NS_EL0	(U(1) << 0)
+#define PMU_COUNT_NS_EL1	(U(1) << 1)
+#define PMU_COUNT_NS_EL2	(U(1) << 2)
+#define PMU_COUNT_S_EL0		(U(1) << 3)
+#define PMU_COUNT_S_EL1		(U(1) << 4)
+#define PMU_COUNT_S_EL2		(U(1) << 5)
+#define PMU_COUNT_EL3		(U(1) << 6)
+
+#define PMU_COUNT_NS		(PMU_COUNT_NS_EL0 | PMU_COUNT_NS_EL1 |	\
+				 PMU_COUNT_NS_EL2)
+#define PMU_COUNT_SECURE	(PMU_COUNT_S_EL0 | PMU_COUNT_S_EL1 |	\
+				 PMU_COUNT_S_EL2 | PMU_COUNT_EL3)
+#define PMU_COUNT_ALL		(PMU_COUNT_NS | PMU_COUNT_SECURE)
+
+/* Highest number of events in a profile */
+#define PMU_PROFILE_MAX_EVENTS	U(16)
+
+/*
+ * Profile of a region of code, delimited by pmu_profile_start() and
+ * pmu_profile_stop() and usually run many times.
+ *
+ * The cycle counter is counted on every run. When a profile has more events
+ * than the PMU has event counters, the events are split into groups of as many
+ * events as there are counters and each run counts the next group in turn. The
+ * result of an event is then its average over the runs it was counted in.
+ *
+ * Event counters are 32-bit wide. They are accumulated in 64 bits, accounting
+ * for an overflow during a run from the overflow status flags.
+ */
+struct pmu_profile {
+	unsigned int filter;
+	unsigned int nr_events;
+	uint16_t events[PMU_PROFILE_MAX_EVENTS];
+	unsigned int group_size;
+	unsigned int nr_groups;
+
+	/* Group counted by the current or next run and its start values */
+	unsigned int group;
+	uint64_t cycles_start;
+	uint32_t start[PMU_PROFILE_MAX_EVENTS];
+
+	/* Totals and values of the last run of the cycles and of each event */
+	uint64_t runs;
+	uint64_t cycles;
+	uint64_t last_cycles;
+	uint64_t counts[PMU_PROFILE_MAX_EVENTS];
+	uint64_t last[PMU_PROFILE_MAX_EVENTS];
+	uint64_t group_runs[PMU_PROFILE_MAX_EVENTS];
+};
+
+/* Return true if a PMUv3 is implemented. */
+bool pmu_is_supported(void);
+
+/* Return the number of event counters accessible from the current EL. */
+unsigned int pmu_get_num_counters(void);
+
+/*
+ * Initialise a profile of the 'nr_events' events in 'events', counted in the
+ * exception levels in 'filter' (PMU_COUNT_*). The PMU is only programmed by
+ * pmu_profile_start().
+ */
+void pmu_profile_init(struct pmu_profile *prof, const uint16_t *events,
+		      unsigned int nr_events, unsigned int filter);
+
+/*
+ * Initialise a profile of the instructions retired, the L1 instruction, L1
+ * data and L2 data cache refills and the L1 instruction and data TLB refills.
+ */
+void pmu_profile_init_default(struct pmu_profile *prof, unsigned int filter);
+
+/*
+ * Program the PMU with the next group of events of 'prof' and start counting.
+ * pmu_profile_stop() must be called on the same CPU.
+ */
+void pmu_profile_start(struct pmu_profile *prof);
+
+/* Stop counting and account for the counts of the run in 'prof'. */
+void pmu_profile_stop(struct pmu_profile *prof);
+
+/*
+ * Return the average count per run of 'event', or 0 if it is not part of
+ * 'prof' or has not been counted yet.
+ */
+uint64_t pmu_profile_avg(const struct pmu_profile *prof, uint16_t event);
+
+/* Return the average number of cycles per run. */
+uint64_t pmu_profile_cycles_avg(const struct pmu_profile *prof);
+
+/*
+ * Print the average cycles and events per run of 'prof' to the console, and
+ * the instructions per cycle if the instructions retired are counted.
+ */
+void pmu_profile_print(const char *name, const struct pmu_profile *prof);
+
+#endif /* PMU_H */
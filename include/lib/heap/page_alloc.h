@@ -11,29 +11,47 @@
 #include <stdint.h>
 #include <stdlib.h>
 
+#include <spinlock.h>
+
 #define HEAP_NULL_PTR		0U
 #define HEAP_INVALID_LEN	-1
 #define HEAP_OUT_OF_RANGE	-2
 #define HEAP_INIT_FAILED	-3
 #define HEAP_INIT_SUCCESS	0
 
+/*
+ * Pool of pages carved out of a memory region with a bump allocator. Each
+ * Realm uses its own pool, so that Realms can be created and destroyed
+ * independently of each other.
+ */
+struct page_pool {
+	uint64_t base;
+	uint64_t size;
+	uint64_t used;
+	int state;
+	spinlock_t lock;
+};
+
 /*
  * Initialize the memory heap space to be used
+ * @pool: pool to initialise
  * @heap_base: heap base address
  * @heap_len: heap size for use
  */
-int page_pool_init(uint64_t heap_base, uint64_t heap_len);
+int page_pool_init(struct page_pool *pool, uint64_t heap_base,
+		   uint64_t heap_len);
 
 /*
  * Return the pointer to the allocated pages
+ * @pool: pool to allocate from
  * @bytes_size: pages to allocate in byte unit
  */
-void *page_alloc(u_register_t bytes_size);
+void *page_alloc(struct page_pool *pool, u_register_t bytes_size);
 
 /*
  * Reset heap memory usage cursor to heap base address
  */
-void page_pool_reset(void);
+void page_pool_reset(struct page_pool *pool);
 void page_free(u_register_t ptr);
 
 #endif /* PAGE_ALLOC_H */
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef PERCPU_H
+#define PERCPU_H
+
+#include <arch_helpers.h>
+#include <assert.h>
+#include <cdefs.h>
+#include <platform_def.h>
+#include <stdint.h>
+
+/*
+ * Per-CPU variables.
+ *
+ * DEFINE_PER_CPU() places a variable in the per-CPU section of the image. The
+ * linker script lays out one copy of this section for each CPU, every copy
+ * starting on a cache line of its own, so that CPUs updating their own
+ * variables never write to a cache line used by another CPU.
+ *
+ * The variable itself is the copy of the CPU at core position 0. The copy of
+ * another CPU is at a fixed offset from it, which each CPU keeps in its thread
+ * ID register (TPIDR_EL1 on AArch64, HTPIDR on AArch32) once it has called
+ * tftf_percpu_init(). The per-CPU section is zeroed at cold boot like the
+ * .bss section, the variables cannot have an initialiser.
+ *
+ *   DEFINE_PER_CPU(unsigned int, counter);
+ *
+ *   (*this_cpu_ptr(counter))++;
+ *   total += per_cpu(counter, core_pos);
+ */
+#define PERCPU_SECTION_NAME	".bss.tftf_percpu"
+
+#define DEFINE_PER_CPU(type, name)					\
+	__section(PERCPU_SECTION_NAME) __typeof__(type) name
+
+#define DECLARE_PER_CPU(type, name)					\
+	extern __typeof__(type) name
+
+/* Linker symbols delimiting the copy of CPU 0 */
+extern char __PERCPU_START__[];
+extern char __PERCPU_UNIT_END__[];
+
+#define PERCPU_UNIT_SIZE						\
+	((uintptr_t)__PERCPU_UNIT_END__ - (uintptr_t)__PERCPU_START__)
+
+static inline uintptr_t percpu_offset(void)
+{
+#ifdef __aarch64__
+	return (uintptr_t)read_tpidr_el1();
+#else
+	return (uintptr_t)read_htpidr();
+#endif
+}
+
+#define PERCPU_PTR_AT(var, offset)					\
+	((__typeof__(&(var)))((uintptr_t)&(var) + (uintptr_t)(offset)))
+
+/* Address of the copy of 'var' of the CPU at core position 'core_pos' */
+#define per_cpu_ptr(var, core_pos)					\
+	PERCPU_PTR_AT(var, (uintptr_t)(core_pos) * PERCPU_UNIT_SIZE)
+
+/* Address of the copy of 'var' of the calling CPU */
+#define this_cpu_ptr(var)		PERCPU_PTR_AT(var, percpu_offset())
+
+#define per_cpu(var, core_pos)		(*per_cpu_ptr(var, core_pos))
+#define this_cpu(var)			(*this_cpu_ptr(var))
+
+/*
+ * Point the thread ID register of the calling CPU to its copy of the per-CPU
+ * variables. It must be called on every boot of a CPU, cold or warm, before
+ * it uses this_cpu_ptr(). The register is preserved across a suspend to
+ * powerdown by tftf_suspend().
+ */
+void tftf_percpu_init(void);
+
+#endif /* PERCPU_H */
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -37,6 +37,25 @@ typedef struct suspend_info {
 	unsigned int save_system_context;
 } suspend_info_t;
 
+/*
+ * System counter timestamps of the stages of the last suspend of a CPU through
+ * tftf_suspend(). The GIC save timestamps are only taken when the system
+ * context is saved, and are zero otherwise.
+ */
+typedef struct suspend_stages {
+	/* Entry in tftf_suspend() */
+	uint64_t start;
+	/* Around the save of the global GIC context */
+	uint64_t gic_save_start;
+	uint64_t gic_save_end;
+	/* PSCI suspend call */
+	uint64_t smc;
+	/* First C code of the resume path, or return of a standby call */
+	uint64_t resume;
+	/* Context restored, just before returning from tftf_suspend() */
+	uint64_t end;
+} suspend_stages_t;
+
 /*
  * Power up a core.
  * This uses the PSCI CPU_ON API, which means it relies on the EL3 firmware's
@@ -76,6 +95,31 @@ int32_t tftf_try_cpu_on(u_register_t target_cpu,
 		    uintptr_t entrypoint,
 		    u_register_t context_id);
 
+/*
+ * Power up a set of cores in a tree, each core powering up its children as
+ * soon as it has booted, so that the CPU_ON calls of different branches run
+ * in parallel. The calling core powers up the first 'fanout' cores of
+ * 'mpids', and the core at index i powers up the cores at indices
+ * fanout * (i + 1) to fanout * (i + 1) + fanout - 1. Only one tree can be
+ * brought up at a time.
+ *
+ *    mpids:      MPIDs of the cores to power up, not including the caller
+ *    count:      Number of cores in 'mpids'
+ *    fanout:     Number of cores each core powers up
+ *    entrypoint: Address where each core will jump once it has powered up
+ *                its children
+ *    context_id: Context identifier as defined by the PSCI specification
+ *    issue_ts:   If not NULL, receives the system counter value at which the
+ *                CPU_ON call of each core of 'mpids' was issued
+ *
+ *    Return: Once every core has booted or failed to, PSCI_E_SUCCESS or the
+ *            first error returned by a CPU_ON call. The subtree of a core that
+ *            fails to power up is not powered up.
+ */
+int32_t tftf_cpu_on_tree(const u_register_t *mpids, unsigned int count,
+			 unsigned int fanout, uintptr_t entrypoint,
+			 u_register_t context_id, uint64_t *issue_ts);
+
 /*
  * Power down the calling core.
  * This uses the PSCI CPU_OFF API, which means it relies on the EL3 firmware's
@@ -107,6 +151,12 @@ int32_t tftf_cpu_off(void);
  */
 int tftf_suspend(const suspend_info_t *info);
 
+/*
+ * Get the timestamps of the stages of the last suspend of the calling CPU
+ * through tftf_suspend().
+ */
+void tftf_get_suspend_stages(suspend_stages_t *stages);
+
 
 /* ----------------------------------------------------------------------------
  * The above APIs might not be suitable in all test scenarios.
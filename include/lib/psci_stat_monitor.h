@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef PSCI_STAT_MONITOR_H
+#define PSCI_STAT_MONITOR_H
+
+#include <stdint.h>
+
+#include <platform_def.h>
+#include <utils_def.h>
+
+/*
+ * Monitoring of the PSCI_STAT counters of every CPU in every valid power
+ * state, from a snapshot of the counters to another.
+ *
+ * When TFTF is built with PSCI_STAT_MONITOR=1, the framework takes a snapshot
+ * before and after each test and appends the count and residency deltas of
+ * each CPU and power state to the test output, followed by the idle
+ * efficiency over the test.
+ */
+
+/* Highest number of power states monitored */
+#define PSCI_STAT_MAX_STATES	U(32)
+
+struct psci_stat_sample {
+	u_register_t count;
+	u_register_t residency;	/* In microseconds */
+};
+
+struct psci_stat_snapshot {
+	uint64_t timestamp;
+	struct psci_stat_sample stat[PLATFORM_CORE_COUNT][PSCI_STAT_MAX_STATES];
+};
+
+/* Idle time of the CPUs between two snapshots, in microseconds */
+struct psci_stat_idle {
+	uint64_t elapsed;	/* Time between the snapshots, per CPU */
+	uint64_t idle;		/* Residency in any power state */
+	uint64_t deep;		/* Residency in the deepest power states */
+	unsigned int cpus;
+};
+
+/*
+ * Enumerate the valid power states of the platform. This must be called
+ * before any other function, after the power state framework is initialised.
+ * Further calls have no effect. Return 0 on success, or -1 if PSCI_STAT is not
+ * supported.
+ */
+int psci_stat_monitor_init(void);
+
+/* Read the counters of all CPUs in all the valid power states into 'snap'. */
+void psci_stat_snapshot(struct psci_stat_snapshot *snap);
+
+/*
+ * Compute the idle time of the CPUs between the snapshots 'before' and
+ * 'after' in 'idle'.
+ */
+void psci_stat_idle(const struct psci_stat_snapshot *before,
+		    const struct psci_stat_snapshot *after,
+		    struct psci_stat_idle *idle);
+
+/*
+ * Return the idle efficiency in per mille: the share of the idle time spent
+ * in the deepest power states, i.e. those at the highest power level.
+ */
+unsigned int psci_stat_idle_efficiency(const struct psci_stat_idle *idle);
+
+/*
+ * Append the count and residency deltas between 'before' and 'after' of each
+ * CPU and power state that changed, and the idle efficiency, to the output of
+ * the current test.
+ */
+void psci_stat_report(const struct psci_stat_snapshot *before,
+		      const struct psci_stat_snapshot *after);
+
+/* Snapshots taken by the framework around each test */
+void psci_stat_monitor_test_start(void);
+void psci_stat_monitor_test_end(void);
+
+#endif /* PSCI_STAT_MONITOR_H */
@@ -9,9 +9,11 @@
 
 /**
  * Pairs a command id with a function call, to handle the command ID.
+ * The table of handlers is sorted by command id at boot time, see
+ * 'cactus_cmd_handlers_init'.
  */
 struct cactus_cmd_handler {
-	const uint64_t id;
+	uint64_t id;
 	struct ffa_value (*fn)(const struct ffa_value *args,
 			       struct mailbox_buffers *mb);
 };
@@ -40,5 +42,7 @@ struct cactus_cmd_handler {
 	};								\
 	CACTUS_HANDLER_FN(name)
 
+void cactus_cmd_handlers_init(void);
+
 bool cactus_handle_cmd(struct ffa_value *cmd_args, struct ffa_value *ret,
-		       struct mailbox_buffers *mb);
+		       struct mailbox_buffers *mb, unsigned int core_pos);
@@ -533,6 +533,68 @@ static inline ffa_id_t cactus_notifications_set_get_sender(struct ffa_value ret)
 	return (ffa_id_t)((ret.arg4 >> 16U) & 0xFFFFU);
 }
 
+/**
+ * Request SP to read the indirect message in its RX buffer, once the RX buffer
+ * full notification is pending for vCPU 'vcpu_id'. The SP replies with the
+ * sender, size and checksum of the message.
+ *
+ * The command id is the hex representation of the string "imsgrd".
+ */
+#define CACTUS_INDIRECT_MSG_READ_CMD U(0x696d73677264)
+
+static inline struct ffa_value cactus_indirect_msg_read_send_cmd(
+	ffa_id_t source, ffa_id_t dest, uint32_t vcpu_id)
+{
+	return cactus_send_cmd(source, dest, CACTUS_INDIRECT_MSG_READ_CMD,
+			       vcpu_id, 0, 0, 0);
+}
+
+static inline uint32_t cactus_indirect_msg_read_get_vcpu(struct ffa_value ret)
+{
+	return (uint32_t)ret.arg4;
+}
+
+static inline struct ffa_value cactus_indirect_msg_read_resp(
+	ffa_id_t source, ffa_id_t dest, ffa_id_t sender, uint32_t size,
+	uint32_t checksum)
+{
+	return cactus_send_response(source, dest, CACTUS_SUCCESS, sender, size,
+				    checksum, 0);
+}
+
+static inline ffa_id_t cactus_indirect_msg_sender(struct ffa_value ret)
+{
+	return (ffa_id_t)ret.arg4;
+}
+
+static inline uint32_t cactus_indirect_msg_size(struct ffa_value ret)
+{
+	return (uint32_t)ret.arg5;
+}
+
+static inline uint32_t cactus_indirect_msg_checksum(struct ffa_value ret)
+{
+	return (uint32_t)ret.arg6;
+}
+
+/**
+ * Checksum of an indirect message payload, as computed by the receiver of
+ * CACTUS_INDIRECT_MSG_READ_CMD (Fletcher-32 over bytes).
+ */
+static inline uint32_t cactus_indirect_msg_payload_checksum(
+	const uint8_t *payload, size_t size)
+{
+	uint32_t sum1 = 0U;
+	uint32_t sum2 = 0U;
+
+	for (size_t i = 0U; i < size; i++) {
+		sum1 = (sum1 + payload[i]) % 0xFFFFU;
+		sum2 = (sum2 + sum1) % 0xFFFFU;
+	}
+
+	return (sum2 << 16) | sum1;
+}
+
 /**
  * Request to start trusted watchdog timer.
  *
@@ -571,6 +633,42 @@ static inline uint32_t cactus_get_req_count(struct ffa_value ret)
 	return (uint32_t)ret.arg4;
 }
 
+/**
+ * Request SP to return, for the current vCPU, the number of times the command
+ * 'cmd_id' has been handled and the total time spent in its handler (in system
+ * counter ticks). The total count of handled requests is also returned.
+ *
+ * The command id is the hex representation of the string "cmdstat".
+ */
+#define CACTUS_GET_CMD_STATS_CMD U(0x636d6473746174)
+
+static inline struct ffa_value cactus_get_cmd_stats_send_cmd(
+	ffa_id_t source, ffa_id_t dest, uint64_t cmd_id)
+{
+	return cactus_send_cmd(source, dest, CACTUS_GET_CMD_STATS_CMD, cmd_id,
+			       0, 0, 0);
+}
+
+static inline uint64_t cactus_get_cmd_stats_id(struct ffa_value ret)
+{
+	return (uint64_t)ret.arg4;
+}
+
+static inline uint64_t cactus_get_cmd_stats_count(struct ffa_value ret)
+{
+	return (uint64_t)ret.arg4;
+}
+
+static inline uint64_t cactus_get_cmd_stats_ticks(struct ffa_value ret)
+{
+	return (uint64_t)ret.arg5;
+}
+
+static inline uint32_t cactus_get_cmd_stats_req_count(struct ffa_value ret)
+{
+	return (uint32_t)ret.arg6;
+}
+
 /**
  * Request SP to return the last serviced secure virtual interrupt.
  *
@@ -272,6 +272,22 @@ static inline ffa_notification_bitmap_t ffa_notifications_get_from_vm(
 	return FFA_NOTIFICATIONS_BITMAP(val.arg4, val.arg5);
 }
 
+/**
+ * Framework notification signalled by the SPMC or the hypervisor to the
+ * receiver of an indirect message, when its RX buffer is full.
+ */
+#define FFA_NOTIFICATION_RX_BUFFER_FULL		UINT32_C(0x1 << 0)
+
+static inline uint32_t ffa_notifications_get_from_spm(struct ffa_value val)
+{
+	return (uint32_t)val.arg6;
+}
+
+static inline uint32_t ffa_notifications_get_from_hyp(struct ffa_value val)
+{
+	return (uint32_t)val.arg7;
+}
+
 /*
  * FFA_NOTIFICATION_INFO_GET is a SMC64 interface.
  * The following macros are defined for SMC64 implementation.
@@ -622,6 +638,31 @@ uint32_t ffa_memory_region_init(
 	enum ffa_memory_shareability shareability, uint32_t *total_length,
 	uint32_t *fragment_length);
 
+/** Flag to delay the Schedule Receiver Interrupt on FFA_MSG_SEND2. */
+#define FFA_MSG_SEND2_FLAGS_DELAY_SRI	UINT32_C(0x1 << 1)
+
+/**
+ * Header of a partition message, at the start of the sender's TX buffer on
+ * FFA_MSG_SEND2, and of the receiver's RX buffer once delivered, as defined in
+ * table 4.1 of section 4.2.2 of the FF-A v1.1 EAC0 specification.
+ */
+struct ffa_partition_rxtx_header {
+	uint32_t flags;
+	uint32_t reserved;
+	/* Offset from the beginning of the buffer to the message payload. */
+	uint32_t offset;
+	ffa_id_t receiver;
+	ffa_id_t sender;
+	/* Size of the message payload. */
+	uint32_t size;
+};
+
+#define FFA_RXTX_HEADER_SIZE	sizeof(struct ffa_partition_rxtx_header)
+#define FFA_MSG_PAYLOAD_MAX	(PAGE_SIZE - FFA_RXTX_HEADER_SIZE)
+
+void ffa_rxtx_header_init(ffa_id_t sender, ffa_id_t receiver, uint32_t size,
+			  struct ffa_partition_rxtx_header *header);
+
 static inline ffa_id_t ffa_dir_msg_dest(struct ffa_value val) {
 	return (ffa_id_t)val.arg1 & U(0xFFFF);
 }
@@ -655,6 +696,7 @@ struct ffa_value ffa_version(uint32_t input_version);
 struct ffa_value ffa_id_get(void);
 struct ffa_value ffa_spm_id_get(void);
 struct ffa_value ffa_msg_wait(void);
+struct ffa_value ffa_msg_send2(uint32_t flags);
 struct ffa_value ffa_error(int32_t error_code);
 struct ffa_value ffa_features(uint32_t feature);
 struct ffa_value ffa_partition_info_get(const struct ffa_uuid uuid);
@@ -8,15 +8,28 @@
 
 #include <host_realm_rmi.h>
 
-bool host_create_realm_payload(u_register_t realm_payload_adr,
-		u_register_t plat_mem_pool_adr,
-		u_register_t plat_mem_pool_size,
-		u_register_t realm_pages_size);
-bool host_create_shared_mem(
+/*
+ * Create the Realm 'realm_ptr' with 'rec_count' RECs, allocating its granules
+ * from the pool [realm_pool_adr, realm_pool_adr + realm_pool_size), which must
+ * not be shared with another Realm. Up to MAX_REALM_COUNT Realms can exist at
+ * the same time.
+ */
+bool host_create_realm_payload(struct realm *realm_ptr,
+		u_register_t realm_payload_adr,
+		u_register_t realm_pool_adr,
+		u_register_t realm_pool_size,
+		unsigned int rec_count);
+bool host_create_shared_mem(struct realm *realm_ptr,
 		u_register_t ns_shared_mem_adr,
 		u_register_t ns_shared_mem_size);
-bool host_destroy_realm(void);
-bool host_enter_realm_execute(uint8_t cmd);
+bool host_destroy_realm(struct realm *realm_ptr);
+
+/*
+ * Run 'cmd' in REC 'rec_num' of 'realm_ptr' on the calling CPU. Different RECs
+ * can be entered from different CPUs at the same time.
+ */
+bool host_enter_realm_execute(struct realm *realm_ptr, uint8_t cmd,
+		unsigned int rec_num);
 
 #endif /* HOST_REALM_HELPER_H */
 
@@ -31,8 +31,13 @@
  * |                          |     | (NS_REALM_SHARED_MEM_SIZE)|
  * +--------------------------+     +---------------------------+
  *
+ * When several Realms are created, the Heap Memory and the Shared Region are
+ * split in MAX_REALM_COUNT slices, one per Realm.
  */
 
+/* Maximum number of Realms the Host manages concurrently */
+#define MAX_REALM_COUNT			U(4)
+
 /*
  * Default values defined in platform.mk, and can be provided as build arguments
  * TFTF_MAX_IMAGE_SIZE: 1mb
@@ -41,8 +46,8 @@
 #ifdef TFTF_MAX_IMAGE_SIZE
 /* 1MB for shared buffer between Realm and Host*/
  #define NS_REALM_SHARED_MEM_SIZE	U(0x100000)
-/* 3MB of memory used as a pool for realm's objects creation*/
- #define PAGE_POOL_MAX_SIZE		U(0x300000)
+/* 3MB of memory per Realm used as a pool for realm's objects creation*/
+ #define PAGE_POOL_MAX_SIZE		(U(0x300000) * MAX_REALM_COUNT)
 /* Base address of each section */
  #define REALM_IMAGE_BASE		(TFTF_BASE + TFTF_MAX_IMAGE_SIZE)
  #define PAGE_POOL_BASE			(REALM_IMAGE_BASE + REALM_MAX_LOAD_IMG_SIZE)
@@ -57,4 +62,13 @@
  #define NS_REALM_SHARED_MEM_BASE	0U
 #endif
 
+/* Heap Memory and Shared Region slices of Realm '_idx' */
+#define REALM_PAGE_POOL_SIZE		(PAGE_POOL_MAX_SIZE / MAX_REALM_COUNT)
+#define REALM_PAGE_POOL_BASE(_idx)	\
+	(PAGE_POOL_BASE + ((_idx) * REALM_PAGE_POOL_SIZE))
+#define REALM_NS_SHARED_MEM_SIZE	\
+	(NS_REALM_SHARED_MEM_SIZE / MAX_REALM_COUNT)
+#define REALM_NS_SHARED_MEM_BASE(_idx)	\
+	(NS_REALM_SHARED_MEM_BASE + ((_idx) * REALM_NS_SHARED_MEM_SIZE))
+
 #endif /* HOST_REALM_MEM_LAYOUT_H */
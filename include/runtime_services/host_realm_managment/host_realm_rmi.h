@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2022, Arm Limited. All rights reserved.
+ * Copyright (c) 2022-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -10,6 +10,10 @@
 
 #include <stdint.h>
 
+#include <heap/page_alloc.h>
+#include <host_shared_data.h>
+#include <perf_helpers.h>
+#include <realm_def.h>
 #include <realm_rsi.h>
 #include <smccc.h>
 #include <utils_def.h>
@@ -17,6 +21,9 @@
 #define RMI_FNUM_MIN_VALUE	U(0x150)
 #define RMI_FNUM_MAX_VALUE	U(0x18F)
 
+/* Get the function number of an RMI FID */
+#define RMI_FNUM(_fid)		(((_fid) >> FUNCID_NUM_SHIFT) & FUNCID_NUM_MASK)
+
 /* Get RMI fastcall std FID from offset */
 #define SMC64_RMI_FID(_offset)					\
 	((SMC_TYPE_FAST << FUNCID_TYPE_SHIFT) |			\
@@ -217,6 +224,11 @@
 #define RMI_NOT_EMULATED_MMIO		0U
 #define RMI_EMULATED_MMIO		1U
 
+/* Faulting IPA bits [55:12] in the HPFAR_EL2 value of a REC exit */
+#define HPFAR_EL2_FIPA_SHIFT		4UL
+#define HPFAR_EL2_FIPA_WIDTH		44UL
+#define HPFAR_EL2_FIPA_IPA_SHIFT	12UL
+
 /*
  * RmiRecExitReason represents the reason for a REC exit.
  * This is returned to NS hosts via RMI_REC_ENTER::run_ptr.
@@ -460,18 +472,36 @@ enum realm_state {
 	REALM_STATE_SYSTEM_OFF
 };
 
+/*
+ * Latency of REC entries, from RMI_REC_ENTER to the REC exit, in system counter
+ * ticks, for each REC exit reason.
+ */
+struct rec_exit_stats {
+	struct perf_stats exit[RMI_EXIT_SERROR + 1U];
+};
+
 struct realm {
 	u_register_t par_base;
 	u_register_t par_size;
 	u_register_t rd;
 	u_register_t rtt_addr;
-	u_register_t rec;
-	u_register_t run;
+	u_register_t vmid;
+	unsigned int rec_count;
+	u_register_t rec[REALM_MAX_REC_COUNT];
+	u_register_t run[REALM_MAX_REC_COUNT];
 	u_register_t num_aux;
 	u_register_t rmm_feat_reg0;
 	u_register_t ipa_ns_buffer;
 	u_register_t ns_buffer_size;
-	u_register_t aux_pages[REC_PARAMS_AUX_GRANULES];
+	u_register_t aux_pages[REALM_MAX_REC_COUNT][REC_PARAMS_AUX_GRANULES];
+	/* Granules of this Realm are allocated from its own pool */
+	struct page_pool pool;
+	/* Host mapping of the region shared with this Realm */
+	host_shared_data_t *host_shared_data;
+	/* Number of log characters dropped by the Realm already reported */
+	uint32_t log_dropped_reported;
+	/* Optional, set to profile the entries of each REC */
+	struct rec_exit_stats *exit_stats[REALM_MAX_REC_COUNT];
 	enum realm_state state;
 };
 
@@ -483,6 +513,11 @@ u_register_t rmi_realm_create(u_register_t rd, u_register_t params_ptr);
 u_register_t rmi_realm_destroy(u_register_t rd);
 u_register_t rmi_features(u_register_t index, u_register_t *features);
 
+/* Number of RMI calls issued by the host, to profile Realm management */
+void host_rmi_reset_call_count(void);
+unsigned long host_rmi_get_call_count(u_register_t fid);
+unsigned long host_rmi_get_total_call_count(void);
+
 /* Realm management */
 u_register_t realm_map_protected_data_unknown(struct realm *realm,
 		u_register_t target_pa,
@@ -496,8 +531,8 @@ u_register_t realm_map_ns_shared(struct realm *realm,
 u_register_t realm_rec_create(struct realm *realm);
 u_register_t realm_activate(struct realm *realm);
 u_register_t realm_destroy(struct realm *realm);
-u_register_t realm_rec_enter(struct realm *realm, u_register_t *exit_reason,
-		unsigned int *test_result);
+u_register_t realm_rec_enter(struct realm *realm, unsigned int rec_num,
+		u_register_t *exit_reason, unsigned int *test_result);
 u_register_t realm_init_ipa_state(struct realm *realm,
 		u_register_t  level,
 		u_register_t  start,
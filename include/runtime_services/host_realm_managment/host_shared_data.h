@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2022, Arm Limited. All rights reserved.
+ * Copyright (c) 2022-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -8,19 +8,19 @@
 #define HOST_SHARED_DATA_H
 
 #include <stdint.h>
-#include <spinlock.h>
 
-#define MAX_BUF_SIZE		10240U
+#include <cassert.h>
+#include <realm_def.h>
+#include <utils_def.h>
+
+/* Size of the Realm log ring buffer, must be a power of two */
+#define MAX_BUF_SIZE		8192U
 #define MAX_DATA_SIZE		5U
 
 /*
- * This structure maps the shared memory to be used between the Host and Realm
- * payload
+ * Command and data exchanged between the Host and one REC
  */
-typedef struct host_shared_data {
-	/* Buffer used from Realm for logging*/
-	uint8_t log_buffer[MAX_BUF_SIZE];
-
+typedef struct rec_shared_data {
 	/* Command set from Host and used by Realm*/
 	uint8_t realm_cmd;
 
@@ -29,17 +29,46 @@ typedef struct host_shared_data {
 
 	/* array of output results passed from Realm to Host*/
 	u_register_t realm_out_val[MAX_DATA_SIZE];
+} rec_shared_data_t;
 
-	/* Lock to avoid concurrent accesses to log_buffer */
-	spinlock_t printf_lock;
+/*
+ * This structure maps the shared memory to be used between the Host and Realm
+ * payload
+ */
+typedef struct host_shared_data {
+	/*
+	 * Ring buffer used from Realm for logging. The Realm is the only
+	 * producer and advances log_head, the Host is the only consumer and
+	 * advances log_tail. Both indexes are free running, the ring is empty
+	 * when they are equal and full when they are MAX_BUF_SIZE apart.
+	 */
+	uint8_t log_buffer[MAX_BUF_SIZE];
+	volatile uint32_t log_head;
+	volatile uint32_t log_tail;
+
+	/* Number of characters the Realm dropped because the ring was full */
+	volatile uint32_t log_dropped;
+
+	/*
+	 * Command and data of each REC, indexed by REC number on the Host side
+	 * and by MPIDR Aff0 on the Realm side, so that RECs entered from
+	 * different CPUs at the same time do not overwrite each other's.
+	 */
+	rec_shared_data_t rec_data[REALM_MAX_REC_COUNT];
 } host_shared_data_t;
 
+CASSERT(IS_POWER_OF_TWO(MAX_BUF_SIZE), assert_log_buffer_size_power_of_two);
+
 /*
  * Different commands that the Host can requests the Realm to perform
  */
 enum realm_cmd {
 	REALM_SLEEP_CMD = 1U,
-	REALM_GET_RSI_VERSION
+	REALM_GET_RSI_VERSION,
+	/* Return to the Host straight away, to measure REC entry and exit */
+	REALM_NOP_CMD,
+	/* Exit to the Host repeatedly with host calls and emulated MMIO reads */
+	REALM_EXIT_LOOP_CMD
 };
 
 /*
@@ -47,60 +76,87 @@ enum realm_cmd {
  */
 enum host_param_index {
 	HOST_CMD_INDEX = 0U,
-	HOST_SLEEP_INDEX
+	HOST_SLEEP_INDEX,
+	HOST_ITERATIONS_INDEX,
+	HOST_MMIO_IPA_INDEX
 };
+struct realm;
+
+/*
+ * Host side accessors, for the region shared with the Realm 'realm_ptr'
+ */
+
 /*
  * Return shared buffer pointer mapped as host_shared_data_t structure
  */
-host_shared_data_t *host_get_shared_structure(void);
+host_shared_data_t *host_get_shared_structure(struct realm *realm_ptr);
+
 /*
- * Set data to be shared from Host to realm
+ * Set data to be shared from Host to REC 'rec_num'
  */
-void realm_shared_data_set_host_val(uint8_t index, u_register_t val);
+void realm_shared_data_set_host_val(struct realm *realm_ptr,
+		unsigned int rec_num, uint8_t index, u_register_t val);
 
 /*
- * Set guest mapped shared buffer pointer
+ * Set data to be shared from REC 'rec_num' to Host
  */
-void realm_set_shared_structure(host_shared_data_t *ptr);
+void realm_shared_data_set_realm_val(struct realm *realm_ptr,
+		unsigned int rec_num, uint8_t index, u_register_t val);
 
 /*
- * Get guest mapped shared buffer pointer
+ * Return REC 'rec_num' data at index
  */
-host_shared_data_t *realm_get_shared_structure(void);
+u_register_t realm_shared_data_get_realm_val(struct realm *realm_ptr,
+		unsigned int rec_num, uint8_t index);
 
 /*
- * Set data to be shared from Realm to Host
+ * Clear shared realm data of all RECs
  */
-void realm_shared_data_set_realm_val(uint8_t index, u_register_t val);
+void realm_shared_data_clear_realm_val(struct realm *realm_ptr);
 
 /*
- * Return Host's data at index
+ * Clear shared Host data of all RECs
  */
-u_register_t realm_shared_data_get_host_val(uint8_t index);
+void realm_shared_data_clear_host_val(struct realm *realm_ptr);
 
 /*
- * Return Realm's data at index
+ * Set command to be send from Host to REC 'rec_num'
  */
-u_register_t realm_shared_data_get_realm_val(uint8_t index);
+void realm_shared_data_set_realm_cmd(struct realm *realm_ptr,
+		unsigned int rec_num, uint8_t cmd);
 
 /*
- * Clear shared realm data
+ * Reset the Realm log ring buffer
  */
-void realm_shared_data_clear_realm_val(void);
+void realm_shared_data_reset_log(struct realm *realm_ptr);
 
 /*
- * Clear shared Host data
+ * Print and consume the messages logged by the Realm
  */
-void realm_shared_data_clear_host_val(void);
+void realm_shared_data_drain_log(struct realm *realm_ptr);
 
 /*
- * Get command sent from Host to realm
+ * Realm side accessors
  */
-uint8_t realm_shared_data_get_realm_cmd(void);
 
 /*
- * Set command to be send from Host to realm
+ * Set guest mapped shared buffer pointer
+ */
+void realm_set_shared_structure(host_shared_data_t *ptr);
+
+/*
+ * Get guest mapped shared buffer pointer
  */
-void realm_shared_data_set_realm_cmd(uint8_t cmd);
+host_shared_data_t *realm_get_shared_structure(void);
+
+/*
+ * Return Host's data at index for the calling REC
+ */
+u_register_t realm_shared_data_get_host_val(uint8_t index);
+
+/*
+ * Get command sent from Host to the calling REC
+ */
+uint8_t realm_shared_data_get_realm_cmd(void);
 
 #endif /* HOST_SHARED_DATA_H */
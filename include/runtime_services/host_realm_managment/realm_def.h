@@ -13,6 +13,8 @@
 /* 1mb for Realm payload as a default value*/
 #define REALM_MAX_LOAD_IMG_SIZE		U(0x100000)
 #define REALM_STACK_SIZE		0x1000U
+/* Maximum number of RECs of a Realm, each running on its own stack */
+#define REALM_MAX_REC_COUNT		U(8)
 #define DATA_PATTERN_1			0x12345678U
 #define DATA_PATTERN_2			0x11223344U
 #define REALM_SUCCESS			0U
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2020, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -39,4 +39,13 @@
 #define PMF_PSCI_STAT_SVC_ID	0
 #define PMF_RT_INSTR_SVC_ID	1
 
+/* Timestamp IDs of the runtime instrumentation service */
+#define PMF_RT_INSTR_ENTER_PSCI		0
+#define PMF_RT_INSTR_EXIT_PSCI		1
+#define PMF_RT_INSTR_ENTER_HW_LOW_PWR	2
+#define PMF_RT_INSTR_EXIT_HW_LOW_PWR	3
+#define PMF_RT_INSTR_ENTER_CFLUSH	4
+#define PMF_RT_INSTR_EXIT_CFLUSH	5
+#define PMF_RT_INSTR_TOTAL_IDS		6
+
 #endif /* __PMF_H__ */
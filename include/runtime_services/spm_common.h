@@ -154,4 +154,22 @@ bool ffa_partition_info_helper(struct mailbox_buffers *mb,
 			const struct ffa_partition_info *expected,
 			const uint16_t expected_size);
 
+/**
+ * Helper to send an indirect message: writes the partition message header and
+ * 'payload' to the TX buffer 'send', and calls FFA_MSG_SEND2.
+ */
+struct ffa_value send_indirect_message(ffa_id_t sender, ffa_id_t receiver,
+				       void *send, const void *payload,
+				       size_t payload_size,
+				       uint32_t send_flags);
+
+/**
+ * Helper to receive an indirect message: copies the payload of the message in
+ * the RX buffer 'recv' of 'receiver' to 'buffer', and releases the RX buffer.
+ * Returns the sender and size of the message in 'sender' and 'size'.
+ */
+bool receive_indirect_message(void *buffer, size_t buffer_size,
+			      const void *recv, ffa_id_t receiver,
+			      ffa_id_t *sender, size_t *size);
+
 #endif /* SPM_COMMON_H */
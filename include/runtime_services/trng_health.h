@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Online health tests of an entropy stream, as per NIST SP 800-90B section
+ * 4.4: the Repetition Count Test and the Adaptive Proportion Test.
+ *
+ * The stream is tested in 8-bit samples against a claimed min-entropy per
+ * sample, with a false positive probability of 2^-20 per test. This code has
+ * no dependency on the framework so that it can be built and tested on the
+ * host.
+ */
+
+#ifndef TRNG_HEALTH_H
+#define TRNG_HEALTH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Samples in an Adaptive Proportion Test window (non-binary samples) */
+#define TRNG_HEALTH_APT_WINDOW		512U
+
+struct trng_health {
+	/* Cutoffs derived from the claimed min-entropy per sample */
+	unsigned int rct_cutoff;
+	unsigned int apt_cutoff;
+
+	/* Repetition Count Test: last sample and its consecutive occurrences */
+	uint8_t rct_sample;
+	unsigned int rct_count;
+
+	/* Adaptive Proportion Test: first sample of the window and its count */
+	uint8_t apt_sample;
+	unsigned int apt_count;
+	unsigned int apt_index;
+
+	/* Results */
+	uint64_t samples;
+	unsigned int rct_failures;
+	unsigned int apt_failures;
+	unsigned int rct_max;
+	unsigned int apt_max;
+};
+
+/*
+ * Initialise the health tests of a stream claimed to have 'min_entropy' bits
+ * of min-entropy per 8-bit sample (1 to 8).
+ */
+void trng_health_init(struct trng_health *health, unsigned int min_entropy);
+
+/*
+ * Run the health tests on the next 'len' samples of the stream. Return false
+ * if any test failed on these samples.
+ */
+bool trng_health_feed(struct trng_health *health, const uint8_t *buf,
+		      size_t len);
+
+/* Return true if no test has failed since trng_health_init(). */
+bool trng_health_ok(const struct trng_health *health);
+
+#endif /* TRNG_HEALTH_H */
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -8,6 +8,8 @@
 #include <assert.h>
 #include <debug.h>
 #include <events.h>
+#include <plat_topology.h>
+#include <platform.h>
 #include <platform_def.h>
 #include <tftf.h>
 #include <tftf_lib.h>
@@ -88,3 +90,89 @@ void tftf_wait_for_event(event_t *event)
 
 	VERBOSE("Received event %p\n", (void *) event);
 }
+
+void tftf_init_barrier(barrier_t *barrier, u_register_t exclude_mpid)
+{
+	unsigned int cpu_node, count = 0;
+	u_register_t mpid;
+
+	assert(barrier != NULL);
+
+	for (unsigned int i = 0; i < PLATFORM_CORE_COUNT; i++)
+		barrier->rank[i] = UINT16_MAX;
+
+	for_each_cpu(cpu_node) {
+		mpid = tftf_get_mpidr_from_node(cpu_node) & MPID_MASK;
+		if (mpid == (exclude_mpid & MPID_MASK))
+			continue;
+
+		barrier->rank[platform_get_core_pos(mpid)] = count;
+		barrier->nodes[count].arrived = 0;
+		barrier->nodes[count].released = 0;
+		barrier->nodes[count].sense = 0;
+		count++;
+	}
+
+	barrier->cpus_count = count;
+}
+
+static void barrier_wait_flag(volatile unsigned int *flag, unsigned int sense)
+{
+	dsbsy();
+	while (*flag != sense) {
+		wfe();
+		dsbsy();
+	}
+}
+
+static void barrier_set_flag(volatile unsigned int *flag, unsigned int sense)
+{
+	/*
+	 * Make the accesses of the CPU before the barrier observable by all
+	 * CPUs before the flag, then wake up the CPU spinning on it.
+	 */
+	dsbsy();
+	*flag = sense;
+	dsbsy();
+	sev();
+}
+
+void tftf_barrier_wait(barrier_t *barrier)
+{
+	unsigned int core_pos = platform_get_core_pos(read_mpidr_el1());
+	unsigned int rank, child, first_child, last_child, sense;
+	barrier_node_t *node;
+
+	assert(barrier != NULL);
+	assert(core_pos < PLATFORM_CORE_COUNT);
+
+	rank = barrier->rank[core_pos];
+	assert(rank < barrier->cpus_count);
+	node = &barrier->nodes[rank];
+
+	sense = node->sense ^ 1U;
+	node->sense = sense;
+
+	first_child = (rank * BARRIER_ARITY) + 1U;
+	last_child = first_child + BARRIER_ARITY;
+	if (last_child > barrier->cpus_count)
+		last_child = barrier->cpus_count;
+
+	VERBOSE("Waiting on barrier %p\n", (void *) barrier);
+
+	/* Wait for the subtrees of the children to arrive */
+	for (child = first_child; child < last_child; child++)
+		barrier_wait_flag(&barrier->nodes[child].arrived, sense);
+
+	/* Report the subtree to the parent and wait for it to release us */
+	if (rank != 0U) {
+		barrier_set_flag(&node->arrived, sense);
+		barrier_wait_flag(&node->released, sense);
+	}
+
+	/* Release the children */
+	for (child = first_child; child < last_child; child++)
+		barrier_set_flag(&barrier->nodes[child].released, sense);
+
+	VERBOSE("Released from barrier %p\n", (void *) barrier);
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <amu.h>
+#include <arch_helpers.h>
+#include <assert.h>
+#include <debug.h>
+#include <string.h>
+
+bool amu_group0_enabled(void)
+{
+	if (amu_get_version() == 0U) {
+		return false;
+	}
+
+	return (read_amcntenset0_el0() & AMU_GROUP0_COUNTERS_MASK) ==
+	       AMU_GROUP0_COUNTERS_MASK;
+}
+
+void amu_group0_snapshot(struct amu_group0_snapshot *snap)
+{
+	assert(snap != NULL);
+
+	isb();
+	snap->timestamp = read_cntpct_el0();
+	for (unsigned int i = 0U; i < AMU_GROUP0_NR_COUNTERS; i++) {
+		snap->cnt[i] = amu_group0_cnt_read(i);
+	}
+}
+
+void amu_activity_init(struct amu_activity *act)
+{
+	memset(act, 0, sizeof(*act));
+}
+
+int amu_activity_add(struct amu_activity *act,
+		     const struct amu_group0_snapshot *start,
+		     const struct amu_group0_snapshot *end)
+{
+	if (end->timestamp < start->timestamp) {
+		return -1;
+	}
+
+	for (unsigned int i = 0U; i < AMU_GROUP0_NR_COUNTERS; i++) {
+		if (end->cnt[i] < start->cnt[i]) {
+			return -1;
+		}
+	}
+
+	act->intervals++;
+	act->ticks += end->timestamp - start->timestamp;
+	for (unsigned int i = 0U; i < AMU_GROUP0_NR_COUNTERS; i++) {
+		act->cnt[i] += end->cnt[i] - start->cnt[i];
+	}
+
+	return 0;
+}
+
+void amu_activity_merge(struct amu_activity *dst,
+			const struct amu_activity *src)
+{
+	dst->intervals += src->intervals;
+	dst->ticks += src->ticks;
+	for (unsigned int i = 0U; i < AMU_GROUP0_NR_COUNTERS; i++) {
+		dst->cnt[i] += src->cnt[i];
+	}
+}
+
+uint64_t amu_activity_freq_khz(const struct amu_activity *act)
+{
+	uint64_t core_cycles = act->cnt[AMU_GROUP0_CORE_CYCLES];
+	uint64_t const_cycles = act->cnt[AMU_GROUP0_CONST_CYCLES];
+	uint64_t freq_khz = read_cntfrq_el0() / 1000U;
+
+	if (const_cycles == 0ULL) {
+		return 0ULL;
+	}
+
+	/* Split the conversion to avoid overflowing on long intervals. */
+	return ((core_cycles / const_cycles) * freq_khz) +
+	       (((core_cycles % const_cycles) * freq_khz) / const_cycles);
+}
+
+unsigned int amu_activity_stall_permille(const struct amu_activity *act)
+{
+	uint64_t core_cycles = act->cnt[AMU_GROUP0_CORE_CYCLES];
+
+	if (core_cycles == 0ULL) {
+		return 0U;
+	}
+
+	return (unsigned int)((act->cnt[AMU_GROUP0_MEM_STALL_CYCLES] * 1000ULL) /
+			      core_cycles);
+}
+
+unsigned int amu_activity_active_permille(const struct amu_activity *act)
+{
+	uint64_t const_cycles = act->cnt[AMU_GROUP0_CONST_CYCLES];
+
+	if (act->ticks == 0ULL) {
+		return 0U;
+	}
+
+	/*
+	 * The counters tick at the same rate, any excess is due to the order
+	 * in which they are read.
+	 */
+	if (const_cycles >= act->ticks) {
+		return 1000U;
+	}
+
+	return (unsigned int)((const_cycles * 1000ULL) / act->ticks);
+}
+
+void amu_activity_print(const char *name, const struct amu_activity *act)
+{
+	unsigned int active = amu_activity_active_permille(act);
+	unsigned int stall = amu_activity_stall_permille(act);
+
+	if (act->intervals == 0ULL) {
+		printf("%s: no samples\n", name);
+		return;
+	}
+
+	printf("%s: %llu samples, active %u.%u%%, %llu kHz, "
+	       "%llu inst/interval, stalled %u.%u%%\n", name,
+	       (unsigned long long)act->intervals, active / 10U, active % 10U,
+	       (unsigned long long)amu_activity_freq_khz(act),
+	       (unsigned long long)(act->cnt[AMU_GROUP0_INST_RETIRED] /
+				    act->intervals),
+	       stall / 10U, stall % 10U);
+}
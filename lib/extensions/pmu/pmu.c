@@ -0,0 +1,339 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <arch.h>
+#include <arch_helpers.h>
+#include <assert.h>
+#include <debug.h>
+#include <pmu.h>
+#include <stddef.h>
+#include <string.h>
+#include <utils_def.h>
+
+static const uint16_t pmu_default_events[] = {
+	PMU_EV_INST_RETIRED,
+	PMU_EV_L1I_CACHE_REFILL,
+	PMU_EV_L1D_CACHE_REFILL,
+	PMU_EV_L2D_CACHE_REFILL,
+	PMU_EV_L1I_TLB_REFILL,
+	PMU_EV_L1D_TLB_REFILL,
+};
+
+static const struct {
+	uint16_t event;
+	const char *name;
+} pmu_event_names[] = {
+	{ PMU_EV_L1I_CACHE_REFILL, "L1I refills" },
+	{ PMU_EV_L1I_TLB_REFILL, "L1I TLB refills" },
+	{ PMU_EV_L1D_CACHE_REFILL, "L1D refills" },
+	{ PMU_EV_L1D_TLB_REFILL, "L1D TLB refills" },
+	{ PMU_EV_INST_RETIRED, "instructions" },
+	{ PMU_EV_PC_WRITE_RETIRED, "PC writes" },
+	{ PMU_EV_BR_MIS_PRED, "mispredicted branches" },
+	{ PMU_EV_CPU_CYCLES, "CPU cycles" },
+	{ PMU_EV_L2D_CACHE_REFILL, "L2D refills" },
+};
+
+bool pmu_is_supported(void)
+{
+	unsigned int ver;
+
+#ifdef __aarch64__
+	ver = (unsigned int)(read_id_aa64dfr0_el1() >>
+			     ID_AA64DFR0_PMUVER_SHIFT) &
+	      ID_AA64DFR0_PMUVER_MASK;
+
+	return (ver != ID_AA64DFR0_PMUVER_NOT_SUPPORTED) &&
+	       (ver != ID_AA64DFR0_PMUVER_IMP_DEF);
+#else
+	ver = (read_id_dfr0() >> ID_DFR0_PERFMON_SHIFT) &
+	      ID_DFR0_PERFMON_MASK;
+
+	return (ver >= ID_DFR0_PERFMON_PMUV3) &&
+	       (ver != ID_DFR0_PERFMON_IMP_DEF);
+#endif
+}
+
+unsigned int pmu_get_num_counters(void)
+{
+	return (unsigned int)(read_pmcr_el0() >> PMCR_EL0_N_SHIFT) &
+	       PMCR_EL0_N_MASK;
+}
+
+/*
+ * Return the filtering bits of PMEVTYPER<n>_EL0 for the exception levels in
+ * 'filter'. PMCCFILTR_EL0 has the same bits at the same positions.
+ *
+ * The P and U bits prohibit counting at EL1 and EL0. In the Non-secure state,
+ * counting at EL1 and EL0 is allowed when NSK and NSU are equal to P and U.
+ * Counting at EL3 is allowed when M is equal to P. The NSH bit allows counting
+ * at Non-secure EL2, and counting at Secure EL2 is allowed when SH differs from
+ * NSH.
+ */
+static u_register_t pmu_filter_bits(unsigned int filter)
+{
+	bool p = (filter & PMU_COUNT_S_EL1) == 0U;
+	bool u = (filter & PMU_COUNT_S_EL0) == 0U;
+	bool nsh = (filter & PMU_COUNT_NS_EL2) != 0U;
+	u_register_t bits = 0U;
+
+	if (p) {
+		bits |= PMEVTYPER_EL0_P_BIT;
+	}
+
+	if (u) {
+		bits |= PMEVTYPER_EL0_U_BIT;
+	}
+
+	if (((filter & PMU_COUNT_NS_EL1) != 0U) == p) {
+		bits |= PMEVTYPER_EL0_NSK_BIT;
+	}
+
+	if (((filter & PMU_COUNT_NS_EL0) != 0U) == u) {
+		bits |= PMEVTYPER_EL0_NSU_BIT;
+	}
+
+	if (nsh) {
+		bits |= PMEVTYPER_EL0_NSH_BIT;
+	}
+
+	if (((filter & PMU_COUNT_S_EL2) != 0U) != nsh) {
+		bits |= PMEVTYPER_EL0_SH_BIT;
+	}
+
+	if (((filter & PMU_COUNT_EL3) != 0U) == p) {
+		bits |= PMEVTYPER_EL0_M_BIT;
+	}
+
+	return bits;
+}
+
+static void pmu_write_evtyper(unsigned int idx, u_register_t val)
+{
+	write_pmselr_el0(idx);
+	isb();
+	write_pmxevtyper_el0(val);
+}
+
+static uint32_t pmu_read_evcntr(unsigned int idx)
+{
+	write_pmselr_el0(idx);
+	isb();
+	return (uint32_t)read_pmxevcntr_el0();
+}
+
+/*
+ * Number of events between the 'start' and 'end' values of a 32-bit counter.
+ * The difference is right modulo 2^32, and the counter went through a whole
+ * wrap around if it overflowed and is back at or above its start value.
+ */
+static uint64_t pmu_delta32(uint32_t start, uint32_t end, bool overflow)
+{
+	uint64_t delta = (uint32_t)(end - start);
+
+	if (overflow && (end >= start)) {
+		delta += 1ULL << 32;
+	}
+
+	return delta;
+}
+
+/* Return the number of events of the current group and its first event */
+static unsigned int pmu_profile_group(const struct pmu_profile *prof,
+				      unsigned int *first)
+{
+	*first = prof->group * prof->group_size;
+
+	if (*first >= prof->nr_events) {
+		return 0U;
+	}
+
+	return MIN(prof->group_size, prof->nr_events - *first);
+}
+
+static u_register_t pmu_profile_mask(unsigned int count)
+{
+	return PMCNTENSET_EL0_C_BIT | ((U(1) << count) - 1U);
+}
+
+void pmu_profile_init(struct pmu_profile *prof, const uint16_t *events,
+		      unsigned int nr_events, unsigned int filter)
+{
+	assert(prof != NULL);
+	assert(nr_events <= PMU_PROFILE_MAX_EVENTS);
+	assert((events != NULL) || (nr_events == 0U));
+
+	memset(prof, 0, sizeof(*prof));
+
+	prof->filter = filter;
+	prof->nr_events = nr_events;
+	for (unsigned int i = 0U; i < nr_events; i++) {
+		prof->events[i] = events[i];
+	}
+
+	prof->group_size = MIN(pmu_get_num_counters(), PMU_PROFILE_MAX_EVENTS);
+	if ((prof->group_size == 0U) || (nr_events == 0U)) {
+		prof->nr_groups = 1U;
+	} else {
+		prof->nr_groups = div_round_up(nr_events, prof->group_size);
+	}
+
+	if ((prof->group_size == 0U) && (nr_events != 0U)) {
+		WARN("No PMU event counters, only cycles are counted\n");
+	}
+}
+
+void pmu_profile_init_default(struct pmu_profile *prof, unsigned int filter)
+{
+	pmu_profile_init(prof, pmu_default_events,
+			 ARRAY_SIZE(pmu_default_events), filter);
+}
+
+void pmu_profile_start(struct pmu_profile *prof)
+{
+	u_register_t type = pmu_filter_bits(prof->filter);
+	unsigned int first, count;
+	u_register_t mask;
+
+	count = pmu_profile_group(prof, &first);
+	mask = pmu_profile_mask(count);
+
+	write_pmcntenclr_el0(mask);
+
+	for (unsigned int i = 0U; i < count; i++) {
+		pmu_write_evtyper(i, type | prof->events[first + i]);
+	}
+	write_pmccfiltr_el0(type);
+
+	/*
+	 * Use a 64-bit cycle counter and count cycles wherever counting events
+	 * is allowed, regardless of MDCR_EL3.SPME.
+	 */
+	write_pmcr_el0((read_pmcr_el0() | PMCR_EL0_E_BIT | PMCR_EL0_LC_BIT) &
+		       ~PMCR_EL0_DP_BIT);
+	write_pmovsclr_el0(mask);
+	isb();
+
+	for (unsigned int i = 0U; i < count; i++) {
+		prof->start[i] = pmu_read_evcntr(i);
+	}
+	prof->cycles_start = read_pmccntr_el0();
+
+	write_pmcntenset_el0(mask);
+	isb();
+}
+
+void pmu_profile_stop(struct pmu_profile *prof)
+{
+	unsigned int first, count;
+	u_register_t mask, ovs;
+	uint64_t cycles, delta;
+
+	count = pmu_profile_group(prof, &first);
+	mask = pmu_profile_mask(count);
+
+	write_pmcntenclr_el0(mask);
+	isb();
+
+	ovs = read_pmovsclr_el0();
+	cycles = read_pmccntr_el0();
+
+#ifdef __aarch64__
+	cycles -= prof->cycles_start;
+#else
+	/* The AArch32 cycle counter is read as a 32-bit value */
+	cycles = pmu_delta32((uint32_t)prof->cycles_start, (uint32_t)cycles,
+			     (ovs & PMCNTENSET_EL0_C_BIT) != 0U);
+#endif
+	prof->last_cycles = cycles;
+	prof->cycles += cycles;
+
+	for (unsigned int i = 0U; i < count; i++) {
+		delta = pmu_delta32(prof->start[i], pmu_read_evcntr(i),
+				    (ovs & PMCNTENSET_EL0_P_BIT(i)) != 0U);
+		prof->last[first + i] = delta;
+		prof->counts[first + i] += delta;
+	}
+
+	prof->group_runs[prof->group]++;
+	prof->runs++;
+	prof->group = (prof->group + 1U) % prof->nr_groups;
+}
+
+uint64_t pmu_profile_avg(const struct pmu_profile *prof, uint16_t event)
+{
+	unsigned int group;
+
+	if (prof->group_size == 0U) {
+		return 0ULL;
+	}
+
+	for (unsigned int i = 0U; i < prof->nr_events; i++) {
+		if (prof->events[i] != event) {
+			continue;
+		}
+
+		group = i / prof->group_size;
+		if (prof->group_runs[group] == 0ULL) {
+			return 0ULL;
+		}
+
+		return prof->counts[i] / prof->group_runs[group];
+	}
+
+	return 0ULL;
+}
+
+uint64_t pmu_profile_cycles_avg(const struct pmu_profile *prof)
+{
+	if (prof->runs == 0ULL) {
+		return 0ULL;
+	}
+
+	return prof->cycles / prof->runs;
+}
+
+static const char *pmu_event_name(uint16_t event)
+{
+	for (unsigned int i = 0U; i < ARRAY_SIZE(pmu_event_names); i++) {
+		if (pmu_event_names[i].event == event) {
+			return pmu_event_names[i].name;
+		}
+	}
+
+	return NULL;
+}
+
+void pmu_profile_print(const char *name, const struct pmu_profile *prof)
+{
+	uint64_t cycles = pmu_profile_cycles_avg(prof);
+	uint64_t insts, ipc;
+	const char *ev_name;
+
+	printf("%s: %llu runs, %llu cycles", name,
+	       (unsigned long long)prof->runs, (unsigned long long)cycles);
+
+	insts = pmu_profile_avg(prof, PMU_EV_INST_RETIRED);
+	if ((insts != 0ULL) && (cycles != 0ULL)) {
+		ipc = (insts * 100ULL) / cycles;
+		printf(", IPC %llu.%02llu", (unsigned long long)(ipc / 100ULL),
+		       (unsigned long long)(ipc % 100ULL));
+	}
+	printf("\n");
+
+	for (unsigned int i = 0U; i < prof->nr_events; i++) {
+		ev_name = pmu_event_name(prof->events[i]);
+		if (ev_name != NULL) {
+			printf("  %s: %llu\n", ev_name,
+			       (unsigned long long)pmu_profile_avg(prof,
+							prof->events[i]));
+		} else {
+			printf("  event 0x%x: %llu\n", prof->events[i],
+			       (unsigned long long)pmu_profile_avg(prof,
+							prof->events[i]));
+		}
+	}
+}
@@ -15,47 +15,46 @@
 
 #include <platform_def.h>
 
-static uint64_t memory_used;
-static uint64_t heap_base_addr;
-static u_register_t heap_addr;
-static uint64_t heap_size;
-static bool heap_initialised = HEAP_INIT_FAILED;
-static spinlock_t mem_lock;
-
 /*
  * Initialize the memory heap space to be used
+ * @pool: pool to initialise
  * @heap_base: heap base address
  * @heap_len: heap size for use
  */
-int page_pool_init(uint64_t heap_base, uint64_t heap_len)
+int page_pool_init(struct page_pool *pool, uint64_t heap_base,
+		   uint64_t heap_len)
 {
 	const uint64_t plat_max_addr = (uint64_t)DRAM_BASE + (uint64_t)DRAM_SIZE;
 	uint64_t max_addr = heap_base + heap_len;
 
 	if (heap_len == 0ULL) {
 		ERROR("heap_len must be non-zero value\n");
-		heap_initialised = HEAP_INVALID_LEN;
+		pool->state = HEAP_INVALID_LEN;
 	} else if (max_addr >= plat_max_addr) {
 		ERROR("heap_base + heap[0x%llx] must not exceed platform"
 			"max address[0x%llx]\n", max_addr, plat_max_addr);
 
-		heap_initialised = HEAP_OUT_OF_RANGE;
+		pool->state = HEAP_OUT_OF_RANGE;
 	} else {
-		heap_base_addr = heap_base;
-		memory_used = heap_base;
-		heap_size = heap_len;
-		heap_initialised = HEAP_INIT_SUCCESS;
+		pool->base = heap_base;
+		pool->used = heap_base;
+		pool->size = heap_len;
+		init_spinlock(&pool->lock);
+		pool->state = HEAP_INIT_SUCCESS;
 	}
-	return heap_initialised;
+	return pool->state;
 }
 
 /*
  * Return the pointer to the allocated pages
+ * @pool: pool to allocate from
  * @bytes_size: pages to allocate in byte unit
  */
-void *page_alloc(u_register_t bytes_size)
+void *page_alloc(struct page_pool *pool, u_register_t bytes_size)
 {
-	if (heap_initialised != HEAP_INIT_SUCCESS) {
+	u_register_t heap_addr;
+
+	if (pool->state != HEAP_INIT_SUCCESS) {
 		ERROR("heap need to be initialised first\n");
 		return HEAP_NULL_PTR;
 	}
@@ -64,35 +63,35 @@ void *page_alloc(u_register_t bytes_size)
 		return HEAP_NULL_PTR;
 	}
 
-	spin_lock(&mem_lock);
+	spin_lock(&pool->lock);
 
-	if ((memory_used + bytes_size) >= (heap_base_addr + heap_size)) {
-		ERROR("Reached to max KB allowed[%llu]\n", (heap_size/1024U));
+	if ((pool->used + bytes_size) >= (pool->base + pool->size)) {
+		ERROR("Reached to max KB allowed[%llu]\n", (pool->size/1024U));
 		goto unlock_failed;
 	}
 	/* set pointer to current used heap memory cursor */
-	heap_addr = memory_used;
+	heap_addr = pool->used;
 	/* move used memory cursor by bytes_size */
-	memory_used += bytes_size;
-	spin_unlock(&mem_lock);
+	pool->used += bytes_size;
+	spin_unlock(&pool->lock);
 
 	return (void *)heap_addr;
 
 unlock_failed:/* failed allocation */
-	spin_unlock(&mem_lock);
+	spin_unlock(&pool->lock);
 	return HEAP_NULL_PTR;
 }
 
 /*
  * Reset heap memory usage cursor to heap base address
  */
-void page_pool_reset(void)
+void page_pool_reset(struct page_pool *pool)
 {
 	/*
-	 * No race condition here, only lead cpu running TFTF test case can
-	 * reset the memory allocation
+	 * No race condition here, only the CPU owning the Realm of this pool
+	 * can reset the memory allocation
 	 */
-	memory_used = heap_base_addr;
+	pool->used = pool->base;
 }
 
 void page_free(u_register_t address)
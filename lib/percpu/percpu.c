@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <arch_helpers.h>
+#include <assert.h>
+#include <percpu.h>
+#include <platform.h>
+#include <platform_def.h>
+
+/* Linker symbol for the end of the copies of all CPUs */
+extern char __PERCPU_END__[];
+
+void tftf_percpu_init(void)
+{
+	unsigned int core_pos = platform_get_core_pos(read_mpidr_el1());
+	uintptr_t offset;
+
+	assert(core_pos < PLATFORM_CORE_COUNT);
+	assert(((uintptr_t)__PERCPU_START__ +
+		(PLATFORM_CORE_COUNT * PERCPU_UNIT_SIZE)) ==
+	       (uintptr_t)__PERCPU_END__);
+
+	offset = (uintptr_t)core_pos * PERCPU_UNIT_SIZE;
+
+#ifdef __aarch64__
+	write_tpidr_el1(offset);
+#else
+	write_htpidr(offset);
+#endif
+	isb();
+}
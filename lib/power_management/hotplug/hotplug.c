@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -12,6 +12,7 @@
 #include <drivers/console.h>
 #include <irq.h>
 #include <pauth.h>
+#include <percpu.h>
 #include <platform.h>
 #include <platform_def.h>
 #include <power_management.h>
@@ -20,6 +21,7 @@
 #include <spinlock.h>
 #include <stdint.h>
 #include <tftf.h>
+#include <utils_def.h>
 
 /*
  * Affinity info map of CPUs as seen by TFTF
@@ -43,7 +45,7 @@ static volatile unsigned int ref_cnt;
 static spinlock_t ref_cnt_lock;
 
 /* Per-cpu test entrypoint */
-volatile test_function_t test_entrypoint[PLATFORM_CORE_COUNT];
+DEFINE_PER_CPU(volatile test_function_t, test_entrypoint);
 
 u_register_t tftf_primary_core = INVALID_MPID;
 
@@ -179,7 +181,8 @@ int32_t tftf_cpu_on(u_register_t target_cpu,
 		 * This is the address where the core will jump to once the framework
 		 * has finished initialising it.
 		 */
-		test_entrypoint[core_pos] = (test_function_t) entrypoint;
+		per_cpu(test_entrypoint, core_pos) =
+			(test_function_t) entrypoint;
 
 		cpus_status_map[core_pos].state = TFTF_AFFINITY_STATE_ON_PENDING;
 		spin_unlock(&cpus_status_map[core_pos].lock);
@@ -217,12 +220,125 @@ int32_t tftf_try_cpu_on(u_register_t target_cpu,
 		 * This is the address where the core will jump to once the
 		 * framework has finished initialising it.
 		 */
-		test_entrypoint[core_pos] = (test_function_t) entrypoint;
+		per_cpu(test_entrypoint, core_pos) =
+			(test_function_t) entrypoint;
 	}
 
 	return ret;
 }
 
+/*
+ * State of the CPU_ON tree being brought up by tftf_cpu_on_tree(). The CPU at
+ * index 'i' of 'mpids' powers on the CPUs at indices fanout * (i + 1) to
+ * fanout * (i + 1) + fanout - 1, the caller powers on the first 'fanout' CPUs.
+ */
+static struct {
+	const u_register_t *mpids;
+	unsigned int count;
+	unsigned int fanout;
+	test_function_t entrypoint;
+	u_register_t context_id;
+	uint64_t *issue_ts;
+
+	/* CPUs that have booted or failed to, and the first error */
+	volatile unsigned int done;
+	volatile int32_t error;
+	spinlock_t lock;
+} cpu_on_tree;
+
+/* Index in the CPU_ON tree of each CPU */
+static DEFINE_PER_CPU(unsigned int, cpu_on_tree_index);
+
+static void cpu_on_tree_done(unsigned int count, int32_t error)
+{
+	spin_lock(&cpu_on_tree.lock);
+	cpu_on_tree.done += count;
+	if ((error != PSCI_E_SUCCESS) &&
+	    (cpu_on_tree.error == PSCI_E_SUCCESS)) {
+		cpu_on_tree.error = error;
+	}
+	spin_unlock(&cpu_on_tree.lock);
+}
+
+/* Number of CPUs in the subtree rooted at index 'idx' */
+static unsigned int cpu_on_tree_size(unsigned int idx)
+{
+	unsigned int first = idx, last = idx, size = 0U;
+
+	while (first < cpu_on_tree.count) {
+		size += MIN(last, cpu_on_tree.count - 1U) - first + 1U;
+		first = cpu_on_tree.fanout * (first + 1U);
+		last = (cpu_on_tree.fanout * (last + 1U)) +
+		       cpu_on_tree.fanout - 1U;
+	}
+
+	return size;
+}
+
+static test_result_t cpu_on_tree_entry(void);
+
+/*
+ * Power on the CPUs of the tree from index 'first' on, as many as the fanout.
+ * A CPU that fails to power on is accounted as done with its whole subtree.
+ */
+static void cpu_on_tree_power_on(unsigned int first)
+{
+	unsigned int last = MIN(first + cpu_on_tree.fanout, cpu_on_tree.count);
+	u_register_t mpid;
+	int32_t ret;
+
+	for (unsigned int i = first; i < last; i++) {
+		mpid = cpu_on_tree.mpids[i];
+		per_cpu(cpu_on_tree_index, platform_get_core_pos(mpid)) = i;
+
+		if (cpu_on_tree.issue_ts != NULL) {
+			cpu_on_tree.issue_ts[i] = syscounter_read();
+		}
+
+		ret = tftf_cpu_on(mpid, (uintptr_t)cpu_on_tree_entry,
+				  cpu_on_tree.context_id);
+		if (ret != PSCI_E_SUCCESS) {
+			cpu_on_tree_done(cpu_on_tree_size(i), ret);
+		}
+	}
+}
+
+static test_result_t cpu_on_tree_entry(void)
+{
+	unsigned int idx = this_cpu(cpu_on_tree_index);
+	test_function_t entrypoint = cpu_on_tree.entrypoint;
+
+	cpu_on_tree_power_on(cpu_on_tree.fanout * (idx + 1U));
+	cpu_on_tree_done(1U, PSCI_E_SUCCESS);
+
+	return entrypoint();
+}
+
+int32_t tftf_cpu_on_tree(const u_register_t *mpids, unsigned int count,
+			 unsigned int fanout, uintptr_t entrypoint,
+			 u_register_t context_id, uint64_t *issue_ts)
+{
+	assert((mpids != NULL) && (count <= PLATFORM_CORE_COUNT));
+	assert(fanout != 0U);
+
+	cpu_on_tree.mpids = mpids;
+	cpu_on_tree.count = count;
+	cpu_on_tree.fanout = fanout;
+	cpu_on_tree.entrypoint = (test_function_t)entrypoint;
+	cpu_on_tree.context_id = context_id;
+	cpu_on_tree.issue_ts = issue_ts;
+	cpu_on_tree.done = 0U;
+	cpu_on_tree.error = PSCI_E_SUCCESS;
+
+	cpu_on_tree_power_on(0U);
+
+	while (cpu_on_tree.done < count) {
+		continue;
+	}
+
+	return cpu_on_tree.error;
+}
+
 /*
  * Prepare the core to power off. Any driver which needs to perform specific
  * tasks before powering off a CPU, e.g. migrating interrupts to another
@@ -288,6 +404,7 @@ int32_t tftf_cpu_off(void)
 void __dead2 tftf_warm_boot_main(void)
 {
 	/* Initialise the CPU */
+	tftf_percpu_init();
 	tftf_arch_setup();
 
 #if ENABLE_PAUTH
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -8,6 +8,7 @@
 #include <debug.h>
 #include <drivers/arm/arm_gic.h>
 #include <drivers/console.h>
+#include <percpu.h>
 #include <platform.h>
 #include <power_management.h>
 #include <psci.h>
@@ -17,6 +18,9 @@
 #include <tftf_lib.h>
 #include "suspend_private.h"
 
+/* Stages of the last suspend of each CPU */
+static DEFINE_PER_CPU(suspend_stages_t, suspend_stages);
+
 int32_t tftf_enter_suspend(const suspend_info_t *info,
 			   tftf_suspend_ctx_t *ctx)
 {
@@ -33,6 +37,7 @@ int32_t tftf_enter_suspend(const suspend_info_t *info,
 			(u_register_t)ctx
 		};
 
+	suspend_stages_t *stages = this_cpu_ptr(suspend_stages);
 	smc_ret_values rc;
 
 	if (info->save_system_context) {
@@ -55,6 +60,13 @@ int32_t tftf_enter_suspend(const suspend_info_t *info,
 	/* Make sure any outstanding message is printed. */
 	console_flush();
 
+	/*
+	 * The timestamps are read back with the MMU on after resuming, but the
+	 * caches may have been powered down in between.
+	 */
+	stages->smc = syscounter_read();
+	flush_dcache_range((u_register_t)stages, sizeof(*stages));
+
 	if (info->psci_api == SMC_PSCI_CPU_SUSPEND)
 		rc = tftf_smc(&cpu_suspend_args);
 	else
@@ -78,6 +90,8 @@ void tftf_restore_system_ctx(tftf_suspend_ctx_t *ctx)
 	 * API for resume.
 	 */
 
+	this_cpu_ptr(suspend_stages)->resume = syscounter_read();
+
 	tftf_early_platform_setup();
 
 	INFO("Restoring system context\n");
@@ -96,11 +110,14 @@ void tftf_save_system_ctx(tftf_suspend_ctx_t *ctx)
 	INFO("Saving system context\n");
 
 	/* Save the global GIC context */
+	this_cpu_ptr(suspend_stages)->gic_save_start = syscounter_read();
 	arm_gic_save_context_global();
+	this_cpu_ptr(suspend_stages)->gic_save_end = syscounter_read();
 }
 
 int tftf_suspend(const suspend_info_t *info)
 {
+	suspend_stages_t *stages = this_cpu_ptr(suspend_stages);
 	int32_t rc;
 	uint64_t flags;
 
@@ -108,6 +125,11 @@ int tftf_suspend(const suspend_info_t *info)
 
 	disable_irq();
 
+	stages->start = syscounter_read();
+	stages->gic_save_start = 0ULL;
+	stages->gic_save_end = 0ULL;
+	stages->resume = 0ULL;
+
 	INFO("Going into suspend state\n");
 
 	/* Save the local GIC context */
@@ -115,9 +137,16 @@ int tftf_suspend(const suspend_info_t *info)
 
 	rc = __tftf_suspend(info);
 
+	/* The resume path only takes a timestamp if it restored the system */
+	if (stages->resume == 0ULL) {
+		stages->resume = syscounter_read();
+	}
+
 	/* Restore the local GIC context */
 	arm_gic_restore_context_local();
 
+	stages->end = syscounter_read();
+
 	/*
 	 * DAIF flags should be restored last because it could be an issue
 	 * to unmask exceptions before that point, e.g. if GIC must be
@@ -129,3 +158,8 @@ int tftf_suspend(const suspend_info_t *info)
 
 	return rc;
 }
+
+void tftf_get_suspend_stages(suspend_stages_t *stages)
+{
+	*stages = *this_cpu_ptr(suspend_stages);
+}
@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <arch_helpers.h>
+#include <assert.h>
+#include <debug.h>
+#include <plat_topology.h>
+#include <platform.h>
+#include <psci.h>
+#include <psci_stat_monitor.h>
+#include <stdbool.h>
+#include <tftf_lib.h>
+
+/* Valid power states of the platform and their power level */
+static struct {
+	unsigned int power_state;
+	unsigned int pwrlvl;
+} psci_stat_states[PSCI_STAT_MAX_STATES];
+
+static unsigned int psci_stat_nr_states;
+static unsigned int psci_stat_max_pwrlvl;
+static bool psci_stat_ready;
+
+/* Snapshots taken by the framework around the current test */
+static struct psci_stat_snapshot test_before, test_after;
+static bool test_started;
+
+int psci_stat_monitor_init(void)
+{
+	unsigned int pstateid_idx[PLAT_MAX_PWR_LEVEL + 1];
+	unsigned int pwrlvl, susp_type, state_id;
+
+	if (psci_stat_ready) {
+		return 0;
+	}
+
+	if ((tftf_get_psci_feature_info(SMC_PSCI_STAT_COUNT) !=
+	     PSCI_E_SUCCESS) ||
+	    (tftf_get_psci_feature_info(SMC_PSCI_STAT_RESIDENCY) !=
+	     PSCI_E_SUCCESS)) {
+		return -1;
+	}
+
+	INIT_PWR_LEVEL_INDEX(pstateid_idx);
+	do {
+		tftf_set_next_state_id_idx(PLAT_MAX_PWR_LEVEL, pstateid_idx);
+		if (pstateid_idx[0] == PWR_STATE_INIT_INDEX) {
+			break;
+		}
+
+		if (tftf_get_pstate_vars(&pwrlvl, &susp_type, &state_id,
+					 pstateid_idx) != PSCI_E_SUCCESS) {
+			continue;
+		}
+
+		if (psci_stat_nr_states == PSCI_STAT_MAX_STATES) {
+			WARN("Only %u power states are monitored\n",
+			     PSCI_STAT_MAX_STATES);
+			break;
+		}
+
+		psci_stat_states[psci_stat_nr_states].power_state =
+			tftf_make_psci_pstate(pwrlvl, susp_type, state_id);
+		psci_stat_states[psci_stat_nr_states].pwrlvl = pwrlvl;
+		psci_stat_max_pwrlvl = MAX(psci_stat_max_pwrlvl, pwrlvl);
+		psci_stat_nr_states++;
+	} while (true);
+
+	psci_stat_ready = true;
+
+	return 0;
+}
+
+void psci_stat_snapshot(struct psci_stat_snapshot *snap)
+{
+	unsigned int cpu_node, core_pos;
+	u_register_t mpid;
+
+	assert(psci_stat_ready);
+
+	snap->timestamp = syscounter_read();
+
+	for_each_cpu(cpu_node) {
+		mpid = tftf_get_mpidr_from_node(cpu_node);
+		core_pos = platform_get_core_pos(mpid);
+
+		for (unsigned int i = 0U; i < psci_stat_nr_states; i++) {
+			snap->stat[core_pos][i].count = tftf_psci_stat_count(
+				mpid, psci_stat_states[i].power_state);
+			snap->stat[core_pos][i].residency =
+				tftf_psci_stat_residency(mpid,
+					psci_stat_states[i].power_state);
+		}
+	}
+}
+
+static uint64_t ticks_to_us(uint64_t ticks)
+{
+	uint64_t freq = read_cntfrq_el0();
+
+	return ((ticks / freq) * 1000000ULL) +
+	       (((ticks % freq) * 1000000ULL) / freq);
+}
+
+void psci_stat_idle(const struct psci_stat_snapshot *before,
+		    const struct psci_stat_snapshot *after,
+		    struct psci_stat_idle *idle)
+{
+	unsigned int cpu_node, core_pos;
+	u_register_t residency;
+
+	idle->elapsed = ticks_to_us(after->timestamp - before->timestamp);
+	idle->idle = 0ULL;
+	idle->deep = 0ULL;
+	idle->cpus = 0U;
+
+	for_each_cpu(cpu_node) {
+		core_pos = platform_get_core_pos(
+				tftf_get_mpidr_from_node(cpu_node));
+		idle->cpus++;
+
+		for (unsigned int i = 0U; i < psci_stat_nr_states; i++) {
+			residency = after->stat[core_pos][i].residency -
+				    before->stat[core_pos][i].residency;
+
+			idle->idle += residency;
+			if (psci_stat_states[i].pwrlvl ==
+			    psci_stat_max_pwrlvl) {
+				idle->deep += residency;
+			}
+		}
+	}
+}
+
+unsigned int psci_stat_idle_efficiency(const struct psci_stat_idle *idle)
+{
+	if (idle->idle == 0ULL) {
+		return 0U;
+	}
+
+	return (unsigned int)((idle->deep * 1000ULL) / idle->idle);
+}
+
+void psci_stat_report(const struct psci_stat_snapshot *before,
+		      const struct psci_stat_snapshot *after)
+{
+	unsigned int cpu_node, core_pos;
+	u_register_t count, residency;
+	struct psci_stat_idle idle;
+	uint64_t total;
+
+	for_each_cpu(cpu_node) {
+		core_pos = platform_get_core_pos(
+				tftf_get_mpidr_from_node(cpu_node));
+
+		for (unsigned int i = 0U; i < psci_stat_nr_states; i++) {
+			count = after->stat[core_pos][i].count -
+				before->stat[core_pos][i].count;
+			residency = after->stat[core_pos][i].residency -
+				    before->stat[core_pos][i].residency;
+			if ((count == 0U) && (residency == 0U)) {
+				continue;
+			}
+
+			tftf_testcase_printf("PSCI_STAT CPU%u state 0x%x: "
+				"%llu entries, %llu us\n", core_pos,
+				psci_stat_states[i].power_state,
+				(unsigned long long)count,
+				(unsigned long long)residency);
+		}
+	}
+
+	psci_stat_idle(before, after, &idle);
+	total = idle.elapsed * idle.cpus;
+
+	tftf_testcase_printf("PSCI_STAT %u CPUs idle %llu/1000 of %llu us, "
+		"idle efficiency %u/1000\n", idle.cpus,
+		(unsigned long long)((total != 0ULL) ?
+				     ((idle.idle * 1000ULL) / total) : 0ULL),
+		(unsigned long long)idle.elapsed,
+		psci_stat_idle_efficiency(&idle));
+}
+
+void psci_stat_monitor_test_start(void)
+{
+	test_started = psci_stat_ready;
+	if (test_started) {
+		psci_stat_snapshot(&test_before);
+	}
+}
+
+void psci_stat_monitor_test_end(void)
+{
+	if (!test_started) {
+		return;
+	}
+
+	psci_stat_snapshot(&test_after);
+	psci_stat_report(&test_before, &test_after);
+	test_started = false;
+}
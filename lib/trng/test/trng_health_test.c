@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Host unit test of the TRNG health tests, built and run with
+ * "make trng_health_test". A uniform stream must pass, a stuck stream must
+ * fail the Repetition Count Test and a biased stream without repetitions must
+ * fail the Adaptive Proportion Test only.
+ */
+
+#include <stdio.h>
+
+#include <trng_health.h>
+
+#define TEST_SAMPLES	(1024U * 1024U)
+
+static struct trng_health health;
+
+static unsigned int failures;
+
+#define CHECK(_cond)							\
+	do {								\
+		if (!(_cond)) {						\
+			printf("%s:%d: check failed: %s\n", __FILE__,	\
+			       __LINE__, #_cond);			\
+			failures++;					\
+		}							\
+	} while (0)
+
+static uint32_t rng = 0x12345678U;
+
+static uint8_t test_rand(void)
+{
+	rng ^= rng << 13;
+	rng ^= rng >> 17;
+	rng ^= rng << 5;
+
+	return (uint8_t)(rng >> 24);
+}
+
+static void test_cutoffs(void)
+{
+	trng_health_init(&health, 1U);
+	CHECK(health.rct_cutoff == 21U);
+	CHECK(health.apt_cutoff == 311U);
+
+	trng_health_init(&health, 8U);
+	CHECK(health.rct_cutoff == 4U);
+	CHECK(health.apt_cutoff == 13U);
+}
+
+static void test_uniform(void)
+{
+	uint8_t sample;
+
+	trng_health_init(&health, 8U);
+
+	for (unsigned int i = 0U; i < TEST_SAMPLES; i++) {
+		sample = test_rand();
+		CHECK(trng_health_feed(&health, &sample, 1U));
+	}
+
+	CHECK(trng_health_ok(&health));
+	CHECK(health.samples == TEST_SAMPLES);
+	printf("uniform: longest run %u, highest window count %u\n",
+	       health.rct_max, health.apt_max);
+}
+
+static void test_stuck(void)
+{
+	uint8_t buf[64];
+
+	for (unsigned int i = 0U; i < sizeof(buf); i++) {
+		buf[i] = test_rand();
+	}
+
+	trng_health_init(&health, 8U);
+	CHECK(trng_health_feed(&health, buf, sizeof(buf)));
+
+	/* One long run fails once */
+	for (unsigned int i = 0U; i < sizeof(buf); i++) {
+		buf[i] = 0x5aU;
+	}
+	CHECK(!trng_health_feed(&health, buf, sizeof(buf)));
+	CHECK(health.rct_failures == 1U);
+	CHECK(health.rct_max >= sizeof(buf));
+	CHECK(!trng_health_ok(&health));
+}
+
+/* One sample in 16 is 0xaa, the others never repeat the previous sample */
+static void test_biased(void)
+{
+	uint8_t prev = 0U, sample;
+
+	trng_health_init(&health, 8U);
+
+	for (unsigned int i = 0U; i < (64U * TRNG_HEALTH_APT_WINDOW); i++) {
+		if ((i % 16U) == 0U) {
+			sample = 0xaaU;
+		} else {
+			do {
+				sample = test_rand();
+			} while ((sample == prev) || (sample == 0xaaU));
+		}
+
+		(void)trng_health_feed(&health, &sample, 1U);
+		prev = sample;
+	}
+
+	CHECK(health.rct_failures == 0U);
+	CHECK(health.apt_failures != 0U);
+}
+
+int main(void)
+{
+	test_cutoffs();
+	test_uniform();
+	test_stuck();
+	test_biased();
+
+	if (failures != 0U) {
+		printf("trng_health_test: %u failures\n", failures);
+		return 1;
+	}
+
+	printf("trng_health_test: PASSED\n");
+	return 0;
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <assert.h>
+#include <string.h>
+#include <trng_health.h>
+
+/*
+ * Adaptive Proportion Test cutoffs for a window of 512 samples, indexed by the
+ * claimed min-entropy per sample minus 1. Each cutoff is 1 + CRITBINOM(512,
+ * 2^-H, 1 - 2^-20), as per SP 800-90B section 4.4.2.
+ */
+static const unsigned int apt_cutoffs[] = {
+	311U, 177U, 103U, 62U, 39U, 25U, 18U, 13U
+};
+
+void trng_health_init(struct trng_health *health, unsigned int min_entropy)
+{
+	assert((min_entropy >= 1U) && (min_entropy <= 8U));
+
+	memset(health, 0, sizeof(*health));
+
+	/* 1 + ceil(20 / H), as per SP 800-90B section 4.4.1 */
+	health->rct_cutoff = 1U + ((20U + min_entropy - 1U) / min_entropy);
+	health->apt_cutoff = apt_cutoffs[min_entropy - 1U];
+}
+
+static bool trng_health_rct(struct trng_health *health, uint8_t sample)
+{
+	if ((health->samples == 0ULL) || (sample != health->rct_sample)) {
+		health->rct_sample = sample;
+		health->rct_count = 1U;
+		if (health->rct_max == 0U) {
+			health->rct_max = 1U;
+		}
+		return true;
+	}
+
+	health->rct_count++;
+	if (health->rct_count > health->rct_max) {
+		health->rct_max = health->rct_count;
+	}
+
+	/* A run of repeated samples fails once, when it reaches the cutoff */
+	if (health->rct_count == health->rct_cutoff) {
+		health->rct_failures++;
+		return false;
+	}
+
+	return true;
+}
+
+static bool trng_health_apt(struct trng_health *health, uint8_t sample)
+{
+	bool ok = true;
+
+	if (health->apt_index == 0U) {
+		health->apt_sample = sample;
+		health->apt_count = 1U;
+	} else if (sample == health->apt_sample) {
+		health->apt_count++;
+		if (health->apt_count == health->apt_cutoff) {
+			health->apt_failures++;
+			ok = false;
+		}
+	}
+
+	health->apt_index++;
+	if (health->apt_index == TRNG_HEALTH_APT_WINDOW) {
+		if (health->apt_count > health->apt_max) {
+			health->apt_max = health->apt_count;
+		}
+		health->apt_index = 0U;
+	}
+
+	return ok;
+}
+
+bool trng_health_feed(struct trng_health *health, const uint8_t *buf,
+		      size_t len)
+{
+	bool ok = true;
+
+	for (size_t i = 0U; i < len; i++) {
+		ok = trng_health_rct(health, buf[i]) && ok;
+		ok = trng_health_apt(health, buf[i]) && ok;
+		health->samples++;
+	}
+
+	return ok;
+}
+
+bool trng_health_ok(const struct trng_health *health)
+{
+	return (health->rct_failures == 0U) && (health->apt_failures == 0U);
+}
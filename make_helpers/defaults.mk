@@ -40,6 +40,9 @@ FWU_BL_TEST := 1
 # framework should try to resume a previous one if it was interrupted
 NEW_TEST_SESSION	:= 1
 
+# Report the PSCI_STAT count and residency deltas of each test
+PSCI_STAT_MONITOR	:= 0
+
 # Use non volatile memory for storing results
 USE_NVM			:= 0
 
@@ -11,33 +11,89 @@
 
 #include <arch_helpers.h>
 #include <host_shared_data.h>
+#include <realm_rsi.h>
+#include <spinlock.h>
+
+/* Longest message realm_printf() can log, including the terminating NUL */
+#define REALM_LOG_LINE_SIZE	256U
+
+/*
+ * Serialises the RECs of this Realm producing into the log ring buffer.
+ * Only used in the Realm, the Host consumes the ring without any lock.
+ */
+static spinlock_t log_lock;
+
+/*
+ * Copy 'len' characters to the shared log ring buffer. If the ring is full,
+ * request the Host to drain it and drop the remaining characters if that did
+ * not free any space.
+ */
+static void realm_log_write(const char *buf, size_t len)
+{
+	host_shared_data_t *guest_shared_data = realm_get_shared_structure();
+	uint32_t head, tail;
+	size_t i;
+
+	if (guest_shared_data == NULL) {
+		return;
+	}
+
+	spin_lock(&log_lock);
+	head = guest_shared_data->log_head;
+	tail = guest_shared_data->log_tail;
+
+	for (i = 0UL; i < len; i++) {
+		if ((head - tail) == MAX_BUF_SIZE) {
+			/* Publish what has been written so far */
+			dmbishst();
+			guest_shared_data->log_head = head;
+
+			rsi_exit_to_host(HOST_CALL_LOG_FLUSH_CMD);
+
+			tail = guest_shared_data->log_tail;
+			if ((head - tail) == MAX_BUF_SIZE) {
+				guest_shared_data->log_dropped += len - i;
+				break;
+			}
+		}
+
+		guest_shared_data->log_buffer[head & (MAX_BUF_SIZE - 1U)] = buf[i];
+		head++;
+	}
+
+	/* Make the characters visible to the Host before the new head */
+	dmbishst();
+	guest_shared_data->log_head = head;
+	spin_unlock(&log_lock);
+}
 
 /*
  * A printf formatted function used in the Realm world to log messages
- * in the shared buffer.
- * Locate the shared logging buffer and print its content
+ * in the shared ring buffer.
  */
 void realm_printf(const char *fmt, ...)
 {
-	host_shared_data_t *guest_shared_data = realm_get_shared_structure();
-	char *log_buffer = (char *)guest_shared_data->log_buffer;
+	char buf[REALM_LOG_LINE_SIZE];
 	va_list args;
+	int len;
 
 	va_start(args, fmt);
-	spin_lock((spinlock_t *)&guest_shared_data->printf_lock);
-	if (strnlen((const char *)log_buffer, MAX_BUF_SIZE) == MAX_BUF_SIZE) {
-		(void)memset((char *)log_buffer, 0, MAX_BUF_SIZE);
-	}
-	(void)vsnprintf((char *)log_buffer +
-			strnlen((const char *)log_buffer, MAX_BUF_SIZE),
-			MAX_BUF_SIZE, fmt, args);
-	spin_unlock((spinlock_t *)&guest_shared_data->printf_lock);
+	len = vsnprintf(buf, sizeof(buf), fmt, args);
 	va_end(args);
+
+	if (len <= 0) {
+		return;
+	}
+
+	realm_log_write(buf, strnlen(buf, sizeof(buf)));
 }
 
 void __attribute__((__noreturn__)) do_panic(const char *file, int line)
 {
 	realm_printf("PANIC in file: %s line: %d\n", file, line);
+
+	/* Return to the Host so that it prints the log and fails the test */
+	rsi_exit_to_host(HOST_CALL_EXIT_FAILED_CMD);
 	while (true) {
 		continue;
 	}
@@ -46,18 +102,13 @@ void __attribute__((__noreturn__)) do_panic(const char *file, int line)
 /* This is used from printf() when crash dump is reached */
 int console_putc(int c)
 {
-	host_shared_data_t *guest_shared_data = realm_get_shared_structure();
-	char *log_buffer = (char *)guest_shared_data->log_buffer;
+	char ch = (char)c;
 
 	if ((c < 0) || (c > 127)) {
 		return -1;
 	}
-	spin_lock((spinlock_t *)&guest_shared_data->printf_lock);
-	if (strnlen((const char *)log_buffer, MAX_BUF_SIZE) == MAX_BUF_SIZE) {
-		(void)memset((char *)log_buffer, 0, MAX_BUF_SIZE);
-	}
-	*((char *)log_buffer + strnlen((const char *)log_buffer, MAX_BUF_SIZE)) = c;
-	spin_unlock((spinlock_t *)&guest_shared_data->printf_lock);
+
+	realm_log_write(&ch, 1UL);
 
 	return c;
 }
@@ -47,9 +47,35 @@ static void realm_get_rsi_version(void)
 }
 
 /*
- * This is the entry function for Realm payload, it first requests the shared buffer
- * IPA address from Host using HOST_CALL/RSI, it reads the command to be executed,
- * performs the request, and returns to Host with the execution state SUCCESS/FAILED
+ * This function exits to the Host as many times as requested by the Host with
+ * back to back host calls. Then, if the Host provided an unprotected IPA which
+ * it emulates, it reads it as many times, each read exiting with a data abort.
+ */
+static void realm_exit_loop_cmd(void)
+{
+	u_register_t iterations =
+		realm_shared_data_get_host_val(HOST_ITERATIONS_INDEX);
+	u_register_t mmio_ipa =
+		realm_shared_data_get_host_val(HOST_MMIO_IPA_INDEX);
+
+	for (u_register_t i = 0UL; i < iterations; i++) {
+		rsi_exit_to_host(HOST_CALL_PING_CMD);
+	}
+
+	if (mmio_ipa == 0UL) {
+		return;
+	}
+
+	for (u_register_t i = 0UL; i < iterations; i++) {
+		(void)*((volatile uint32_t *)mmio_ipa);
+	}
+}
+
+/*
+ * This is the entry function for Realm payload, run by every REC. It first
+ * requests the shared buffer IPA address from Host using HOST_CALL/RSI, then
+ * for each entry from the Host, it reads the command to be executed, performs
+ * the request, and returns to Host with the execution state SUCCESS/FAILED.
  *
  * Host in NS world requests Realm to execute certain operations using command
  * depending on the test case the Host wants to perform.
@@ -57,29 +83,42 @@ static void realm_get_rsi_version(void)
 void realm_payload_main(void)
 {
 	uint8_t cmd = 0U;
-	bool test_succeed = false;
+	bool test_succeed;
 
 	realm_set_shared_structure((host_shared_data_t *)rsi_get_ns_buffer());
-	if (realm_get_shared_structure() != NULL) {
-		cmd = realm_shared_data_get_realm_cmd();
-		switch (cmd) {
-		case REALM_SLEEP_CMD:
-			realm_sleep_cmd();
-			test_succeed = true;
-			break;
-		case REALM_GET_RSI_VERSION:
-			realm_get_rsi_version();
-			test_succeed = true;
-			break;
-		default:
-			INFO("REALM_PAYLOAD: %s invalid cmd=%hhu", __func__, cmd);
-			break;
+
+	while (true) {
+		test_succeed = false;
+
+		if (realm_get_shared_structure() != NULL) {
+			cmd = realm_shared_data_get_realm_cmd();
+			switch (cmd) {
+			case REALM_SLEEP_CMD:
+				realm_sleep_cmd();
+				test_succeed = true;
+				break;
+			case REALM_GET_RSI_VERSION:
+				realm_get_rsi_version();
+				test_succeed = true;
+				break;
+			case REALM_NOP_CMD:
+				test_succeed = true;
+				break;
+			case REALM_EXIT_LOOP_CMD:
+				realm_exit_loop_cmd();
+				test_succeed = true;
+				break;
+			default:
+				INFO("REALM_PAYLOAD: %s invalid cmd=%hhu",
+				     __func__, cmd);
+				break;
+			}
 		}
-	}
 
-	if (test_succeed) {
-		rsi_exit_to_host(HOST_CALL_EXIT_SUCCESS_CMD);
-	} else {
-		rsi_exit_to_host(HOST_CALL_EXIT_FAILED_CMD);
+		if (test_succeed) {
+			rsi_exit_to_host(HOST_CALL_EXIT_SUCCESS_CMD);
+		} else {
+			rsi_exit_to_host(HOST_CALL_EXIT_FAILED_CMD);
+		}
 	}
 }
@@ -6,12 +6,21 @@
  *
  */
 
+#include <arch_helpers.h>
 #include <host_realm_rmi.h>
 #include <lib/aarch64/arch_features.h>
 #include <realm_rsi.h>
 #include <smccc.h>
 
-static struct rsi_host_call host_cal __aligned(sizeof(struct rsi_host_call));
+/* Host call structure of each REC, indexed by MPIDR Aff0 */
+static struct rsi_host_call host_cal[REALM_MAX_REC_COUNT]
+		__aligned(sizeof(struct rsi_host_call));
+
+static struct rsi_host_call *rsi_get_host_call(void)
+{
+	return &host_cal[MPIDR_AFF_ID(read_mpidr_el1(), 0) %
+			 REALM_MAX_REC_COUNT];
+}
 
 /* This function return RSI_ABI_VERSION */
 u_register_t rsi_get_version(void)
@@ -27,21 +36,24 @@ u_register_t rsi_get_version(void)
 /* This function will call the Host to request IPA of the NS shared buffer */
 u_register_t rsi_get_ns_buffer(void)
 {
+	struct rsi_host_call *host_call = rsi_get_host_call();
 	smc_ret_values res = {};
 
-	host_cal.imm = HOST_CALL_GET_SHARED_BUFF_CMD;
-	res = tftf_smc(&(smc_args) {RSI_HOST_CALL, (u_register_t)&host_cal,
+	host_call->imm = HOST_CALL_GET_SHARED_BUFF_CMD;
+	res = tftf_smc(&(smc_args) {RSI_HOST_CALL, (u_register_t)host_call,
 		0UL, 0UL, 0UL, 0UL, 0UL, 0UL});
 	if (res.ret0 != RSI_SUCCESS) {
 		return 0U;
 	}
-	return host_cal.gprs[0];
+	return host_call->gprs[0];
 }
 
 /* This function call Host and request to exit Realm with proper exit code */
 void rsi_exit_to_host(enum host_call_cmd exit_code)
 {
-	host_cal.imm = exit_code;
-	tftf_smc(&(smc_args) {RSI_HOST_CALL, (u_register_t)&host_cal,
+	struct rsi_host_call *host_call = rsi_get_host_call();
+
+	host_call->imm = exit_code;
+	tftf_smc(&(smc_args) {RSI_HOST_CALL, (u_register_t)host_call,
 		0UL, 0UL, 0UL, 0UL, 0UL, 0UL});
 }
@@ -66,7 +66,9 @@ typedef enum {
 enum host_call_cmd {
 	HOST_CALL_GET_SHARED_BUFF_CMD = 1U,
 	HOST_CALL_EXIT_SUCCESS_CMD,
-	HOST_CALL_EXIT_FAILED_CMD
+	HOST_CALL_EXIT_FAILED_CMD,
+	HOST_CALL_LOG_FLUSH_CMD,
+	HOST_CALL_PING_CMD
 };
 
 struct rsi_realm_config {
@@ -1,10 +1,12 @@
 /*
- * Copyright (c) 2022, Arm Limited. All rights reserved.
+ * Copyright (c) 2022-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
 #include <string.h>
+
+#include <arch_helpers.h>
 #include <host_shared_data.h>
 
 /**
@@ -32,18 +34,27 @@ host_shared_data_t *realm_get_shared_structure(void)
 }
 
 /*
- * Return Host's data at index
+ * Return the shared data of the calling REC, indexed by MPIDR Aff0
+ */
+static rec_shared_data_t *realm_get_rec_data(void)
+{
+	return &guest_shared_data->rec_data[
+		MPIDR_AFF_ID(read_mpidr_el1(), 0) % REALM_MAX_REC_COUNT];
+}
+
+/*
+ * Return Host's data at index for the calling REC
  */
 u_register_t realm_shared_data_get_host_val(uint8_t index)
 {
-	return guest_shared_data->host_param_val[(index >= MAX_DATA_SIZE) ?
+	return realm_get_rec_data()->host_param_val[(index >= MAX_DATA_SIZE) ?
 		(MAX_DATA_SIZE - 1) : index];
 }
 
 /*
- * Get command sent from Host to realm
+ * Get command sent from Host to the calling REC
  */
 uint8_t realm_shared_data_get_realm_cmd(void)
 {
-	return guest_shared_data->realm_cmd;
+	return realm_get_rec_data()->realm_cmd;
 }
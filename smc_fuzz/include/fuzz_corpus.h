@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef FUZZ_CORPUS_H
+#define FUZZ_CORPUS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <utils_def.h>
+
+/*
+ * The fuzzer log lives in the last SMCF_LOG_SIZE bytes of the TFTF NVM, away
+ * from the test results which grow from the start of it. It survives a reset
+ * of the platform, so the sequence that crashed EL3 can be replayed.
+ */
+#define SMCF_LOG_MAGIC		U(0x46434d53)	/* "SMCF" */
+#define SMCF_LOG_VERSION	U(2)
+#define SMCF_LOG_SIZE		U(0x100000)
+#define SMCF_LOG_MAX_SEQS	U(256)
+
+/* Number of signatures tracked by the coverage map */
+#define SMCF_COV_BITS		U(8192)
+
+/* Value of smcf_seq.parent for sequences not derived from another one */
+#define SMCF_NO_PARENT		U(0xffff)
+
+/* States of a logged sequence */
+#define SMCF_SEQ_RUNNING	U(1)	/* Was executing when the log was saved */
+#define SMCF_SEQ_DONE		U(2)	/* All calls returned */
+
+/* How a sequence was derived from its parent */
+#define SMCF_MUT_NONE		U(0)	/* Generated from the seed only */
+#define SMCF_MUT_SPLICE		U(1)	/* Parent prefix, then fresh calls */
+#define SMCF_MUT_ARGS		U(2)	/* Parent calls, some arguments re-drawn */
+
+/* One SMC issued by the fuzzer, 8 bytes */
+struct smcf_call {
+	uint16_t func;		/* Index of the function in the fuzzer table */
+	uint16_t ret;		/* Low 16 bits of the first value returned */
+	uint32_t arg;		/* Seed the arguments of the call derive from */
+};
+
+/* One sequence of calls, generated from a seed and possibly a parent */
+struct smcf_seq {
+	uint32_t seed;
+	uint32_t first;		/* Index of the first call in the log */
+	uint32_t count;		/* Number of calls in the sequence */
+	uint32_t score;		/* Coverage signatures first seen by it */
+	uint16_t parent;	/* Index of the parent sequence */
+	uint16_t prefix;	/* Calls kept from the parent */
+	uint8_t state;
+	uint8_t mutation;
+	uint16_t picks;		/* Times it was picked as a parent */
+	uint16_t cpu;		/* Core position of the CPU that ran it */
+};
+
+struct smcf_log_hdr {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t seq_count;
+	uint32_t call_count;
+	struct smcf_seq seqs[SMCF_LOG_MAX_SEQS];
+};
+
+#define SMCF_LOG_MAX_CALLS						\
+	((SMCF_LOG_SIZE - sizeof(struct smcf_log_hdr)) /		\
+	 sizeof(struct smcf_call))
+
+/*
+ * Start an empty log, or load the log left by a previous run. Return false if
+ * the NVM cannot hold the log or if there is no valid log to load.
+ */
+bool smcf_log_start(void);
+bool smcf_log_load(void);
+
+/* Access to the sequences of the log */
+unsigned int smcf_log_seq_count(void);
+struct smcf_seq *smcf_log_seq(unsigned int idx);
+
+/*
+ * Append a sequence of 'count' calls run by the CPU at core position 'cpu' to
+ * the log, in the RUNNING state. Return NULL if the log is full. The log can be
+ * appended to by several CPUs at once.
+ */
+struct smcf_seq *smcf_log_new_seq(uint32_t seed, uint32_t count,
+				  unsigned int cpu);
+
+/* Save the header of 'seq' to the NVM. */
+bool smcf_log_save_seq(const struct smcf_seq *seq);
+
+/* Write or read 'n' calls of 'seq' starting at call 'idx'. */
+bool smcf_log_write_calls(const struct smcf_seq *seq, unsigned int idx,
+			  const struct smcf_call *calls, unsigned int n);
+bool smcf_log_read_calls(const struct smcf_seq *seq, unsigned int idx,
+			 struct smcf_call *calls, unsigned int n);
+
+/*
+ * Coverage feedback. A call is summarised by a signature made of the function,
+ * its return code and the order of magnitude of the instructions retired in
+ * EL3 while serving it. smcf_cov_add() accounts for the signature of the call
+ * and for the transition from the previous call of the sequence, and returns
+ * the number of signatures that had never been seen before in 'cov'.
+ */
+struct smcf_cov {
+	uint8_t map[SMCF_COV_BITS / 8U];
+	unsigned int seen;
+};
+
+void smcf_cov_reset(struct smcf_cov *cov);
+unsigned int smcf_cov_add(struct smcf_cov *cov, uint32_t *prev, uint16_t func,
+			  uint64_t ret, uint64_t insns);
+
+/* Add the signatures of 'src' to 'dst'. */
+void smcf_cov_merge(struct smcf_cov *dst, const struct smcf_cov *src);
+
+/*
+ * Pick the parent of the next mutated sequence of the CPU at core position
+ * 'cpu', among the sequences it ran, favouring the ones that found new
+ * signatures and have not been picked often. Return SMCF_NO_PARENT if none of
+ * them found any coverage.
+ */
+unsigned int smcf_corpus_pick(uint32_t *rng, unsigned int cpu);
+
+/* xorshift32 step, for the scheduling decisions */
+uint32_t smcf_rand(uint32_t *rng);
+
+#endif /* FUZZ_CORPUS_H */
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef SMCF_ARGS_H
+#define SMCF_ARGS_H
+
+#include <stdint.h>
+
+#include <utils_def.h>
+
+/*
+ * How the arguments of a call are drawn. The mode of a function is set by the
+ * 'arguments' property of its device tree leaf, and is kept in the top bits of
+ * the argument seed of each call so that logged calls replay identically.
+ *
+ * VALID	Values the callee accepts: known function IDs, present MPIDRs,
+ *		values within the documented range.
+ * BOUNDARY	Values around the edges of the valid ones: one past the range,
+ *		zero, all ones, an MPIDR of an absent CPU.
+ * RANDOM	Raw random values.
+ * MIXED	Each argument picks one of the above, half of them valid.
+ */
+#define SMCF_ARGS_VALID		U(0)
+#define SMCF_ARGS_BOUNDARY	U(1)
+#define SMCF_ARGS_RANDOM	U(2)
+#define SMCF_ARGS_MIXED		U(3)
+
+#define SMCF_ARGS_SHIFT		U(30)
+#define SMCF_ARGS_SEED_MASK	((U(1) << SMCF_ARGS_SHIFT) - U(1))
+
+/* Argument seed of a call with the given mode */
+#define SMCF_ARGS(_mode, _seed)						\
+	(((uint32_t)(_mode) << SMCF_ARGS_SHIFT) | ((_seed) & SMCF_ARGS_SEED_MASK))
+
+/* State of the argument generators of one call */
+struct smcf_args {
+	uint32_t rng;
+	unsigned int mode;
+};
+
+void smcf_args_init(struct smcf_args *args, uint32_t arg);
+
+/* Any 32-bit or 64-bit value, whatever the mode */
+uint32_t smcf_arg_u32(struct smcf_args *args);
+uint64_t smcf_arg_u64(struct smcf_args *args);
+
+/* A value of [min, max] */
+uint32_t smcf_arg_range(struct smcf_args *args, uint32_t min, uint32_t max);
+
+/* One of the 'count' values of 'valid', such as function IDs */
+uint32_t smcf_arg_choice(struct smcf_args *args, const uint32_t *valid,
+			 unsigned int count);
+
+/* The MPIDR of one of the CPUs of the platform topology */
+u_register_t smcf_arg_mpidr(struct smcf_args *args);
+
+#endif /* SMCF_ARGS_H */
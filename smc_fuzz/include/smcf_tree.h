@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef SMCF_TREE_H
+#define SMCF_TREE_H
+
+#include <stdint.h>
+
+#include <smcf_args.h>
+#include <utils_def.h>
+
+/*
+ * Functions the fuzzer can call, as X(ID, functionname). The device tree
+ * leaves name them by their 'functionname' and the sequence log by their
+ * position in this list, so new functions must be added at the end to keep
+ * older logs replayable.
+ *
+ * Each function is served by smcf_<functionname>(), defined with the other
+ * functions of its call family in smc_fuzz/src/fuzz_<family>.c. A family is
+ * added by appending its functions here and adding its source file to
+ * tests-smcfuzzing.mk.
+ */
+#define SMCF_FUNC_LIST(X)						\
+	X(SDEI_VERSION, sdei_version)					\
+	X(SDEI_PE_UNMASK, sdei_pe_unmask)				\
+	X(SDEI_PE_MASK, sdei_pe_mask)					\
+	X(SDEI_EVENT_STATUS, sdei_event_status)				\
+	X(SDEI_EVENT_SIGNAL, sdei_event_signal)				\
+	X(SDEI_PRIVATE_RESET, sdei_private_reset)			\
+	X(SDEI_SHARED_RESET, sdei_shared_reset)				\
+	X(PSCI_VERSION, psci_version)					\
+	X(PSCI_FEATURES, psci_features)					\
+	X(PSCI_AFFINITY_INFO, psci_affinity_info)			\
+	X(PSCI_NODE_HW_STATE, psci_node_hw_state)			\
+	X(PSCI_STAT_RESIDENCY, psci_stat_residency)			\
+	X(PSCI_STAT_COUNT, psci_stat_count)				\
+	X(PSCI_MIG_INFO_TYPE, psci_mig_info_type)			\
+	X(TRNG_VERSION, trng_version)					\
+	X(TRNG_FEATURES, trng_features)					\
+	X(TRNG_UUID, trng_uuid)						\
+	X(TRNG_RND, trng_rnd)						\
+	X(FFA_VERSION, ffa_version)					\
+	X(FFA_FEATURES, ffa_features)					\
+	X(FFA_ID_GET, ffa_id_get)					\
+	X(FFA_SPM_ID_GET, ffa_spm_id_get)				\
+	X(FFA_PARTITION_INFO_GET, ffa_partition_info_get)		\
+	X(FFA_RX_RELEASE, ffa_rx_release)				\
+	X(SMCCC_VERSION, smccc_version)					\
+	X(SMCCC_ARCH_FEATURES, smccc_arch_features)			\
+	X(SMCCC_ARCH_SOC_ID, smccc_arch_soc_id)				\
+	X(SMCCC_SERVICE_QUERY, smccc_service_query)			\
+	X(EM_VERSION, em_version)					\
+	X(EM_FEATURES, em_features)					\
+	X(EM_CPU_ERRATUM_FEATURES, em_cpu_erratum_features)
+
+#define SMCF_FUNC_ENUM(_id, _name)	SMCF_##_id,
+
+enum smc_fuzz_func {
+	SMCF_FUNC_LIST(SMCF_FUNC_ENUM)
+	SMCF_FUNC_COUNT
+};
+
+/*
+ * 'arg' is the seed the arguments of the call are drawn from, see smcf_args.h.
+ * The functions return the first value returned by the call.
+ */
+#define SMCF_FUNC_DECL(_id, _name)	int64_t smcf_##_name(uint32_t arg);
+
+SMCF_FUNC_LIST(SMCF_FUNC_DECL)
+
+/* Value of smcf_tree_entry.child for the leaves */
+#define SMCF_TREE_LEAF		U(0xffff)
+
+/*
+ * The bias tree is generated at build time from SMC_FUZZ_DTS into
+ * smcf_bias_tree.h, as constant tables for alias method sampling. To pick one
+ * of the 'count' entries of a node, an entry 'i' is drawn uniformly, then a
+ * value uniformly in [0, total). Entry 'i' is kept if the value is below its
+ * threshold, else its alias is taken, which picks each entry with probability
+ * bias / total in constant time.
+ */
+struct smcf_tree_entry {
+	uint32_t threshold;
+	uint16_t alias;		/* Index of the alias within the node */
+	uint16_t child;		/* Node index of a branch, or SMCF_TREE_LEAF */
+	uint16_t func;		/* Function of a leaf, or SMCF_FUNC_COUNT */
+	uint16_t args;		/* SMCF_ARGS_* mode of the arguments of a leaf */
+};
+
+struct smcf_tree_node {
+	uint32_t total;		/* Sum of the biases of the entries */
+	uint16_t first;		/* Index of the first entry of the node */
+	uint16_t count;		/* Number of entries of the node */
+};
+
+#endif /* SMCF_TREE_H */
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2020, Arm Limited. All rights reserved.
+ * Copyright (c) 2020-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -7,58 +7,95 @@
 #ifndef SMCMALLOC_H
 #define SMCMALLOC_H
 
+#include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include "fifo3d.h"
 
 #define TOTALMEMORYSIZE (0x10000)
-#define BLKSPACEDIV (4)
-#define TOPBITSIZE (20)
-#define MAX_NAME_CHARS 50
 
+/*
+ * The memory image is managed as a two-level segregated fit (TLSF) allocator:
+ * free blocks are kept in lists indexed by the power of two of their size
+ * (first level) and by SMCMALLOC_SL_COUNT linear subdivisions of it (second
+ * level). Bitmaps of the non-empty lists find a large enough free block, and
+ * the block headers merge a freed block with its free neighbours, so both
+ * smcmalloc() and smcfree() run in constant time.
+ *
+ * All returned addresses are aligned on SMCMALLOC_ALIGN bytes. The allocator
+ * does not depend on TFTF. The fuzzer no longer allocates its sequences from
+ * it, so it is only built for the host, by "make smcmalloc_test".
+ */
+#define SMCMALLOC_ALIGN_LOG2	(4)
+#define SMCMALLOC_ALIGN		(1U << SMCMALLOC_ALIGN_LOG2)
+#define SMCMALLOC_SL_LOG2	(3)
+#define SMCMALLOC_SL_COUNT	(1U << SMCMALLOC_SL_LOG2)
+
+/* Blocks smaller than this are all in the first level list 0 */
+#define SMCMALLOC_SMALL_LOG2	(SMCMALLOC_SL_LOG2 + SMCMALLOC_ALIGN_LOG2)
+
+/* First level lists, the largest holds the block of the whole image */
+#define SMCMALLOC_FL_COUNT	(16 - SMCMALLOC_SMALL_LOG2 + 2)
+
+/* Offset standing for no block in the free lists */
+#define SMCMALLOC_NONE		UINT32_MAX
+
+/*
+ * Header of a block. The size includes the header and is a multiple of
+ * SMCMALLOC_ALIGN, so its low bits hold the flags. The free list links are only
+ * meaningful for free blocks and the previous block offset when that block is
+ * free.
+ */
 struct memblk {
-	unsigned int address;
-	unsigned int size;
-	int valid;
+	uint32_t size;
+	uint32_t prev_phys;
+	uint32_t next_free;
+	uint32_t prev_free;
 };
 
 struct memmod {
-	char memory[TOTALMEMORYSIZE];
-	unsigned int nmemblk;
-	unsigned int maxmemblk;
-	unsigned int checkadd;
-	struct memblk *memptr;
-	struct memblk *memptrend;
-	unsigned int mallocdeladd[((TOTALMEMORYSIZE/BLKSPACEDIV)/sizeof(struct memblk))];
-	struct memblk *precblock[((TOTALMEMORYSIZE/BLKSPACEDIV)/sizeof(struct memblk))];
-	struct memblk *trailblock[((TOTALMEMORYSIZE/BLKSPACEDIV)/sizeof(struct memblk))];
-	struct memblk *memblkqueue[((TOTALMEMORYSIZE/BLKSPACEDIV)/sizeof(struct memblk))];
-	unsigned int memallocsize[((TOTALMEMORYSIZE/BLKSPACEDIV)/sizeof(struct memblk))];
-	unsigned int mallocdeladd_valid[((TOTALMEMORYSIZE/BLKSPACEDIV)/sizeof(struct memblk))];
-	unsigned int mallocdeladd_queue[((TOTALMEMORYSIZE/BLKSPACEDIV)/sizeof(struct memblk))];
-	unsigned int checksa[4*((TOTALMEMORYSIZE/BLKSPACEDIV)/sizeof(struct memblk))];
-	unsigned int checkea[4*((TOTALMEMORYSIZE/BLKSPACEDIV)/sizeof(struct memblk))];
-	unsigned int cntdeladd;
-	unsigned int ptrmemblkqueue;
-	unsigned int mallocdeladd_queue_cnt;
-	unsigned int checknumentries;
+	char memory[TOTALMEMORYSIZE] __attribute__((__aligned__(16)));
+	uint32_t fl_map;
+	uint32_t sl_map[SMCMALLOC_FL_COUNT];
+	uint32_t free_head[SMCMALLOC_FL_COUNT][SMCMALLOC_SL_COUNT];
+
+	/* Bytes in the allocated blocks, headers included */
+	unsigned int used;
+	unsigned int peak;
+	unsigned int nalloc;
 	unsigned int memerror;
 };
 
-struct peret {
-	unsigned int tbit;
-	unsigned int pow2;
+/* Usage of a memory image, see smcmalloc_stats() */
+struct smcmalloc_stats {
+	unsigned int used;		/* Bytes allocated, headers included */
+	unsigned int peak;		/* Highest value of used */
+	unsigned int nalloc;		/* Live allocations */
+	unsigned int free;		/* Bytes in free blocks */
+	unsigned int free_blocks;
+	unsigned int largest_free;	/* Largest allocation that can succeed */
+	/* Percentage of the free memory outside the largest free block */
+	unsigned int fragmentation;
 };
 
-void initmem(void);
-struct peret priorityencoder(unsigned int);
-void *smcmalloc(unsigned int, struct memmod*);
-int smcfree(void*, struct memmod *);
+/* Memory errors reported in memmod.memerror */
+#define SMCMALLOC_ERR_NOMEM	(4U)
+#define SMCMALLOC_ERR_BADFREE	(10U)
+
+void initmem(struct memmod *mmod);
+void *smcmalloc(unsigned int rsize, struct memmod *mmod);
+int smcfree(void *faddptr, struct memmod *mmod);
+
+/*
+ * Walks all the blocks, so it is meant for reports and checks rather than
+ * for the allocation paths.
+ */
+void smcmalloc_stats(const struct memmod *mmod, struct smcmalloc_stats *stats);
+
 #ifdef DEBUG_SMC_MALLOC
-void displayblocks(struct memmod *);
-void displaymalloctable(struct memmod *);
+void displayblocks(struct memmod *mmod);
 #endif
 
 #endif /* SMCMALLOC_H */
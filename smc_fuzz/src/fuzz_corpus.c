@@ -0,0 +1,287 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include <cassert.h>
+#include <debug.h>
+#include "fuzz_corpus.h"
+#include <nvm.h>
+#include <platform_def.h>
+#include <spinlock.h>
+
+CASSERT(sizeof(struct smcf_call) == 8U, assert_smcf_call_size);
+CASSERT(sizeof(struct smcf_log_hdr) < SMCF_LOG_SIZE, assert_smcf_log_size);
+CASSERT((SMCF_COV_BITS & (SMCF_COV_BITS - 1U)) == 0U,
+	assert_smcf_cov_bits_power_of_2);
+
+#define SMCF_LOG_OFFSET		(TFTF_NVM_SIZE - SMCF_LOG_SIZE)
+#define SMCF_CALLS_OFFSET	(SMCF_LOG_OFFSET + sizeof(struct smcf_log_hdr))
+
+/* RAM copy of the log header, the calls are only kept in the NVM */
+static struct smcf_log_hdr smcf_log;
+
+/* Serialises the CPUs appending sequences to the log */
+static spinlock_t smcf_log_lock;
+
+static bool smcf_log_save_hdr(void)
+{
+	return tftf_nvm_write(SMCF_LOG_OFFSET, &smcf_log,
+			      offsetof(struct smcf_log_hdr, seqs)) ==
+			      STATUS_SUCCESS;
+}
+
+bool smcf_log_start(void)
+{
+	(void)memset(&smcf_log, 0, sizeof(smcf_log));
+	smcf_log.magic = SMCF_LOG_MAGIC;
+	smcf_log.version = SMCF_LOG_VERSION;
+
+	if (SMCF_LOG_SIZE > TFTF_NVM_SIZE) {
+		ERROR("NVM too small for the SMC fuzz log\n");
+		return false;
+	}
+
+	return smcf_log_save_hdr();
+}
+
+bool smcf_log_load(void)
+{
+	if ((SMCF_LOG_SIZE > TFTF_NVM_SIZE) ||
+	    (tftf_nvm_read(SMCF_LOG_OFFSET, &smcf_log, sizeof(smcf_log)) !=
+	     STATUS_SUCCESS)) {
+		return false;
+	}
+
+	if ((smcf_log.magic != SMCF_LOG_MAGIC) ||
+	    (smcf_log.version != SMCF_LOG_VERSION) ||
+	    (smcf_log.seq_count > SMCF_LOG_MAX_SEQS) ||
+	    (smcf_log.call_count > SMCF_LOG_MAX_CALLS)) {
+		ERROR("No valid SMC fuzz log in NVM\n");
+		return false;
+	}
+
+	return true;
+}
+
+unsigned int smcf_log_seq_count(void)
+{
+	return smcf_log.seq_count;
+}
+
+struct smcf_seq *smcf_log_seq(unsigned int idx)
+{
+	if (idx >= smcf_log.seq_count) {
+		return NULL;
+	}
+
+	return &smcf_log.seqs[idx];
+}
+
+struct smcf_seq *smcf_log_new_seq(uint32_t seed, uint32_t count,
+				  unsigned int cpu)
+{
+	struct smcf_seq *seq;
+
+	spin_lock(&smcf_log_lock);
+
+	if ((smcf_log.seq_count == SMCF_LOG_MAX_SEQS) ||
+	    (count > (SMCF_LOG_MAX_CALLS - smcf_log.call_count))) {
+		spin_unlock(&smcf_log_lock);
+		return NULL;
+	}
+
+	seq = &smcf_log.seqs[smcf_log.seq_count];
+	(void)memset(seq, 0, sizeof(*seq));
+	seq->seed = seed;
+	seq->first = smcf_log.call_count;
+	seq->count = count;
+	seq->parent = SMCF_NO_PARENT;
+	seq->state = SMCF_SEQ_RUNNING;
+	seq->cpu = (uint16_t)cpu;
+
+	smcf_log.seq_count++;
+	smcf_log.call_count += count;
+
+	spin_unlock(&smcf_log_lock);
+
+	return seq;
+}
+
+bool smcf_log_save_seq(const struct smcf_seq *seq)
+{
+	unsigned long long offset = SMCF_LOG_OFFSET +
+		offsetof(struct smcf_log_hdr, seqs) +
+		((unsigned long long)(seq - smcf_log.seqs) * sizeof(*seq));
+
+	bool ret;
+
+	if (tftf_nvm_write(offset, seq, sizeof(*seq)) != STATUS_SUCCESS) {
+		return false;
+	}
+
+	spin_lock(&smcf_log_lock);
+	ret = smcf_log_save_hdr();
+	spin_unlock(&smcf_log_lock);
+
+	return ret;
+}
+
+bool smcf_log_write_calls(const struct smcf_seq *seq, unsigned int idx,
+			  const struct smcf_call *calls, unsigned int n)
+{
+	if ((idx > seq->count) || (n > (seq->count - idx))) {
+		return false;
+	}
+
+	return tftf_nvm_write(SMCF_CALLS_OFFSET +
+			      ((unsigned long long)(seq->first + idx) *
+			       sizeof(*calls)),
+			      calls, n * sizeof(*calls)) == STATUS_SUCCESS;
+}
+
+bool smcf_log_read_calls(const struct smcf_seq *seq, unsigned int idx,
+			 struct smcf_call *calls, unsigned int n)
+{
+	if ((idx > seq->count) || (n > (seq->count - idx))) {
+		return false;
+	}
+
+	return tftf_nvm_read(SMCF_CALLS_OFFSET +
+			     ((unsigned long long)(seq->first + idx) *
+			      sizeof(*calls)),
+			     calls, n * sizeof(*calls)) == STATUS_SUCCESS;
+}
+
+void smcf_cov_reset(struct smcf_cov *cov)
+{
+	(void)memset(cov, 0, sizeof(*cov));
+}
+
+/* Final mixer of MurmurHash3, spreads the signatures over the map */
+static uint32_t smcf_hash(uint32_t h)
+{
+	h ^= h >> 16;
+	h *= 0x85ebca6bU;
+	h ^= h >> 13;
+	h *= 0xc2b2ae35U;
+	h ^= h >> 16;
+
+	return h;
+}
+
+static unsigned int smcf_cov_set(struct smcf_cov *cov, uint32_t sig)
+{
+	uint32_t bit = sig & (SMCF_COV_BITS - 1U);
+	uint8_t mask = (uint8_t)(1U << (bit & 7U));
+
+	if ((cov->map[bit / 8U] & mask) != 0U) {
+		return 0U;
+	}
+
+	cov->map[bit / 8U] |= mask;
+	cov->seen++;
+
+	return 1U;
+}
+
+unsigned int smcf_cov_add(struct smcf_cov *cov, uint32_t *prev, uint16_t func,
+			  uint64_t ret, uint64_t insns)
+{
+	unsigned int magnitude = 0U;
+	uint32_t sig;
+	unsigned int found;
+
+	while (insns != 0ULL) {
+		magnitude++;
+		insns >>= 1;
+	}
+
+	sig = smcf_hash(((uint32_t)func << 16) ^ (uint32_t)ret ^
+			((uint32_t)(ret >> 32) * 31U) ^ (magnitude << 26));
+
+	found = smcf_cov_set(cov, sig);
+	found += smcf_cov_set(cov, smcf_hash((*prev * 31U) ^ sig));
+	*prev = sig;
+
+	return found;
+}
+
+void smcf_cov_merge(struct smcf_cov *dst, const struct smcf_cov *src)
+{
+	uint8_t added;
+
+	for (unsigned int i = 0U; i < sizeof(dst->map); i++) {
+		added = src->map[i] & (uint8_t)~dst->map[i];
+		dst->map[i] |= added;
+
+		while (added != 0U) {
+			dst->seen++;
+			added &= added - 1U;
+		}
+	}
+}
+
+uint32_t smcf_rand(uint32_t *rng)
+{
+	uint32_t x = *rng;
+
+	/* Zero is a fixed point of xorshift */
+	if (x == 0U) {
+		x = 0x9e3779b9U;
+	}
+
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*rng = x;
+
+	return x;
+}
+
+/* Energy of a sequence of 'cpu', halved each time it is picked */
+static uint32_t smcf_energy(const struct smcf_seq *seq, unsigned int cpu)
+{
+	if ((seq->cpu != cpu) || (seq->state != SMCF_SEQ_DONE) ||
+	    (seq->score == 0U)) {
+		return 0U;
+	}
+
+	return (seq->score * 16U) >> MIN((uint32_t)seq->picks, 4U);
+}
+
+unsigned int smcf_corpus_pick(uint32_t *rng, unsigned int cpu)
+{
+	unsigned int seq_count = smcf_log.seq_count;
+	uint32_t total = 0U;
+	uint32_t target;
+	unsigned int i;
+
+	/*
+	 * Only the sequences of 'cpu' are considered, which no other CPU
+	 * updates, so the log does not need to be locked.
+	 */
+	for (i = 0U; i < seq_count; i++) {
+		total += smcf_energy(&smcf_log.seqs[i], cpu);
+	}
+
+	if (total == 0U) {
+		return SMCF_NO_PARENT;
+	}
+
+	target = smcf_rand(rng) % total;
+	for (i = 0U; i < seq_count; i++) {
+		if (target < smcf_energy(&smcf_log.seqs[i], cpu)) {
+			break;
+		}
+		target -= smcf_energy(&smcf_log.seqs[i], cpu);
+	}
+
+	smcf_log.seqs[i].picks++;
+
+	return i;
+}
@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <errata_abi.h>
+#include <smcf_args.h>
+#include <smcf_tree.h>
+#include <tftf_lib.h>
+
+/* Arm erratum numbers have up to seven digits */
+#define SMCF_EM_ERRATUM_MAX	U(9999999)
+
+static const uint32_t smcf_em_fids[] = {
+	EM_VERSION,
+	EM_FEATURES,
+	EM_CPU_ERRATUM_FEATURES,
+};
+
+int64_t smcf_em_version(uint32_t arg)
+{
+	return tftf_em_abi_version();
+}
+
+int64_t smcf_em_features(uint32_t arg)
+{
+	struct smcf_args args;
+	smc_args smc = { EM_FEATURES };
+
+	smcf_args_init(&args, arg);
+	smc.arg1 = smcf_arg_choice(&args, smcf_em_fids,
+				   ARRAY_SIZE(smcf_em_fids));
+
+	return (int64_t)tftf_smc(&smc).ret0;
+}
+
+int64_t smcf_em_cpu_erratum_features(uint32_t arg)
+{
+	struct smcf_args args;
+	uint32_t erratum;
+
+	smcf_args_init(&args, arg);
+	erratum = smcf_arg_range(&args, 0U, SMCF_EM_ERRATUM_MAX);
+
+	/* The forward flag asks about the lower EL (0) or the higher EL (1) */
+	return (int64_t)tftf_em_abi_cpu_feature_implemented(erratum,
+					smcf_arg_range(&args, 0U, 1U)).ret0;
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <ffa_helpers.h>
+#include <ffa_svc.h>
+#include <smcf_args.h>
+#include <smcf_tree.h>
+
+static const uint32_t smcf_ffa_versions[] = {
+	MAKE_FFA_VERSION(1, 0),
+	MAKE_FFA_VERSION(1, 1),
+	FFA_VERSION_COMPILED,
+};
+
+/* The null UUID, which asks for all the partitions */
+static const uint32_t smcf_ffa_uuid_words[] = { 0U };
+
+/* Error code of a failed call, else the function ID it returned */
+static int64_t smcf_ffa_ret(struct ffa_value ret)
+{
+	if (ffa_func_id(ret) == FFA_ERROR) {
+		return ffa_error_code(ret);
+	}
+
+	return ffa_func_id(ret);
+}
+
+int64_t smcf_ffa_version(uint32_t arg)
+{
+	struct smcf_args args;
+
+	smcf_args_init(&args, arg);
+
+	return (int64_t)ffa_version(smcf_arg_choice(&args, smcf_ffa_versions,
+				    ARRAY_SIZE(smcf_ffa_versions))).fid;
+}
+
+int64_t smcf_ffa_features(uint32_t arg)
+{
+	struct smcf_args args;
+
+	smcf_args_init(&args, arg);
+
+	return smcf_ffa_ret(ffa_features(smcf_arg_range(&args,
+			    FFA_FID(SMC_32, FFA_FNUM_MIN_VALUE),
+			    FFA_FID(SMC_32, FFA_FNUM_MAX_VALUE))));
+}
+
+int64_t smcf_ffa_id_get(uint32_t arg)
+{
+	return smcf_ffa_ret(ffa_id_get());
+}
+
+int64_t smcf_ffa_spm_id_get(uint32_t arg)
+{
+	return smcf_ffa_ret(ffa_spm_id_get());
+}
+
+int64_t smcf_ffa_partition_info_get(uint32_t arg)
+{
+	struct smcf_args args;
+	struct ffa_value ret;
+
+	smcf_args_init(&args, arg);
+
+	const struct ffa_uuid uuid = { {
+		smcf_arg_choice(&args, smcf_ffa_uuid_words, 1U),
+		smcf_arg_choice(&args, smcf_ffa_uuid_words, 1U),
+		smcf_arg_choice(&args, smcf_ffa_uuid_words, 1U),
+		smcf_arg_choice(&args, smcf_ffa_uuid_words, 1U),
+	} };
+
+	ret = ffa_partition_info_get(uuid);
+
+	/* Give the RX buffer back, so the next calls can use it */
+	if (ffa_func_id(ret) != FFA_ERROR) {
+		(void)ffa_rx_release();
+	}
+
+	return smcf_ffa_ret(ret);
+}
+
+int64_t smcf_ffa_rx_release(uint32_t arg)
+{
+	return smcf_ffa_ret(ffa_rx_release());
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <platform_def.h>
+#include <psci.h>
+#include <smcf_args.h>
+#include <smcf_tree.h>
+#include <tftf_lib.h>
+
+/*
+ * Only the PSCI functions that leave the calling CPU and the system running are
+ * fuzzed. CPU_ON, CPU_OFF, CPU_SUSPEND and the system wide calls would take the
+ * CPUs away from the fuzzer.
+ *
+ * PSCI_FEATURES only reports whether a function is implemented, so it is
+ * queried about every PSCI function, including those never called.
+ */
+static const uint32_t smcf_psci_features_queries[] = {
+	SMC_PSCI_VERSION,
+	SMC_PSCI_CPU_SUSPEND_AARCH64,
+	SMC_PSCI_CPU_OFF,
+	SMC_PSCI_CPU_ON_AARCH64,
+	SMC_PSCI_AFFINITY_INFO_AARCH64,
+	SMC_PSCI_MIG_INFO_TYPE,
+	SMC_PSCI_SYSTEM_OFF,
+	SMC_PSCI_SYSTEM_RESET,
+	SMC_PSCI_FEATURES,
+	SMC_PSCI_CPU_HW_STATE64,
+	SMC_PSCI_SYSTEM_SUSPEND64,
+	SMC_PSCI_STAT_RESIDENCY64,
+	SMC_PSCI_STAT_COUNT64,
+	SMC_PSCI_RESET2_AARCH64,
+	SMC_PSCI_MEM_PROTECT,
+};
+
+/*
+ * Power state of a local state of the platform when the power level drawn is
+ * valid, else a random one.
+ */
+static uint32_t smcf_psci_power_state(struct smcf_args *args)
+{
+	uint32_t level = smcf_arg_range(args, MPIDR_AFFLVL0, PLAT_MAX_PWR_LEVEL);
+
+	if (level > PLAT_MAX_PWR_LEVEL) {
+		return smcf_arg_u32(args);
+	}
+
+	return tftf_make_psci_pstate(level, smcf_arg_u32(args) & 1U, 0U);
+}
+
+int64_t smcf_psci_version(uint32_t arg)
+{
+	return tftf_get_psci_version();
+}
+
+int64_t smcf_psci_features(uint32_t arg)
+{
+	struct smcf_args args;
+
+	smcf_args_init(&args, arg);
+
+	return tftf_get_psci_feature_info(smcf_arg_choice(&args,
+				smcf_psci_features_queries,
+				ARRAY_SIZE(smcf_psci_features_queries)));
+}
+
+int64_t smcf_psci_affinity_info(uint32_t arg)
+{
+	struct smcf_args args;
+	u_register_t mpid;
+
+	smcf_args_init(&args, arg);
+	mpid = smcf_arg_mpidr(&args);
+
+	return tftf_psci_affinity_info(mpid, smcf_arg_range(&args,
+				       MPIDR_AFFLVL0, PLAT_MAX_PWR_LEVEL));
+}
+
+int64_t smcf_psci_node_hw_state(uint32_t arg)
+{
+	struct smcf_args args;
+	u_register_t mpid;
+
+	smcf_args_init(&args, arg);
+	mpid = smcf_arg_mpidr(&args);
+
+	return tftf_psci_node_hw_state(mpid, smcf_arg_range(&args,
+				       MPIDR_AFFLVL0, PLAT_MAX_PWR_LEVEL));
+}
+
+int64_t smcf_psci_stat_residency(uint32_t arg)
+{
+	struct smcf_args args;
+	u_register_t mpid;
+
+	smcf_args_init(&args, arg);
+	mpid = smcf_arg_mpidr(&args);
+
+	return tftf_psci_stat_residency(mpid, smcf_psci_power_state(&args));
+}
+
+int64_t smcf_psci_stat_count(uint32_t arg)
+{
+	struct smcf_args args;
+	u_register_t mpid;
+
+	smcf_args_init(&args, arg);
+	mpid = smcf_arg_mpidr(&args);
+
+	return tftf_psci_stat_count(mpid, smcf_psci_power_state(&args));
+}
+
+int64_t smcf_psci_mig_info_type(uint32_t arg)
+{
+	smc_args args = { SMC_PSCI_MIG_INFO_TYPE };
+
+	return (int64_t)tftf_smc(&args).ret0;
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <sdei.h>
+#include <smcf_args.h>
+#include <smcf_tree.h>
+#include <tftf_lib.h>
+
+/* SDEI event 0 is the only event signalled by software */
+static const uint32_t smcf_sdei_events[] = { 0U };
+
+int64_t smcf_sdei_version(uint32_t arg)
+{
+	int64_t ret = sdei_version();
+
+	if (ret != MAKE_SDEI_VERSION(1, 0, 0)) {
+		tftf_testcase_printf("Unexpected SDEI version: 0x%llx\n", ret);
+	}
+
+	return ret;
+}
+
+int64_t smcf_sdei_pe_unmask(uint32_t arg)
+{
+	int64_t ret = sdei_pe_unmask();
+
+	if (ret < 0) {
+		tftf_testcase_printf("SDEI pe unmask failed: 0x%llx\n", ret);
+	}
+
+	return ret;
+}
+
+int64_t smcf_sdei_pe_mask(uint32_t arg)
+{
+	int64_t ret = sdei_pe_mask();
+
+	if (ret < 0) {
+		tftf_testcase_printf("SDEI pe mask failed: 0x%llx\n", ret);
+	}
+
+	return ret;
+}
+
+int64_t smcf_sdei_event_status(uint32_t arg)
+{
+	struct smcf_args args;
+
+	smcf_args_init(&args, arg);
+
+	return sdei_event_status((int32_t)smcf_arg_choice(&args,
+				 smcf_sdei_events, ARRAY_SIZE(smcf_sdei_events)));
+}
+
+int64_t smcf_sdei_event_signal(uint32_t arg)
+{
+	struct smcf_args args;
+
+	smcf_args_init(&args, arg);
+
+	return sdei_event_signal(smcf_arg_mpidr(&args));
+}
+
+int64_t smcf_sdei_private_reset(uint32_t arg)
+{
+	int64_t ret = sdei_private_reset();
+
+	if (ret < 0) {
+		tftf_testcase_printf("SDEI private reset failed: 0x%llx\n", ret);
+	}
+
+	return ret;
+}
+
+int64_t smcf_sdei_shared_reset(uint32_t arg)
+{
+	int64_t ret = sdei_shared_reset();
+
+	if (ret < 0) {
+		tftf_testcase_printf("SDEI shared reset failed: 0x%llx\n", ret);
+	}
+
+	return ret;
+}
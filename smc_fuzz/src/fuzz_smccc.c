@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <arm_arch_svc.h>
+#include <smccc.h>
+#include <smcf_args.h>
+#include <smcf_tree.h>
+#include <tftf_lib.h>
+
+/* General service queries every owning entity implements, SMCCC 6.2 */
+#define SMCF_SMCCC_CALL_COUNT	U(0xff00)
+#define SMCF_SMCCC_CALL_UID	U(0xff01)
+#define SMCF_SMCCC_REVISION	U(0xff03)
+
+static const uint32_t smcf_smccc_arch_fids[] = {
+	SMCCC_VERSION,
+	SMCCC_ARCH_FEATURES,
+	SMCCC_ARCH_SOC_ID,
+	SMCCC_ARCH_WORKAROUND_1,
+	SMCCC_ARCH_WORKAROUND_2,
+	SMCCC_ARCH_WORKAROUND_3,
+	SMCCC_ARCH_WORKAROUND_4,
+};
+
+static const uint32_t smcf_smccc_queries[] = {
+	SMCF_SMCCC_CALL_COUNT,
+	SMCF_SMCCC_CALL_UID,
+	SMCF_SMCCC_REVISION,
+};
+
+int64_t smcf_smccc_version(uint32_t arg)
+{
+	smc_args smc = { SMCCC_VERSION };
+
+	return (int64_t)tftf_smc(&smc).ret0;
+}
+
+int64_t smcf_smccc_arch_features(uint32_t arg)
+{
+	struct smcf_args args;
+	smc_args smc = { SMCCC_ARCH_FEATURES };
+
+	smcf_args_init(&args, arg);
+	smc.arg1 = smcf_arg_choice(&args, smcf_smccc_arch_fids,
+				   ARRAY_SIZE(smcf_smccc_arch_fids));
+
+	return (int64_t)tftf_smc(&smc).ret0;
+}
+
+int64_t smcf_smccc_arch_soc_id(uint32_t arg)
+{
+	struct smcf_args args;
+	smc_args smc = { SMCCC_ARCH_SOC_ID };
+
+	smcf_args_init(&args, arg);
+	smc.arg1 = smcf_arg_range(&args, SMC_GET_SOC_VERSION,
+				  SMC_GET_SOC_REVISION);
+
+	return (int64_t)tftf_smc(&smc).ret0;
+}
+
+/*
+ * Query the call count, UID or revision of an owning entity, including the
+ * SiP, OEM, vendor and trusted OS services that no other family covers.
+ */
+int64_t smcf_smccc_service_query(uint32_t arg)
+{
+	struct smcf_args args;
+	uint32_t oen, query;
+	smc_args smc = { 0 };
+
+	smcf_args_init(&args, arg);
+	oen = smcf_arg_range(&args, OEN_ARM_START, OEN_LIMIT - 1U) &
+	      FUNCID_OEN_MASK;
+	query = smcf_arg_choice(&args, smcf_smccc_queries,
+				ARRAY_SIZE(smcf_smccc_queries)) & U(0xffff);
+
+	smc.fid = ((uint32_t)SMC_TYPE_FAST << FUNCID_TYPE_SHIFT) |
+		  ((uint32_t)SMC_32 << FUNCID_CC_SHIFT) |
+		  (oen << FUNCID_OEN_SHIFT) | query;
+
+	return (int64_t)tftf_smc(&smc).ret0;
+}
@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <smcf_args.h>
+#include <smcf_tree.h>
+#include <tftf_lib.h>
+#include <trng.h>
+
+static const uint32_t smcf_trng_fids[] = {
+	SMC_TRNG_VERSION,
+	SMC_TRNG_FEATURES,
+	SMC_TRNG_UUID,
+	SMC_TRNG_RND,
+};
+
+int64_t smcf_trng_version(uint32_t arg)
+{
+	return tftf_trng_version();
+}
+
+int64_t smcf_trng_features(uint32_t arg)
+{
+	struct smcf_args args;
+	smc_args smc = { SMC_TRNG_FEATURES };
+
+	smcf_args_init(&args, arg);
+	smc.arg1 = smcf_arg_choice(&args, smcf_trng_fids,
+				   ARRAY_SIZE(smcf_trng_fids));
+
+	return (int64_t)tftf_smc(&smc).ret0;
+}
+
+int64_t smcf_trng_uuid(uint32_t arg)
+{
+	return (int64_t)tftf_trng_uuid().ret0;
+}
+
+int64_t smcf_trng_rnd(uint32_t arg)
+{
+	struct smcf_args args;
+
+	smcf_args_init(&args, arg);
+
+	return (int64_t)tftf_trng_rnd(smcf_arg_range(&args, 1U,
+					TRNG_MAX_BITS)).ret0;
+}
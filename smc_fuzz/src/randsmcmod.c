@@ -1,572 +1,430 @@
 /*
- * Copyright (c) 2020, Arm Limited. All rights reserved.
+ * Copyright (c) 2020-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
+#include <string.h>
+
 #include <arch_helpers.h>
+#include <cassert.h>
 #include <debug.h>
 #include <drivers/arm/private_timer.h>
 #include <events.h>
-#include "fifo3d.h"
-#include <libfdt.h>
+#include "fuzz_corpus.h"
+#include <perf_helpers.h>
+#include <pmu.h>
 
 #include <power_management.h>
-#include <sdei.h>
+#include <smcf_bias_tree.h>
 #include <tftf_lib.h>
 #include <timer.h>
 
 #include <plat_topology.h>
 #include <platform.h>
 
-extern char _binary___dtb_start[];
-
-struct memmod tmod __aligned(65536) __section("smcfuzz");
-
-/*
- * switch to use either standard C malloc or custom SMC malloc
- */
-
-#define FIRST_NODE_DEVTREE_OFFSET (8)
+/* Number of sequences each fuzzing CPU runs */
+#define SMC_FUZZ_RUNS		(SMC_FUZZ_INSTANCE_COUNT + SMC_FUZZ_MUTATIONS)
 
-#ifdef SMC_FUZZ_TMALLOC
-#define GENMALLOC(x)	malloc((x))
-#define GENFREE(x)	free((x))
+/* Number of CPUs fuzzing at once */
+#if SMC_FUZZ_MULTI_CPU
+#define SMC_FUZZ_CPUS		PLATFORM_CORE_COUNT
 #else
-#define GENMALLOC(x)	smcmalloc((x), mmod)
-#define GENFREE(x)	smcfree((x), mmod)
+#define SMC_FUZZ_CPUS		1U
 #endif
 
-/*
- * Device tree parameter struct
- */
-
-struct fdt_header_sf {
-	unsigned int magic;
-	unsigned int totalsize;
-	unsigned int off_dt_struct;
-	unsigned int off_dt_strings;
-	unsigned int off_mem_rsvmap;
-	unsigned int version;
-	unsigned int last_comp_version;
-	unsigned int boot_cpuid_phys;
-	unsigned int size_dt_strings;
-	unsigned int size_dt_struct;
-};
+CASSERT((SMC_FUZZ_RUNS * SMC_FUZZ_CPUS) <= SMCF_LOG_MAX_SEQS,
+	assert_smc_fuzz_log_seqs);
+CASSERT((SMC_FUZZ_CALLS_PER_INSTANCE * SMC_FUZZ_RUNS * SMC_FUZZ_CPUS) <=
+	SMCF_LOG_MAX_CALLS, assert_smc_fuzz_log_calls);
 
 /*
- * Structure to read the fields of the device tree
+ * State of the fuzzer on each CPU, so that the CPUs can fuzz at once without
+ * sharing anything but the log.
  */
-struct propval {
-	unsigned int len;
-	unsigned int nameoff;
+static struct smc_fuzz_cpu {
+	/* Calls of the sequence being executed */
+	struct smcf_call calls[SMC_FUZZ_CALLS_PER_INSTANCE];
+	struct smcf_cov cov;
+	struct smcf_seq *seqs[SMC_FUZZ_RUNS];
+	test_result_t results[SMC_FUZZ_RUNS];
+	unsigned int runs;
+
+	/* Profile of the instructions retired in EL3 by each call */
+	bool pmu_present;
+	struct pmu_profile pmu;
+
+	/* Calls whose return value differed from the log when replayed */
+	unsigned int diverged;
+} smc_fuzz_cpus[PLATFORM_CORE_COUNT];
+
+/* Set when the log could not be written to the NVM */
+static bool smcf_log_failed;
+
+/* Handlers of the call families, indexed by function id */
+typedef int64_t (*smcf_func_t)(uint32_t arg);
+
+#define SMCF_FUNC_ENTRY(_id, _name)	[SMCF_##_id] = { #_name, smcf_##_name },
+
+static const struct {
+	const char *name;
+	smcf_func_t fn;
+} smc_fuzz_funcs[SMCF_FUNC_COUNT] = {
+	SMCF_FUNC_LIST(SMCF_FUNC_ENTRY)
 };
 
 /*
- * Converting from big endian to little endian to read values
- * of device tree
+ * Running SMC call from its function id. Functions of the device tree unknown
+ * to the fuzzer have the id SMCF_FUNC_COUNT and are skipped.
  */
-unsigned int lendconv(unsigned int val)
+int64_t runtestfunction(uint16_t func, uint32_t arg)
 {
-	unsigned int res;
+	int64_t ret;
 
-	res = val << 24;
-	res |= ((val << 8) & 0xFF0000U);
-	res |= ((val >> 8) & 0xFF00U);
-	res |= ((val >> 24) & 0xFFU);
-	return res;
+	if (func >= SMCF_FUNC_COUNT) {
+		return 0;
+	}
+
+	ret = smc_fuzz_funcs[func].fn(arg);
+	VERBOSE("running %s\n", smc_fuzz_funcs[func].name);
+
+	return ret;
 }
 
 /*
- * Function to read strings from device tree
+ * The instructions retired in EL3 while serving a call are used as a cheap
+ * coverage signal. They read 0 when EL3 prohibits counting in the secure state.
  */
-void pullstringdt(void **dtb,
-		  void *dtb_beg,
-		  unsigned int offset,
-		  char *cset)
+static void smc_fuzz_pmu_init(struct smc_fuzz_cpu *cpu)
 {
-	int fistr;
-	int cntchr;
-	char rval;
+	uint16_t event = PMU_EV_INST_RETIRED;
 
-	if (offset != 0U) {
-		*dtb = dtb_beg + offset;
+	cpu->pmu_present = pmu_is_supported();
+	if (cpu->pmu_present) {
+		pmu_profile_init(&cpu->pmu, &event, 1U, PMU_COUNT_EL3);
 	}
-	fistr = 0;
-
-	cntchr = 0;
-	while (fistr == 0) {
-		rval = *((char *)*dtb);
-		*dtb += sizeof(char);
-		cset[cntchr] = rval;
-		if (cset[cntchr] == 0) {
-			fistr = 1;
-		}
-		cntchr++;
+}
+
+static void smc_fuzz_pmu_begin(struct smc_fuzz_cpu *cpu)
+{
+	if (cpu->pmu_present) {
+		pmu_profile_start(&cpu->pmu);
 	}
+}
 
-	if ((cntchr % 4) != 0) {
-		for (unsigned int i = 0U; (int)i < (4 - (cntchr % 4)); i++) {
-			*dtb += sizeof(char);
-		}
+static uint32_t smc_fuzz_pmu_end(struct smc_fuzz_cpu *cpu)
+{
+	if (!cpu->pmu_present) {
+		return 0U;
 	}
+
+	pmu_profile_stop(&cpu->pmu);
+
+	return (uint32_t)cpu->pmu.last[0];
 }
 
-/*
- * Structure for Node information extracted from device tree
- */
-struct rand_smc_node {
-	int *biases;				 // Biases of the individual nodes
-	int *biasarray;				 // Array of biases across all nodes
-	char **snames;				 // String that is unique to the SMC call called in test
-	struct rand_smc_node *treenodes;	 // Selection of nodes that are farther down in the tree
-						// that reference further rand_smc_node objects
-	int *norcall;				// Specifies whether a particular node is a leaf node or tree node
-	int entries;				// Number of nodes in object
-	int biasent;				// Number that gives the total number of entries in biasarray
-						// based on all biases of the nodes
-	char **nname;				// Array of node names
-};
+static void smc_fuzz_log_error(void)
+{
+	if (!smcf_log_failed) {
+		WARN("Cannot write the SMC fuzz log to NVM\n");
+		smcf_log_failed = true;
+	}
+}
 
+static unsigned int smc_fuzz_core_pos(void)
+{
+	return platform_get_core_pos(read_mpidr_el1() & MPID_MASK);
+}
 
 /*
- * Create bias tree from given device tree description
+ * Select a function by walking the bias tree generated from the device tree.
+ *
+ * Starting from the root node, one of the entries of the node is selected
+ * according to the entry biases, with the alias method described in
+ * smcf_tree.h. If the entry is a leaf, the walk ends with its function. If it
+ * is a tree node, the selection starts again from that node until an eventual
+ * leaf is found, which is returned.
  */
-
-struct rand_smc_node *createsmctree(int *casz,
-				    struct memmod *mmod)
+static const struct smcf_tree_entry *smc_fuzz_pick(uint32_t *rng)
 {
-	void *dtb;
-	void *dtb_pn;
-	void *dtb_beg;
-	struct fdt_header fhd;
-	unsigned int rval;
-	struct propval pv;
-	char cset[MAX_NAME_CHARS];
-	char nodename[MAX_NAME_CHARS];
-	int dtdone;
-	struct fifo3d f3d;
-	int leafnode = 0;
-	unsigned int fnode = 0U;
-	unsigned int bias_count = 0U;
-	unsigned int bintnode = 0U;
-	unsigned int treenodetrack = 0U;
-	struct fdt_header *fhdptr;
-	struct rand_smc_node *ndarray = NULL;
-	int cntndarray;
-	struct rand_smc_node nrnode;
-	struct rand_smc_node *tndarray;
-
-	f3d.col = 0;
-	f3d.curr_col = 0;
+	const struct smcf_tree_node *node = &smcf_tree_nodes[SMCF_TREE_ROOT];
+	const struct smcf_tree_entry *entry;
+	unsigned int i;
 
-	/*
-	 * Read device tree header and check for valid type
-	 */
+	while (true) {
+		i = smcf_rand(rng) % node->count;
+		entry = &smcf_tree_entries[node->first + i];
 
-	fhdptr = (struct fdt_header *)_binary___dtb_start;
+		if ((smcf_rand(rng) % node->total) >= entry->threshold) {
+			entry = &smcf_tree_entries[node->first + entry->alias];
+		}
+
+		if (entry->child == SMCF_TREE_LEAF) {
+			return entry;
+		}
 
-	if (fdt_check_header((void *)fhdptr) != 0) {
-		printf("ERROR, not device tree compliant\n");
+		node = &smcf_tree_nodes[entry->child];
 	}
-	fhd = *fhdptr;
-	cntndarray = 0;
-	nrnode.entries = 0;
+}
 
-	/*
-	 * Create pointers to device tree data
-	 */
-	dtb = _binary___dtb_start;
-	dtb_pn = _binary___dtb_start;
+/*
+ * Fill the calls of 'cpu' with the calls of 'seq', from its parent and its
+ * seed. The random streams are private to the sequence, so that the CPUs fuzzing
+ * at once draw independent calls.
+ */
+static void smc_fuzzing_generate(struct smc_fuzz_cpu *cpu,
+				 struct smcf_seq *seq)
+{
+	uint32_t rng = seq->seed;
+	uint32_t argrng = seq->seed ^ 0x5bd1e995U;
+	struct smcf_seq *parent = smcf_log_seq(seq->parent);
+	const struct smcf_tree_entry *leaf;
+	uint32_t mode;
+	unsigned int i;
 
-	dtb_beg = dtb;
-	fhd = *((struct fdt_header *)dtb);
-	dtb += (fdt32_to_cpu(fhd.off_dt_struct) + FIRST_NODE_DEVTREE_OFFSET);
-	dtdone = 0;
+	/* Calls inherited from the parent sequence */
+	if ((parent != NULL) &&
+	    !smcf_log_read_calls(parent, 0U, cpu->calls, seq->prefix)) {
+		smc_fuzz_log_error();
+		seq->parent = SMCF_NO_PARENT;
+		seq->prefix = 0U;
+		seq->mutation = SMCF_MUT_NONE;
+	}
 
-	/*
-	 * Reading device tree file
-	 */
-	while (dtdone == 0) {
-		rval = *((unsigned int *)dtb);
-		dtb += sizeof(unsigned int);
-
-		/*
-		 * Reading node name from device tree and pushing it into the raw data
-		 * Table of possible values reading from device tree binary file:
-		 * 1	New node found within current tree, possible leaf or tree variant
-		 * 2 	Node termination of current hiearchy.
-		 *     Could indicate end of tree or preparation for another branch
-		 * 3 	Leaf node indication where a bias with a function name should be
-		 *     found for the current node
-		 * 9  	End of device tree file and we end the read of the bias tree
-		 */
-		if (fdt32_to_cpu(rval) == 1) {
-			pullstringdt(&dtb, dtb_beg, 0U, cset);
-			push_3dfifo_col(&f3d, cset, mmod);
-			strlcpy(nodename, cset, MAX_NAME_CHARS);
-
-			/*
-			 * Error checking to make sure that bias is specified
-			 */
-			if (fnode == 0U) {
-				fnode = 1U;
-			} else {
-				if (!((fnode == 1U) && (bias_count == 1U))) {
-					printf("ERROR: Did not find bias or multiple bias ");
-					printf("designations before %s %u %u\n",
-					cset, fnode, bias_count);
-				}
-				bias_count = 0U;
-			}
-		}
+	for (i = seq->prefix; i < seq->count; i++) {
+		leaf = smc_fuzz_pick(&rng);
+		cpu->calls[i].func = leaf->func;
+		cpu->calls[i].arg = SMCF_ARGS(leaf->args, smcf_rand(&argrng));
+	}
 
-		/*
-		 * Reading node parameters of bias and function name
-		 */
-		if (fdt32_to_cpu(rval) == 3) {
-			pv = *((struct propval *)dtb);
-			dtb += sizeof(struct propval);
-			pullstringdt(&dtb_pn, dtb_beg,
-				     (fdt32_to_cpu(fhd.off_dt_strings) +
-				      fdt32_to_cpu(pv.nameoff)), cset);
-			if (strcmp(cset, "bias") == 0) {
-				rval = *((unsigned int *)dtb);
-				dtb += sizeof(unsigned int);
-				push_3dfifo_bias(&f3d, fdt32_to_cpu(rval));
-				bias_count++;
-				if (bintnode == 1U) {
-					fnode = 0U;
-					bintnode = 0U;
-					bias_count = 0U;
-				}
-			}
-			if (strcmp(cset, "functionname") == 0) {
-				pullstringdt(&dtb, dtb_beg, 0, cset);
-				push_3dfifo_fname(&f3d, cset);
-				leafnode = 1;
-				if (bias_count == 0U) {
-					bintnode = 1U;
-					fnode = 1U;
-				} else {
-					bias_count = 0U;
-					fnode = 0U;
-				}
+	/* Keep the calls of the parent but draw some of their arguments again */
+	if (seq->mutation == SMCF_MUT_ARGS) {
+		for (i = 0U; i < seq->count; i++) {
+			if ((smcf_rand(&rng) % 4U) == 0U) {
+				mode = cpu->calls[i].arg >> SMCF_ARGS_SHIFT;
+				cpu->calls[i].arg = SMCF_ARGS(mode,
+							smcf_rand(&argrng));
 			}
 		}
+	}
 
-		/*
-		 * Node termination and evaluate whether the bias tree requires addition.
-		 * The non tree nodes are added.
-		 */
-		if (fdt32_to_cpu(rval) == 2) {
-			if ((fnode > 0U) || (bias_count > 0U)) {
-				printf("ERROR: early node termination... ");
-				printf("no bias or functionname field for leaf node, near %s %u\n",
-				nodename, fnode);
-			}
-			f3d.col--;
-			if (leafnode == 1) {
-				leafnode = 0;
-			} else {
-				/*
-				 * Create bias tree in memory from raw data
-				 */
-				tndarray =
-					GENMALLOC((cntndarray + 1) *
-						   sizeof(struct rand_smc_node));
-				unsigned int treenodetrackmal = 0;
-				for (unsigned int j = 0U; (int)j < cntndarray; j++) {
-					tndarray[j].biases = GENMALLOC(ndarray[j].entries * sizeof(int));
-					tndarray[j].snames = GENMALLOC(ndarray[j].entries * sizeof(char *));
-					tndarray[j].norcall = GENMALLOC(ndarray[j].entries * sizeof(int));
-					tndarray[j].nname = GENMALLOC(ndarray[j].entries * sizeof(char *));
-					tndarray[j].treenodes = GENMALLOC(ndarray[j].entries * sizeof(struct rand_smc_node));
-					tndarray[j].entries = ndarray[j].entries;
-					for (unsigned int i = 0U; (int)i < ndarray[j].entries; i++) {
-						tndarray[j].snames[i] = GENMALLOC(1 * sizeof(char[MAX_NAME_CHARS]));
-						strlcpy(tndarray[j].snames[i], ndarray[j].snames[i], MAX_NAME_CHARS);
-						tndarray[j].nname[i] = GENMALLOC(1 * sizeof(char[MAX_NAME_CHARS]));
-						strlcpy(tndarray[j].nname[i], ndarray[j].nname[i], MAX_NAME_CHARS);
-						tndarray[j].biases[i] = ndarray[j].biases[i];
-						tndarray[j].norcall[i] = ndarray[j].norcall[i];
-						if (tndarray[j].norcall[i] == 1) {
-							tndarray[j].treenodes[i] = tndarray[treenodetrackmal];
-							treenodetrackmal++;
-						}
-					}
-					tndarray[j].biasent = ndarray[j].biasent;
-					tndarray[j].biasarray = GENMALLOC((tndarray[j].biasent) * sizeof(int));
-					for (unsigned int i = 0U; (int)i < ndarray[j].biasent; i++) {
-						tndarray[j].biasarray[i] = ndarray[j].biasarray[i];
-					}
-				}
-				tndarray[cntndarray].biases = GENMALLOC(f3d.row[f3d.col + 1] * sizeof(int));
-				tndarray[cntndarray].snames = GENMALLOC(f3d.row[f3d.col + 1] * sizeof(char *));
-				tndarray[cntndarray].norcall = GENMALLOC(f3d.row[f3d.col + 1] * sizeof(int));
-				tndarray[cntndarray].nname = GENMALLOC(f3d.row[f3d.col + 1] * sizeof(char *));
-				tndarray[cntndarray].treenodes = GENMALLOC(f3d.row[f3d.col + 1] * sizeof(struct rand_smc_node));
-				tndarray[cntndarray].entries = f3d.row[f3d.col + 1];
-
-				/*
-				 * Populate bias tree with former values in tree
-				 */
-				int cntbias = 0;
-				int bias_count = 0;
-				for (unsigned int j = 0U; (int)j < f3d.row[f3d.col + 1]; j++) {
-					tndarray[cntndarray].snames[j] = GENMALLOC(1 * sizeof(char[MAX_NAME_CHARS]));
-					strlcpy(tndarray[cntndarray].snames[j], f3d.fnamefifo[f3d.col + 1][j], MAX_NAME_CHARS);
-					tndarray[cntndarray].nname[j] = GENMALLOC(1 * sizeof(char[MAX_NAME_CHARS]));
-					strlcpy(tndarray[cntndarray].nname[j], f3d.nnfifo[f3d.col + 1][j], MAX_NAME_CHARS);
-					tndarray[cntndarray].biases[j] = f3d.biasfifo[f3d.col + 1][j];
-					cntbias += tndarray[cntndarray].biases[j];
-					if (strcmp(tndarray[cntndarray].snames[j], "none") != 0) {
-						strlcpy(tndarray[cntndarray].snames[j], f3d.fnamefifo[f3d.col + 1][j], MAX_NAME_CHARS);
-						tndarray[cntndarray].norcall[j] = 0;
-						tndarray[cntndarray].treenodes[j] = nrnode;
-					} else {
-						tndarray[cntndarray].norcall[j] = 1;
-						tndarray[cntndarray].treenodes[j] = tndarray[treenodetrack];
-						treenodetrack++;
-					}
-				}
+	for (i = 0U; i < seq->count; i++) {
+		cpu->calls[i].ret = 0U;
+	}
+}
 
-				tndarray[cntndarray].biasent = cntbias;
-				tndarray[cntndarray].biasarray = GENMALLOC((tndarray[cntndarray].biasent) * sizeof(int));
-				for (unsigned int j = 0U; j < tndarray[cntndarray].entries; j++) {
-					for (unsigned int i = 0U; i < tndarray[cntndarray].biases[j]; i++) {
-						tndarray[cntndarray].biasarray[bias_count] = j;
-						bias_count++;
-					}
-				}
+/*
+ * Function executes a single SMC fuzz test instance, for the sequence 'seq'.
+ * The calls are saved to the log before they are issued, so the sequence can
+ * be replayed even if it never returns.
+ */
+static test_result_t smc_fuzzing_instance(struct smc_fuzz_cpu *cpu,
+					  struct smcf_seq *seq)
+{
+	uint32_t prev = 0U;
+	uint32_t insns;
+	int64_t ret;
 
-				/*
-				 * Free memory of old bias tree
-				 */
-				if (cntndarray > 0) {
-					for (unsigned int j = 0U; (int)j < cntndarray; j++) {
-						for (unsigned int i = 0U;
-						     (int)i < ndarray[j].entries;
-						     i++) {
-							GENFREE(ndarray[j].snames[i]);
-							GENFREE(ndarray[j].nname[i]);
-						}
-						GENFREE(ndarray[j].biases);
-						GENFREE(ndarray[j].norcall);
-						GENFREE(ndarray[j].biasarray);
-						GENFREE(ndarray[j].snames);
-						GENFREE(ndarray[j].nname);
-						GENFREE(ndarray[j].treenodes);
-					}
-					GENFREE(ndarray);
-				}
+	smc_fuzzing_generate(cpu, seq);
 
-				/*
-				 * Move pointers to new bias tree to current tree
-				 */
-				ndarray = tndarray;
-				cntndarray++;
-
-				/*
-				 * Free raw data
-				 */
-				for (unsigned int j = 0U; (int)j < f3d.row[f3d.col + 1]; j++) {
-					GENFREE(f3d.nnfifo[f3d.col + 1][j]);
-					GENFREE(f3d.fnamefifo[f3d.col + 1][j]);
-				}
-				GENFREE(f3d.nnfifo[f3d.col + 1]);
-				GENFREE(f3d.fnamefifo[f3d.col + 1]);
-				GENFREE(f3d.biasfifo[f3d.col + 1]);
-				f3d.curr_col -= 1;
-			}
-		}
+	if (!smcf_log_write_calls(seq, 0U, cpu->calls, seq->count) ||
+	    !smcf_log_save_seq(seq)) {
+		smc_fuzz_log_error();
+	}
 
-		/*
-		 * Ending device tree file and freeing raw data
-		 */
-		if (fdt32_to_cpu(rval) == 9) {
-			for (unsigned int i = 0U; (int)i < f3d.col; i++) {
-				for (unsigned int j = 0U; (int)j < f3d.row[i]; j++) {
-					GENFREE(f3d.nnfifo[i][j]);
-					GENFREE(f3d.fnamefifo[i][j]);
-				}
-				GENFREE(f3d.nnfifo[i]);
-				GENFREE(f3d.fnamefifo[i]);
-				GENFREE(f3d.biasfifo[i]);
-			}
-			GENFREE(f3d.nnfifo);
-			GENFREE(f3d.fnamefifo);
-			GENFREE(f3d.biasfifo);
-			GENFREE(f3d.row);
-			dtdone = 1;
-		}
+	for (unsigned int i = 0U; i < seq->count; i++) {
+		smc_fuzz_pmu_begin(cpu);
+		ret = runtestfunction(cpu->calls[i].func, cpu->calls[i].arg);
+		insns = smc_fuzz_pmu_end(cpu);
+
+		cpu->calls[i].ret = (uint16_t)ret;
+		seq->score += smcf_cov_add(&cpu->cov, &prev, cpu->calls[i].func,
+					   (uint64_t)ret, insns);
 	}
 
+	seq->state = SMCF_SEQ_DONE;
+	if (!smcf_log_write_calls(seq, 0U, cpu->calls, seq->count) ||
+	    !smcf_log_save_seq(seq)) {
+		smc_fuzz_log_error();
+	}
 
-	*casz = cntndarray;
-	return ndarray;
+	return TEST_RESULT_SUCCESS;
 }
 
 /*
- * Running SMC call from what function name is selected
+ * Seed of instance 'i' on the CPU at core position 'core_pos'. The CPUs get
+ * distinct streams from the build seeds, which are used as they are when a
+ * single CPU is fuzzing.
  */
-void runtestfunction(char *funcstr)
+static uint32_t smc_fuzz_seed(unsigned int i, unsigned int core_pos)
 {
-	if (strcmp(funcstr, "sdei_version") == 0) {
-		long long ret = sdei_version();
-		if (ret != MAKE_SDEI_VERSION(1, 0, 0)) {
-			tftf_testcase_printf("Unexpected SDEI version: 0x%llx\n",
-					     ret);
-		}
-		printf("running %s\n", funcstr);
-	}
-	if (strcmp(funcstr, "sdei_pe_unmask") == 0) {
-		long long ret = sdei_pe_unmask();
-		if (ret < 0) {
-			tftf_testcase_printf("SDEI pe unmask failed: 0x%llx\n",
-					     ret);
-		}
-		printf("running %s\n", funcstr);
+	uint32_t seeds[SMC_FUZZ_INSTANCE_COUNT] = {SMC_FUZZ_SEEDS};
+
+	if (SMC_FUZZ_CPUS == 1U) {
+		return seeds[i];
 	}
-	if (strcmp(funcstr, "sdei_pe_mask") == 0) {
-		int64_t ret = sdei_pe_mask();
-		if (ret < 0) {
-			tftf_testcase_printf("SDEI pe mask failed: 0x%llx\n", ret);
+
+	return seeds[i] + (core_pos * 0x9e3779b9U);
+}
+
+/*
+ * Run all the instances on the calling CPU, then mutate the sequences that
+ * found new coverage, for as many instances as requested.
+ */
+static test_result_t smc_fuzzing_cpu(void)
+{
+	unsigned int core_pos = smc_fuzz_core_pos();
+	struct smc_fuzz_cpu *cpu = &smc_fuzz_cpus[core_pos];
+	test_result_t result = TEST_RESULT_SUCCESS;
+	uint32_t rng = smc_fuzz_seed(0U, core_pos);
+	struct smcf_seq *parent;
+	struct smcf_seq *seq;
+	unsigned int i;
+
+	smcf_cov_reset(&cpu->cov);
+	smc_fuzz_pmu_init(cpu);
+
+	for (i = 0U; i < SMC_FUZZ_RUNS; i++) {
+		if (i < SMC_FUZZ_INSTANCE_COUNT) {
+			seq = smcf_log_new_seq(smc_fuzz_seed(i, core_pos),
+					       SMC_FUZZ_CALLS_PER_INSTANCE,
+					       core_pos);
+		} else {
+			seq = smcf_log_new_seq(smcf_rand(&rng),
+					       SMC_FUZZ_CALLS_PER_INSTANCE,
+					       core_pos);
 		}
-		printf("running %s\n", funcstr);
-	}
-	if (strcmp(funcstr, "sdei_event_status") == 0) {
-		int64_t ret = sdei_event_status(0);
-		if (ret < 0) {
-			tftf_testcase_printf("SDEI event status failed: 0x%llx\n",
-					     ret);
+
+		if (seq == NULL) {
+			ERROR("SMC fuzz log full, stopping after %u runs\n", i);
+			result = TEST_RESULT_FAIL;
+			break;
 		}
-		printf("running %s\n", funcstr);
-	}
-	if (strcmp(funcstr, "sdei_event_signal") == 0) {
-		int64_t ret = sdei_event_signal(0);
-		if (ret < 0) {
-			tftf_testcase_printf("SDEI event signal failed: 0x%llx\n",
-					     ret);
+
+		if (i >= SMC_FUZZ_INSTANCE_COUNT) {
+			seq->parent = smcf_corpus_pick(&rng, core_pos);
 		}
-		printf("running %s\n", funcstr);
-	}
-	if (strcmp(funcstr, "sdei_private_reset") == 0) {
-		int64_t ret = sdei_private_reset();
-		if (ret < 0) {
-			tftf_testcase_printf("SDEI private reset failed: 0x%llx\n",
-					     ret);
+
+		parent = smcf_log_seq(seq->parent);
+		if (parent == NULL) {
+			seq->parent = SMCF_NO_PARENT;
+		} else if ((parent->count > 1U) &&
+			   ((smcf_rand(&rng) & 1U) == 0U)) {
+			seq->mutation = SMCF_MUT_SPLICE;
+			seq->prefix = 1U + (smcf_rand(&rng) %
+					    (parent->count - 1U));
+		} else {
+			seq->mutation = SMCF_MUT_ARGS;
+			seq->prefix = parent->count;
 		}
-		printf("running %s\n", funcstr);
-	}
-	if (strcmp(funcstr, "sdei_shared_reset") == 0) {
-		int64_t ret = sdei_shared_reset();
-		if (ret < 0) {
-			tftf_testcase_printf("SDEI shared reset failed: 0x%llx\n",
-					     ret);
+
+		VERBOSE("Starting SMC fuzz test with seed 0x%x\n", seq->seed);
+		cpu->seqs[i] = seq;
+		cpu->results[i] = smc_fuzzing_instance(cpu, seq);
+		cpu->runs = i + 1U;
+
+		if (cpu->results[i] == TEST_RESULT_FAIL) {
+			result = TEST_RESULT_FAIL;
 		}
-		printf("running %s\n", funcstr);
 	}
+
+	return result;
 }
 
 /*
- * Function executes a single SMC fuzz test instance with a supplied seed.
+ * Re-issue the calls saved in the log by a previous run, in the same order and
+ * with the same arguments, and count those that do not return the logged
+ * value. When several CPUs replay at once, each one replays the sequences its
+ * core position ran, so the per-CPU logs are replayed together.
  */
-test_result_t smc_fuzzing_instance(uint32_t seed)
+static test_result_t smc_fuzzing_replay_cpu(void)
 {
-	/*
-	 * Setting up malloc block parameters
-	 */
-	tmod.memptr = (void *)tmod.memory;
-	tmod.memptrend = (void *)tmod.memory;
-	tmod.maxmemblk = ((TOTALMEMORYSIZE / BLKSPACEDIV) / sizeof(struct memblk));
-	tmod.nmemblk = 1;
-	tmod.memptr->address = 0U;
-	tmod.memptr->size = TOTALMEMORYSIZE - (TOTALMEMORYSIZE / BLKSPACEDIV);
-	tmod.memptr->valid = 1;
-	tmod.mallocdeladd[0] = 0U;
-	tmod.precblock[0] = (void *)tmod.memory;
-	tmod.trailblock[0] = NULL;
-	tmod.cntdeladd = 0U;
-	tmod.ptrmemblkqueue = 0U;
-	tmod.mallocdeladd_queue_cnt = 0U;
-	tmod.checkadd = 1U;
-	tmod.checknumentries = 0U;
-	tmod.memerror = 0U;
-	struct memmod *mmod;
-	mmod = &tmod;
-	int cntndarray;
-	struct rand_smc_node *tlnode;
+	unsigned int core_pos = smc_fuzz_core_pos();
+	struct smc_fuzz_cpu *cpu = &smc_fuzz_cpus[core_pos];
+	struct smcf_call calls[32];
+	struct smcf_seq *seq;
+	unsigned int i, j, n;
+	uint16_t ret;
+
+	for (i = 0U; i < smcf_log_seq_count(); i++) {
+		seq = smcf_log_seq(i);
+
+		if ((SMC_FUZZ_CPUS != 1U) && (seq->cpu != core_pos)) {
+			continue;
+		}
 
-	/*
-	 * Creating SMC bias tree
-	 */
-	struct rand_smc_node *ndarray = createsmctree(&cntndarray, &tmod);
+		VERBOSE("Replaying sequence %u, seed 0x%x, %u calls%s\n", i,
+			seq->seed, seq->count,
+			(seq->state == SMCF_SEQ_DONE) ? "" :
+			" (did not complete)");
 
-	if (tmod.memerror != 0) {
-		return TEST_RESULT_FAIL;
-	}
+		for (j = 0U; j < seq->count; j += n) {
+			n = MIN(seq->count - j, (unsigned int)ARRAY_SIZE(calls));
 
-	/*
-	 * Initialize pseudo random number generator with supplied seed.
-	 */
-	srand(seed);
+			if (!smcf_log_read_calls(seq, j, calls, n)) {
+				ERROR("Cannot read the SMC fuzz log\n");
+				return TEST_RESULT_FAIL;
+			}
 
-	/*
-	 * Code to traverse the bias tree and select function based on the biaes within
-	 *
-	 * The algorithm starts with the first node to pull up the biasarray.  The
-	 * array is specified as a series of values that reflect the bias of the nodes
-	 * in question. So for instance if there are three nodes with a bias of 2,5,7
-	 * the biasarray would have the following constituency:
-	 *
-	 * 0,0,1,1,1,1,1,2,2,2,2,2,2,2.
-	 *
-	 * Mapping 0 as node 1, 1 as node 2, and 2 as node 3.
-	 * The biasent variable contains the count of the size of the biasarray which
-	 * provides the input for random selection.  This is subsequently applied as an
-	 * index to the biasarray.  The selection pulls up the node and then is checked
-	 * for whether it is a leaf or tree node using the norcall variable.
-	 * If it is a leaf then the bias tree traversal ends with an SMC call.
-	 * If it is a tree node then the process begins again with
-	 * another loop to continue the process of selection until an eventual leaf
-	 * node is found.
-	 */
-	for (unsigned int i = 0U; i < SMC_FUZZ_CALLS_PER_INSTANCE; i++) {
-		tlnode = &ndarray[cntndarray - 1];
-		int nd = 0;
-		while (nd == 0) {
-			int nch = rand()%tlnode->biasent;
-			int selent = tlnode->biasarray[nch];
-			if (tlnode->norcall[selent] == 0) {
-				runtestfunction(tlnode->snames[selent]);
-				nd = 1;
-			} else {
-				tlnode = &tlnode->treenodes[selent];
+			for (unsigned int k = 0U; k < n; k++) {
+				ret = (uint16_t)runtestfunction(calls[k].func,
+								calls[k].arg);
+
+				if ((seq->state == SMCF_SEQ_DONE) &&
+				    (ret != calls[k].ret)) {
+					VERBOSE("Sequence %u call %u returned "
+						"0x%x, 0x%x logged\n", i, j + k,
+						ret, calls[k].ret);
+					cpu->diverged++;
+				}
 			}
 		}
+
+		cpu->runs++;
+	}
+
+	return TEST_RESULT_SUCCESS;
+}
+
+static test_result_t smc_fuzz_run(test_function_t fn)
+{
+	(void)memset(smc_fuzz_cpus, 0, sizeof(smc_fuzz_cpus));
+
+	if (SMC_FUZZ_CPUS == 1U) {
+		return fn();
+	}
+
+	return perf_run_on_cpus(tftf_get_total_cpus_count(), fn);
+}
+
+static test_result_t smc_fuzzing_replay(void)
+{
+	unsigned int seqs = 0U, diverged = 0U;
+	test_result_t result;
+
+	if (!smcf_log_load()) {
+		return TEST_RESULT_FAIL;
+	}
+
+	result = smc_fuzz_run(smc_fuzzing_replay_cpu);
+
+	for (unsigned int i = 0U; i < PLATFORM_CORE_COUNT; i++) {
+		seqs += smc_fuzz_cpus[i].runs;
+		diverged += smc_fuzz_cpus[i].diverged;
 	}
 
+	printf("SMC fuzz replay: %u sequences, %u calls diverged\n",
+	       seqs, diverged);
+
 	/*
-	 * End of test SMC selection and freeing of nodes
+	 * With several CPUs the order of the calls across CPUs is not
+	 * reproduced, so the return values may legitimately differ.
 	 */
-	if (cntndarray > 0) {
-		for (unsigned int j = 0U; j < cntndarray; j++) {
-			for (unsigned int i = 0U; i < ndarray[j].entries; i++) {
-				GENFREE(ndarray[j].snames[i]);
-				GENFREE(ndarray[j].nname[i]);
-			}
-			GENFREE(ndarray[j].biases);
-			GENFREE(ndarray[j].norcall);
-			GENFREE(ndarray[j].biasarray);
-			GENFREE(ndarray[j].snames);
-			GENFREE(ndarray[j].nname);
-			GENFREE(ndarray[j].treenodes);
-		}
-		GENFREE(ndarray);
+	if ((SMC_FUZZ_CPUS == 1U) && (diverged != 0U)) {
+		return TEST_RESULT_FAIL;
 	}
 
-	return TEST_RESULT_SUCCESS;
+	return result;
 }
 
 /*
@@ -575,38 +433,69 @@ test_result_t smc_fuzzing_instance(uint32_t seed)
 test_result_t smc_fuzzing_top(void)
 {
 	/* These SMC_FUZZ_x macros are supplied by the build system. */
-	test_result_t results[SMC_FUZZ_INSTANCE_COUNT];
-	uint32_t seeds[SMC_FUZZ_INSTANCE_COUNT] = {SMC_FUZZ_SEEDS};
-	test_result_t result = TEST_RESULT_SUCCESS;
+	struct smcf_cov cov;
+	struct smc_fuzz_cpu *cpu;
+	struct smcf_seq *seq;
+	test_result_t result;
 	unsigned int i;
 
-	/* Run each instance. */
-	for (i = 0U; i < SMC_FUZZ_INSTANCE_COUNT; i++) {
-		printf("Starting SMC fuzz test with seed 0x%x\n", seeds[i]);
-		results[i] = smc_fuzzing_instance(seeds[i]);
+	if (SMC_FUZZ_REPLAY != 0) {
+		return smc_fuzzing_replay();
 	}
 
+	smcf_log_failed = false;
+	if (!smcf_log_start()) {
+		smc_fuzz_log_error();
+	}
+
+	result = smc_fuzz_run(smc_fuzzing_cpu);
+
 	/* Report successes and failures. */
 	printf("SMC Fuzz Test Results Summary\n");
-	for (i = 0U; i < SMC_FUZZ_INSTANCE_COUNT; i++) {
-		/* Display instance number. */
-		printf("  Instance #%d\n", i);
-
-		/* Print test results. */
-		printf("    Result: ");
-		if (results[i] == TEST_RESULT_SUCCESS) {
-			printf("SUCCESS\n");
-		} else if (results[i] == TEST_RESULT_FAIL) {
-			printf("FAIL\n");
-			/* If we got a failure, update the result value. */
-			result = TEST_RESULT_FAIL;
-		} else if (results[i] == TEST_RESULT_SKIPPED) {
-			printf("SKIPPED\n");
+	smcf_cov_reset(&cov);
+	for (unsigned int core_pos = 0U; core_pos < PLATFORM_CORE_COUNT;
+	     core_pos++) {
+		cpu = &smc_fuzz_cpus[core_pos];
+		if (cpu->runs == 0U) {
+			continue;
 		}
 
-		/* Print seed used */
-		printf("    Seed: 0x%x\n", seeds[i]);
+		if (SMC_FUZZ_CPUS != 1U) {
+			printf("  CPU %u, %u coverage signatures\n", core_pos,
+			       cpu->cov.seen);
+		}
+		smcf_cov_merge(&cov, &cpu->cov);
+
+		for (i = 0U; i < cpu->runs; i++) {
+			seq = cpu->seqs[i];
+
+			/* Display instance number. */
+			printf("  Instance #%d\n", i);
+
+			/* Print test results. */
+			printf("    Result: ");
+			if (cpu->results[i] == TEST_RESULT_SUCCESS) {
+				printf("SUCCESS\n");
+			} else if (cpu->results[i] == TEST_RESULT_FAIL) {
+				printf("FAIL\n");
+				/* If we got a failure, update the result value. */
+				result = TEST_RESULT_FAIL;
+			} else if (cpu->results[i] == TEST_RESULT_SKIPPED) {
+				printf("SKIPPED\n");
+			}
+
+			/* Print seed used, and where the sequence came from */
+			printf("    Seed: 0x%x\n", seq->seed);
+			if (seq->parent != SMCF_NO_PARENT) {
+				printf("    Parent: sequence %u, %s\n",
+				       seq->parent,
+				       (seq->mutation == SMCF_MUT_SPLICE) ?
+				       "spliced" : "new arguments");
+			}
+			printf("    New coverage: %u\n", seq->score);
+		}
 	}
+	printf("  Coverage signatures: %u\n", cov.seen);
 
 	/*
 	 * Print out the smc fuzzer parameters so this test can be replicated.
@@ -616,11 +505,17 @@ test_result_t smc_fuzzing_top(void)
 		SMC_FUZZ_INSTANCE_COUNT);
 	printf("  SMC_FUZZ_CALLS_PER_INSTANCE=%u\n",
 		SMC_FUZZ_CALLS_PER_INSTANCE);
-	printf("  SMC_FUZZ_SEEDS=0x%x", seeds[0]);
+	printf("  SMC_FUZZ_MUTATIONS=%u\n", SMC_FUZZ_MUTATIONS);
+	printf("  SMC_FUZZ_MULTI_CPU=%u\n", SMC_FUZZ_MULTI_CPU);
+	printf("  SMC_FUZZ_SEEDS=0x%x", smc_fuzz_seed(0U, 0U));
 	for (i = 1U; i < SMC_FUZZ_INSTANCE_COUNT; i++) {
-		printf(",0x%x", seeds[i]);
+		printf(",0x%x", smc_fuzz_seed(i, 0U));
 	}
 	printf("\n");
+	if (!smcf_log_failed) {
+		printf("The executed calls are logged in NVM, build with "
+		       "SMC_FUZZ_REPLAY=1 to replay them\n");
+	}
 
 	return result;
 }
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <arch.h>
+#include "fuzz_corpus.h"
+#include <plat_topology.h>
+#include <smcf_args.h>
+#include <utils_def.h>
+
+void smcf_args_init(struct smcf_args *args, uint32_t arg)
+{
+	args->rng = arg & SMCF_ARGS_SEED_MASK;
+	args->mode = arg >> SMCF_ARGS_SHIFT;
+}
+
+/* Mode of the next argument, drawn when the call mixes them */
+static unsigned int smcf_arg_mode(struct smcf_args *args)
+{
+	uint32_t r;
+
+	if (args->mode != SMCF_ARGS_MIXED) {
+		return args->mode;
+	}
+
+	r = smcf_rand(&args->rng) % 4U;
+	if (r < 2U) {
+		return SMCF_ARGS_VALID;
+	}
+
+	return (r == 2U) ? SMCF_ARGS_BOUNDARY : SMCF_ARGS_RANDOM;
+}
+
+uint32_t smcf_arg_u32(struct smcf_args *args)
+{
+	return smcf_rand(&args->rng);
+}
+
+uint64_t smcf_arg_u64(struct smcf_args *args)
+{
+	uint64_t hi = smcf_rand(&args->rng);
+
+	return (hi << 32) | smcf_rand(&args->rng);
+}
+
+uint32_t smcf_arg_range(struct smcf_args *args, uint32_t min, uint32_t max)
+{
+	uint32_t edges[] = { min, max, min - 1U, max + 1U, 0U, UINT32_MAX };
+
+	switch (smcf_arg_mode(args)) {
+	case SMCF_ARGS_VALID:
+		if ((max - min) == UINT32_MAX) {
+			return smcf_rand(&args->rng);
+		}
+		return min + (smcf_rand(&args->rng) % (max - min + 1U));
+	case SMCF_ARGS_BOUNDARY:
+		return edges[smcf_rand(&args->rng) % ARRAY_SIZE(edges)];
+	default:
+		return smcf_rand(&args->rng);
+	}
+}
+
+uint32_t smcf_arg_choice(struct smcf_args *args, const uint32_t *valid,
+			 unsigned int count)
+{
+	uint32_t v = valid[smcf_rand(&args->rng) % count];
+
+	switch (smcf_arg_mode(args)) {
+	case SMCF_ARGS_VALID:
+		return v;
+	case SMCF_ARGS_BOUNDARY:
+		/* Neighbours of a valid value, or the extreme values */
+		switch (smcf_rand(&args->rng) % 4U) {
+		case 0U:
+			return v - 1U;
+		case 1U:
+			return v + 1U;
+		case 2U:
+			return 0U;
+		default:
+			return UINT32_MAX;
+		}
+	default:
+		return smcf_rand(&args->rng);
+	}
+}
+
+u_register_t smcf_arg_mpidr(struct smcf_args *args)
+{
+	unsigned int count = tftf_get_total_cpus_count();
+	unsigned int n, cpu_node;
+	u_register_t mpid = 0U;
+
+	switch (smcf_arg_mode(args)) {
+	case SMCF_ARGS_VALID:
+		n = smcf_rand(&args->rng) % count;
+		for_each_cpu(cpu_node) {
+			mpid = tftf_get_mpidr_from_node(cpu_node);
+			if (n-- == 0U) {
+				break;
+			}
+		}
+		return mpid;
+	case SMCF_ARGS_BOUNDARY:
+		/* Absent CPUs next to the present ones, or invalid MPIDRs */
+		switch (smcf_rand(&args->rng) % 4U) {
+		case 0U:
+			for_each_cpu(cpu_node) {
+				mpid = tftf_get_mpidr_from_node(cpu_node);
+			}
+			return mpid + 1U;
+		case 1U:
+			return MPIDR_AFFINITY_MASK;
+		case 2U:
+			return INVALID_MPID;
+		default:
+			return MPIDR_MT_MASK | MPIDR_CLUSTER_MASK;
+		}
+	default:
+		return (u_register_t)smcf_arg_u64(args) & MPIDR_AFFINITY_MASK;
+	}
+}
@@ -1,559 +1,325 @@
 /*
- * Copyright (c) 2020, Arm Limited. All rights reserved.
+ * Copyright (c) 2020-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
-#include <debug.h>
-#include <drivers/arm/private_timer.h>
-#include <events.h>
-#include "fifo3d.h"
-#include <libfdt.h>
+#include "smcmalloc.h"
 
-#include <power_management.h>
-#include <sdei.h>
-#include <tftf_lib.h>
-#include <timer.h>
+#define BLK_FREE		(1U << 0)	/* The block is free */
+#define BLK_PREV_FREE		(1U << 1)	/* The previous block is free */
+#define BLK_FLAGS		(SMCMALLOC_ALIGN - 1U)
 
-#include <plat_topology.h>
-#include <platform.h>
+#define BLK_HDR_SIZE		((uint32_t)sizeof(struct memblk))
+#define BLK_MIN_SIZE		(BLK_HDR_SIZE + SMCMALLOC_ALIGN)
 
-/*
- * Priority encoder for enabling proper alignment of returned malloc
- * addresses
- */
-struct peret priorityencoder(unsigned int num)
+static inline struct memblk *blk_at(struct memmod *mmod, uint32_t off)
 {
-	unsigned int topbit = 0U;
-	struct peret prt;
-	unsigned int cntbit = 0U;
-
-	for (unsigned int i = TOPBITSIZE; i != 0U; i--) {
-		if (((num >> i) & 1U) == 1U) {
-			if (topbit < i) {
-				topbit = i;
-			}
-			cntbit++;
-		}
-	}
-	if ((num  & 1U) == 1U) {
-		cntbit++;
-	}
+	return (struct memblk *)(void *)&mmod->memory[off];
+}
+
+static inline uint32_t blk_off(struct memmod *mmod, const struct memblk *blk)
+{
+	return (uint32_t)((const char *)blk - mmod->memory);
+}
 
-	prt.pow2 = 0U;
-	if (cntbit == 1U) {
-		prt.pow2 = 1U;
+static inline uint32_t blk_size(const struct memblk *blk)
+{
+	return blk->size & ~BLK_FLAGS;
+}
+
+/* Index of the most significant bit set, 'x' must not be 0 */
+static inline unsigned int fls32(uint32_t x)
+{
+	return 31U - (unsigned int)__builtin_clz(x);
+}
+
+static inline unsigned int ffs32(uint32_t x)
+{
+	return (unsigned int)__builtin_ctz(x);
+}
+
+/* Lists holding the free blocks of 'size' bytes */
+static void mapping(uint32_t size, unsigned int *fl, unsigned int *sl)
+{
+	unsigned int f;
+
+	if (size < (1U << SMCMALLOC_SMALL_LOG2)) {
+		*fl = 0U;
+		*sl = size >> SMCMALLOC_ALIGN_LOG2;
+		return;
 	}
-	prt.tbit = topbit;
-	return prt;
+
+	f = fls32(size);
+	*sl = (size >> (f - SMCMALLOC_SL_LOG2)) ^ SMCMALLOC_SL_COUNT;
+	*fl = f - SMCMALLOC_SMALL_LOG2 + 1U;
 }
 
 /*
- * Generic malloc function requesting memory.  Alignment of
- * returned memory is the next largest size if not a power
- * of two. The memmod structure is required to represent memory image
+ * Round 'size' up to the start of the next list, so that any block of the
+ * list mapping() returns for it is large enough.
  */
-void *smcmalloc(unsigned int rsize,
-		struct memmod *mmod)
+static uint32_t round_up_list(uint32_t size)
 {
-	unsigned int alignnum;
-	unsigned int modval;
-	unsigned int aladd;
-	unsigned int mallocdeladd_pos = 0U;
-	struct memblk *newblk = NULL;
-	bool foundmem = false;
-	struct peret prt;
-	int incrnmemblk = 0;
-	int incrcntdeladd = 0;
+	if (size >= (1U << SMCMALLOC_SMALL_LOG2)) {
+		size += (1U << (fls32(size) - SMCMALLOC_SL_LOG2)) - 1U;
+	}
 
-	/*
-	 * minimum size is 16
-	 */
-	if (rsize < 16U) {
-		rsize = 16U;
+	return size;
+}
+
+static void insert_free(struct memmod *mmod, struct memblk *blk)
+{
+	uint32_t off = blk_off(mmod, blk);
+	unsigned int fl, sl;
+
+	mapping(blk_size(blk), &fl, &sl);
+
+	blk->prev_free = SMCMALLOC_NONE;
+	blk->next_free = mmod->free_head[fl][sl];
+	if (blk->next_free != SMCMALLOC_NONE) {
+		blk_at(mmod, blk->next_free)->prev_free = off;
 	}
 
-	/*
-	 * Is size on a power of 2 boundary?  if not select next largest power of 2
-	 * to place the memory request in
-	 */
-	prt = priorityencoder(rsize);
-	if (prt.pow2 == 1U) {
-		alignnum = 1U << prt.tbit;
+	mmod->free_head[fl][sl] = off;
+	mmod->fl_map |= 1U << fl;
+	mmod->sl_map[fl] |= 1U << sl;
+}
+
+static void remove_free(struct memmod *mmod, struct memblk *blk)
+{
+	unsigned int fl, sl;
+
+	mapping(blk_size(blk), &fl, &sl);
+
+	if (blk->prev_free != SMCMALLOC_NONE) {
+		blk_at(mmod, blk->prev_free)->next_free = blk->next_free;
 	} else {
-		alignnum = 1U << (prt.tbit + 1);
+		mmod->free_head[fl][sl] = blk->next_free;
 	}
-	mmod->memptr = (void *)mmod->memory;
-	for (unsigned int i = 0U; i < mmod->nmemblk; i++) {
-		modval = mmod->memptr->address % alignnum;
-		if (modval == 0U) {
-			aladd = 0U;
-		} else {
-			aladd = alignnum - modval;
-		}
 
-		/*
-		 * Searching sizes and alignments of memory blocks to find a candidate that will
-		 * accept the size
-		 */
-		if ((rsize <= (mmod->memptr->size - aladd)) &&
-		    (mmod->memptr->size > aladd) && (mmod->memptr->valid == 1)) {
-			foundmem = true;
-
-			/*
-			 * Reuse malloc table entries that have been retired.
-			 * If none exists create new entry
-			 */
-			if (mmod->mallocdeladd_queue_cnt > 0U) {
-				mmod->mallocdeladd_queue_cnt--;
-				mallocdeladd_pos =
-					mmod->mallocdeladd_queue[mmod->
-								 mallocdeladd_queue_cnt];
-			} else {
-				mallocdeladd_pos = mmod->cntdeladd;
-				incrcntdeladd = 1;
-			}
-
-			/*
-			 * Determining if the size adheres to power of 2 boundary and
-			 * if a retired malloc block
-			 * can be utilized from the malloc table
-			 */
-			if (modval == 0U) {
-				if (mmod->ptrmemblkqueue > 0U) {
-					newblk = mmod->memblkqueue[mmod->ptrmemblkqueue - 1U];
-					mmod->ptrmemblkqueue--;
-				} else {
-					newblk = mmod->memptrend;
-					newblk++;
-					incrnmemblk = 1;
-				}
-
-				/*
-				 * Setting memory block parameters for newly created memory
-				 */
-				newblk->size = 0U;
-				newblk->address = mmod->memptr->address;
-				newblk->valid = 1;
-				mmod->precblock[mallocdeladd_pos] = newblk;
-
-				/*
-				 * Scrolling through the malloc attribute table to
-				 * find entries that have values that
-				 * match the newly created block and replace them with it
-				 */
-				unsigned int fadd = newblk->address + newblk->size;
-				for (unsigned int j = 0U; j < mmod->cntdeladd; j++) {
-					if ((fadd == mmod->mallocdeladd[j]) && (mmod->mallocdeladd_valid[j] == 1U)) {
-						mmod->precblock[j] = newblk;
-					}
-					if ((fadd ==
-					     (mmod->mallocdeladd[j] + mmod->memallocsize[j])) && (mmod->mallocdeladd_valid[j] == 1U)) {
-						mmod->trailblock[j] = newblk;
-					}
-				}
-
-				/*
-				 * Setting table parameters
-				 */
-				mmod->mallocdeladd[mallocdeladd_pos] =
-					mmod->memptr->address;
-				mmod->memallocsize[mallocdeladd_pos] = rsize;
-				mmod->memptr->size -= rsize;
-				mmod->memptr->address += (rsize);
-				mmod->trailblock[mallocdeladd_pos] = mmod->memptr;
-				mmod->mallocdeladd_valid[mallocdeladd_pos] = 1U;
-				mmod->memptr = (void *)mmod->memory;
-
-				/*
-				 * Removing entries from malloc table that can be
-				 * merged with other blocks
-				 */
-				for (unsigned int j = 0U; j < mmod->nmemblk; j++) {
-					if (mmod->memptr->valid == 1) {
-						if ((mmod->trailblock[mallocdeladd_pos]->address +
-						     mmod->trailblock[mallocdeladd_pos]->size) == mmod->memptr->address) {
-							if ((mmod->memptr->size ==
-							     0U) && (mmod->trailblock[mallocdeladd_pos]->size != 0U)) {
-								mmod->memptr->valid = 0;
-								mmod->memblkqueue[mmod->ptrmemblkqueue] = mmod->memptr;
-								mmod->ptrmemblkqueue++;
-								if (mmod->ptrmemblkqueue >= mmod->maxmemblk) {
-									mmod->memerror = 1U;
-								}
-							}
-						}
-					}
-					mmod->memptr++;
-				}
-			} else {
-				/*
-				 * Allocating memory that is aligned with power of 2
-				 */
-				unsigned int nblksize = mmod->memptr->size - rsize - (alignnum - modval);
-				if (mmod->ptrmemblkqueue > 0U) {
-					newblk = mmod->memblkqueue[mmod->ptrmemblkqueue - 1U];
-					mmod->ptrmemblkqueue--;
-				} else {
-					newblk = mmod->memptrend;
-					newblk++;
-					incrnmemblk = 1;
-				}
-				newblk->size = nblksize;
-				newblk->address = mmod->memptr->address +
-						  (alignnum - modval) + rsize;
-				newblk->valid = 1;
-				mmod->trailblock[mallocdeladd_pos] = newblk;
-
-				/*
-				 * Scrolling through the malloc attribute table to find entries
-				 * that have values that
-				 * match the newly created block and replace them with it
-				 */
-				unsigned int fadd = newblk->address + newblk->size;
-				for (unsigned int i = 0U; i < mmod->cntdeladd; i++) {
-					if ((fadd == mmod->mallocdeladd[i]) && (mmod->mallocdeladd_valid[i] == 1U)) {
-					    mmod->precblock[i] = newblk;
-					}
-					if ((fadd == (mmod->mallocdeladd[i] +
-					      mmod->memallocsize[i])) && (mmod->mallocdeladd_valid[i] == 1U)) {
-						mmod->trailblock[i] = newblk;
-					}
-				}
-
-				/*
-				 * Setting table parameters
-				 */
-				mmod->memallocsize[mallocdeladd_pos] = rsize;
-				mmod->memptr->size = (alignnum - modval);
-				mmod->mallocdeladd[mallocdeladd_pos] = mmod->memptr->address + mmod->memptr->size;
-				mmod->precblock[mallocdeladd_pos] = mmod->memptr;
-				mmod->mallocdeladd_valid[mallocdeladd_pos] = 1U;
-			}
-			if (incrcntdeladd == 1) {
-				mmod->cntdeladd++;
-				if (mmod->cntdeladd >= mmod->maxmemblk) {
-					printf("ERROR: size of GENMALLOC table exceeded\n");
-					mmod->memerror = 2U;
-				}
-			}
-			break;
-		}
-		mmod->memptr++;
+	if (blk->next_free != SMCMALLOC_NONE) {
+		blk_at(mmod, blk->next_free)->prev_free = blk->prev_free;
 	}
-	if (incrnmemblk == 1) {
-		mmod->nmemblk++;
-		mmod->memptrend++;
-		if (mmod->nmemblk >=
-		    ((TOTALMEMORYSIZE / BLKSPACEDIV)/sizeof(struct memblk))) {
-			printf("SMC GENMALLOC exceeded block limit of %ld\n",
-					((TOTALMEMORYSIZE / BLKSPACEDIV) / sizeof(struct memblk)));
-			mmod->memerror = 3U;
+
+	if (mmod->free_head[fl][sl] == SMCMALLOC_NONE) {
+		mmod->sl_map[fl] &= ~(1U << sl);
+		if (mmod->sl_map[fl] == 0U) {
+			mmod->fl_map &= ~(1U << fl);
 		}
 	}
-	if (foundmem == false) {
-		printf("ERROR: SMC GENMALLOC did not find memory region, size is %u\n", rsize);
-		mmod->memerror = 4U;
-	}
+}
 
-/*
- * Debug functions
- */
+/* Block following 'blk' in the memory image, or NULL for the last one */
+static struct memblk *next_phys(struct memmod *mmod, struct memblk *blk)
+{
+	uint32_t off = blk_off(mmod, blk) + blk_size(blk);
 
-#ifdef DEBUG_SMC_MALLOC
-	if (mmod->checkadd == 1) {
-		for (unsigned int i = 0U; i < mmod->checknumentries; i++) {
-			if (((mmod->mallocdeladd[mallocdeladd_pos] >
-			      mmod->checksa[i])
-			     && (mmod->mallocdeladd[mallocdeladd_pos] <
-				 mmod->checkea[i]))
-			    || (((mmod->mallocdeladd[mallocdeladd_pos] + rsize) >
-				 mmod->checksa[i])
-				&& ((mmod->mallocdeladd[mallocdeladd_pos] + rsize) <
-				    mmod->checkea[i]))) {
-				printf("ERROR: found overlap with previous addressin smc GENMALLOC\n");
-				printf("New address %u size %u\n", mmod->mallocdeladd[mallocdeladd_pos], rsize);
-				printf("Conflicting address %u size %u\n", mmod->checksa[i], (mmod->checkea[i] - mmod->checksa[i]));
-				mmod->memerror = 5U;
-			}
-		}
-		mmod->checksa[mmod->checknumentries] =
-			mmod->mallocdeladd[mallocdeladd_pos];
-		mmod->checkea[mmod->checknumentries] =
-			mmod->mallocdeladd[mallocdeladd_pos] + rsize;
-		mmod->checknumentries++;
-		if (mmod->checknumentries >= (4U * mmod->maxmemblk)) {
-			printf("ERROR: check queue size exceeded\n"); mmod->memerror = 6U;
-		}
-		mmod->memptr = (void *)mmod->memory;
-		for (unsigned int i = 0U; i < mmod->nmemblk; i++) {
-			if (mmod->memptr->valid == 1) {
-				if (((mmod->mallocdeladd[mallocdeladd_pos] >
-				      mmod->memptr->address)
-				     && (mmod->mallocdeladd[mallocdeladd_pos] < (mmod->memptr->address + mmod->memptr->size)))
-				    || (((mmod->mallocdeladd[mallocdeladd_pos] + rsize) > mmod->memptr->address)
-					&& ((mmod->mallocdeladd[mallocdeladd_pos] +
-					     rsize) < (mmod->memptr->address + mmod->memptr->size)))) {
-					printf("ERROR: found overlap with GENFREE memory region in smc GENMALLOC\n");
-					printf("New address %u size %u\n", mmod->mallocdeladd[mallocdeladd_pos], rsize);
-					printf("Conflicting address %u size %u\n", mmod->memptr->address, mmod->memptr->size);
-					mmod->memerror = 7U;
-				}
-			}
-			mmod->memptr++;
-		}
-		for (unsigned int i = 0U; i < mmod->cntdeladd; i++) {
-			if (mmod->mallocdeladd_valid[i] == 1) {
-				mmod->memptr = (void *)mmod->memory;
-				for (unsigned int j = 0U; j < mmod->nmemblk; j++) {
-					if (mmod->memptr->valid == 1) {
-						if (((mmod->mallocdeladd[i] >
-						      mmod->memptr->address)
-						     && (mmod->mallocdeladd[i] < (mmod->memptr->address + mmod->memptr->size)))
-						    || (((mmod->mallocdeladd[i] + mmod->memallocsize[i]) > mmod->memptr->address)
-							&& ((mmod->mallocdeladd[i] + mmod->memallocsize[i]) <
-								(mmod->memptr->address + mmod->memptr->size)))) {
-							printf("ERROR: found overlap with GENFREE memory region ");
-							printf("full search in smc GENMALLOC\n");
-							printf("New address %u size %u\n", mmod->mallocdeladd[i],
-									mmod->memallocsize[i]);
-							printf("Conflicting address %u size %u\n", mmod->memptr->address,
-									mmod->memptr->size);
-							mmod->memerror = 8U;
-						}
-					}
-					mmod->memptr++;
-				}
-			}
-		}
-		mmod->memptr = (void *)mmod->memory;
-		newblk = (void *)mmod->memory;
-		for (unsigned int i = 0U; i < mmod->nmemblk; i++) {
-			if (mmod->memptr->valid == 1) {
-				for (unsigned int j = 0U; j < mmod->nmemblk; j++) {
-					if (newblk->valid == 1) {
-						if (((mmod->memptr->address >
-						      newblk->address) && (mmod->memptr->address < (newblk->address + newblk->size)))
-						    || (((mmod->memptr->address + mmod->memptr->size) >
-							 newblk->address) && ((mmod->memptr->address +
-							 mmod->memptr->size) < (newblk->address + newblk->size)))) {
-							printf("ERROR: found overlap in GENFREE memory regions in smc GENMALLOC\n");
-							printf("Region 1 address %u size %u\n", mmod->memptr->address, mmod->memptr->size);
-							printf("Region 2 address %u size %u\n", newblk->address, newblk->size);
-							mmod->memerror = 9U;
-						}
-					}
-					newblk++;
-				}
-			}
-			mmod->memptr++;
-			newblk = (void *)mmod->memory;
+	return (off < TOTALMEMORYSIZE) ? blk_at(mmod, off) : NULL;
+}
+
+/* Mark 'blk' free or used in its header and in the header of the next block */
+static void set_free(struct memmod *mmod, struct memblk *blk, bool free)
+{
+	struct memblk *next = next_phys(mmod, blk);
+
+	if (free) {
+		blk->size |= BLK_FREE;
+	} else {
+		blk->size &= ~BLK_FREE;
+	}
+
+	if (next != NULL) {
+		if (free) {
+			next->size |= BLK_PREV_FREE;
+			next->prev_phys = blk_off(mmod, blk);
+		} else {
+			next->size &= ~BLK_PREV_FREE;
 		}
 	}
-#endif
-	return (void *)mmod->memory + ((TOTALMEMORYSIZE / BLKSPACEDIV)) +
-	       mmod->mallocdeladd[mallocdeladd_pos];
-#ifdef DEBUG_SMC_MALLOC
-	return (void *)mmod->memory + 0x100U + mmod->mallocdeladd[mallocdeladd_pos];
-#endif
+}
+
+void initmem(struct memmod *mmod)
+{
+	struct memblk *blk = blk_at(mmod, 0U);
+
+	mmod->fl_map = 0U;
+	(void)memset(mmod->sl_map, 0, sizeof(mmod->sl_map));
+	(void)memset(mmod->free_head, 0xff, sizeof(mmod->free_head));
+	mmod->used = 0U;
+	mmod->peak = 0U;
+	mmod->nalloc = 0U;
+	mmod->memerror = 0U;
+
+	blk->size = TOTALMEMORYSIZE | BLK_FREE;
+	blk->prev_phys = SMCMALLOC_NONE;
+	insert_free(mmod, blk);
 }
 
 /*
- * Memory free function for memory allocated from malloc function.
- * The memmod structure is
- * required to represent memory image
+ * Generic malloc function requesting memory. The memmod structure is required
+ * to represent memory image. Returns NULL and sets memerror if no free block
+ * is large enough.
  */
-
-int smcfree(void *faddptr,
-	    struct memmod *mmod)
+void *smcmalloc(unsigned int rsize, struct memmod *mmod)
 {
-	unsigned int fadd = faddptr - ((TOTALMEMORYSIZE/BLKSPACEDIV)) -
-			    (void *)mmod->memory;
-	int fentry = 0;
-	struct memblk *newblk = NULL;
-	int incrnmemblk = 0;
+	uint32_t size, rest;
+	unsigned int fl, sl;
+	uint32_t map;
+	struct memblk *blk, *split;
+
+	/* Minimum size is 16 */
+	if (rsize < SMCMALLOC_ALIGN) {
+		rsize = SMCMALLOC_ALIGN;
+	}
+
+	if (rsize > (TOTALMEMORYSIZE - BLK_HDR_SIZE)) {
+		goto nomem;
+	}
+
+	size = (rsize + BLK_HDR_SIZE + BLK_FLAGS) & ~BLK_FLAGS;
 
 	/*
-	 * Scrolling through the malloc attribute table to find entries that match
-	 * the user supplied address
+	 * Find the first non-empty list at or above the one of the rounded up
+	 * size: first in the same first level, then in the next ones.
 	 */
+	mapping(round_up_list(size), &fl, &sl);
+	if (fl >= SMCMALLOC_FL_COUNT) {
+		goto nomem;
+	}
 
-
-	for (unsigned int i = 0U; i < mmod->cntdeladd; i++) {
-		if ((fadd == mmod->mallocdeladd[i]) &&
-		    (mmod->mallocdeladd_valid[i] == 1U)) {
-			fentry = 1;
-			if (mmod->trailblock[i] != NULL) {
-				if ((mmod->precblock[i]->address + mmod->precblock[i]->size) == fadd) {
-
-					/*
-					 * Found matching attribute block and then proceed to merge with
-					 * surrounding blocks
-					 */
-
-					mmod->precblock[i]->size += mmod->memallocsize[i] + mmod->trailblock[i]->size;
-					mmod->memblkqueue[mmod->ptrmemblkqueue] = mmod->trailblock[i];
-					mmod->ptrmemblkqueue++;
-					if (mmod->ptrmemblkqueue >= mmod->maxmemblk) {
-						printf("ERROR: GENMALLOC size exceeded in memory block queue\n");
-						exit(1);
-					}
-					mmod->trailblock[i]->valid = 0;
-					newblk = mmod->precblock[i];
-					mmod->memptr = (void *)mmod->memory;
-
-					/*
-					 * Scrolling through the malloc attribute table to find entries that have values that
-					 * match the newly merged block and replace them with it
-					 */
-
-					for (unsigned int j = 0U; j < mmod->nmemblk; j++) {
-						if (mmod->memptr->valid == 1) {
-							if ((mmod->trailblock[i]->address + mmod->trailblock[i]->size) == mmod->memptr->address) {
-								if ((mmod->memptr->size == 0U) &&
-								    (mmod->trailblock[i]->size != 0U)) {
-									mmod->memptr->valid = 0;
-									mmod->memblkqueue[mmod->ptrmemblkqueue] = mmod->memptr;
-									mmod->ptrmemblkqueue++;
-									if (mmod->ptrmemblkqueue >= mmod->maxmemblk) {
-										printf("ERROR: GENMALLOC size exceeded in memory block queue\n");
-										exit(1);
-									}
-								}
-							}
-						}
-						mmod->memptr++;
-					}
-				}
-			}
-
-			/*
-			 * Setting table parameters
-			 */
-
-			mmod->mallocdeladd_valid[i] = 0U;
-			mmod->mallocdeladd_queue[mmod->mallocdeladd_queue_cnt] = i;
-			mmod->mallocdeladd_queue_cnt++;
-			if (mmod->mallocdeladd_queue_cnt >= mmod->maxmemblk) {
-				printf("ERROR: GENMALLOC reuse queue size exceeded\n");
-				exit(1);
-			}
-
-			/*
-			 * Scrolling through the malloc attribute table to find entries
-			 * that have values that
-			 * match the newly merged block and replace them with it
-			 */
-
-			unsigned int faddGENFREE = newblk->address + newblk->size;
-			for (unsigned int j = 0U; j < mmod->cntdeladd; j++) {
-				if ((faddGENFREE == mmod->mallocdeladd[j]) &&
-				    (mmod->mallocdeladd_valid[j] == 1U))
-					mmod->precblock[j] = newblk;
-				if ((faddGENFREE ==
-				     (mmod->mallocdeladd[j] +
-				      mmod->memallocsize[i])) &&
-				    (mmod->mallocdeladd_valid[j] == 1U))
-					mmod->trailblock[j] = newblk;
-			}
+	map = mmod->sl_map[fl] & (~0U << sl);
+	if (map == 0U) {
+		map = (fl + 1U < 32U) ? (mmod->fl_map & (~0U << (fl + 1U))) : 0U;
+		if (map == 0U) {
+			goto nomem;
 		}
+		fl = ffs32(map);
+		map = mmod->sl_map[fl];
 	}
-	if (incrnmemblk == 1) {
-		mmod->nmemblk++;
-		mmod->memptrend++;
-		if (mmod->nmemblk >=
-		    ((TOTALMEMORYSIZE / BLKSPACEDIV) / sizeof(struct memblk))) {
-			printf("SMC GENFREE exceeded block limit of %ld\n",
-					((TOTALMEMORYSIZE / BLKSPACEDIV) / sizeof(struct memblk)));
-			exit(1);
-		}
+	sl = ffs32(map);
+
+	blk = blk_at(mmod, mmod->free_head[fl][sl]);
+	remove_free(mmod, blk);
+
+	/* Give the end of the block back if it can hold another block */
+	rest = blk_size(blk) - size;
+	if (rest >= BLK_MIN_SIZE) {
+		blk->size = size | (blk->size & BLK_PREV_FREE);
+		split = blk_at(mmod, blk_off(mmod, blk) + size);
+		split->size = rest;
+		set_free(mmod, split, true);
+		insert_free(mmod, split);
 	}
-	if (fentry == 0) {
-		printf("ERROR: smcGENFREE cannot find address to GENFREE %u\n", fadd);
-		exit(1);
+	set_free(mmod, blk, false);
+
+	mmod->used += blk_size(blk);
+	mmod->nalloc++;
+	if (mmod->used > mmod->peak) {
+		mmod->peak = mmod->used;
 	}
-#ifdef DEBUG_SMC_MALLOC
+
+	return (char *)blk + BLK_HDR_SIZE;
+
+nomem:
+	printf("ERROR: SMC GENMALLOC did not find memory region, size is %u\n",
+	       rsize);
+	mmod->memerror = SMCMALLOC_ERR_NOMEM;
+	return NULL;
+}
 
 /*
- * Debug functions
+ * Memory free function for memory allocated from malloc function. The freed
+ * block is merged with the free blocks around it. Returns -1 and sets memerror
+ * if the address was not returned by smcmalloc() or was already freed.
  */
+int smcfree(void *faddptr, struct memmod *mmod)
+{
+	uintptr_t fadd = (uintptr_t)faddptr - (uintptr_t)mmod->memory;
+	struct memblk *blk, *prev, *next;
+
+	if ((faddptr == NULL) || (fadd < BLK_HDR_SIZE) ||
+	    (fadd >= TOTALMEMORYSIZE) || ((fadd & BLK_FLAGS) != 0U)) {
+		goto badfree;
+	}
 
-	if (mmod->checkadd == 1) {
-		for (unsigned int i = 0U; i < mmod->checknumentries; i++) {
-			if (fadd == mmod->checksa[i]) {
-				mmod->checksa[i] = 0U;
-				mmod->checkea[i] = 0U;
-			}
+	blk = blk_at(mmod, (uint32_t)fadd - BLK_HDR_SIZE);
+	if (((blk->size & BLK_FREE) != 0U) || (blk_size(blk) < BLK_MIN_SIZE) ||
+	    (blk_size(blk) > (TOTALMEMORYSIZE - blk_off(mmod, blk)))) {
+		goto badfree;
+	}
+
+	mmod->used -= blk_size(blk);
+	mmod->nalloc--;
+
+	next = next_phys(mmod, blk);
+	if ((next != NULL) && ((next->size & BLK_FREE) != 0U)) {
+		remove_free(mmod, next);
+		blk->size += blk_size(next);
+	}
+
+	if ((blk->size & BLK_PREV_FREE) != 0U) {
+		prev = blk_at(mmod, blk->prev_phys);
+		remove_free(mmod, prev);
+		prev->size += blk_size(blk);
+		blk = prev;
+	}
+
+	set_free(mmod, blk, true);
+	insert_free(mmod, blk);
+
+	return 0;
+
+badfree:
+	printf("ERROR: smcGENFREE cannot find address to GENFREE %p\n",
+	       faddptr);
+	mmod->memerror = SMCMALLOC_ERR_BADFREE;
+	return -1;
+}
+
+void smcmalloc_stats(const struct memmod *mmod, struct smcmalloc_stats *stats)
+{
+	const struct memblk *blk;
+	uint32_t off, size;
+
+	(void)memset(stats, 0, sizeof(*stats));
+	stats->used = mmod->used;
+	stats->peak = mmod->peak;
+	stats->nalloc = mmod->nalloc;
+
+	for (off = 0U; off < TOTALMEMORYSIZE; off += size) {
+		blk = (const struct memblk *)(const void *)&mmod->memory[off];
+		size = blk_size(blk);
+		if ((blk->size & BLK_FREE) == 0U) {
+			continue;
 		}
-		mmod->memptr = (void *)mmod->memory;
-		newblk = (void *)mmod->memory;
-		for (unsigned int i = 0U; i < mmod->nmemblk; i++) {
-			if (mmod->memptr->valid == 1) {
-				for (unsigned int j = 0U; j < mmod->nmemblk; j++) {
-					if (newblk->valid == 1) {
-						if (((mmod->memptr->address > newblk->address)
-						     && (mmod->memptr->address < (newblk->address + newblk->size)))
-						    || (((mmod->memptr->address + mmod->memptr->size) > newblk->address)
-							&& ((mmod->memptr->address + mmod->memptr->size) < ((newblk->address + newblk->size))))) {
-							printf("ERROR: found overlap in GENFREE memory regions in smc GENMALLOC\n");
-							printf("Region 1 address %u size %u\n", mmod->memptr->address, mmod->memptr->size);
-							printf("Region 2 address %u size %u\n", newblk->address, newblk->size);
-						}
-					}
-					newblk++;
-				}
-			}
-			mmod->memptr++;
-			newblk = (void *)mmod->memory;
+
+		stats->free += size;
+		stats->free_blocks++;
+		if ((size - BLK_HDR_SIZE) > stats->largest_free) {
+			stats->largest_free = size - BLK_HDR_SIZE;
 		}
 	}
-#endif
-	return 0;
+
+	if (stats->free != 0U) {
+		stats->fragmentation = 100U - (((stats->largest_free +
+					BLK_HDR_SIZE) * 100U) / stats->free);
+	}
 }
 
 /*
- * Diplay malloc tables for debug purposes
+ * Display the memory blocks for debug purposes
  */
-
 #ifdef DEBUG_SMC_MALLOC
 void displayblocks(struct memmod *mmod)
 {
-	mmod->memptr = (void *)mmod->memory;
-	printf("Displaying blocks:\n");
-	for (unsigned int i = 0U; i < mmod->nmemblk; i++) {
-		if (mmod->memptr->valid == 1) {
-			printf("*********************************************************************************************\n");
-			printf("%u * Address: %u * Size: %u * Valid: %u *\n", i, mmod->memptr->address, mmod->memptr->size, mmod->memptr->valid);
-		}
-		mmod->memptr++;
-	}
-}
+	struct memblk *blk;
 
-void displaymalloctable(struct memmod *mmod)
-{
-	printf("\n\nDisplaying GENMALLOC table\n");
-	for (unsigned int i = 0U; i < mmod->cntdeladd; i++) {
-		if (mmod->mallocdeladd_valid[i] == 1U) {
-			printf("**********************************************************************************************\n");
-			printf("GENMALLOC Address: %u\n", mmod->mallocdeladd[i]);
-			printf("**********************************************************************************************\n");
-			printf("GENMALLOC Size: %u\n", mmod->memallocsize[i]);
-			printf("**********************************************************************************************\n");
-			if (mmod->trailblock[i] != NULL) {
-				printf("Trail Block:\n");
-				printf("* Address: %u * Size: %u *\n",
-				       mmod->trailblock[i]->address,
-				       mmod->trailblock[i]->size);
-			}
-			printf("**********************************************************************************************\n");
-			if (mmod->precblock[i] != NULL) {
-				printf("Previous Block:\n");
-				printf("* Address: %u * Size: %u *\n",
-				       mmod->precblock[i]->address,
-				       mmod->precblock[i]->size);
-			}
-			printf("**********************************************************************************************\n\n\n");
-		}
+	printf("Displaying blocks:\n");
+	for (blk = blk_at(mmod, 0U); blk != NULL; blk = next_phys(mmod, blk)) {
+		printf("* Address: %u * Size: %u * Free: %u *\n",
+		       blk_off(mmod, blk), blk_size(blk),
+		       blk->size & BLK_FREE);
 	}
 }
 #endif
@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Host unit test of the SMC fuzzer allocator, built and run with
+ * "make smcmalloc_test". Random allocations and frees are checked against a
+ * shadow table for alignment, overlaps and corruption of the allocated data,
+ * and the memory image must be back to a single free block at the end.
+ */
+
+#include "smcmalloc.h"
+
+#define TEST_ALLOCS	256U
+#define TEST_ROUNDS	200000U
+
+static struct memmod mmod;
+
+static struct {
+	unsigned char *ptr;
+	unsigned int size;
+	unsigned char fill;
+} allocs[TEST_ALLOCS];
+
+static unsigned int failures;
+
+#define CHECK(_cond)							\
+	do {								\
+		if (!(_cond)) {						\
+			printf("%s:%d: check failed: %s\n", __FILE__,	\
+			       __LINE__, #_cond);			\
+			failures++;					\
+		}							\
+	} while (0)
+
+static uint32_t rng = 0x12345678U;
+
+static uint32_t test_rand(void)
+{
+	rng ^= rng << 13;
+	rng ^= rng >> 17;
+	rng ^= rng << 5;
+
+	return rng;
+}
+
+/* Mostly small sizes, as the fuzzer uses, with some large ones */
+static unsigned int test_size(void)
+{
+	switch (test_rand() % 8U) {
+	case 0U:
+		return test_rand() % 4096U;
+	case 1U:
+		return test_rand() % 1024U;
+	default:
+		return test_rand() % 128U;
+	}
+}
+
+static void check_data(unsigned int i)
+{
+	for (unsigned int j = 0U; j < allocs[i].size; j++) {
+		if (allocs[i].ptr[j] != allocs[i].fill) {
+			printf("allocation %u corrupted at byte %u\n", i, j);
+			failures++;
+			return;
+		}
+	}
+}
+
+static void check_overlaps(void)
+{
+	for (unsigned int i = 0U; i < TEST_ALLOCS; i++) {
+		for (unsigned int j = i + 1U; j < TEST_ALLOCS; j++) {
+			if ((allocs[i].ptr == NULL) || (allocs[j].ptr == NULL)) {
+				continue;
+			}
+			CHECK((allocs[i].ptr + allocs[i].size <= allocs[j].ptr) ||
+			      (allocs[j].ptr + allocs[j].size <= allocs[i].ptr));
+		}
+	}
+}
+
+static void test_random(void)
+{
+	struct smcmalloc_stats stats;
+	unsigned int i, live = 0U, failed = 0U;
+
+	initmem(&mmod);
+
+	for (unsigned int round = 0U; round < TEST_ROUNDS; round++) {
+		i = test_rand() % TEST_ALLOCS;
+
+		if (allocs[i].ptr != NULL) {
+			check_data(i);
+			CHECK(smcfree(allocs[i].ptr, &mmod) == 0);
+			allocs[i].ptr = NULL;
+			live--;
+			continue;
+		}
+
+		allocs[i].size = test_size();
+		allocs[i].fill = (unsigned char)test_rand();
+		allocs[i].ptr = smcmalloc(allocs[i].size, &mmod);
+		if (allocs[i].ptr == NULL) {
+			/* The image may be full, not an error */
+			mmod.memerror = 0U;
+			failed++;
+			continue;
+		}
+
+		CHECK(((uintptr_t)allocs[i].ptr % SMCMALLOC_ALIGN) == 0U);
+		CHECK((allocs[i].ptr >= (unsigned char *)mmod.memory) &&
+		      (allocs[i].ptr + allocs[i].size <=
+		       (unsigned char *)mmod.memory + TOTALMEMORYSIZE));
+		(void)memset(allocs[i].ptr, allocs[i].fill, allocs[i].size);
+		live++;
+
+		if ((round % 1024U) == 0U) {
+			check_overlaps();
+		}
+	}
+
+	smcmalloc_stats(&mmod, &stats);
+	CHECK(stats.nalloc == live);
+	CHECK((stats.used + stats.free) == TOTALMEMORYSIZE);
+	printf("%u live allocations, %u failed, used %u, peak %u, "
+	       "%u free blocks, largest %u, fragmentation %u%%\n",
+	       live, failed, stats.used, stats.peak, stats.free_blocks,
+	       stats.largest_free, stats.fragmentation);
+
+	for (i = 0U; i < TEST_ALLOCS; i++) {
+		if (allocs[i].ptr != NULL) {
+			check_data(i);
+			CHECK(smcfree(allocs[i].ptr, &mmod) == 0);
+			allocs[i].ptr = NULL;
+		}
+	}
+
+	/* Everything merged back */
+	smcmalloc_stats(&mmod, &stats);
+	CHECK(stats.used == 0U);
+	CHECK(stats.nalloc == 0U);
+	CHECK(stats.free_blocks == 1U);
+	CHECK(stats.fragmentation == 0U);
+	CHECK(stats.largest_free == (TOTALMEMORYSIZE - sizeof(struct memblk)));
+	CHECK(mmod.memerror == 0U);
+}
+
+static void test_errors(void)
+{
+	struct smcmalloc_stats stats;
+	void *p, *q;
+
+	initmem(&mmod);
+
+	/* The whole image in one allocation, then nothing left */
+	smcmalloc_stats(&mmod, &stats);
+	p = smcmalloc(stats.largest_free / 2U, &mmod);
+	CHECK(p != NULL);
+	q = smcmalloc(TOTALMEMORYSIZE, &mmod);
+	CHECK(q == NULL);
+	CHECK(mmod.memerror == SMCMALLOC_ERR_NOMEM);
+
+	/* Double free and foreign pointers are refused */
+	mmod.memerror = 0U;
+	CHECK(smcfree(p, &mmod) == 0);
+	CHECK(smcfree(p, &mmod) == -1);
+	CHECK(mmod.memerror == SMCMALLOC_ERR_BADFREE);
+	CHECK(smcfree(&stats, &mmod) == -1);
+	CHECK(smcfree(NULL, &mmod) == -1);
+
+	/* Zero-sized requests still get a distinct block */
+	p = smcmalloc(0U, &mmod);
+	q = smcmalloc(0U, &mmod);
+	CHECK((p != NULL) && (q != NULL) && (p != q));
+	CHECK(mmod.peak >= mmod.used);
+}
+
+int main(void)
+{
+	test_random();
+	test_errors();
+
+	if (failures != 0U) {
+		printf("smcmalloc_test: %u failures\n", failures);
+		return 1;
+	}
+
+	printf("smcmalloc_test: PASSED\n");
+	return 0;
+}
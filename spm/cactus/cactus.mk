@@ -50,6 +50,7 @@ CACTUS_SOURCES	:=					\
 		cactus_message_loop.c			\
 		cactus_test_cpu_features.c		\
 		cactus_test_direct_messaging.c		\
+		cactus_test_indirect_messaging.c	\
 		cactus_test_interrupts.c		\
 		cactus_test_memory_sharing.c		\
 		cactus_tests_smmuv3.c			\
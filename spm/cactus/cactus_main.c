@@ -52,6 +52,10 @@ static void __dead2 message_loop(ffa_id_t vm_id, struct mailbox_buffers *mb)
 	struct ffa_value ffa_ret;
 	ffa_id_t destination;
 
+	/* The vCPU position doesn't change, get it once for all commands. */
+	unsigned int core_pos = platform_get_core_pos(read_mpidr_el1() &
+						      MPID_MASK);
+
 	/*
 	* This initial wait call is necessary to inform SPMD that
 	* SP initialization has completed. It blocks until receiving
@@ -100,7 +104,7 @@ static void __dead2 message_loop(ffa_id_t vm_id, struct mailbox_buffers *mb)
 			break;
 		}
 
-		if (!cactus_handle_cmd(&ffa_ret, &ffa_ret, mb)) {
+		if (!cactus_handle_cmd(&ffa_ret, &ffa_ret, mb, core_pos)) {
 			break;
 		}
 	}
@@ -315,6 +319,8 @@ void __dead2 cactus_main(bool primary_cold_boot,
 
 	cactus_print_memory_layout(ffa_id);
 
+	cactus_cmd_handlers_init();
+
 	register_secondary_entrypoint();
 	discover_managed_exit_interrupt_id();
 
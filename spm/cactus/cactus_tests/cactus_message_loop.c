@@ -4,6 +4,8 @@
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
+#include <arch_helpers.h>
+#include <assert.h>
 #include <debug.h>
 
 #include <cactus_message_loop.h>
@@ -12,6 +14,12 @@
 #include <events.h>
 #include <platform.h>
 
+/**
+ * Maximum number of command handlers that can be registered in the
+ * ".cactus_handler" section.
+ */
+#define CACTUS_MAX_CMD_HANDLERS		U(32)
+
 /**
  * Counter of the number of handled requests, for each CPU. The number of
  * requests can be accessed from another Cactus SP, or from the normal world
@@ -19,6 +27,16 @@
  */
 static uint32_t requests_counter[PLATFORM_CORE_COUNT];
 
+/**
+ * Number of times each command has been handled, and time spent in its handler
+ * in system counter ticks, for each CPU. Indexed as the sorted command handler
+ * table. Can be accessed using CACTUS_GET_CMD_STATS_CMD.
+ */
+static struct cactus_cmd_stats {
+	uint64_t count;
+	uint64_t ticks;
+} cmd_stats[PLATFORM_CORE_COUNT][CACTUS_MAX_CMD_HANDLERS];
+
 /**
  * Begin and end of command handler table, respectively. Both symbols defined by
  * the linker.
@@ -26,6 +44,9 @@ static uint32_t requests_counter[PLATFORM_CORE_COUNT];
 extern struct cactus_cmd_handler cactus_cmd_handler_begin[];
 extern struct cactus_cmd_handler cactus_cmd_handler_end[];
 
+/* Number of entries in the command handler table. */
+static unsigned int cmd_handlers_count;
+
 #define PRINT_CMD(smc_ret)						\
 	VERBOSE("cmd %lx; args: %lx, %lx, %lx, %lx\n",	 		\
 		smc_ret.arg3, smc_ret.arg4, smc_ret.arg5, 		\
@@ -35,23 +56,88 @@ extern struct cactus_cmd_handler cactus_cmd_handler_end[];
 ffa_id_t g_dir_req_source_id;
 
 /**
- * Traverses command table from section ".cactus_handler", searches for a
- * registered command and invokes the respective handler.
+ * Sorts the command table from section ".cactus_handler" by command id, such
+ * that 'cactus_handle_cmd' can look up a command with a binary search.
+ * Must be called once in the primary cold boot, before the message loop.
+ */
+void cactus_cmd_handlers_init(void)
+{
+	struct cactus_cmd_handler *table = cactus_cmd_handler_begin;
+	struct cactus_cmd_handler tmp;
+	unsigned int i, j;
+
+	cmd_handlers_count = cactus_cmd_handler_end - cactus_cmd_handler_begin;
+
+	if (cmd_handlers_count > CACTUS_MAX_CMD_HANDLERS) {
+		ERROR("Too many command handlers (%u)!\n", cmd_handlers_count);
+		panic();
+	}
+
+	/* The table is small, an insertion sort will do. */
+	for (i = 1U; i < cmd_handlers_count; i++) {
+		tmp = table[i];
+
+		for (j = i; (j > 0U) && (table[j - 1U].id > tmp.id); j--) {
+			table[j] = table[j - 1U];
+		}
+
+		table[j] = tmp;
+	}
+
+	for (i = 1U; i < cmd_handlers_count; i++) {
+		if (table[i - 1U].id == table[i].id) {
+			ERROR("Command %llx registered twice!\n", table[i].id);
+			panic();
+		}
+	}
+}
+
+/**
+ * Binary search of the command id 'cmd' in the sorted command table.
+ * Returns the index of the command in the table, or -1 if not found.
+ */
+static int cactus_cmd_handler_lookup(uint64_t cmd)
+{
+	unsigned int low = 0U;
+	unsigned int high = cmd_handlers_count;
+	unsigned int mid;
+
+	while (low < high) {
+		mid = low + ((high - low) / 2U);
+
+		if (cactus_cmd_handler_begin[mid].id == cmd) {
+			return (int)mid;
+		}
+
+		if (cactus_cmd_handler_begin[mid].id < cmd) {
+			low = mid + 1U;
+		} else {
+			high = mid;
+		}
+	}
+
+	return -1;
+}
+
+/**
+ * Looks up the command in the table from section ".cactus_handler", and invokes
+ * the respective handler. 'core_pos' is the position of the calling vCPU, as
+ * cached by the message loop.
  */
 bool cactus_handle_cmd(struct ffa_value *cmd_args, struct ffa_value *ret,
-		       struct mailbox_buffers *mb)
+		       struct mailbox_buffers *mb, unsigned int core_pos)
 {
 	uint64_t in_cmd;
-
-	/* Get which core it is running from. */
-	unsigned int core_pos = platform_get_core_pos(
-						read_mpidr_el1() & MPID_MASK);
+	uint64_t ticks;
+	int idx;
 
 	if (cmd_args == NULL || ret == NULL) {
 		ERROR("Invalid arguments passed to %s!\n", __func__);
 		return false;
 	}
 
+	assert(core_pos < PLATFORM_CORE_COUNT);
+
 	/* Get the source of the Direct Request message. */
 	if (ffa_func_id(*cmd_args) == FFA_MSG_SEND_DIRECT_REQ_SMC32 ||
 	    ffa_func_id(*cmd_args) == FFA_MSG_SEND_DIRECT_REQ_SMC64) {
@@ -62,23 +148,24 @@ bool cactus_handle_cmd(struct ffa_value *cmd_args, struct ffa_value *ret,
 
 	in_cmd = cactus_get_cmd(*cmd_args);
 
-	for (struct cactus_cmd_handler *it_cmd = cactus_cmd_handler_begin;
-	     it_cmd < cactus_cmd_handler_end;
-	     it_cmd++) {
-		if (it_cmd->id == in_cmd) {
-			*ret = it_cmd->fn(cmd_args, mb);
+	idx = cactus_cmd_handler_lookup(in_cmd);
+	if (idx >= 0) {
+		ticks = syscounter_read();
+		*ret = cactus_cmd_handler_begin[idx].fn(cmd_args, mb);
+		ticks = syscounter_read() - ticks;
 
-			/*
-			 * Increment the number of requests handled in current
-			 * core.
-			 */
-			requests_counter[core_pos]++;
+		/*
+		 * Increment the number of requests handled in current
+		 * core, and account for the time spent in the handler.
+		 */
+		requests_counter[core_pos]++;
+		cmd_stats[core_pos][idx].count++;
+		cmd_stats[core_pos][idx].ticks += ticks;
 
-			return true;
-		}
+		return true;
 	}
 
-	/* Handle special command. */
+	/* Handle special commands. */
 	if (in_cmd == CACTUS_GET_REQ_COUNT_CMD) {
 		uint32_t requests_counter_resp;
 
@@ -94,6 +181,25 @@ bool cactus_handle_cmd(struct ffa_value *cmd_args, struct ffa_value *ret,
 		return true;
 	}
 
+	if (in_cmd == CACTUS_GET_CMD_STATS_CMD) {
+		idx = cactus_cmd_handler_lookup(
+				cactus_get_cmd_stats_id(*cmd_args));
+		if (idx < 0) {
+			*ret = cactus_error_resp(ffa_dir_msg_dest(*cmd_args),
+						 ffa_dir_msg_source(*cmd_args),
+						 CACTUS_ERROR_INVALID);
+			return true;
+		}
+
+		*ret = cactus_send_response(ffa_dir_msg_dest(*cmd_args),
+					    ffa_dir_msg_source(*cmd_args),
+					    CACTUS_SUCCESS,
+					    cmd_stats[core_pos][idx].count,
+					    cmd_stats[core_pos][idx].ticks,
+					    requests_counter[core_pos], 0);
+		return true;
+	}
+
 	*ret = cactus_error_resp(ffa_dir_msg_dest(*cmd_args),
 				 ffa_dir_msg_source(*cmd_args),
 				 CACTUS_ERROR_UNHANDLED);
@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "cactus_message_loop.h"
+#include "cactus_test_cmds.h"
+
+#include <debug.h>
+#include <ffa_helpers.h>
+#include <spm_common.h>
+
+/*
+ * Payload of the last indirect message read. A partition has a single RX
+ * buffer, so there is at most one message to read at a time.
+ */
+static uint8_t msg_payload[FFA_MSG_PAYLOAD_MAX];
+
+CACTUS_CMD_HANDLER(indirect_msg_read, CACTUS_INDIRECT_MSG_READ_CMD)
+{
+	ffa_id_t source = ffa_dir_msg_source(*args);
+	ffa_id_t vm_id = ffa_dir_msg_dest(*args);
+	uint32_t vcpu_id = cactus_indirect_msg_read_get_vcpu(*args);
+	struct ffa_value ret;
+	ffa_id_t sender;
+	size_t size;
+
+	VERBOSE("Partition %x requested to read an indirect message.\n",
+		source);
+
+	/* The SPMC signals the message with the RX buffer full notification. */
+	ret = ffa_notification_get(vm_id, vcpu_id,
+				   FFA_NOTIFICATIONS_FLAG_BITMAP_SPM);
+	if (is_ffa_call_error(ret)) {
+		return cactus_error_resp(vm_id, source, ffa_error_code(ret));
+	}
+
+	if ((ffa_notifications_get_from_spm(ret) &
+	     FFA_NOTIFICATION_RX_BUFFER_FULL) == 0U) {
+		ERROR("RX buffer full notification not pending.\n");
+		return cactus_error_resp(vm_id, source, CACTUS_ERROR_TEST);
+	}
+
+	if (!receive_indirect_message(msg_payload, sizeof(msg_payload),
+				      mb->recv, vm_id, &sender, &size)) {
+		return cactus_error_resp(vm_id, source, CACTUS_ERROR_TEST);
+	}
+
+	return cactus_indirect_msg_read_resp(
+		vm_id, source, sender, (uint32_t)size,
+		cactus_indirect_msg_payload_checksum(msg_payload, size));
+}
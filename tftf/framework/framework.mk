@@ -1,5 +1,5 @@
 #
-# Copyright (c) 2018-2022, Arm Limited. All rights reserved.
+# Copyright (c) 2018-2023, Arm Limited. All rights reserved.
 #
 # SPDX-License-Identifier: BSD-3-Clause
 #
@@ -54,16 +54,21 @@ FRAMEWORK_SOURCES	+=						\
 	lib/events/events.c						\
 	lib/extensions/amu/${ARCH}/amu.c				\
 	lib/extensions/amu/${ARCH}/amu_helpers.S			\
+	lib/extensions/amu/amu_activity.c				\
+	lib/extensions/pmu/pmu.c					\
 	lib/exceptions/irq.c						\
 	lib/locks/${ARCH}/spinlock.S					\
+	lib/percpu/percpu.c						\
 	lib/power_management/hotplug/hotplug.c				\
 	lib/power_management/suspend/${ARCH}/asm_tftf_suspend.S		\
 	lib/power_management/suspend/tftf_suspend.c			\
 	lib/psci/psci.c							\
+	lib/psci/psci_stat_monitor.c					\
 	lib/sdei/sdei.c							\
 	lib/smc/${ARCH}/asm_smc.S					\
 	lib/smc/${ARCH}/smc.c						\
 	lib/trng/trng.c							\
+	lib/trng/trng_health.c						\
         lib/errata_abi/errata_abi.c                                     \
 	lib/trusted_os/trusted_os.c					\
 	lib/utils/mp_printf.c						\
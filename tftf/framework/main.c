@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2022, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -13,11 +13,13 @@
 #include <mmio.h>
 #include <nvm.h>
 #include <pauth.h>
+#include <percpu.h>
 #include <plat_topology.h>
 #include <platform.h>
 #include <platform_def.h>
 #include <power_management.h>
 #include <psci.h>
+#include <psci_stat_monitor.h>
 #include <sgi.h>
 #include <stdint.h>
 #include <string.h>
@@ -33,13 +35,13 @@ extern const char version_string[];
 unsigned int lead_cpu_mpid;
 
 /* Defined in hotplug.c */
-extern volatile test_function_t test_entrypoint[PLATFORM_CORE_COUNT];
+DECLARE_PER_CPU(volatile test_function_t, test_entrypoint);
 
 /* Per-CPU results for the current test */
-static test_result_t test_results[PLATFORM_CORE_COUNT];
+static DEFINE_PER_CPU(test_result_t, test_result);
 
 /* Context ID passed to tftf_psci_cpu_on() */
-static u_register_t cpu_on_ctx_id_arr[PLATFORM_CORE_COUNT];
+static DEFINE_PER_CPU(u_register_t, cpu_on_ctx_id);
 
 static unsigned int test_is_rebooting;
 
@@ -151,10 +153,11 @@ static void prepare_next_test(void)
 
 	/* Populate the test entrypoint for the lead CPU */
 	core_pos = platform_get_core_pos(lead_cpu_mpid);
-	test_entrypoint[core_pos] = (test_function_t) current_testcase()->test;
+	per_cpu(test_entrypoint, core_pos) =
+		(test_function_t) current_testcase()->test;
 
 	for (unsigned int i = 0; i < PLATFORM_CORE_COUNT; ++i)
-		test_results[i] = TEST_RESULT_NA;
+		per_cpu(test_result, i) = TEST_RESULT_NA;
 
 	/* If we're starting a new testsuite, announce it. */
 	test_ref_t test_to_run;
@@ -170,6 +173,10 @@ static void prepare_next_test(void)
 
 	/* TODO: Take a 1st timestamp to be able to measure test duration */
 
+#if PSCI_STAT_MONITOR
+	psci_stat_monitor_test_start();
+#endif
+
 	tftf_set_test_progress(TEST_IN_PROGRESS);
 }
 
@@ -188,7 +195,7 @@ static test_result_t get_overall_test_result(void)
 		cpu_mpid = tftf_get_mpidr_from_node(cpu_node);
 		core_pos = platform_get_core_pos(cpu_mpid);
 
-		switch (test_results[core_pos]) {
+		switch (per_cpu(test_result, core_pos)) {
 		case TEST_RESULT_NA:
 			/* Ignoring */
 			break;
@@ -220,7 +227,7 @@ static test_result_t get_overall_test_result(void)
 
 		default:
 			ERROR("Unknown test result value: %u\n",
-				test_results[core_pos]);
+				per_cpu(test_result, core_pos));
 			panic();
 		}
 	}
@@ -272,6 +279,11 @@ static unsigned int close_test(void)
 	/* Ensure no CPU is still executing the test */
 	assert(tftf_get_ref_cnt() == 0);
 
+#if PSCI_STAT_MONITOR
+	/* Append the PSCI_STAT deltas over the test to its output */
+	psci_stat_monitor_test_end();
+#endif
+
 	/* Save test result in NVM */
 	tftf_testcase_set_result(current_testcase(),
 				get_overall_test_result(),
@@ -363,7 +375,6 @@ static void __dead2 hand_over_to_lead_cpu(void)
 void __dead2 run_tests(void)
 {
 	unsigned int mpid = read_mpidr_el1() & MPID_MASK;
-	unsigned int core_pos = platform_get_core_pos(mpid);
 	unsigned int test_session_finished;
 	unsigned int cpus_cnt;
 
@@ -384,7 +395,7 @@ void __dead2 run_tests(void)
 		 * crashes in the test (and thus, never returns from it), this
 		 * variable will hold the right value.
 		 */
-		test_results[core_pos] = TEST_RESULT_CRASHED;
+		this_cpu(test_result) = TEST_RESULT_CRASHED;
 
 		/*
 		 * Jump to the test entrypoint for this core.
@@ -393,11 +404,11 @@ void __dead2 run_tests(void)
 		 * - For other CPUs, it has been populated by tftf_cpu_on() or
 		 *   tftf_try_cpu_on()
 		 */
-		while (test_entrypoint[core_pos] == 0)
+		while (this_cpu(test_entrypoint) == 0)
 			;
 
-		test_results[core_pos] = test_entrypoint[core_pos]();
-		test_entrypoint[core_pos] = 0;
+		this_cpu(test_result) = this_cpu(test_entrypoint)();
+		this_cpu(test_entrypoint) = 0;
 
 		/*
 		 * Decrement the reference count to indicate that the CPU is not
@@ -435,14 +446,14 @@ u_register_t tftf_get_cpu_on_ctx_id(unsigned int core_pos)
 {
 	assert(core_pos < PLATFORM_CORE_COUNT);
 
-	return cpu_on_ctx_id_arr[core_pos];
+	return per_cpu(cpu_on_ctx_id, core_pos);
 }
 
 void tftf_set_cpu_on_ctx_id(unsigned int core_pos, u_register_t context_id)
 {
 	assert(core_pos < PLATFORM_CORE_COUNT);
 
-	cpu_on_ctx_id_arr[core_pos] = context_id;
+	per_cpu(cpu_on_ctx_id, core_pos) = context_id;
 }
 
 unsigned int tftf_is_rebooted(void)
@@ -532,6 +543,8 @@ void __dead2 tftf_cold_boot_main(void)
 	STATUS status;
 	int rc;
 
+	tftf_percpu_init();
+
 	NOTICE("%s\n", TFTF_WELCOME_STR);
 	NOTICE("%s\n", build_message);
 	NOTICE("%s\n\n", version_string);
@@ -607,6 +620,12 @@ void __dead2 tftf_cold_boot_main(void)
 	 */
 	tftf_init_pstate_framework();
 
+#if PSCI_STAT_MONITOR
+	if (psci_stat_monitor_init() != 0) {
+		WARN("PSCI_STAT is not supported, disabling the monitor\n");
+	}
+#endif
+
 	/* The lead CPU is always the primary core. */
 	lead_cpu_mpid = read_mpidr_el1() & MPID_MASK;
 
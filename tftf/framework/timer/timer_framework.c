@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2020, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -11,6 +11,7 @@
 #include <errno.h>
 #include <irq.h>
 #include <mmio.h>
+#include <percpu.h>
 #include <platform.h>
 #include <platform_def.h>
 #include <power_management.h>
@@ -37,7 +38,7 @@ static const plat_timer_t *plat_timer_info;
 /*
  * Interrupt requested time by cores in terms of absolute time.
  */
-static volatile unsigned long long interrupt_req_time[PLATFORM_CORE_COUNT];
+static DEFINE_PER_CPU(volatile unsigned long long, interrupt_req_time);
 /*
  * Contains the target core number of the timer interrupt.
  */
@@ -54,7 +55,7 @@ static unsigned int systicks_per_ms;
 /*
  * Stores per CPU timer handler invoked on expiration of the requested timeout.
  */
-static irq_handler_t timer_handler[PLATFORM_CORE_COUNT];
+static DEFINE_PER_CPU(irq_handler_t, timer_handler);
 
 /* Helper function */
 static inline unsigned long long get_current_time_ms(void)
@@ -66,7 +67,7 @@ static inline unsigned long long get_current_time_ms(void)
 static inline unsigned long long get_current_prog_time(void)
 {
 	return current_prog_core == INVALID_CORE ?
-		0 : interrupt_req_time[current_prog_core];
+		0 : per_cpu(interrupt_req_time, current_prog_core);
 }
 
 int tftf_initialise_timer(void)
@@ -84,7 +85,7 @@ int tftf_initialise_timer(void)
 
 	/* Initialise the array to max possible time */
 	for (unsigned int i = 0; i < PLATFORM_CORE_COUNT; i++)
-		interrupt_req_time[i] = INVALID_TIME;
+		per_cpu(interrupt_req_time, i) = INVALID_TIME;
 
 	tftf_irq_register_handler(TIMER_IRQ, tftf_timer_framework_handler);
 	arm_gic_set_intr_priority(TIMER_IRQ, GIC_HIGHEST_NS_PRIORITY);
@@ -112,8 +113,8 @@ static inline unsigned int get_lowest_req_core(void)
 	 * to the core with lowest core number
 	 */
 	for (i = 0; i < PLATFORM_CORE_COUNT; i++) {
-		if (interrupt_req_time[i] < lowest_timer) {
-			lowest_timer = interrupt_req_time[i];
+		if (per_cpu(interrupt_req_time, i) < lowest_timer) {
+			lowest_timer = per_cpu(interrupt_req_time, i);
 			lowest_core_req =  i;
 		}
 	}
@@ -147,7 +148,7 @@ int tftf_program_timer(unsigned long time_out_ms)
 
 	core_pos = platform_get_core_pos(read_mpidr_el1());
 	/* A timer interrupt request is already available for the core */
-	assert(interrupt_req_time[core_pos] == INVALID_TIME);
+	assert(per_cpu(interrupt_req_time, core_pos) == INVALID_TIME);
 
 	flags = read_daif();
 	disable_irq();
@@ -163,10 +164,11 @@ int tftf_program_timer(unsigned long time_out_ms)
 	current_time = get_current_time_ms();
 
 	/* Update the requested time */
-	interrupt_req_time[core_pos] = current_time + time_out_ms;
+	per_cpu(interrupt_req_time, core_pos) = current_time + time_out_ms;
 
 	VERBOSE("Need timer interrupt at: %lld current_prog_time:%lld\n"
-			" current time: %lld\n", interrupt_req_time[core_pos],
+			" current time: %lld\n",
+					per_cpu(interrupt_req_time, core_pos),
 					get_current_prog_time(),
 					get_current_time_ms());
 
@@ -176,7 +178,8 @@ int tftf_program_timer(unsigned long time_out_ms)
 	 * requested time and retarget the timer interrupt to the current
 	 * core.
 	 */
-	if ((!get_current_prog_time()) || (interrupt_req_time[core_pos] <
+	if ((!get_current_prog_time()) ||
+	    (per_cpu(interrupt_req_time, core_pos) <
 				(get_current_prog_time() - TIMER_STEP_VALUE))) {
 
 		arm_gic_set_intr_target(TIMER_IRQ, core_pos);
@@ -326,7 +329,7 @@ int tftf_cancel_timer(void)
 {
 	unsigned int core_pos = platform_get_core_pos(read_mpidr_el1());
 	unsigned int next_timer_req_core_pos;
-	unsigned long long current_time;
+	unsigned long long current_time, next_time;
 	u_register_t flags;
 	int rc = 0;
 
@@ -339,7 +342,7 @@ int tftf_cancel_timer(void)
 	disable_irq();
 	spin_lock(&timer_lock);
 
-	interrupt_req_time[core_pos] = INVALID_TIME;
+	per_cpu(interrupt_req_time, core_pos) = INVALID_TIME;
 
 	if (core_pos == current_prog_core) {
 		/*
@@ -377,9 +380,10 @@ int tftf_cancel_timer(void)
 			 * window of TIMER_STEP_VALUE from current time,
 			 * program it to fire after TIMER_STEP_VALUE.
 			 */
-			if (interrupt_req_time[next_timer_req_core_pos] >
-					 current_time + TIMER_STEP_VALUE)
-				rc = PROGRAM_TIMER(interrupt_req_time[next_timer_req_core_pos] - current_time);
+			next_time = per_cpu(interrupt_req_time,
+					    next_timer_req_core_pos);
+			if (next_time > current_time + TIMER_STEP_VALUE)
+				rc = PROGRAM_TIMER(next_time - current_time);
 			else
 				rc = PROGRAM_TIMER(TIMER_STEP_VALUE);
 			VERBOSE("Cancel and program new timer for core_pos: "
@@ -411,14 +415,14 @@ int tftf_timer_framework_handler(void *data)
 	unsigned long long current_time;
 	int rc = 0;
 
-	assert(interrupt_req_time[handler_core_pos] != INVALID_TIME);
+	assert(per_cpu(interrupt_req_time, handler_core_pos) != INVALID_TIME);
 	spin_lock(&timer_lock);
 
 	current_time = get_current_time_ms();
 	/* Check if we interrupt is targeted correctly */
 	assert(handler_core_pos == current_prog_core);
 
-	interrupt_req_time[handler_core_pos] = INVALID_TIME;
+	per_cpu(interrupt_req_time, handler_core_pos) = INVALID_TIME;
 
 	/* Execute the driver handler */
 	if (plat_timer_info->handler)
@@ -438,14 +442,14 @@ int tftf_timer_framework_handler(void *data)
 	 * Execute the handler requested by the core, the handlers for the
 	 * other cores will be executed as part of handling IRQ_WAKE_SGI.
 	 */
-	if (timer_handler[handler_core_pos])
-		timer_handler[handler_core_pos](data);
+	if (per_cpu(timer_handler, handler_core_pos))
+		per_cpu(timer_handler, handler_core_pos)(data);
 
 	/* Send interrupts to all the CPUS in the min time block */
 	for (int i = 0; i < PLATFORM_CORE_COUNT; i++) {
-		if ((interrupt_req_time[i] <=
+		if ((per_cpu(interrupt_req_time, i) <=
 				(current_time + TIMER_STEP_VALUE))) {
-			interrupt_req_time[i] = INVALID_TIME;
+			per_cpu(interrupt_req_time, i) = INVALID_TIME;
 			tftf_send_sgi(IRQ_WAKE_SGI, i);
 		}
 	}
@@ -454,11 +458,11 @@ int tftf_timer_framework_handler(void *data)
 	next_timer_req_core_pos = get_lowest_req_core();
 	if (next_timer_req_core_pos != INVALID_CORE) {
 		/* Check we have not exceeded the time for next core */
-		assert(interrupt_req_time[next_timer_req_core_pos] >
+		assert(per_cpu(interrupt_req_time, next_timer_req_core_pos) >
 							current_time);
 		arm_gic_set_intr_target(TIMER_IRQ, next_timer_req_core_pos);
-		rc = PROGRAM_TIMER(interrupt_req_time[next_timer_req_core_pos]
-				 - current_time);
+		rc = PROGRAM_TIMER(per_cpu(interrupt_req_time,
+					   next_timer_req_core_pos) - current_time);
 	}
 	/* Update current program core to the newer one */
 	current_prog_core = next_timer_req_core_pos;
@@ -474,8 +478,8 @@ int tftf_timer_register_handler(irq_handler_t irq_handler)
 	int ret;
 
 	/* Validate no handler is registered */
-	assert(!timer_handler[core_pos]);
-	timer_handler[core_pos] = irq_handler;
+	assert(!per_cpu(timer_handler, core_pos));
+	per_cpu(timer_handler, core_pos) = irq_handler;
 
 	/*
 	 * Also register same handler to IRQ_WAKE_SGI, as it can be waken
@@ -498,8 +502,8 @@ int tftf_timer_unregister_handler(void)
 	ret = tftf_irq_unregister_handler(IRQ_WAKE_SGI);
 	assert(!ret);
 	/* Validate a handler is registered */
-	assert(timer_handler[core_pos]);
-	timer_handler[core_pos] = 0;
+	assert(per_cpu(timer_handler, core_pos));
+	per_cpu(timer_handler, core_pos) = 0;
 
 	return ret;
 }
@@ -534,7 +538,7 @@ unsigned int tftf_get_timer_step_value(void)
  *
  * 3. The system suspend request was down-graded by firmware and the timer
  * interrupt is targeted to another core which woke up first. In this case,
- * that core will wake us up and the interrupt_req_time[] corresponding to
+ * that core will wake us up and the interrupt_req_time corresponding to
  * our core will be cleared. In this case, no need to do anything as GIC
  * state is preserved.
  *
@@ -551,7 +555,7 @@ void tftf_timer_gic_state_restore(void)
 	arm_gic_intr_enable(TIMER_IRQ);
 
 	/* Check if the programmed core is the woken up core */
-	if (interrupt_req_time[core_pos] == INVALID_TIME) {
+	if (per_cpu(interrupt_req_time, core_pos) == INVALID_TIME) {
 		INFO("The programmed core is not the one woken up\n");
 	} else {
 		current_prog_core = core_pos;
@@ -0,0 +1,327 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <arch_helpers.h>
+#include <assert.h>
+#include <debug.h>
+#include <events.h>
+#include <perf_helpers.h>
+#include <plat_topology.h>
+#include <platform.h>
+#include <power_management.h>
+#include <psci.h>
+#include <string.h>
+#include <test_helpers.h>
+#include <utils_def.h>
+
+void perf_stats_init(struct perf_stats *stats)
+{
+	assert(stats != NULL);
+
+	memset(stats, 0, sizeof(*stats));
+	stats->min = UINT64_MAX;
+}
+
+static unsigned int perf_hist_bucket(uint64_t ticks)
+{
+	unsigned int bucket = 0U;
+
+	while ((ticks != 0ULL) && (bucket < (PERF_HIST_BUCKETS - 1U))) {
+		ticks >>= 1;
+		bucket++;
+	}
+
+	return bucket;
+}
+
+void perf_stats_add(struct perf_stats *stats, uint64_t ticks)
+{
+	stats->count++;
+	stats->sum += ticks;
+
+	if (ticks < stats->min) {
+		stats->min = ticks;
+	}
+
+	if (ticks > stats->max) {
+		stats->max = ticks;
+	}
+
+	stats->hist[perf_hist_bucket(ticks)]++;
+}
+
+void perf_stats_merge(struct perf_stats *dst, const struct perf_stats *src)
+{
+	if (src->count == 0ULL) {
+		return;
+	}
+
+	dst->count += src->count;
+	dst->sum += src->sum;
+	dst->min = MIN(dst->min, src->min);
+	dst->max = MAX(dst->max, src->max);
+
+	for (unsigned int i = 0U; i < PERF_HIST_BUCKETS; i++) {
+		dst->hist[i] += src->hist[i];
+	}
+}
+
+uint64_t perf_stats_avg(const struct perf_stats *stats)
+{
+	if (stats->count == 0ULL) {
+		return 0ULL;
+	}
+
+	return stats->sum / stats->count;
+}
+
+uint64_t perf_stats_percentile(const struct perf_stats *stats,
+			       unsigned int pct)
+{
+	uint64_t target, seen = 0ULL;
+
+	assert((pct > 0U) && (pct <= 100U));
+
+	if (stats->count == 0ULL) {
+		return 0ULL;
+	}
+
+	/* Rank of the sample at the requested percentile, rounded up. */
+	target = ((stats->count * pct) + 99ULL) / 100ULL;
+
+	for (unsigned int i = 0U; i < PERF_HIST_BUCKETS; i++) {
+		seen += stats->hist[i];
+		if (seen >= target) {
+			if (i == 0U) {
+				return 0ULL;
+			}
+			return MIN((1ULL << i) - 1ULL, stats->max);
+		}
+	}
+
+	return stats->max;
+}
+
+uint64_t perf_ticks_to_ns(uint64_t ticks)
+{
+	uint64_t freq = read_cntfrq_el0();
+
+	/* Split the conversion to avoid overflowing on long durations. */
+	return ((ticks / freq) * 1000000000ULL) +
+	       (((ticks % freq) * 1000000000ULL) / freq);
+}
+
+uint64_t perf_rate_per_sec(uint64_t events, uint64_t ticks)
+{
+	if (ticks == 0ULL) {
+		return 0ULL;
+	}
+
+	return (events * read_cntfrq_el0()) / ticks;
+}
+
+void perf_stats_print(const char *name, const struct perf_stats *stats,
+		      bool print_hist)
+{
+	if (stats->count == 0ULL) {
+		printf("%s: no samples\n", name);
+		return;
+	}
+
+	printf("%s: %llu samples, avg %llu ns, min %llu ns, max %llu ns, "
+	       "p50 %llu ns, p99 %llu ns\n", name,
+	       (unsigned long long)stats->count,
+	       (unsigned long long)perf_ticks_to_ns(perf_stats_avg(stats)),
+	       (unsigned long long)perf_ticks_to_ns(stats->min),
+	       (unsigned long long)perf_ticks_to_ns(stats->max),
+	       (unsigned long long)perf_ticks_to_ns(
+					perf_stats_percentile(stats, 50U)),
+	       (unsigned long long)perf_ticks_to_ns(
+					perf_stats_percentile(stats, 99U)));
+
+	if (!print_hist) {
+		return;
+	}
+
+	for (unsigned int i = 0U; i < PERF_HIST_BUCKETS; i++) {
+		if (stats->hist[i] == 0U) {
+			continue;
+		}
+
+		printf("  < %llu ns: %u\n",
+		       (unsigned long long)perf_ticks_to_ns(1ULL << i),
+		       stats->hist[i]);
+	}
+}
+
+/*
+ * Per-run state of perf_run_on_cpus().
+ */
+static test_function_t perf_cpu_fn;
+static event_t perf_cpu_ready[PLATFORM_CORE_COUNT];
+static event_t perf_cpu_done[PLATFORM_CORE_COUNT];
+static event_t perf_cpus_start;
+static volatile bool perf_cpus_abort;
+static unsigned int perf_cpu_pos[PLATFORM_CORE_COUNT];
+
+/* Throughput accounted for by each CPU in the last run */
+static struct perf_throughput perf_cpu_tp[PLATFORM_CORE_COUNT];
+
+static test_result_t perf_cpu_entry(void)
+{
+	unsigned int core_pos = platform_get_core_pos(read_mpidr_el1() &
+						      MPID_MASK);
+	test_result_t ret;
+
+	tftf_send_event(&perf_cpu_ready[core_pos]);
+	tftf_wait_for_event(&perf_cpus_start);
+
+	if (perf_cpus_abort) {
+		ret = TEST_RESULT_SKIPPED;
+	} else {
+		ret = perf_cpu_fn();
+	}
+
+	tftf_send_event(&perf_cpu_done[core_pos]);
+
+	return ret;
+}
+
+test_result_t perf_run_on_cpus(unsigned int cpu_count, test_function_t fn)
+{
+	unsigned int lead_mpid = read_mpidr_el1() & MPID_MASK;
+	unsigned int cpu_node, mpidr;
+	unsigned int started = 0U;
+	test_result_t ret;
+	int32_t psci_ret;
+
+	assert((cpu_count > 0U) && (cpu_count <= PLATFORM_CORE_COUNT));
+	assert(fn != NULL);
+
+	perf_cpu_fn = fn;
+	perf_cpus_abort = false;
+	tftf_init_event(&perf_cpus_start);
+
+	for (unsigned int i = 0U; i < PLATFORM_CORE_COUNT; i++) {
+		tftf_init_event(&perf_cpu_ready[i]);
+		tftf_init_event(&perf_cpu_done[i]);
+		perf_cpu_tp[i].events = 0ULL;
+	}
+
+	for_each_cpu(cpu_node) {
+		if (started == (cpu_count - 1U)) {
+			break;
+		}
+
+		mpidr = tftf_get_mpidr_from_node(cpu_node);
+		if (mpidr == lead_mpid) {
+			continue;
+		}
+
+		psci_ret = tftf_cpu_on(mpidr, (uintptr_t)perf_cpu_entry, 0U);
+		if (psci_ret != PSCI_E_SUCCESS) {
+			ERROR("tftf_cpu_on mpidr 0x%x returns %d\n",
+			      mpidr, psci_ret);
+			ret = TEST_RESULT_FAIL;
+			goto release;
+		}
+
+		perf_cpu_pos[started] = platform_get_core_pos(mpidr);
+		tftf_wait_for_event(&perf_cpu_ready[perf_cpu_pos[started]]);
+		started++;
+	}
+
+	if (started != (cpu_count - 1U)) {
+		ERROR("Only %u CPUs available, %u requested\n", started + 1U,
+		      cpu_count);
+		ret = TEST_RESULT_FAIL;
+		goto release;
+	}
+
+	tftf_send_event_to(&perf_cpus_start, started);
+	ret = fn();
+
+	for (unsigned int i = 0U; i < started; i++) {
+		tftf_wait_for_event(&perf_cpu_done[perf_cpu_pos[i]]);
+	}
+
+	wait_for_non_lead_cpus();
+
+	return ret;
+
+release:
+	/* Release the CPUs that were already powered on without running fn. */
+	perf_cpus_abort = true;
+	dsbsy();
+	tftf_send_event_to(&perf_cpus_start, started);
+	wait_for_non_lead_cpus();
+
+	return ret;
+}
+
+unsigned int perf_next_cpu_count(unsigned int count, unsigned int max)
+{
+	if (count >= max) {
+		return 0U;
+	}
+
+	return MIN(count * 2U, max);
+}
+
+static struct perf_throughput *perf_this_cpu_tp(void)
+{
+	return &perf_cpu_tp[platform_get_core_pos(read_mpidr_el1() &
+						  MPID_MASK)];
+}
+
+void perf_throughput_start(void)
+{
+	perf_this_cpu_tp()->start = syscounter_read();
+}
+
+void perf_throughput_end(uint64_t events)
+{
+	struct perf_throughput *tp = perf_this_cpu_tp();
+
+	tp->end = syscounter_read();
+	tp->events = events;
+}
+
+bool perf_throughput_has_cpu(unsigned int core_pos)
+{
+	assert(core_pos < PLATFORM_CORE_COUNT);
+
+	return perf_cpu_tp[core_pos].events != 0ULL;
+}
+
+void perf_throughput_collect(struct perf_throughput *tp)
+{
+	const struct perf_throughput *cpu;
+
+	tp->start = UINT64_MAX;
+	tp->end = 0ULL;
+	tp->events = 0ULL;
+
+	for (unsigned int i = 0U; i < PLATFORM_CORE_COUNT; i++) {
+		cpu = &perf_cpu_tp[i];
+		if (cpu->events == 0ULL) {
+			continue;
+		}
+
+		tp->start = MIN(tp->start, cpu->start);
+		tp->end = MAX(tp->end, cpu->end);
+		tp->events += cpu->events;
+	}
+
+	if (tp->events == 0ULL) {
+		tp->start = 0ULL;
+	}
+}
+
+uint64_t perf_throughput_rate(const struct perf_throughput *tp)
+{
+	return perf_rate_per_sec(tp->events, tp->end - tp->start);
+}
@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <arch_helpers.h>
+#include <assert.h>
+#include <pmf_helpers.h>
+#include <smccc.h>
+#include <tftf_lib.h>
+
+/* ID of the runtime instrumentation timestamp 'id' */
+#define PMF_RT_INSTR_TID(id)						\
+	(((u_register_t)PMF_ARM_TIF_IMPL_ID << PMF_IMPL_ID_SHIFT) |	\
+	 ((u_register_t)PMF_RT_INSTR_SVC_ID << PMF_SVC_ID_SHIFT) |	\
+	 (u_register_t)(id))
+
+u_register_t pmf_get_ts(u_register_t tid, u_register_t *ts)
+{
+	smc_args args = { 0 };
+	smc_ret_values ret;
+
+	args.fid = PMF_SMC_GET_TIMESTAMP;
+	args.arg1 = tid;
+	args.arg2 = read_mpidr_el1();
+	ret = tftf_smc(&args);
+	*ts = ret.ret1;
+
+	return ret.ret0;
+}
+
+int pmf_rt_instr_get_ts(u_register_t *ts, unsigned int count)
+{
+	assert(count <= PMF_RT_INSTR_TOTAL_IDS);
+
+	for (unsigned int i = 0U; i < count; i++) {
+		if (pmf_get_ts(PMF_RT_INSTR_TID(i), &ts[i]) != 0U) {
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+bool pmf_rt_instr_is_supported(void)
+{
+	u_register_t ts;
+
+	return pmf_get_ts(PMF_RT_INSTR_TID(PMF_RT_INSTR_ENTER_PSCI), &ts) ==
+	       0U;
+}
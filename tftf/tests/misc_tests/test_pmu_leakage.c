@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2019-2020, Arm Limited. All rights reserved.
+ * Copyright (c) 2019-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -47,6 +47,7 @@
 #include <drivers/arm/arm_gic.h>
 #include <irq.h>
 #include <platform.h>
+#include <pmu.h>
 #include <power_management.h>
 #include <sgi.h>
 #include <string.h>
@@ -81,100 +82,30 @@ struct pmu_event_info {
 #define V8_2_DEBUG_ARCH_SUPPORTED DBGDIDR_V8_2_DEBUG_ARCH_SUPPORTED
 #endif
 
-static inline void configure_pmu_cntr0(const uint32_t event)
-{
-	/*
-	 * Disabling the P bit tells the counter to increment at EL1.
-	 * Setting the NSK bit to be different from the P bit further tells the
-	 * counter NOT to increment at non-secure EL1. Combined with the P bit,
-	 * the effect is to tell the counter to increment at secure EL1.
-	 * Setting the M bit to be equal to the P bit tells the counter to
-	 * increment at EL3.
-	 * Disabling the NSH bit tells the counter NOT to increment at
-	 * non-secure EL2.
-	 * Setting the SH bit to be different to the NSH bit tells the counter
-	 * to increment at secure EL2.
-	 * The counter therefore is told to count only at secure EL1, secure EL2
-	 * and EL3. This is to ensure maximum accuracy of the results, since we
-	 * are only interested if the secure world is leaking PMU counters.
-	 */
-	write_pmevtyper0_el0(
-		(read_pmevtyper0_el0() | PMEVTYPER_EL0_NSK_BIT |
-		 PMEVTYPER_EL0_SH_BIT) &
-		~(PMEVTYPER_EL0_P_BIT | PMEVTYPER_EL0_NSH_BIT |
-		  PMEVTYPER_EL0_M_BIT));
-
-	/*
-	 * Write to the EVTCOUNT bits to tell the counter which event to
-	 * monitor.
-	 */
-	write_pmevtyper0_el0(
-		(read_pmevtyper0_el0() & ~PMEVTYPER_EL0_EVTCOUNT_BITS) | event);
-
-	/* Setting the P[n] bit enables counter n */
-	write_pmcntenset_el0(
-		read_pmcntenset_el0() | PMCNTENSET_EL0_P_BIT(0));
-}
-
-static inline void configure_pmu_cycle_cntr(void)
-{
-	/*
-	 * Disabling the P bit tells the counter to increment at EL1.
-	 * Setting the NSK bit to be different from the P bit further tells the
-	 * counter NOT to increment at non-secure EL1. Combined with the P bit,
-	 * the effect is to tell the counter to increment at secure EL1.
-	 * Setting the M bit to be equal to the P bit tells the counter to
-	 * increment at EL3.
-	 * Disabling the NSH bit tells the counter NOT to increment at
-	 * non-secure EL2.
-	 * Setting the SH bit to be different to the NSH bit tells the counter
-	 * to increment at secure EL2.
-	 * The counter therefore is told to count only at secure EL1, secure EL2
-	 * and EL3. This is to ensure maximum accuracy of the results, since we
-	 * are only interested if the secure world is leaking PMU counters.
-	 */
-	write_pmccfiltr_el0(
-		(read_pmccfiltr_el0() | PMCCFILTR_EL0_NSK_BIT |
-		 PMCCFILTR_EL0_SH_BIT) &
-		~(PMCCFILTR_EL0_P_BIT | PMCCFILTR_EL0_NSH_BIT |
-		  PMCCFILTR_EL0_M_BIT));
-
-	/* Setting the C bit enables the cycle counter in the PMU */
-	write_pmcntenset_el0(
-		read_pmcntenset_el0() | PMCNTENSET_EL0_C_BIT);
-
-	/*
-	 * Disabling the DP bit makes the cycle counter increment where
-	 * prohibited by MDCR_EL3.SPME. If higher execution levels don't save
-	 * and restore PMCR_EL0, then PMU information will be leaked.
-	 */
-	write_pmcr_el0(read_pmcr_el0() & ~PMCR_EL0_DP_BIT);
-}
+/*
+ * The counters are told to count only at secure EL1, secure EL2 and EL3. This
+ * is to ensure maximum accuracy of the results, since we are only interested
+ * if the secure world is leaking PMU counters.
+ *
+ * The PMU library also clears the PMCR_EL0.DP bit, which makes the cycle
+ * counter increment where prohibited by MDCR_EL3.SPME. If higher execution
+ * levels don't save and restore PMCR_EL0, then PMU information will be leaked.
+ */
+#define SECURE_FILTER	(PMU_COUNT_S_EL1 | PMU_COUNT_S_EL2 | PMU_COUNT_EL3)
 
-static inline void pmu_enable_counting(void)
-{
-	/*
-	 * Setting the E bit gives [fine-grained] control to the PMCNTENSET_EL0
-	 * register, which controls which counters can increment.
-	 */
-	write_pmcr_el0(read_pmcr_el0() | PMCR_EL0_E_BIT);
-}
+static struct pmu_profile profile;
 
-static unsigned long long profile_invalid_smc(u_register_t (*read_cntr_f)(void))
+static void profile_invalid_smc(struct pmu_profile *prof)
 {
-	unsigned long long evt_cnt;
 	smc_args args = { INVALID_FN };
 
-	evt_cnt = (*read_cntr_f)();
+	pmu_profile_start(prof);
 	tftf_smc(&args);
-	evt_cnt = (*read_cntr_f)() - evt_cnt;
-
-	return evt_cnt;
+	pmu_profile_stop(prof);
 }
 
-static unsigned long long profile_cpu_suspend(u_register_t (*read_cntr_f)(void))
+static void profile_cpu_suspend(struct pmu_profile *prof)
 {
-	unsigned long long evt_cnt;
 	unsigned int power_state;
 	unsigned int stateid;
 
@@ -196,33 +127,32 @@ static unsigned long long profile_cpu_suspend(u_register_t (*read_cntr_f)(void))
 	tftf_send_sgi(IRQ_NS_SGI_0,
 		platform_get_core_pos(read_mpidr_el1() & MPID_MASK));
 
-	evt_cnt = (*read_cntr_f)();
+	pmu_profile_start(prof);
 	tftf_cpu_suspend(power_state);
-	evt_cnt = (*read_cntr_f)() - evt_cnt;
+	pmu_profile_stop(prof);
 
 	/* Unmask the IRQ to let the interrupt handler to execute */
 	enable_irq();
 	isb();
 
 	tftf_irq_disable(IRQ_NS_SGI_0);
-
-	return evt_cnt;
 }
 
-static unsigned long long profile_fast_smc_add(u_register_t (*read_cntr_f)(void))
+static void profile_fast_smc_add(struct pmu_profile *prof)
 {
-	unsigned long long evt_cnt;
 	smc_args args = { TSP_FAST_FID(TSP_ADD), 4, 6 };
 
-	evt_cnt = (*read_cntr_f)();
+	pmu_profile_start(prof);
 	tftf_smc(&args);
-	evt_cnt = (*read_cntr_f)() - evt_cnt;
-
-	return evt_cnt;
+	pmu_profile_stop(prof);
 }
 
-static void measure_event(u_register_t (*read_cntr_func)(void),
-			  unsigned long long (*profile_func)(u_register_t (*read_cntr_f)(void)),
+/*
+ * Profile 'ITERATIONS_CNT' times and gather statistics of the cycles if
+ * 'cycles' is true, else of the first event of 'prof'.
+ */
+static void measure_event(struct pmu_profile *prof, bool cycles,
+			  void (*profile_func)(struct pmu_profile *prof),
 			  struct pmu_event_info *info)
 {
 	unsigned long long evt_cnt;
@@ -235,7 +165,8 @@ static void measure_event(u_register_t (*read_cntr_func)(void),
 	max_cnt = 0;
 
 	for (unsigned int i = 0; i < ITERATIONS_CNT; ++i) {
-		evt_cnt = (*profile_func)(read_cntr_func);
+		(*profile_func)(prof);
+		evt_cnt = cycles ? prof->last_cycles : prof->last[0];
 
 		min_cnt = MIN(min_cnt, evt_cnt);
 		max_cnt = MAX(max_cnt, evt_cnt);
@@ -285,16 +216,16 @@ test_result_t smc_psci_suspend_pc_write_retired(void)
 	return TEST_RESULT_SKIPPED;
 #else
 	struct pmu_event_info baseline, cpu_suspend;
+	uint16_t event = PMU_EV_PC_WRITE_RETIRED;
 
 	SKIP_TEST_IF_ARCH_DEBUG_VERSION_LESS_THAN(V8_2_DEBUG_ARCH_SUPPORTED);
 
-	configure_pmu_cntr0(PMU_EV_PC_WRITE_RETIRED);
-	pmu_enable_counting();
+	pmu_profile_init(&profile, &event, 1U, SECURE_FILTER);
 
 	tftf_testcase_printf("Getting baseline event count:\n");
-	measure_event(read_pmevcntr0_el0, profile_invalid_smc, &baseline);
+	measure_event(&profile, false, profile_invalid_smc, &baseline);
 	tftf_testcase_printf("Profiling PSCI_SUSPEND_PC:\n");
-	measure_event(read_pmevcntr0_el0, profile_cpu_suspend, &cpu_suspend);
+	measure_event(&profile, false, profile_cpu_suspend, &cpu_suspend);
 
 	if (!results_within_allowed_margin(baseline.avg, cpu_suspend.avg))
 		return TEST_RESULT_FAIL;
@@ -317,13 +248,12 @@ test_result_t smc_psci_suspend_cycles(void)
 
 	SKIP_TEST_IF_ARCH_DEBUG_VERSION_LESS_THAN(V8_2_DEBUG_ARCH_SUPPORTED);
 
-	configure_pmu_cycle_cntr();
-	pmu_enable_counting();
+	pmu_profile_init(&profile, NULL, 0U, SECURE_FILTER);
 
 	tftf_testcase_printf("Getting baseline event count:\n");
-	measure_event(read_pmccntr_el0, profile_invalid_smc, &baseline);
+	measure_event(&profile, true, profile_invalid_smc, &baseline);
 	tftf_testcase_printf("Profiling PSCI_SUSPEND_PC:\n");
-	measure_event(read_pmccntr_el0, profile_cpu_suspend, &cpu_suspend);
+	measure_event(&profile, true, profile_cpu_suspend, &cpu_suspend);
 
 	if (!results_within_allowed_margin(baseline.avg, cpu_suspend.avg))
 		return TEST_RESULT_FAIL;
@@ -343,18 +273,18 @@ test_result_t fast_smc_add_pc_write_retired(void)
 	return TEST_RESULT_SKIPPED;
 #else
 	struct pmu_event_info baseline, fast_smc_add;
+	uint16_t event = PMU_EV_PC_WRITE_RETIRED;
 
 	SKIP_TEST_IF_ARCH_DEBUG_VERSION_LESS_THAN(V8_2_DEBUG_ARCH_SUPPORTED);
 
 	SKIP_TEST_IF_TSP_NOT_PRESENT();
 
-	configure_pmu_cntr0(PMU_EV_PC_WRITE_RETIRED);
-	pmu_enable_counting();
+	pmu_profile_init(&profile, &event, 1U, SECURE_FILTER);
 
 	tftf_testcase_printf("Getting baseline event count:\n");
-	measure_event(read_pmevcntr0_el0, profile_invalid_smc, &baseline);
+	measure_event(&profile, false, profile_invalid_smc, &baseline);
 	tftf_testcase_printf("Profiling Fast Add SMC:\n");
-	measure_event(read_pmevcntr0_el0, profile_fast_smc_add, &fast_smc_add);
+	measure_event(&profile, false, profile_fast_smc_add, &fast_smc_add);
 
 	if (!results_within_allowed_margin(baseline.avg, fast_smc_add.avg))
 		return TEST_RESULT_FAIL;
@@ -379,13 +309,12 @@ test_result_t fast_smc_add_cycles(void)
 
 	SKIP_TEST_IF_TSP_NOT_PRESENT();
 
-	configure_pmu_cycle_cntr();
-	pmu_enable_counting();
+	pmu_profile_init(&profile, NULL, 0U, SECURE_FILTER);
 
 	tftf_testcase_printf("Getting baseline event count:\n");
-	measure_event(read_pmccntr_el0, profile_invalid_smc, &baseline);
+	measure_event(&profile, true, profile_invalid_smc, &baseline);
 	tftf_testcase_printf("Profiling Fast Add SMC:\n");
-	measure_event(read_pmccntr_el0, profile_fast_smc_add, &fast_smc_add);
+	measure_event(&profile, true, profile_fast_smc_add, &fast_smc_add);
 
 	if (!results_within_allowed_margin(baseline.avg, fast_smc_add.avg))
 		return TEST_RESULT_FAIL;
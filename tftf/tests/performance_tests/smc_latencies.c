@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -9,11 +9,16 @@
  * The SMC calls used are simple ones (PSCI_VERSION and the Standard Service
  * UID) that involve almost no handling on the EL3 firmware's side so that we
  * come close to measuring the overhead of the SMC itself.
+ *
+ * When a PMU is implemented, the SMCs are also profiled to report the
+ * instructions per cycle, cache and TLB refills of the round trip. Events are
+ * only counted in the secure world if the EL3 firmware allows it.
  */
 
 #include <arch_helpers.h>
 #include <arm_arch_svc.h>
 #include <debug.h>
+#include <pmu.h>
 #include <psci.h>
 #include <smccc.h>
 #include <std_svc.h>
@@ -23,6 +28,7 @@
 
 #define ITERATIONS_CNT 1000
 static unsigned long long raw_results[ITERATIONS_CNT];
+static struct pmu_profile smc_profile;
 
 /* Latency information in nano-seconds */
 struct latency_info {
@@ -52,7 +58,8 @@ static inline unsigned long long cycles_to_ns(unsigned long long cycles)
  *
  * This function also prints some additional, intermediate information, like the
  * number of cycles for each SMC and the average number of cycles for an SMC
- * round trip.
+ * round trip, then sends the SMC 'ITERATIONS_CNT' more times to profile it with
+ * the PMU, so that profiling does not add to the latencies measured.
  */
 static void test_measure_smc_latency(const smc_args *smc_args,
 				     struct latency_info *latency)
@@ -92,6 +99,18 @@ static void test_measure_smc_latency(const smc_args *smc_args,
 		NOTICE("%llu cycles\t%llu ns\n",
 			raw_results[i], cycles_to_ns(raw_results[i]));
 	}
+
+	if (!pmu_is_supported()) {
+		return;
+	}
+
+	pmu_profile_init_default(&smc_profile, PMU_COUNT_ALL);
+	for (unsigned int i = 0; i < ITERATIONS_CNT; ++i) {
+		pmu_profile_start(&smc_profile);
+		tftf_smc(smc_args);
+		pmu_profile_stop(&smc_profile);
+	}
+	pmu_profile_print("PMU profile", &smc_profile);
 }
 
 /*
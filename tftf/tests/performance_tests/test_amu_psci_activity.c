@@ -0,0 +1,270 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * This file contains tests that account for the activity of the CPUs around
+ * PSCI power transitions with the AMU group 0 counters. The share of time a
+ * CPU was active, its effective frequency while active and its memory stall
+ * ratio show how many cycles firmware spends on the idle and hotplug paths.
+ */
+
+#include <amu.h>
+#include <arch_helpers.h>
+#include <debug.h>
+#include <events.h>
+#include <percpu.h>
+#include <perf_helpers.h>
+#include <plat_topology.h>
+#include <platform.h>
+#include <platform_def.h>
+#include <power_management.h>
+#include <psci.h>
+#include <psci_stat_monitor.h>
+#include <tftf_lib.h>
+#include <timer.h>
+
+/* Suspends per CPU and per power state */
+#define AMU_SUSPEND_ITERATIONS		50U
+
+/* Time a CPU stays suspended, in milliseconds */
+#define AMU_SUSPEND_TIME_MS		10U
+
+/* CPU_ON/CPU_OFF cycles per CPU */
+#define AMU_HOTPLUG_ITERATIONS		20U
+
+struct amu_psci_cpu {
+	struct amu_activity standby;
+	struct amu_activity pwrdown;
+	unsigned int discarded;
+};
+
+static DEFINE_PER_CPU(struct amu_psci_cpu, amu_psci_cpu);
+
+/* PSCI_STAT counters before and after the suspend test */
+static struct psci_stat_snapshot stat_before, stat_after;
+
+static event_t hotplug_target_booted;
+
+/*
+ * Suspend the calling CPU to power level 0 in the state of type 'type' and
+ * account for its activity from before the suspend call to after the resume.
+ * A CPU on which this power state is not supported accounts for nothing.
+ */
+static test_result_t suspend_activity(unsigned int type,
+				      struct amu_activity *act,
+				      unsigned int *discarded)
+{
+	struct amu_group0_snapshot start, end;
+	unsigned int stateid, power_state;
+	int ret;
+
+	ret = tftf_psci_make_composite_state_id(PSTATE_AFF_LVL_0, type,
+						&stateid);
+	if (ret != PSCI_E_SUCCESS) {
+		return TEST_RESULT_SUCCESS;
+	}
+
+	power_state = tftf_make_psci_pstate(PSTATE_AFF_LVL_0, type, stateid);
+
+	for (unsigned int i = 0U; i < AMU_SUSPEND_ITERATIONS; i++) {
+		amu_group0_snapshot(&start);
+		ret = tftf_program_timer_and_suspend(AMU_SUSPEND_TIME_MS,
+						     power_state, NULL, NULL);
+		amu_group0_snapshot(&end);
+		tftf_cancel_timer();
+
+		if (ret != 0) {
+			ERROR("Failed to program timer or suspend CPU: 0x%x\n",
+			      ret);
+			return TEST_RESULT_FAIL;
+		}
+
+		if (amu_activity_add(act, &start, &end) != 0) {
+			(*discarded)++;
+		}
+	}
+
+	return TEST_RESULT_SUCCESS;
+}
+
+/* Executed concurrently by all CPUs */
+static test_result_t amu_suspend_cpu(void)
+{
+	struct amu_psci_cpu *cpu = this_cpu_ptr(amu_psci_cpu);
+	test_result_t ret;
+
+	amu_activity_init(&cpu->standby);
+	amu_activity_init(&cpu->pwrdown);
+	cpu->discarded = 0U;
+
+	ret = suspend_activity(PSTATE_TYPE_STANDBY, &cpu->standby,
+			       &cpu->discarded);
+	if (ret != TEST_RESULT_SUCCESS) {
+		return ret;
+	}
+
+	return suspend_activity(PSTATE_TYPE_POWERDOWN, &cpu->pwrdown,
+				&cpu->discarded);
+}
+
+/*
+ * Suspend all CPUs repeatedly to the level 0 standby and powerdown states,
+ * with a timer to wake them up, and print the activity of each CPU from the
+ * suspend call to its return. In a standby state the CPU should mostly be in
+ * WFI, in a powerdown state it should be off. Any active time is spent by the
+ * firmware entering and leaving the state.
+ *
+ * An interval in which a counter went backwards means that EL3 did not
+ * preserve the AMU counters across the suspend. It is discarded and reported.
+ *
+ * If PSCI_STAT is supported, the idle efficiency over the test is reported too.
+ */
+test_result_t test_amu_activity_cpu_suspend(void)
+{
+	struct amu_activity standby, pwrdown;
+	const struct amu_psci_cpu *cpu;
+	unsigned int cpu_node, core_pos;
+	unsigned int discarded = 0U;
+	struct psci_stat_idle idle;
+	bool psci_stat;
+	test_result_t ret;
+
+	if (!amu_group0_enabled()) {
+		return TEST_RESULT_SKIPPED;
+	}
+
+	psci_stat = (psci_stat_monitor_init() == 0);
+	if (psci_stat) {
+		psci_stat_snapshot(&stat_before);
+	}
+
+	ret = perf_run_on_cpus(tftf_get_total_cpus_count(), amu_suspend_cpu);
+	if (ret != TEST_RESULT_SUCCESS) {
+		return ret;
+	}
+
+	if (psci_stat) {
+		psci_stat_snapshot(&stat_after);
+	}
+
+	amu_activity_init(&standby);
+	amu_activity_init(&pwrdown);
+
+	for_each_cpu(cpu_node) {
+		core_pos = platform_get_core_pos(
+				tftf_get_mpidr_from_node(cpu_node));
+		cpu = per_cpu_ptr(amu_psci_cpu, core_pos);
+
+		printf("CPU %u\n", core_pos);
+		amu_activity_print("  Standby", &cpu->standby);
+		amu_activity_print("  Powerdown", &cpu->pwrdown);
+
+		amu_activity_merge(&standby, &cpu->standby);
+		amu_activity_merge(&pwrdown, &cpu->pwrdown);
+		discarded += cpu->discarded;
+	}
+
+	amu_activity_print("All CPUs, standby", &standby);
+	amu_activity_print("All CPUs, powerdown", &pwrdown);
+
+	tftf_testcase_printf("Standby: active %u/1000, powerdown: active "
+			     "%u/1000\n", amu_activity_active_permille(&standby),
+			     amu_activity_active_permille(&pwrdown));
+
+	if (psci_stat) {
+		psci_stat_idle(&stat_before, &stat_after, &idle);
+		tftf_testcase_printf("Idle efficiency %u/1000\n",
+				     psci_stat_idle_efficiency(&idle));
+	}
+
+	if (discarded != 0U) {
+		tftf_testcase_printf("%u intervals discarded, the AMU counters "
+				     "were not preserved\n", discarded);
+	}
+
+	return TEST_RESULT_SUCCESS;
+}
+
+static test_result_t hotplug_target(void)
+{
+	tftf_send_event(&hotplug_target_booted);
+
+	return TEST_RESULT_SUCCESS;
+}
+
+/*
+ * Power each other CPU on and off repeatedly and print the activity of the
+ * lead CPU over each CPU_ON/CPU_OFF cycle, from the CPU_ON call until the
+ * target CPU is reported off. The lead CPU waits for the target in WFE, so its
+ * active time is mostly spent in the CPU_ON and AFFINITY_INFO calls.
+ */
+test_result_t test_amu_activity_cpu_hotplug(void)
+{
+	unsigned int lead_mpid = read_mpidr_el1() & MPID_MASK;
+	struct amu_group0_snapshot start, end;
+	struct amu_activity act, total;
+	unsigned int cpu_node, mpid;
+	unsigned int discarded = 0U;
+	int ret;
+
+	if (!amu_group0_enabled()) {
+		return TEST_RESULT_SKIPPED;
+	}
+
+	amu_activity_init(&total);
+
+	for_each_cpu(cpu_node) {
+		mpid = tftf_get_mpidr_from_node(cpu_node);
+		if (mpid == lead_mpid) {
+			continue;
+		}
+
+		amu_activity_init(&act);
+
+		for (unsigned int i = 0U; i < AMU_HOTPLUG_ITERATIONS; i++) {
+			tftf_init_event(&hotplug_target_booted);
+
+			amu_group0_snapshot(&start);
+
+			ret = tftf_cpu_on(mpid, (uintptr_t)hotplug_target, 0);
+			if (ret != PSCI_E_SUCCESS) {
+				tftf_testcase_printf("Failed to power on CPU "
+						     "0x%x (%d)\n", mpid, ret);
+				return TEST_RESULT_FAIL;
+			}
+
+			tftf_wait_for_event(&hotplug_target_booted);
+
+			while (tftf_psci_affinity_info(mpid, MPIDR_AFFLVL0) !=
+			       PSCI_STATE_OFF) {
+				continue;
+			}
+
+			amu_group0_snapshot(&end);
+
+			if (amu_activity_add(&act, &start, &end) != 0) {
+				discarded++;
+			}
+		}
+
+		printf("CPU %u\n", platform_get_core_pos(mpid));
+		amu_activity_print("  CPU_ON/CPU_OFF, lead CPU", &act);
+
+		amu_activity_merge(&total, &act);
+	}
+
+	amu_activity_print("All CPUs, CPU_ON/CPU_OFF, lead CPU", &total);
+
+	tftf_testcase_printf("Lead CPU active %u/1000, %llu kHz\n",
+			     amu_activity_active_permille(&total),
+			     (unsigned long long)amu_activity_freq_khz(&total));
+
+	if (discarded != 0U) {
+		tftf_testcase_printf("%u intervals discarded\n", discarded);
+	}
+
+	return TEST_RESULT_SUCCESS;
+}
@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * This file contains tests that measure how long it takes to bring CPUs
+ * online with PSCI CPU_ON, when the lead CPU powers them all on and when they
+ * are powered on in a tree by tftf_cpu_on_tree().
+ */
+
+#include <arch_helpers.h>
+#include <debug.h>
+#include <events.h>
+#include <percpu.h>
+#include <perf_helpers.h>
+#include <plat_topology.h>
+#include <platform.h>
+#include <platform_def.h>
+#include <power_management.h>
+#include <psci.h>
+#include <test_helpers.h>
+#include <tftf_lib.h>
+
+/* Bring-ups measured per CPU count and per fanout */
+#define HOTPLUG_PERF_ITERATIONS		10U
+
+/*
+ * Fanouts of the CPU_ON trees measured. A fanout of PLATFORM_CORE_COUNT is
+ * the lead CPU powering all CPUs on itself.
+ */
+static const unsigned int hotplug_perf_fanouts[] = {
+	PLATFORM_CORE_COUNT, 2U, 4U
+};
+
+static event_t cpu_booted[PLATFORM_CORE_COUNT];
+
+/* Time at which each CPU entered the test */
+static DEFINE_PER_CPU(uint64_t, entry_ts);
+
+static u_register_t mpids[PLATFORM_CORE_COUNT];
+static uint64_t issue_ts[PLATFORM_CORE_COUNT];
+
+static test_result_t cpu_entry(void)
+{
+	unsigned int core_pos;
+
+	this_cpu(entry_ts) = syscounter_read();
+
+	core_pos = platform_get_core_pos(read_mpidr_el1() & MPID_MASK);
+	tftf_send_event(&cpu_booted[core_pos]);
+
+	return TEST_RESULT_SUCCESS;
+}
+
+/*
+ * Bring the first 'count' CPUs of 'mpids' online with a tree of 'fanout',
+ * and account for the time until the last of them entered the test in
+ * 'online', and for the time from the CPU_ON call of each CPU to its entry in
+ * the test in 'cpu_on'.
+ */
+static int bring_up(unsigned int count, unsigned int fanout,
+		    struct perf_stats *online, struct perf_stats *cpu_on)
+{
+	uint64_t start, last = 0ULL, entry;
+	unsigned int core_pos;
+	int32_t ret;
+
+	for (unsigned int i = 0U; i < count; i++) {
+		tftf_init_event(&cpu_booted[platform_get_core_pos(mpids[i])]);
+	}
+
+	start = syscounter_read();
+	ret = tftf_cpu_on_tree(mpids, count, fanout, (uintptr_t)cpu_entry, 0U,
+			       issue_ts);
+	if (ret != PSCI_E_SUCCESS) {
+		tftf_testcase_printf("Failed to power on CPUs (%d)\n", ret);
+		return -1;
+	}
+
+	for (unsigned int i = 0U; i < count; i++) {
+		core_pos = platform_get_core_pos(mpids[i]);
+		tftf_wait_for_event(&cpu_booted[core_pos]);
+
+		entry = per_cpu(entry_ts, core_pos);
+		last = MAX(last, entry);
+		perf_stats_add(cpu_on, entry - issue_ts[i]);
+	}
+
+	perf_stats_add(online, last - start);
+
+	/* Wait for all the CPUs to be powered off by the framework */
+	for (unsigned int i = 0U; i < count; i++) {
+		while (tftf_is_cpu_online(mpids[i])) {
+			continue;
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * @Test_Aim@ Measure the time to bring CPUs online as the CPU count grows.
+ *
+ * 1, 2, 4, ... and all the other CPUs are powered on, by the lead CPU and in
+ * trees of fanout 2 and 4 where each CPU powers on its children once it has
+ * booted. For each, the time until all CPUs are online and the latency from
+ * the CPU_ON call of a CPU to its entry in the test are printed.
+ */
+test_result_t test_psci_hotplug_perf(void)
+{
+	unsigned int lead_mpid = read_mpidr_el1() & MPID_MASK;
+	struct perf_stats online, cpu_on;
+	unsigned int cpu_node, cpus_count = 0U;
+	unsigned int count, fanout;
+
+	SKIP_TEST_IF_LESS_THAN_N_CPUS(2);
+
+	for_each_cpu(cpu_node) {
+		mpids[cpus_count] = tftf_get_mpidr_from_node(cpu_node);
+		if (mpids[cpus_count] != lead_mpid) {
+			cpus_count++;
+		}
+	}
+
+	for_each_perf_cpu_count(count, 1U, cpus_count) {
+		printf("%u CPUs\n", count);
+
+		for (unsigned int f = 0U; f < ARRAY_SIZE(hotplug_perf_fanouts);
+		     f++) {
+			fanout = hotplug_perf_fanouts[f];
+			if ((f != 0U) && (fanout >= count)) {
+				/* Same as the lead CPU powering all CPUs on */
+				continue;
+			}
+
+			perf_stats_init(&online);
+			perf_stats_init(&cpu_on);
+
+			for (unsigned int i = 0U; i < HOTPLUG_PERF_ITERATIONS;
+			     i++) {
+				if (bring_up(count, fanout, &online,
+					     &cpu_on) != 0) {
+					return TEST_RESULT_FAIL;
+				}
+			}
+
+			if (f == 0U) {
+				printf("  Lead CPU:\n");
+			} else {
+				printf("  Tree of fanout %u:\n", fanout);
+			}
+			perf_stats_print("    All online", &online, false);
+			perf_stats_print("    CPU_ON to entry", &cpu_on, false);
+
+			tftf_testcase_printf("%u CPUs, fanout %u: all online "
+				"in %llu ns\n", count, MIN(fanout, count),
+				(unsigned long long)perf_ticks_to_ns(
+						perf_stats_avg(&online)));
+		}
+	}
+
+	return TEST_RESULT_SUCCESS;
+}
@@ -0,0 +1,232 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * This file contains a test that breaks the time of a system suspend and
+ * resume down into stages, from the timestamps taken by tftf_suspend() and,
+ * when the firmware is built with runtime instrumentation, the PMF timestamps
+ * of the PSCI call.
+ */
+
+#include <arch_helpers.h>
+#include <debug.h>
+#include <drivers/arm/arm_gic.h>
+#include <perf_helpers.h>
+#include <platform.h>
+#include <platform_def.h>
+#include <pmf_helpers.h>
+#include <power_management.h>
+#include <psci.h>
+#include <tftf_lib.h>
+#include <timer.h>
+
+/* PMF runtime instrumentation timestamps used by this test */
+#define TOTAL_IDS		(PMF_RT_INSTR_EXIT_HW_LOW_PWR + 1)
+
+/* System suspends measured */
+#define SYS_SUSPEND_ITERATIONS	10U
+
+struct sys_suspend_breakdown {
+	struct perf_stats ns_save;	/* NS context save, except the GIC */
+	struct perf_stats gic_save;	/* GIC distributor save */
+	struct perf_stats suspend;	/* PSCI call to low power entry */
+	struct perf_stats fw_resume;	/* Low power exit to PSCI exit */
+	struct perf_stats warm_boot;	/* PSCI exit to NS resume path */
+	struct perf_stats fw_total;	/* PSCI call to NS resume path */
+	struct perf_stats ns_restore;	/* NS context restore */
+	unsigned int gic_save_mmio;	/* GIC context MMIO accesses */
+	unsigned int gic_restore_mmio;
+	unsigned int invalid;		/* Suspends without PMF timestamps */
+};
+
+static volatile unsigned int wakeup_irq_rcvd;
+
+static int suspend_wakeup_handler(void *data)
+{
+	wakeup_irq_rcvd = 1U;
+
+	return 0;
+}
+
+/*
+ * Widen a PMF timestamp taken after the system counter value 'ref' to 64 bits.
+ * The timestamps are truncated to the register width on AArch32.
+ */
+static uint64_t pmf_ts_after(u_register_t ts, uint64_t ref)
+{
+	return ref + (u_register_t)(ts - (u_register_t)ref);
+}
+
+/*
+ * Account for the stages of the last suspend in 'b'. The PSCI call is split at
+ * the PMF timestamps when they were taken during this suspend.
+ */
+static void account_stages(struct sys_suspend_breakdown *b, bool rt_instr)
+{
+	suspend_stages_t stages;
+	u_register_t raw_ts[TOTAL_IDS];
+	uint64_t ts[TOTAL_IDS];
+	unsigned int save_mmio, restore_mmio;
+	uint64_t gic_save;
+
+	tftf_get_suspend_stages(&stages);
+
+	arm_gic_get_context_mmio_accesses(&save_mmio, &restore_mmio);
+	b->gic_save_mmio += save_mmio;
+	b->gic_restore_mmio += restore_mmio;
+
+	gic_save = stages.gic_save_end - stages.gic_save_start;
+	perf_stats_add(&b->ns_save, stages.smc - stages.start - gic_save);
+	perf_stats_add(&b->gic_save, gic_save);
+	perf_stats_add(&b->fw_total, stages.resume - stages.smc);
+	perf_stats_add(&b->ns_restore, stages.end - stages.resume);
+
+	if (!rt_instr) {
+		return;
+	}
+
+	if (pmf_rt_instr_get_ts(raw_ts, TOTAL_IDS) != 0) {
+		b->invalid++;
+		return;
+	}
+
+	for (unsigned int i = 0U; i < TOTAL_IDS; i++) {
+		ts[i] = pmf_ts_after(raw_ts[i], stages.smc);
+	}
+
+	if (!((stages.smc <= ts[PMF_RT_INSTR_ENTER_PSCI]) &&
+	      (ts[PMF_RT_INSTR_ENTER_PSCI] <=
+	       ts[PMF_RT_INSTR_ENTER_HW_LOW_PWR]) &&
+	      (ts[PMF_RT_INSTR_ENTER_HW_LOW_PWR] <=
+	       ts[PMF_RT_INSTR_EXIT_HW_LOW_PWR]) &&
+	      (ts[PMF_RT_INSTR_EXIT_HW_LOW_PWR] <=
+	       ts[PMF_RT_INSTR_EXIT_PSCI]) &&
+	      (ts[PMF_RT_INSTR_EXIT_PSCI] <= stages.resume))) {
+		b->invalid++;
+		return;
+	}
+
+	perf_stats_add(&b->suspend,
+		       ts[PMF_RT_INSTR_ENTER_HW_LOW_PWR] - stages.smc);
+	perf_stats_add(&b->fw_resume, ts[PMF_RT_INSTR_EXIT_PSCI] -
+				      ts[PMF_RT_INSTR_EXIT_HW_LOW_PWR]);
+	perf_stats_add(&b->warm_boot,
+		       stages.resume - ts[PMF_RT_INSTR_EXIT_PSCI]);
+}
+
+/*
+ * @Test_Aim@ Break the time of a system suspend and resume down into stages.
+ *
+ * The lead CPU suspends the system repeatedly with a timer to wake it up, and
+ * the latency of each stage is printed: the save of the NS context and of the
+ * GIC distributor, the PSCI call and the firmware resume, and the restore of
+ * the NS context, with the MMIO accesses made to save and restore the GIC
+ * context. The PSCI call stages are split at the PMF runtime instrumentation
+ * timestamps if the firmware provides them, otherwise the time from the PSCI
+ * call to the NS resume path, which includes the time spent suspended, is
+ * printed as a whole.
+ */
+test_result_t test_psci_system_suspend_breakdown(void)
+{
+	static struct sys_suspend_breakdown b;
+	int timer_ret, psci_ret;
+	bool rt_instr;
+
+	if (tftf_get_psci_feature_info(SMC_PSCI_SYSTEM_SUSPEND) !=
+	    PSCI_E_SUCCESS) {
+		tftf_testcase_printf("System suspend is not supported "
+				     "by the EL3 firmware\n");
+		return TEST_RESULT_SKIPPED;
+	}
+
+	rt_instr = pmf_rt_instr_is_supported();
+
+	perf_stats_init(&b.ns_save);
+	perf_stats_init(&b.gic_save);
+	perf_stats_init(&b.suspend);
+	perf_stats_init(&b.fw_resume);
+	perf_stats_init(&b.warm_boot);
+	perf_stats_init(&b.fw_total);
+	perf_stats_init(&b.ns_restore);
+	b.gic_save_mmio = 0U;
+	b.gic_restore_mmio = 0U;
+	b.invalid = 0U;
+
+	tftf_timer_register_handler(suspend_wakeup_handler);
+
+	for (unsigned int i = 0U; i < SYS_SUSPEND_ITERATIONS; i++) {
+		wakeup_irq_rcvd = 0U;
+
+		tftf_program_timer_and_sys_suspend(PLAT_SUSPEND_ENTRY_TIME,
+						   &timer_ret, &psci_ret);
+
+		while (wakeup_irq_rcvd == 0U) {
+			continue;
+		}
+
+		if (timer_ret != 0) {
+			tftf_testcase_printf("Timer programming failed with "
+					     "return value %i\n", timer_ret);
+			tftf_timer_unregister_handler();
+			return TEST_RESULT_FAIL;
+		}
+
+		if (psci_ret != PSCI_E_SUCCESS) {
+			tftf_testcase_printf("System suspend failed with "
+					     "return value %i\n", psci_ret);
+			tftf_timer_unregister_handler();
+			return TEST_RESULT_FAIL;
+		}
+
+		account_stages(&b, rt_instr);
+	}
+
+	tftf_cancel_timer();
+	tftf_timer_unregister_handler();
+
+	perf_stats_print("NS context save", &b.ns_save, false);
+	perf_stats_print("GIC distributor save", &b.gic_save, false);
+	if (b.suspend.count != 0ULL) {
+		perf_stats_print("PSCI call to low power", &b.suspend, false);
+		perf_stats_print("Firmware resume", &b.fw_resume, false);
+		perf_stats_print("PSCI exit to NS resume", &b.warm_boot,
+				 false);
+	}
+	perf_stats_print("PSCI call to NS resume", &b.fw_total, false);
+	perf_stats_print("NS context restore", &b.ns_restore, false);
+	printf("GIC context MMIO accesses per suspend: %u save, %u restore\n",
+	       b.gic_save_mmio / SYS_SUSPEND_ITERATIONS,
+	       b.gic_restore_mmio / SYS_SUSPEND_ITERATIONS);
+
+	if (!rt_instr) {
+		printf("No PMF runtime instrumentation, the PSCI call is not "
+		       "broken down\n");
+	} else if (b.invalid != 0U) {
+		tftf_testcase_printf("%u suspends without valid PMF "
+				     "timestamps\n", b.invalid);
+	}
+
+	tftf_testcase_printf("Save %llu ns (GIC %llu ns), restore %llu ns\n",
+		(unsigned long long)perf_ticks_to_ns(
+			perf_stats_avg(&b.ns_save) +
+			perf_stats_avg(&b.gic_save)),
+		(unsigned long long)perf_ticks_to_ns(
+			perf_stats_avg(&b.gic_save)),
+		(unsigned long long)perf_ticks_to_ns(
+			perf_stats_avg(&b.ns_restore)));
+	if (b.suspend.count != 0ULL) {
+		tftf_testcase_printf("Firmware suspend %llu ns, resume %llu "
+			"ns, warm boot %llu ns\n",
+			(unsigned long long)perf_ticks_to_ns(
+				perf_stats_avg(&b.suspend)),
+			(unsigned long long)perf_ticks_to_ns(
+				perf_stats_avg(&b.fw_resume)),
+			(unsigned long long)perf_ticks_to_ns(
+				perf_stats_avg(&b.warm_boot)));
+	}
+
+	return TEST_RESULT_SUCCESS;
+}
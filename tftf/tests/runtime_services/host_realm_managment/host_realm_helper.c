@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2022, Arm Limited. All rights reserved.
+ * Copyright (c) 2022-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -9,25 +9,20 @@
 
 #include <arch_helpers.h>
 #include <debug.h>
-#include <events.h>
 #include <heap/page_alloc.h>
 #include <host_realm_helper.h>
 #include <host_realm_mem_layout.h>
 #include <host_realm_rmi.h>
 #include <host_shared_data.h>
-#include <plat_topology.h>
-#include <power_management.h>
 #include <realm_def.h>
+#include <spinlock.h>
 #include <test_helpers.h>
 #include <xlat_tables_v2.h>
 
-static struct realm realm;
-static bool realm_payload_created;
-static bool shared_mem_created;
+/* Realms created by the Host, a Realm in slot 'i' uses VMID 'i + 1' */
+static struct realm *realms[MAX_REALM_COUNT];
+static spinlock_t realms_lock;
 static bool realm_payload_mmaped;
-static u_register_t exit_reason = RMI_EXIT_INVALID;
-static unsigned int test_result = TEST_RESULT_FAIL;
-static volatile bool timer_enabled;
 
 /* From the TFTF_BASE offset, memory used by TFTF + Shared + Realm + POOL should
  * not exceed DRAM_END offset
@@ -38,78 +33,68 @@ CASSERT((((uint64_t)NS_REALM_SHARED_MEM_BASE + (uint64_t)NS_REALM_SHARED_MEM_SIZ
 	error_ns_memory_and_realm_payload_exceed_DRAM_SIZE);
 
 /*
- * The function handler to print the Realm logged buffer,
- * executed by the secondary core
+ * Initialisation function which will clear the shared region, including the
+ * Realm log ring buffer. The log is printed by the Host whenever a REC exits.
  */
-static inline test_result_t timer_handler(void)
+static void host_init_realm_print_buffer(struct realm *realm_ptr)
 {
-	size_t str_len = 0UL;
-	host_shared_data_t *host_shared_data = host_get_shared_structure();
-	char *log_buffer = (char *)host_shared_data->log_buffer;
-
-	do {
-		spin_lock((spinlock_t *)&host_shared_data->printf_lock);
-		str_len = strlen((const char *)log_buffer);
-
-		/*
-		 * Read Realm message from shared printf location and print
-		 * them using uart
-		 */
-		if (str_len != 0UL) {
-			/* Avoid memory overflow */
-			log_buffer[MAX_BUF_SIZE - 1] = 0U;
-
-			mp_printf("%s", log_buffer);
-			(void)memset((char *)log_buffer, 0, MAX_BUF_SIZE);
-		}
-		spin_unlock((spinlock_t *)&host_shared_data->printf_lock);
+	host_shared_data_t *host_shared_data =
+		host_get_shared_structure(realm_ptr);
 
-	} while ((timer_enabled || (str_len != 0UL)));
+	(void)memset((char *)host_shared_data, 0, sizeof(host_shared_data_t));
+	realm_shared_data_reset_log(realm_ptr);
+}
+
+/*
+ * Track 'realm_ptr' in a free slot, which also gives its VMID.
+ */
+static bool host_register_realm(struct realm *realm_ptr)
+{
+	bool ret = false;
+
+	spin_lock(&realms_lock);
+	for (unsigned int i = 0U; i < MAX_REALM_COUNT; i++) {
+		if (realms[i] == NULL) {
+			realms[i] = realm_ptr;
+			realm_ptr->vmid = i + 1U;
+			ret = true;
+			break;
+		}
+	}
+	spin_unlock(&realms_lock);
 
-	return TEST_RESULT_SUCCESS;
+	return ret;
 }
 
 /*
- * Initialisation function which will clear the shared region,
- * and try to find another CPU other than the lead one to
- * handle the Realm message logging
+ * Release the slot of 'realm_ptr'. Returns false if it was not registered.
  */
-void host_init_realm_print_buffer(void)
+static bool host_unregister_realm(struct realm *realm_ptr)
 {
-	u_register_t other_mpidr, my_mpidr;
-	int ret;
-	host_shared_data_t *host_shared_data = host_get_shared_structure();
+	bool ret = false;
 
-	(void)memset((char *)host_shared_data, 0, sizeof(host_shared_data_t));
-	/* Program timer */
-	timer_enabled = false;
-
-	/* Find a valid CPU to power on */
-	my_mpidr = read_mpidr_el1() & MPID_MASK;
-	other_mpidr = tftf_find_any_cpu_other_than(my_mpidr);
-	if (other_mpidr == INVALID_MPID) {
-		ERROR("Couldn't find a valid other CPU\n");
-		return;
+	spin_lock(&realms_lock);
+	if ((realm_ptr->vmid != 0U) && (realm_ptr->vmid <= MAX_REALM_COUNT) &&
+	    (realms[realm_ptr->vmid - 1U] == realm_ptr)) {
+		realms[realm_ptr->vmid - 1U] = NULL;
+		ret = true;
 	}
+	spin_unlock(&realms_lock);
 
-	/* Power on the other CPU */
-	ret = tftf_cpu_on(other_mpidr, (uintptr_t)timer_handler, 0);
-	if (ret != PSCI_E_SUCCESS) {
-		ERROR("powering on %llx failed",
-		(unsigned long long)other_mpidr);
-		return;
-	}
-	timer_enabled = true;
+	return ret;
 }
 
 /**
  *   @brief    - Add regions assigned to Host into its translation table data
- *   structure.
+ *   structure. The whole memory pool and shared region are mapped once, and
+ *   then carved out between the Realms.
  **/
-static test_result_t host_mmap_realm_payload(u_register_t realm_payload_adr,
-		u_register_t plat_mem_pool_adr,
-		u_register_t plat_mem_pool_size)
+static test_result_t host_mmap_realm_payload(u_register_t realm_payload_adr)
 {
+	const u_register_t plat_mem_pool_adr = PAGE_POOL_BASE;
+	const u_register_t plat_mem_pool_size = PAGE_POOL_MAX_SIZE +
+						NS_REALM_SHARED_MEM_SIZE;
+
 	if (realm_payload_mmaped) {
 		return REALM_SUCCESS;
 	}
@@ -139,162 +124,180 @@ static test_result_t host_mmap_realm_payload(u_register_t realm_payload_adr,
 	return REALM_SUCCESS;
 }
 
-static bool host_enter_realm(u_register_t *exit_reason, unsigned int *test_result)
+static bool host_enter_realm(struct realm *realm_ptr, unsigned int rec_num,
+		uint8_t cmd, u_register_t *exit_reason,
+		unsigned int *test_result)
 {
 	u_register_t ret;
 
-	if (!realm_payload_created) {
+	if (realm_ptr->state != REALM_STATE_ACTIVE) {
 		ERROR("%s failed, Realm not created\n", __func__);
 		return false;
 	}
-	if (!shared_mem_created) {
+	if (realm_ptr->host_shared_data == NULL) {
 		ERROR("%s failed, shared memory not created\n", __func__);
 		return false;
 	}
+	if (rec_num >= realm_ptr->rec_count) {
+		ERROR("%s failed, invalid REC %u\n", __func__, rec_num);
+		return false;
+	}
+
+	realm_shared_data_set_realm_cmd(realm_ptr, rec_num, cmd);
 
 	/* Enter Realm  */
-	ret = realm_rec_enter(&realm, exit_reason, test_result);
+	ret = realm_rec_enter(realm_ptr, rec_num, exit_reason, test_result);
 	if (ret != REALM_SUCCESS) {
 		ERROR("Rec enter failed something went wrong, ret=%lx\n", ret);
 
 		/* Free test resources */
-		if (realm_destroy(&realm) != REALM_SUCCESS) {
-			ERROR("%s\n", "realm_destroy failed");
-		}
-		realm_payload_created = false;
+		(void)host_destroy_realm(realm_ptr);
 		return false;
 	}
 
 	return true;
 }
 
-bool host_create_realm_payload(u_register_t realm_payload_adr,
-		u_register_t plat_mem_pool_adr,
-		u_register_t plat_mem_pool_size,
-		u_register_t realm_pages_size)
+bool host_create_realm_payload(struct realm *realm_ptr,
+		u_register_t realm_payload_adr,
+		u_register_t realm_pool_adr,
+		u_register_t realm_pool_size,
+		unsigned int rec_count)
 {
 	if (realm_payload_adr == TFTF_BASE) {
 		ERROR("realm_payload_adr should grater then TFTF_BASE\n");
 		return false;
 	}
 
-	if (plat_mem_pool_adr  == 0UL ||
-			plat_mem_pool_size == 0UL ||
-			realm_pages_size == 0UL) {
-		ERROR("plat_mem_pool_size or "
-			"plat_mem_pool_size or realm_pages_size isNull\n");
+	if (realm_pool_adr == 0UL || realm_pool_size == 0UL) {
+		ERROR("realm_pool_adr or realm_pool_size is Null\n");
+		return false;
+	}
+
+	if ((realm_pool_adr < PAGE_POOL_BASE) ||
+	    ((realm_pool_adr + realm_pool_size) >
+	     (PAGE_POOL_BASE + PAGE_POOL_MAX_SIZE))) {
+		ERROR("Realm pool must be within the Host memory pool\n");
 		return false;
 	}
-	/* Initialize  Host NS heap memory to be used in Realm creation*/
-	if (page_pool_init(plat_mem_pool_adr, realm_pages_size)
+
+	if ((rec_count == 0U) || (rec_count > REALM_MAX_REC_COUNT)) {
+		ERROR("Invalid number of RECs %u\n", rec_count);
+		return false;
+	}
+
+	(void)memset(realm_ptr, 0, sizeof(*realm_ptr));
+	realm_ptr->rec_count = rec_count;
+
+	if (!host_register_realm(realm_ptr)) {
+		ERROR("Too many Realms\n");
+		return false;
+	}
+
+	/* Initialize Host NS heap memory to be used in this Realm creation */
+	if (page_pool_init(&realm_ptr->pool, realm_pool_adr, realm_pool_size)
 		!= HEAP_INIT_SUCCESS) {
 		ERROR("page_pool_init() failed\n");
-		return false;
+		goto unregister_realm;
 	}
 
 	/* Mmap Realm payload region*/
-	if (host_mmap_realm_payload(realm_payload_adr,
-			plat_mem_pool_adr,
-			plat_mem_pool_size) != REALM_SUCCESS) {
+	if (host_mmap_realm_payload(realm_payload_adr) != REALM_SUCCESS) {
 		ERROR("host_mmap_realm_payload() failed\n");
-		return false;
+		goto unregister_realm;
 	}
 
 	/* Read Realm feature Regs*/
-	if (rmi_features(0UL, &realm.rmm_feat_reg0) != REALM_SUCCESS) {
+	if (rmi_features(0UL, &realm_ptr->rmm_feat_reg0) != REALM_SUCCESS) {
 		ERROR("rmi_features() Read Realm feature failed\n");
 		goto destroy_realm;
 	}
 
 	/* Create Realm */
-	if (realm_create(&realm) != REALM_SUCCESS) {
+	if (realm_create(realm_ptr) != REALM_SUCCESS) {
 		ERROR("realm_create() failed\n");
 		goto destroy_realm;
 	}
 
-	if (realm_init_ipa_state(&realm, 0U, 0U, 1ULL << 32)
-		!= RMI_SUCCESS) {
-		ERROR("realm_init_ipa_state\n");
-		goto destroy_realm;
-	}
-	/* RTT map Realm image */
-	if (realm_map_payload_image(&realm, realm_payload_adr) !=
+	/* Initialise the RIPAS of the PAR and RTT map Realm image */
+	if (realm_map_payload_image(realm_ptr, realm_payload_adr) !=
 			REALM_SUCCESS) {
 		ERROR("realm_map_payload_image() failed\n");
 		goto destroy_realm;
 	}
 
-	/* Create REC */
-	if (realm_rec_create(&realm) != REALM_SUCCESS) {
+	/* Create RECs */
+	if (realm_rec_create(realm_ptr) != REALM_SUCCESS) {
 		ERROR("REC create failed\n");
 		goto destroy_realm;
 	}
 
 	/* Activate Realm */
-	if (realm_activate(&realm) != REALM_SUCCESS) {
+	if (realm_activate(realm_ptr) != REALM_SUCCESS) {
 		ERROR("Realm activate failed\n");
 		goto destroy_realm;
 	}
 
-	realm_payload_created = true;
-
-	return realm_payload_created;
+	return true;
 
 	/* Free test resources */
 destroy_realm:
-	if (realm_destroy(&realm) != REALM_SUCCESS) {
+	if (realm_destroy(realm_ptr) != REALM_SUCCESS) {
 		ERROR("%s\n", "realm_destroy failed");
 	}
-	realm_payload_created = false;
 
-	return realm_payload_created;
+unregister_realm:
+	(void)host_unregister_realm(realm_ptr);
+
+	return false;
 }
 
-bool host_create_shared_mem(u_register_t ns_shared_mem_adr,
+bool host_create_shared_mem(struct realm *realm_ptr,
+	u_register_t ns_shared_mem_adr,
 	u_register_t ns_shared_mem_size)
 {
 	/* RTT map NS shared region */
-	if (realm_map_ns_shared(&realm, ns_shared_mem_adr, ns_shared_mem_size) !=
-		REALM_SUCCESS) {
+	if (realm_map_ns_shared(realm_ptr, ns_shared_mem_adr,
+			ns_shared_mem_size) != REALM_SUCCESS) {
 		ERROR("realm_map_ns_shared() failed\n");
-		shared_mem_created = false;
 		return false;
 	}
 
-	host_init_realm_print_buffer();
-	realm_shared_data_clear_realm_val();
-	shared_mem_created = true;
+	realm_ptr->host_shared_data = (host_shared_data_t *)ns_shared_mem_adr;
+	host_init_realm_print_buffer(realm_ptr);
+	realm_shared_data_clear_realm_val(realm_ptr);
 
-	return shared_mem_created;
+	return true;
 }
 
-bool host_destroy_realm(void)
+bool host_destroy_realm(struct realm *realm_ptr)
 {
 	/* Free test resources */
-	timer_enabled = false;
-	page_pool_reset();
-
-	if (!realm_payload_created) {
+	if (!host_unregister_realm(realm_ptr)) {
 		ERROR("realm_destroy failed, Realm not created\n");
 		return false;
 	}
 
-	realm_payload_created = false;
-	if (realm_destroy(&realm) != REALM_SUCCESS) {
+	if (realm_destroy(realm_ptr) != REALM_SUCCESS) {
 		ERROR("%s\n", "realm_destroy failed");
 		return false;
 	}
 
+	page_pool_reset(&realm_ptr->pool);
+	realm_ptr->host_shared_data = NULL;
+	realm_ptr->state = REALM_STATE_NULL;
+
 	return true;
 }
 
-bool host_enter_realm_execute(uint8_t cmd)
+bool host_enter_realm_execute(struct realm *realm_ptr, uint8_t cmd,
+		unsigned int rec_num)
 {
-	exit_reason = RMI_EXIT_INVALID;
-	test_result = TEST_RESULT_FAIL;
+	u_register_t exit_reason = RMI_EXIT_INVALID;
+	unsigned int test_result = TEST_RESULT_FAIL;
 
-	realm_shared_data_set_realm_cmd(cmd);
-	if (!host_enter_realm(&exit_reason, &test_result)) {
+	if (!host_enter_realm(realm_ptr, rec_num, cmd, &exit_reason,
+			&test_result)) {
 		return false;
 	}
 
@@ -7,77 +7,120 @@
 
 #include <string.h>
 
+#include <arch_helpers.h>
 #include <debug.h>
 #include <heap/page_alloc.h>
 #include <host_realm_helper.h>
 #include <host_realm_mem_layout.h>
 #include <host_realm_rmi.h>
+#include <host_shared_data.h>
 #include <plat/common/platform.h>
 #include <realm_def.h>
 #include <tftf_lib.h>
 
+/*
+ * Number of RMI calls issued by the host, per RMI function number. The
+ * counters are not atomic, they are only meant to profile sequences run from
+ * a single CPU, such as a Realm creation.
+ */
+static unsigned long
+	rmi_call_count[RMI_FNUM_MAX_VALUE - RMI_FNUM_MIN_VALUE + 1U];
+
+static inline smc_ret_values rmi_smc(smc_args *args)
+{
+	rmi_call_count[RMI_FNUM(args->fid) - RMI_FNUM_MIN_VALUE]++;
+
+	return tftf_smc(args);
+}
+
+void host_rmi_reset_call_count(void)
+{
+	(void)memset(rmi_call_count, 0, sizeof(rmi_call_count));
+}
+
+unsigned long host_rmi_get_call_count(u_register_t fid)
+{
+	if ((RMI_FNUM(fid) < RMI_FNUM_MIN_VALUE) ||
+	    (RMI_FNUM(fid) > RMI_FNUM_MAX_VALUE)) {
+		return 0UL;
+	}
+
+	return rmi_call_count[RMI_FNUM(fid) - RMI_FNUM_MIN_VALUE];
+}
+
+unsigned long host_rmi_get_total_call_count(void)
+{
+	unsigned long total = 0UL;
+
+	for (unsigned int i = 0U; i < ARRAY_SIZE(rmi_call_count); i++) {
+		total += rmi_call_count[i];
+	}
+
+	return total;
+}
+
 static inline u_register_t rmi_data_create(bool unknown, u_register_t data,
 		u_register_t rd, u_register_t map_addr, u_register_t src)
 {
 	if (unknown) {
-		return ((smc_ret_values)(tftf_smc(&(smc_args)
+		return ((smc_ret_values)(rmi_smc(&(smc_args)
 				{RMI_DATA_CREATE_UNKNOWN, data, rd, map_addr,
 			0UL, 0UL, 0UL, 0UL}))).ret0;
 	} else {
-		return ((smc_ret_values)(tftf_smc(&(smc_args) {RMI_DATA_CREATE,
+		return ((smc_ret_values)(rmi_smc(&(smc_args) {RMI_DATA_CREATE,
 			data, rd, map_addr, src, 0UL, 0UL, 0UL}))).ret0;
 	}
 }
 
 static inline u_register_t rmi_realm_activate(u_register_t rd)
 {
-	return ((smc_ret_values)(tftf_smc(&(smc_args) {RMI_REALM_ACTIVATE,
+	return ((smc_ret_values)(rmi_smc(&(smc_args) {RMI_REALM_ACTIVATE,
 		rd, 0UL, 0UL, 0UL, 0UL, 0UL, 0UL}))).ret0;
 }
 
 u_register_t rmi_realm_create(u_register_t rd, u_register_t params_ptr)
 {
-	return ((smc_ret_values)(tftf_smc(&(smc_args) {RMI_REALM_CREATE,
+	return ((smc_ret_values)(rmi_smc(&(smc_args) {RMI_REALM_CREATE,
 		rd, params_ptr, 0UL, 0UL, 0UL, 0UL, 0UL}))).ret0;
 }
 
 u_register_t rmi_realm_destroy(u_register_t rd)
 {
-	return ((smc_ret_values)(tftf_smc(&(smc_args) {RMI_REALM_DESTROY,
+	return ((smc_ret_values)(rmi_smc(&(smc_args) {RMI_REALM_DESTROY,
 		rd, 0UL, 0UL, 0UL, 0UL, 0UL, 0UL}))).ret0;
 }
 
 static inline u_register_t rmi_data_destroy(u_register_t rd,
 		u_register_t map_addr)
 {
-	return ((smc_ret_values)(tftf_smc(&(smc_args) {RMI_DATA_DESTROY,
+	return ((smc_ret_values)(rmi_smc(&(smc_args) {RMI_DATA_DESTROY,
 		rd, map_addr, 0UL, 0UL, 0UL, 0UL, 0UL}))).ret0;
 }
 
 static inline u_register_t rmi_rec_create(u_register_t rec, u_register_t rd,
 	u_register_t params_ptr)
 {
-	return ((smc_ret_values)(tftf_smc(&(smc_args) {RMI_REC_CREATE,
+	return ((smc_ret_values)(rmi_smc(&(smc_args) {RMI_REC_CREATE,
 			rec, rd, params_ptr, 0UL, 0UL, 0UL, 0UL}))).ret0;
 }
 
 static inline u_register_t rmi_rec_destroy(u_register_t rec)
 {
-	return ((smc_ret_values)(tftf_smc(&(smc_args) {RMI_REC_DESTROY,
+	return ((smc_ret_values)(rmi_smc(&(smc_args) {RMI_REC_DESTROY,
 		rec, 0UL, 0UL, 0UL, 0UL, 0UL, 0UL}))).ret0;
 }
 
 static inline u_register_t rmi_rtt_create(u_register_t rtt, u_register_t rd,
 	u_register_t map_addr, u_register_t level)
 {
-	return ((smc_ret_values)(tftf_smc(&(smc_args) {RMI_RTT_CREATE,
+	return ((smc_ret_values)(rmi_smc(&(smc_args) {RMI_RTT_CREATE,
 			rtt, rd, map_addr, level, 0UL, 0UL, 0UL}))).ret0;
 }
 
 static inline u_register_t rmi_rtt_destroy(u_register_t rtt, u_register_t rd,
 	u_register_t map_addr, u_register_t level)
 {
-	return ((smc_ret_values)(tftf_smc(&(smc_args) {RMI_RTT_DESTROY,
+	return ((smc_ret_values)(rmi_smc(&(smc_args) {RMI_RTT_DESTROY,
 		rtt, rd, map_addr, level, 0UL, 0UL, 0UL}))).ret0;
 }
 
@@ -85,7 +128,7 @@ u_register_t rmi_features(u_register_t index, u_register_t *features)
 {
 	smc_ret_values rets;
 
-	rets = tftf_smc(&(smc_args) {RMI_FEATURES, index, 0UL, 0UL, 0UL, 0UL, 0UL, 0UL});
+	rets = rmi_smc(&(smc_args) {RMI_FEATURES, index, 0UL, 0UL, 0UL, 0UL, 0UL, 0UL});
 	*features = rets.ret1;
 	return rets.ret0;
 }
@@ -94,14 +137,14 @@ static inline u_register_t rmi_rtt_init_ripas(u_register_t rd,
 	u_register_t map_addr,
 	u_register_t level)
 {
-	return ((smc_ret_values)(tftf_smc(&(smc_args) {RMI_RTT_INIT_RIPAS,
+	return ((smc_ret_values)(rmi_smc(&(smc_args) {RMI_RTT_INIT_RIPAS,
 		rd, map_addr, level, 0UL, 0UL, 0UL, 0UL}))).ret0;
 }
 
 static inline u_register_t rmi_rtt_fold(u_register_t rtt, u_register_t rd,
 	u_register_t map_addr, u_register_t level)
 {
-	return ((smc_ret_values)(tftf_smc(&(smc_args) {RMI_RTT_FOLD,
+	return ((smc_ret_values)(rmi_smc(&(smc_args) {RMI_RTT_FOLD,
 		rtt, rd, map_addr, level, 0UL, 0UL, 0UL}))).ret0;
 }
 
@@ -110,7 +153,7 @@ static inline u_register_t rmi_rec_aux_count(u_register_t rd,
 {
 	smc_ret_values rets;
 
-	rets = tftf_smc(&(smc_args) {RMI_REC_AUX_COUNT, rd, 0UL, 0UL, 0UL, 0UL, 0UL, 0UL});
+	rets = rmi_smc(&(smc_args) {RMI_REC_AUX_COUNT, rd, 0UL, 0UL, 0UL, 0UL, 0UL, 0UL});
 	*aux_count = rets.ret1;
 	return rets.ret0;
 }
@@ -119,7 +162,7 @@ static inline u_register_t rmi_rtt_set_ripas(u_register_t rd, u_register_t rec,
 	u_register_t map_addr, u_register_t level,
 	u_register_t ripas)
 {
-	return ((smc_ret_values)(tftf_smc(&(smc_args) {RMI_RTT_SET_RIPAS,
+	return ((smc_ret_values)(rmi_smc(&(smc_args) {RMI_RTT_SET_RIPAS,
 			rd, rec, map_addr, level, ripas, 0UL, 0UL}))).ret0;
 }
 
@@ -127,7 +170,7 @@ static inline u_register_t rmi_rtt_mapunprotected(u_register_t rd,
 	u_register_t map_addr,
 	u_register_t level, u_register_t ns_pa)
 {
-	return ((smc_ret_values)(tftf_smc(&(smc_args) {RMI_RTT_MAP_UNPROTECTED,
+	return ((smc_ret_values)(rmi_smc(&(smc_args) {RMI_RTT_MAP_UNPROTECTED,
 		rd, map_addr, level, ns_pa, 0UL, 0UL, 0UL}))).ret0;
 }
 
@@ -136,7 +179,7 @@ static u_register_t rmi_rtt_readentry(u_register_t rd, u_register_t map_addr,
 {
 	smc_ret_values rets;
 
-	rets = tftf_smc(&(smc_args) {RMI_RTT_READ_ENTRY,
+	rets = rmi_smc(&(smc_args) {RMI_RTT_READ_ENTRY,
 		rd, map_addr, level, 0UL, 0UL, 0UL, 0UL});
 
 	rtt->walk_level = rets.ret1;
@@ -149,7 +192,7 @@ static inline u_register_t rmi_rtt_unmap_unprotected(u_register_t rd,
 	u_register_t map_addr,
 	u_register_t level, u_register_t ns_pa)
 {
-	return ((smc_ret_values)(tftf_smc(&(smc_args) {RMI_RTT_UNMAP_UNPROTECTED,
+	return ((smc_ret_values)(rmi_smc(&(smc_args) {RMI_RTT_UNMAP_UNPROTECTED,
 		rd, map_addr, level, ns_pa, 0UL, 0UL, 0UL}))).ret0;
 }
 
@@ -179,7 +222,7 @@ static u_register_t rmi_create_rtt_levels(struct realm *realm,
 	u_register_t rtt, ret;
 
 	while (level++ < max_level) {
-		rtt = (u_register_t)page_alloc(PAGE_SIZE);
+		rtt = (u_register_t)page_alloc(&realm->pool, PAGE_SIZE);
 		if (rtt == HEAP_NULL_PTR) {
 			ERROR("Failed to allocate memory for rtt\n");
 			return REALM_ERROR;
@@ -231,6 +274,15 @@ static u_register_t realm_fold_rtt(u_register_t rd, u_register_t addr,
 		return REALM_ERROR;
 	}
 
+	/* The folded RTT is returned to the delegated state. */
+	ret = rmi_granule_undelegate(rtt.out_addr);
+	if (ret != RMI_SUCCESS) {
+		ERROR("Rtt undelegate failed,"
+			"rtt.out_addr=0x%llx ret=0x%lx\n",
+			rtt.out_addr, ret);
+		return REALM_ERROR;
+	}
+
 	page_free(rtt.out_addr);
 
 	return REALM_SUCCESS;
@@ -265,24 +317,11 @@ static u_register_t realm_map_protected_data(bool unknown, struct realm *realm,
 		return REALM_ERROR;
 	}
 
-	ret = rmi_rtt_init_ripas(rd, map_addr, map_level);
-	if (RMI_RETURN_STATUS(ret) == RMI_ERROR_RTT) {
-		ret = rmi_create_rtt_levels(realm, map_addr,
-				RMI_RETURN_INDEX(ret), map_level);
-		if (ret != RMI_SUCCESS) {
-			ERROR("rmi_create_rtt_levels failed,"
-				"ret=0x%lx line:%d\n",
-				ret, __LINE__);
-			goto err;
-		}
-		ret = rmi_rtt_init_ripas(rd, map_addr, map_level);
-		if (ret != RMI_SUCCESS) {
-			ERROR("rmi_create_rtt_levels failed,"
-				"ret=0x%lx line:%d\n",
-				ret, __LINE__);
-			goto err;
-		}
-	}
+	/*
+	 * The RIPAS of the range is expected to have been initialised by
+	 * realm_init_ipa_state(). Data granules are always created at level 3,
+	 * a block is then folded into a single level 2 entry.
+	 */
 	for (size = 0UL; size < map_size; size += PAGE_SIZE) {
 		ret = rmi_granule_delegate(phys);
 		if (ret != RMI_SUCCESS) {
@@ -297,7 +336,7 @@ static u_register_t realm_map_protected_data(bool unknown, struct realm *realm,
 			/* Create missing RTTs and retry */
 			level = RMI_RETURN_INDEX(ret);
 			ret = rmi_create_rtt_levels(realm, map_addr, level,
-				map_level);
+				RTT_MAX_LEVEL);
 			if (ret != RMI_SUCCESS) {
 				ERROR("rmi_create_rtt_levels failed,"
 					"ret=0x%lx line:%d\n",
@@ -492,12 +531,34 @@ static u_register_t realm_tear_down_rtt_range(struct realm *realm,
 
 		switch (rtt.state) {
 		case RMI_ASSIGNED:
-			realm_destroy_undelegate_range(realm, map_addr,
-					rtt_out_addr, map_size);
-			break;
-		case RMI_UNASSIGNED:
-		case RMI_DESTROYED:
-			break;
+			if (level == RTT_MAX_LEVEL) {
+				realm_destroy_undelegate_range(realm, map_addr,
+						rtt_out_addr, map_size);
+				break;
+			}
+
+			/*
+			 * Data granules can only be destroyed at level 3, so
+			 * unfold the block into a table first.
+			 */
+			ret = rmi_create_rtt_levels(realm, map_addr, level,
+					level + 1U);
+			if (ret != RMI_SUCCESS) {
+				ERROR("unfold failed, map_addr=0x%lx\n",
+					map_addr);
+				return REALM_ERROR;
+			}
+
+			ret = rmi_rtt_readentry(rd, ALIGN_DOWN(map_addr,
+					map_size), level, &rtt);
+			if ((ret != RMI_SUCCESS) || (rtt.state != RMI_TABLE)) {
+				ERROR("unfold failed, map_addr=0x%lx\n",
+					map_addr);
+				return REALM_ERROR;
+			}
+
+			rtt_out_addr = rtt.out_addr;
+			/* Fall through */
 		case RMI_TABLE:
 			ret = realm_tear_down_rtt_range(realm, level + 1U,
 				map_addr, end_addr);
@@ -517,6 +578,9 @@ static u_register_t realm_tear_down_rtt_range(struct realm *realm,
 				return REALM_ERROR;
 			}
 			break;
+		case RMI_UNASSIGNED:
+		case RMI_DESTROYED:
+			break;
 		case RMI_VALID_NS:
 			ret = rmi_rtt_unmap_unprotected(rd, map_addr, level,
 				rtt_out_addr);
@@ -537,19 +601,19 @@ static u_register_t realm_tear_down_rtt_range(struct realm *realm,
 
 u_register_t rmi_granule_delegate(u_register_t addr)
 {
-	return ((smc_ret_values)(tftf_smc(&(smc_args) {RMI_GRANULE_DELEGATE,
+	return ((smc_ret_values)(rmi_smc(&(smc_args) {RMI_GRANULE_DELEGATE,
 			addr, 0UL, 0UL, 0UL, 0UL, 0UL, 0UL}))).ret0;
 }
 
 u_register_t rmi_granule_undelegate(u_register_t addr)
 {
-	return ((smc_ret_values)(tftf_smc(&(smc_args) {RMI_GRANULE_UNDELEGATE,
+	return ((smc_ret_values)(rmi_smc(&(smc_args) {RMI_GRANULE_UNDELEGATE,
 			addr, 0UL, 0UL, 0UL, 0UL, 0UL, 0UL}))).ret0;
 }
 
 u_register_t rmi_version(void)
 {
-	return ((smc_ret_values)(tftf_smc(&(smc_args) {RMI_VERSION,
+	return ((smc_ret_values)(rmi_smc(&(smc_args) {RMI_VERSION,
 			0UL, 0UL, 0UL, 0UL, 0UL, 0UL, 0UL}))).ret0;
 }
 
@@ -565,7 +629,8 @@ u_register_t realm_create(struct realm *realm)
 	 * Allocate memory for PAR - Realm image. Granule delegation
 	 * of PAR will be performed during rtt creation.
 	 */
-	realm->par_base = (u_register_t)page_alloc(realm->par_size);
+	realm->par_base = (u_register_t)page_alloc(&realm->pool,
+			realm->par_size);
 	if (realm->par_base == HEAP_NULL_PTR) {
 		ERROR("page_alloc failed, base=0x%lx, size=0x%lx\n",
 			  realm->par_base, realm->par_size);
@@ -573,7 +638,7 @@ u_register_t realm_create(struct realm *realm)
 	}
 
 	/* Allocate and delegate RD */
-	realm->rd = (u_register_t)page_alloc(PAGE_SIZE);
+	realm->rd = (u_register_t)page_alloc(&realm->pool, PAGE_SIZE);
 	if (realm->rd == HEAP_NULL_PTR) {
 		ERROR("Failed to allocate memory for rd\n");
 		goto err_free_par;
@@ -587,7 +652,7 @@ u_register_t realm_create(struct realm *realm)
 	}
 
 	/* Allocate and delegate RTT */
-	realm->rtt_addr = (u_register_t)page_alloc(PAGE_SIZE);
+	realm->rtt_addr = (u_register_t)page_alloc(&realm->pool, PAGE_SIZE);
 	if (realm->rtt_addr == HEAP_NULL_PTR) {
 		ERROR("Failed to allocate memory for rtt_addr\n");
 		goto err_undelegate_rd;
@@ -601,7 +666,8 @@ u_register_t realm_create(struct realm *realm)
 	}
 
 	/* Allocate memory for params */
-	params = (struct rmi_realm_params *)page_alloc(PAGE_SIZE);
+	params = (struct rmi_realm_params *)page_alloc(&realm->pool,
+			PAGE_SIZE);
 	if (params == NULL) {
 		ERROR("Failed to allocate memory for params\n");
 		goto err_undelegate_rtt;
@@ -612,7 +678,7 @@ u_register_t realm_create(struct realm *realm)
 	params->rtt_level_start = 0L;
 	params->rtt_num_start = 1U;
 	params->rtt_base = realm->rtt_addr;
-	params->vmid = 1U;
+	params->vmid = realm->vmid;
 	params->hash_algo = RMI_HASH_SHA_256;
 
 	/* Create Realm */
@@ -669,22 +735,43 @@ u_register_t realm_map_payload_image(struct realm *realm,
 	u_register_t realm_payload_adr)
 {
 	u_register_t src_pa = realm_payload_adr;
-	u_register_t i = 0UL;
+	u_register_t offset, map_addr, map_size;
 	u_register_t ret;
 
-	/* MAP image regions */
-	while (i < (realm->par_size / PAGE_SIZE)) {
-		ret =	realm_map_protected_data(false, realm,
-				realm->par_base + i * PAGE_SIZE,
-				PAGE_SIZE,
-				src_pa + i * PAGE_SIZE);
+	/*
+	 * Initialise the RIPAS of the whole PAR in a single range call. The
+	 * range is extended to level 2 blocks, so that it takes a single
+	 * RMI_RTT_INIT_RIPAS per 2MB rather than one per page.
+	 */
+	ret = realm_init_ipa_state(realm, 2U,
+			ALIGN_DOWN(realm->par_base, RTT_L2_BLOCK_SIZE),
+			ALIGN(realm->par_base + realm->par_size,
+			      RTT_L2_BLOCK_SIZE));
+	if (ret != RMI_SUCCESS) {
+		ERROR("realm_init_ipa_state failed, par_base=0x%lx ret=0x%lx\n",
+			realm->par_base, ret);
+		return REALM_ERROR;
+	}
+
+	/* MAP image regions, using 2MB blocks where aligned */
+	for (offset = 0UL; offset < realm->par_size; offset += map_size) {
+		map_addr = realm->par_base + offset;
+
+		if (IS_ALIGNED(map_addr, RTT_L2_BLOCK_SIZE) &&
+		    ((realm->par_size - offset) >= RTT_L2_BLOCK_SIZE)) {
+			map_size = RTT_L2_BLOCK_SIZE;
+		} else {
+			map_size = PAGE_SIZE;
+		}
+
+		ret = realm_map_protected_data(false, realm, map_addr,
+				map_size, src_pa + offset);
 		if (ret != RMI_SUCCESS) {
 			ERROR("realm_map_protected_data failed,"
 				"par_base=0x%lx ret=0x%lx\n",
 				realm->par_base, ret);
 			return REALM_ERROR;
 		}
-		i++;
 	}
 
 	return REALM_SUCCESS;
@@ -696,19 +783,32 @@ u_register_t realm_init_ipa_state(struct realm *realm,
 		uint64_t end)
 {
 	u_register_t rd = realm->rd, ret;
-	u_register_t map_size = rtt_level_mapsize(level);
+	u_register_t map_level, map_size;
 
 	while (start < end) {
-		ret = rmi_rtt_init_ripas(rd, start, level);
+		/*
+		 * Use the largest entry, from 'level' down, that is aligned
+		 * and fits in the remaining range.
+		 */
+		map_level = level;
+		map_size = rtt_level_mapsize(map_level);
+		while ((map_level < RTT_MAX_LEVEL) &&
+		       (!IS_ALIGNED(start, map_size) ||
+			((end - start) < map_size))) {
+			map_level++;
+			map_size = rtt_level_mapsize(map_level);
+		}
+
+		ret = rmi_rtt_init_ripas(rd, start, map_level);
 
 		if (RMI_RETURN_STATUS(ret) == RMI_ERROR_RTT) {
-			int cur_level = RMI_RETURN_INDEX(ret);
+			u_register_t cur_level = RMI_RETURN_INDEX(ret);
 
-			if (cur_level < level) {
+			if (cur_level < map_level) {
 				ret = rmi_create_rtt_levels(realm,
 						start,
 						cur_level,
-						level);
+						map_level);
 				if (ret != RMI_SUCCESS) {
 					ERROR("rmi_create_rtt_levels failed,"
 						"ret=0x%lx line:%d\n",
@@ -719,13 +819,16 @@ u_register_t realm_init_ipa_state(struct realm *realm,
 				continue;
 			}
 
-			if (level >= RTT_MAX_LEVEL) {
+			if (map_level >= RTT_MAX_LEVEL) {
 				return REALM_ERROR;
 			}
 
 			/* There's an entry at a lower level, recurse */
-			realm_init_ipa_state(realm, start, start + map_size,
-					     level + 1);
+			ret = realm_init_ipa_state(realm, map_level + 1U,
+						   start, start + map_size);
+			if (ret != RMI_SUCCESS) {
+				return ret;
+			}
 		} else if (ret != RMI_SUCCESS) {
 			return REALM_ERROR;
 		}
@@ -778,13 +881,13 @@ static void realm_free_rec_aux(u_register_t *aux_pages, unsigned int num_aux)
 }
 
 static u_register_t realm_alloc_rec_aux(struct realm *realm,
-		struct rmi_rec_params *params)
+		unsigned int rec_num, struct rmi_rec_params *params)
 {
 	u_register_t ret;
 	unsigned int i;
 
 	for (i = 0; i < realm->num_aux; i++) {
-		params->aux[i] = (u_register_t)page_alloc(PAGE_SIZE);
+		params->aux[i] = (u_register_t)page_alloc(&realm->pool, PAGE_SIZE);
 		if (params->aux[i] == HEAP_NULL_PTR) {
 			ERROR("Failed to allocate memory for aux rec\n");
 			goto err_free_mem;
@@ -797,7 +900,7 @@ static u_register_t realm_alloc_rec_aux(struct realm *realm,
 		}
 
 		/* We need a copy in Realm object for final destruction */
-		realm->aux_pages[i] = params->aux[i];
+		realm->aux_pages[rec_num][i] = params->aux[i];
 	}
 	return RMI_SUCCESS;
 err_free_mem:
@@ -805,35 +908,37 @@ err_free_mem:
 	return ret;
 }
 
-u_register_t realm_rec_create(struct realm *realm)
+static u_register_t realm_create_one_rec(struct realm *realm,
+		unsigned int rec_num)
 {
 	struct rmi_rec_params *rec_params = HEAP_NULL_PTR;
 	u_register_t ret;
 
 	/* Allocate memory for run object */
-	realm->run = (u_register_t)page_alloc(PAGE_SIZE);
-	if (realm->run == HEAP_NULL_PTR) {
+	realm->run[rec_num] = (u_register_t)page_alloc(&realm->pool, PAGE_SIZE);
+	if (realm->run[rec_num] == HEAP_NULL_PTR) {
 		ERROR("Failed to allocate memory for run\n");
 		return REALM_ERROR;
 	}
-	(void)memset((void *)realm->run, 0x0, PAGE_SIZE);
+	(void)memset((void *)realm->run[rec_num], 0x0, PAGE_SIZE);
 
 	/* Allocate and delegate REC */
-	realm->rec = (u_register_t)page_alloc(PAGE_SIZE);
-	if (realm->rec == HEAP_NULL_PTR) {
+	realm->rec[rec_num] = (u_register_t)page_alloc(&realm->pool, PAGE_SIZE);
+	if (realm->rec[rec_num] == HEAP_NULL_PTR) {
 		ERROR("Failed to allocate memory for REC\n");
 		goto err_free_mem;
 	} else {
-		ret = rmi_granule_delegate(realm->rec);
+		ret = rmi_granule_delegate(realm->rec[rec_num]);
 		if (ret != RMI_SUCCESS) {
 			ERROR("rec delegation failed, rec=0x%lx, ret=0x%lx\n",
-					realm->rd, ret);
+					realm->rec[rec_num], ret);
 			goto err_free_mem;
 		}
 	}
 
 	/* Allocate memory for rec_params */
-	rec_params = (struct rmi_rec_params *)page_alloc(PAGE_SIZE);
+	rec_params = (struct rmi_rec_params *)page_alloc(&realm->pool,
+			PAGE_SIZE);
 	if (rec_params == NULL) {
 		ERROR("Failed to allocate memory for rec_params\n");
 		goto err_undelegate_rec;
@@ -848,19 +953,23 @@ u_register_t realm_rec_create(struct realm *realm)
 	}
 
 	/* Delegate the required number of auxiliary Granules  */
-	ret = realm_alloc_rec_aux(realm, rec_params);
+	ret = realm_alloc_rec_aux(realm, rec_num, rec_params);
 	if (ret != RMI_SUCCESS) {
 		ERROR("REC realm_alloc_rec_aux, ret=0x%lx\n", ret);
-		goto err_free_mem;
+		goto err_undelegate_rec;
 	}
 
+	/*
+	 * Every REC starts at the beginning of the Realm image, which tells
+	 * them apart with the Aff0 field of their MPIDR.
+	 */
 	rec_params->pc = realm->par_base;
 	rec_params->flags = RMI_RUNNABLE;
-	rec_params->mpidr = 0x0UL;
+	rec_params->mpidr = (u_register_t)rec_num;
 	rec_params->num_aux = realm->num_aux;
 
 	/* Create REC  */
-	ret = rmi_rec_create(realm->rec, realm->rd,
+	ret = rmi_rec_create(realm->rec[rec_num], realm->rd,
 			(u_register_t)rec_params);
 	if (ret != RMI_SUCCESS) {
 		ERROR("REC create failed, ret=0x%lx\n", ret);
@@ -875,20 +984,79 @@ err_free_rec_aux:
 	realm_free_rec_aux(rec_params->aux, realm->num_aux);
 
 err_undelegate_rec:
-	ret = rmi_granule_undelegate(realm->rec);
+	ret = rmi_granule_undelegate(realm->rec[rec_num]);
 	if (ret != RMI_SUCCESS) {
 		WARN("rec undelegation failed, rec=0x%lx, ret=0x%lx\n",
-				realm->rec, ret);
+				realm->rec[rec_num], ret);
 	}
 
 err_free_mem:
-	page_free(realm->run);
-	page_free(realm->rec);
+	page_free(realm->run[rec_num]);
+	page_free(realm->rec[rec_num]);
 	page_free((u_register_t)rec_params);
 
 	return REALM_ERROR;
 }
 
+static u_register_t realm_destroy_one_rec(struct realm *realm,
+		unsigned int rec_num)
+{
+	u_register_t ret;
+
+	/* Destroy, undelegate and free */
+	ret = rmi_rec_destroy(realm->rec[rec_num]);
+	if (ret != RMI_SUCCESS) {
+		ERROR("REC destroy failed, rec=0x%lx, ret=0x%lx\n",
+				realm->rec[rec_num], ret);
+		return REALM_ERROR;
+	}
+
+	ret = rmi_granule_undelegate(realm->rec[rec_num]);
+	if (ret != RMI_SUCCESS) {
+		ERROR("rec undelegation failed, rec=0x%lx, ret=0x%lx\n",
+				realm->rec[rec_num], ret);
+		return REALM_ERROR;
+	}
+
+	realm_free_rec_aux(realm->aux_pages[rec_num], realm->num_aux);
+	page_free(realm->rec[rec_num]);
+
+	/* Free run object */
+	page_free(realm->run[rec_num]);
+
+	return REALM_SUCCESS;
+}
+
+/*
+ * Create the 'realm->rec_count' RECs of a Realm, in MPIDR order as required by
+ * the RMM. If one fails, the RECs created so far are destroyed.
+ */
+u_register_t realm_rec_create(struct realm *realm)
+{
+	unsigned int i;
+
+	if ((realm->rec_count == 0U) ||
+	    (realm->rec_count > REALM_MAX_REC_COUNT)) {
+		ERROR("Invalid number of RECs %u\n", realm->rec_count);
+		return REALM_ERROR;
+	}
+
+	for (i = 0U; i < realm->rec_count; i++) {
+		if (realm_create_one_rec(realm, i) != REALM_SUCCESS) {
+			goto err_destroy_recs;
+		}
+	}
+
+	return REALM_SUCCESS;
+
+err_destroy_recs:
+	while (i-- > 0U) {
+		(void)realm_destroy_one_rec(realm, i);
+	}
+
+	return REALM_ERROR;
+}
+
 u_register_t realm_activate(struct realm *realm)
 {
 	u_register_t ret;
@@ -923,26 +1091,12 @@ u_register_t realm_destroy(struct realm *realm)
 	}
 
 	/* For each REC - Destroy, undelegate and free */
-	ret = rmi_rec_destroy(realm->rec);
-	if (ret != RMI_SUCCESS) {
-		ERROR("REC destroy failed, rec=0x%lx, ret=0x%lx\n",
-				realm->rec, ret);
-		return REALM_ERROR;
-	}
-
-	ret = rmi_granule_undelegate(realm->rec);
-	if (ret != RMI_SUCCESS) {
-		ERROR("rec undelegation failed, rec=0x%lx, ret=0x%lx\n",
-				realm->rec, ret);
-		return REALM_ERROR;
+	for (unsigned int i = 0U; i < realm->rec_count; i++) {
+		if (realm_destroy_one_rec(realm, i) != REALM_SUCCESS) {
+			return REALM_ERROR;
+		}
 	}
 
-	realm_free_rec_aux(realm->aux_pages, realm->num_aux);
-	page_free(realm->rec);
-
-	/* Free run object */
-	page_free(realm->run);
-
 	/*
 	 * For each data granule - Destroy, undelegate and free
 	 * RTTs (level 1U and below) must be destroyed leaf-upwards,
@@ -996,19 +1150,59 @@ undo_from_new_state:
 	return REALM_SUCCESS;
 }
 
+/*
+ * Return true if the faulting IPA reported in HPFAR_EL2 by a REC exit is in
+ * the unprotected half of the Realm IPA space.
+ */
+static bool realm_ipa_is_unprotected(struct realm *realm, u_register_t hpfar)
+{
+	u_register_t ipa = EXTRACT(HPFAR_EL2_FIPA, hpfar) <<
+			   HPFAR_EL2_FIPA_IPA_SHIFT;
 
-u_register_t realm_rec_enter(struct realm *realm, u_register_t *exit_reason,
-		unsigned int *test_result)
+	return (ipa & (1UL << (EXTRACT(RMM_FEATURE_REGISTER_0_S2SZ,
+			realm->rmm_feat_reg0) - 1))) != 0UL;
+}
+
+u_register_t realm_rec_enter(struct realm *realm, unsigned int rec_num,
+		u_register_t *exit_reason, unsigned int *test_result)
 {
-	struct rmi_rec_run *run = (struct rmi_rec_run *)realm->run;
+	struct rmi_rec_run *run = (struct rmi_rec_run *)realm->run[rec_num];
+	struct rec_exit_stats *stats = realm->exit_stats[rec_num];
+	uint64_t ticks = 0ULL;
 	u_register_t ret;
 	bool re_enter_rec;
 
 	do {
 		re_enter_rec = false;
-		ret = ((smc_ret_values)(tftf_smc(&(smc_args) {RMI_REC_ENTER,
-				realm->rec, realm->run,
+
+		if (stats != NULL) {
+			ticks = syscounter_read();
+		}
+
+		ret = ((smc_ret_values)(rmi_smc(&(smc_args) {RMI_REC_ENTER,
+				realm->rec[rec_num], realm->run[rec_num],
 				0UL, 0UL, 0UL, 0UL, 0UL}))).ret0;
+
+		if ((stats != NULL) && (ret == RMI_SUCCESS) &&
+		    (run->exit.exit_reason <= RMI_EXIT_SERROR)) {
+			perf_stats_add(&stats->exit[run->exit.exit_reason],
+				       syscounter_read() - ticks);
+		}
+
+		/* Only set for the entry following an emulated MMIO access */
+		run->entry.flags = RMI_NOT_EMULATED_MMIO;
+
+		/*
+		 * Fast path for the host calls which only measure the round
+		 * trip to the Realm.
+		 */
+		if ((ret == RMI_SUCCESS) &&
+		    (run->exit.exit_reason == RMI_EXIT_HOST_CALL) &&
+		    (run->exit.imm == HOST_CALL_PING_CMD)) {
+			re_enter_rec = true;
+			continue;
+		}
+
 		VERBOSE("rmi_rec_enter, \
 				run->exit_reason=0x%lx, \
 				run->exit.esr=0x%llx, \
@@ -1046,14 +1240,38 @@ u_register_t realm_rec_enter(struct realm *realm, u_register_t *exit_reason,
 			case HOST_CALL_EXIT_FAILED_CMD:
 				*test_result =  TEST_RESULT_FAIL;
 				break;
+			case HOST_CALL_LOG_FLUSH_CMD:
+				realm_shared_data_drain_log(realm);
+				re_enter_rec = true;
+				break;
 			default:
 				break;
 			}
 
+		} else if (run->exit.exit_reason == RMI_EXIT_IRQ) {
+			/* The interrupt is handled by the Host on return */
+			re_enter_rec = true;
+		} else if ((run->exit.exit_reason == RMI_EXIT_SYNC) &&
+			   (EC_BITS(run->exit.esr) == EC_DABORT_LOWER_EL) &&
+			   ((ISS_BITS(run->exit.esr) &
+			     BIT(ESR_ISS_DABORT_ISV_BIT)) != 0UL) &&
+			   realm_ipa_is_unprotected(realm, run->exit.hpfar)) {
+			/*
+			 * The Host has no device to emulate, accesses to
+			 * unprotected IPAs which are not mapped read as zero
+			 * and ignore writes. Aborts on protected IPAs are
+			 * returned to the caller.
+			 */
+			run->entry.gprs[0] = 0UL;
+			run->entry.flags = RMI_EMULATED_MMIO;
+			re_enter_rec = true;
 		}
 
 	} while (re_enter_rec);
 
+	/* Print what the Realm logged before it exited */
+	realm_shared_data_drain_log(realm);
+
 	*exit_reason = run->exit.exit_reason;
 
 	return ret;
@@ -1,107 +1,178 @@
 /*
- * Copyright (c) 2022, Arm Limited. All rights reserved.
+ * Copyright (c) 2022-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
 #include <string.h>
 
-#include <host_realm_mem_layout.h>
+#include <arch_helpers.h>
+#include <debug.h>
+#include <host_realm_rmi.h>
 #include <host_shared_data.h>
+#include <spinlock.h>
+
+/* Longest chunk of the Realm log printed at once, including the NUL */
+#define HOST_LOG_CHUNK_SIZE	128U
 
-static host_shared_data_t *host_shared_data =
-		((host_shared_data_t *)(NS_REALM_SHARED_MEM_BASE));
-static host_shared_data_t *guest_shared_data;
 /*
- * Return shared buffer pointer mapped as host_shared_data_t structure
+ * Serialises the Host CPUs consuming the Realm logs. Never taken by the
+ * Realms, which only ever write log_head.
  */
-host_shared_data_t *host_get_shared_structure(void)
-{
-	return host_shared_data;
-}
+static spinlock_t log_drain_lock;
 
 /*
- * Set guest mapped shared buffer pointer
+ * Return shared buffer pointer mapped as host_shared_data_t structure
  */
-void realm_set_shared_structure(host_shared_data_t *ptr)
+host_shared_data_t *host_get_shared_structure(struct realm *realm_ptr)
 {
-	guest_shared_data = ptr;
+	return realm_ptr->host_shared_data;
 }
 
 /*
- * Get guest mapped shared buffer pointer
+ * Return the shared data of REC 'rec_num'
  */
-host_shared_data_t *realm_get_shared_structure(void)
+static rec_shared_data_t *host_get_rec_data(struct realm *realm_ptr,
+		unsigned int rec_num)
 {
-	return guest_shared_data;
+	return &realm_ptr->host_shared_data->rec_data[
+		(rec_num >= REALM_MAX_REC_COUNT) ?
+		(REALM_MAX_REC_COUNT - 1U) : rec_num];
 }
 
 /*
- * Set data to be shared from Host to realm
+ * Set data to be shared from Host to REC 'rec_num'
  */
-void realm_shared_data_set_host_val(uint8_t index, u_register_t val)
+void realm_shared_data_set_host_val(struct realm *realm_ptr,
+		unsigned int rec_num, uint8_t index, u_register_t val)
 {
-	host_shared_data->host_param_val[(index >= MAX_DATA_SIZE) ?
-		(MAX_DATA_SIZE - 1) : index] = val;
+	host_get_rec_data(realm_ptr, rec_num)->host_param_val[
+		(index >= MAX_DATA_SIZE) ? (MAX_DATA_SIZE - 1) : index] = val;
 }
 
 /*
- * Set data to be shared from realm to Host
+ * Set data to be shared from REC 'rec_num' to Host
  */
-void realm_shared_data_set_realm_val(uint8_t index, u_register_t val)
+void realm_shared_data_set_realm_val(struct realm *realm_ptr,
+		unsigned int rec_num, uint8_t index, u_register_t val)
 {
-	host_shared_data->realm_out_val[(index >= MAX_DATA_SIZE) ?
-		(MAX_DATA_SIZE - 1) : index] = val;
+	host_get_rec_data(realm_ptr, rec_num)->realm_out_val[
+		(index >= MAX_DATA_SIZE) ? (MAX_DATA_SIZE - 1) : index] = val;
 }
 
 /*
- * Return Host's data at index
+ * Return REC 'rec_num' data at index
  */
-u_register_t realm_shared_data_get_host_val(uint8_t index)
+u_register_t realm_shared_data_get_realm_val(struct realm *realm_ptr,
+		unsigned int rec_num, uint8_t index)
 {
-	return guest_shared_data->host_param_val[(index >= MAX_DATA_SIZE) ?
-		(MAX_DATA_SIZE - 1) : index];
+	return host_get_rec_data(realm_ptr, rec_num)->realm_out_val[
+		(index >= MAX_DATA_SIZE) ? (MAX_DATA_SIZE - 1) : index];
 }
 
 /*
- * Return Realm's data at index
+ * Clear shared realm data of all RECs
  */
-u_register_t realm_shared_data_get_realm_val(uint8_t index)
+void realm_shared_data_clear_realm_val(struct realm *realm_ptr)
 {
-	return host_shared_data->realm_out_val[(index >= MAX_DATA_SIZE) ?
-		(MAX_DATA_SIZE - 1) : index];
+	rec_shared_data_t *rec_data = realm_ptr->host_shared_data->rec_data;
+
+	for (unsigned int i = 0U; i < REALM_MAX_REC_COUNT; i++) {
+		(void)memset((char *)rec_data[i].realm_out_val, 0,
+			     sizeof(rec_data[i].realm_out_val));
+	}
 }
 
 /*
- * Clear shared realm data
+ * Clear shared Host data of all RECs
  */
-void realm_shared_data_clear_realm_val(void)
+void realm_shared_data_clear_host_val(struct realm *realm_ptr)
 {
-	(void)memset((char *)host_shared_data->realm_out_val, 0,
-	MAX_DATA_SIZE * sizeof(host_shared_data->realm_out_val[0]));
+	rec_shared_data_t *rec_data = realm_ptr->host_shared_data->rec_data;
+
+	for (unsigned int i = 0U; i < REALM_MAX_REC_COUNT; i++) {
+		(void)memset((char *)rec_data[i].host_param_val, 0,
+			     sizeof(rec_data[i].host_param_val));
+	}
 }
 
 /*
- * Clear shared Host data
+ * Set command to be send from Host to REC 'rec_num'
  */
-void realm_shared_data_clear_host_val(void)
+void realm_shared_data_set_realm_cmd(struct realm *realm_ptr,
+		unsigned int rec_num, uint8_t cmd)
 {
-	(void)memset((char *)host_shared_data->host_param_val, 0,
-	MAX_DATA_SIZE * sizeof(host_shared_data->host_param_val[0]));
+	host_get_rec_data(realm_ptr, rec_num)->realm_cmd = cmd;
 }
 
 /*
- * Get command sent from Host to realm
+ * Reset the Realm log ring buffer
  */
-uint8_t realm_shared_data_get_realm_cmd(void)
+void realm_shared_data_reset_log(struct realm *realm_ptr)
 {
-	return guest_shared_data->realm_cmd;
+	host_shared_data_t *host_shared_data = realm_ptr->host_shared_data;
+
+	spin_lock(&log_drain_lock);
+	host_shared_data->log_head = 0U;
+	host_shared_data->log_tail = 0U;
+	host_shared_data->log_dropped = 0U;
+	realm_ptr->log_dropped_reported = 0U;
+	spin_unlock(&log_drain_lock);
 }
 
 /*
- * Set command to be send from Host to realm
+ * Print and consume the messages logged by the Realm. Called when a REC exits,
+ * so the Realm log no longer needs a CPU polling the shared buffer.
  */
-void realm_shared_data_set_realm_cmd(uint8_t cmd)
+void realm_shared_data_drain_log(struct realm *realm_ptr)
 {
-	host_shared_data->realm_cmd = cmd;
+	host_shared_data_t *host_shared_data = realm_ptr->host_shared_data;
+	char chunk[HOST_LOG_CHUNK_SIZE];
+	uint32_t head, tail, dropped;
+	uint32_t len, i;
+
+	if (host_shared_data == NULL) {
+		return;
+	}
+
+	/* Do not serialise REC exits on the lock when there is nothing new */
+	if ((host_shared_data->log_head == host_shared_data->log_tail) &&
+	    (host_shared_data->log_dropped == realm_ptr->log_dropped_reported)) {
+		return;
+	}
+
+	spin_lock(&log_drain_lock);
+	head = host_shared_data->log_head;
+	tail = host_shared_data->log_tail;
+
+	/* Read the characters only after the head that published them */
+	dmbish();
+
+	while (tail != head) {
+		len = head - tail;
+		if (len > (HOST_LOG_CHUNK_SIZE - 1U)) {
+			len = HOST_LOG_CHUNK_SIZE - 1U;
+		}
+
+		for (i = 0U; i < len; i++) {
+			chunk[i] = (char)host_shared_data->log_buffer[
+					(tail + i) & (MAX_BUF_SIZE - 1U)];
+		}
+		chunk[len] = '\0';
+		tail += len;
+
+		mp_printf("%s", chunk);
+	}
+
+	/* Release the space only once the characters have been read */
+	dmbish();
+	host_shared_data->log_tail = tail;
+
+	dropped = host_shared_data->log_dropped;
+	if (dropped != realm_ptr->log_dropped_reported) {
+		WARN("Realm log: %u characters dropped\n",
+		     dropped - realm_ptr->log_dropped_reported);
+		realm_ptr->log_dropped_reported = dropped;
+	}
+	spin_unlock(&log_drain_lock);
 }
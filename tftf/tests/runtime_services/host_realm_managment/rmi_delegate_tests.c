@@ -10,6 +10,7 @@
 #include <host_realm_helper.h>
 #include <host_realm_mem_layout.h>
 #include <host_shared_data.h>
+#include <perf_helpers.h>
 #include <plat_topology.h>
 #include <platform.h>
 #include <power_management.h>
@@ -325,3 +326,203 @@ test_result_t realm_fail_del(void)
 
 	return TEST_RESULT_SUCCESS;
 }
+
+/* Largest number of granules each CPU moves per pass of the benchmark */
+#define PERF_DELUNDEL_GRANULES		U(64)
+
+/* Number of delegate then undelegate passes of each CPU */
+#define PERF_DELUNDEL_ROUNDS		U(16)
+
+/*
+ * Layouts of the granules moved by the benchmark. Each CPU works on its own
+ * slice of the page pool, using every 'stride'-th granule of it, unless the
+ * layout is interleaved, in which case neighbouring granules, and so the same
+ * GPT descriptors, are shared between the CPUs.
+ */
+static const struct perf_delundel_layout {
+	const char *name;
+	unsigned int stride;
+	bool interleaved;
+} perf_delundel_layouts[] = {
+	{ "contiguous", 1U, false },
+	{ "stride 64KB", 16U, false },
+	{ "stride 256KB", 64U, false },
+	{ "interleaved", 1U, true },
+};
+
+static const struct perf_delundel_layout *perf_delundel_layout;
+
+static struct perf_delundel_data {
+	struct perf_stats del;
+	struct perf_stats undel;
+} delundel_data[PLATFORM_CORE_COUNT];
+
+static unsigned int perf_delundel_slice(void)
+{
+	return (PAGE_POOL_MAX_SIZE / GRANULE_SIZE) / PLATFORM_CORE_COUNT;
+}
+
+/* Number of granules each CPU moves per pass with the current layout */
+static unsigned int perf_delundel_count(void)
+{
+	return MIN(PERF_DELUNDEL_GRANULES,
+		   perf_delundel_slice() / perf_delundel_layout->stride);
+}
+
+static u_register_t perf_delundel_addr(unsigned int core_pos, unsigned int i)
+{
+	unsigned int granule;
+
+	if (perf_delundel_layout->interleaved) {
+		granule = (i * PLATFORM_CORE_COUNT) + core_pos;
+	} else {
+		granule = (core_pos * perf_delundel_slice()) +
+			  (i * perf_delundel_layout->stride);
+	}
+
+	return (u_register_t)PAGE_POOL_BASE +
+	       ((u_register_t)granule * GRANULE_SIZE);
+}
+
+/*
+ * Undelegate the granules 'first' to 'end' - 1 of the calling CPU, giving back
+ * the ones left delegated by a failed pass to the later tests.
+ */
+static void perf_delundel_release(unsigned int core_pos, unsigned int first,
+				  unsigned int end)
+{
+	for (unsigned int i = first; i < end; i++) {
+		(void)rmi_granule_undelegate(perf_delundel_addr(core_pos, i));
+	}
+}
+
+/*
+ * Delegate and undelegate the granules of the calling CPU, accounting for the
+ * latency of each RMI call.
+ */
+static test_result_t realm_perf_delundel(void)
+{
+	unsigned int core_pos = platform_get_core_pos(read_mpidr_el1() &
+						      MPID_MASK);
+	struct perf_delundel_data *data = &delundel_data[core_pos];
+	unsigned int count = perf_delundel_count();
+	uint64_t ticks, granules = 0ULL;
+	u_register_t retrmm;
+	unsigned int i;
+
+	perf_stats_init(&data->del);
+	perf_stats_init(&data->undel);
+	perf_throughput_start();
+
+	for (unsigned int round = 0U; round < PERF_DELUNDEL_ROUNDS; round++) {
+		for (i = 0U; i < count; i++) {
+			ticks = syscounter_read();
+			retrmm = rmi_granule_delegate(
+					perf_delundel_addr(core_pos, i));
+			perf_stats_add(&data->del, syscounter_read() - ticks);
+
+			if (retrmm != 0UL) {
+				ERROR("Delegate of 0x%lx returns %lx\n",
+				      perf_delundel_addr(core_pos, i), retrmm);
+				perf_delundel_release(core_pos, 0U, i);
+				return TEST_RESULT_FAIL;
+			}
+		}
+
+		for (i = 0U; i < count; i++) {
+			ticks = syscounter_read();
+			retrmm = rmi_granule_undelegate(
+					perf_delundel_addr(core_pos, i));
+			perf_stats_add(&data->undel, syscounter_read() - ticks);
+
+			if (retrmm != 0UL) {
+				ERROR("Undelegate of 0x%lx returns %lx\n",
+				      perf_delundel_addr(core_pos, i), retrmm);
+				perf_delundel_release(core_pos, i + 1U, count);
+				return TEST_RESULT_FAIL;
+			}
+		}
+
+		granules += count;
+	}
+
+	perf_throughput_end(granules);
+
+	return TEST_RESULT_SUCCESS;
+}
+
+/*
+ * Delegate and undelegate throughput, on 1 CPU and then doubling the number of
+ * CPUs up to all of them, for each layout of granules. Reports the number of
+ * granules moved to the Realm PAS and back per second, and the average cost
+ * of one delegate and one undelegate, which includes the GPT update and the
+ * TLB and cache maintenance done by EL3 for that granule.
+ */
+test_result_t realm_perf_delundel_multi_cpu(void)
+{
+	unsigned int cpus_count = tftf_get_total_cpus_count();
+	struct perf_stats del, undel;
+	struct perf_throughput tp;
+	unsigned int cpus;
+	test_result_t ret;
+
+	if (get_armv9_2_feat_rme_support() == 0U) {
+		return TEST_RESULT_SKIPPED;
+	}
+
+	if (perf_delundel_slice() == 0U) {
+		tftf_testcase_printf("No page pool to delegate\n");
+		return TEST_RESULT_SKIPPED;
+	}
+
+	for (unsigned int l = 0U; l < ARRAY_SIZE(perf_delundel_layouts); l++) {
+		perf_delundel_layout = &perf_delundel_layouts[l];
+
+		if (perf_delundel_count() == 0U) {
+			continue;
+		}
+
+		for_each_perf_cpu_count(cpus, 1U, cpus_count) {
+			ret = perf_run_on_cpus(cpus, realm_perf_delundel);
+			if (ret != TEST_RESULT_SUCCESS) {
+				return ret;
+			}
+
+			perf_throughput_collect(&tp);
+			perf_stats_init(&del);
+			perf_stats_init(&undel);
+
+			for (unsigned int i = 0U; i < PLATFORM_CORE_COUNT; i++) {
+				if (!perf_throughput_has_cpu(i)) {
+					continue;
+				}
+
+				perf_stats_merge(&del, &delundel_data[i].del);
+				perf_stats_merge(&undel,
+						 &delundel_data[i].undel);
+			}
+
+			if (tp.events == 0ULL) {
+				ERROR("No granule was delegated\n");
+				return TEST_RESULT_FAIL;
+			}
+
+			printf("%s, %u CPUs: %llu granules/s\n",
+			       perf_delundel_layout->name, cpus,
+			       (unsigned long long)perf_throughput_rate(&tp));
+			perf_stats_print("  delegate", &del, false);
+			perf_stats_print("  undelegate", &undel, false);
+
+			tftf_testcase_printf("%s, %u CPUs: %llu granules/s, "
+				"delegate %llu ns, undelegate %llu ns\n",
+				perf_delundel_layout->name, cpus,
+				(unsigned long long)perf_throughput_rate(&tp),
+				(unsigned long long)perf_ticks_to_ns(
+						perf_stats_avg(&del)),
+				(unsigned long long)perf_ticks_to_ns(
+						perf_stats_avg(&undel)));
+		}
+	}
+
+	return TEST_RESULT_SUCCESS;
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2021-2022, Arm Limited. All rights reserved.
+ * Copyright (c) 2021-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -7,12 +7,25 @@
 #include <stdlib.h>
 
 #include <arch_features.h>
+#include <arch_helpers.h>
 #include <debug.h>
 #include <host_realm_helper.h>
 #include <host_realm_mem_layout.h>
+#include <host_realm_rmi.h>
 #include <host_shared_data.h>
+#include <perf_helpers.h>
+#include <plat_topology.h>
+#include <platform.h>
+#include <timer.h>
+#include <utils_def.h>
 
 #define SLEEP_TIME_MS	200U
+
+/* Bytes in a MB, for the payload size normalised timings */
+#define REALM_PERF_MB	(1024U * 1024U)
+
+static struct realm realm;
+
 /*
  * @Test_Aim@ Test realm payload creation and execution
  */
@@ -38,21 +51,20 @@ test_result_t test_realm_create_enter(void)
 		return TEST_RESULT_SKIPPED;
 	}
 
-	if (!host_create_realm_payload((u_register_t)REALM_IMAGE_BASE,
+	if (!host_create_realm_payload(&realm, (u_register_t)REALM_IMAGE_BASE,
 			(u_register_t)PAGE_POOL_BASE,
-			(u_register_t)(PAGE_POOL_MAX_SIZE +
-			NS_REALM_SHARED_MEM_SIZE),
-			(u_register_t)PAGE_POOL_MAX_SIZE)) {
+			(u_register_t)PAGE_POOL_MAX_SIZE, 1U)) {
 		return TEST_RESULT_FAIL;
 	}
-	if (!host_create_shared_mem(NS_REALM_SHARED_MEM_BASE,
+	if (!host_create_shared_mem(&realm, NS_REALM_SHARED_MEM_BASE,
 			NS_REALM_SHARED_MEM_SIZE)) {
 		return TEST_RESULT_FAIL;
 	}
 
-	realm_shared_data_set_host_val(HOST_SLEEP_INDEX, SLEEP_TIME_MS);
-	ret1 = host_enter_realm_execute(REALM_SLEEP_CMD);
-	ret2 = host_destroy_realm();
+	realm_shared_data_set_host_val(&realm, 0U, HOST_SLEEP_INDEX,
+				       SLEEP_TIME_MS);
+	ret1 = host_enter_realm_execute(&realm, REALM_SLEEP_CMD, 0U);
+	ret2 = host_destroy_realm(&realm);
 
 	if (!ret1 || !ret2) {
 		ERROR("test_realm_create_enter create:%d destroy:%d\n",
@@ -61,3 +73,382 @@ test_result_t test_realm_create_enter(void)
 	}
 	return TEST_RESULT_SUCCESS;
 }
+
+static void print_rmi_call_count(const char *name, u_register_t fid)
+{
+	printf("  %s: %lu\n", name, host_rmi_get_call_count(fid));
+}
+
+/* Whether the PAR of 'realm_ptr' holds a 2MB aligned block */
+static bool realm_par_has_block(const struct realm *realm_ptr)
+{
+	u_register_t block = ALIGN(realm_ptr->par_base, RTT_L2_BLOCK_SIZE);
+
+	return (block + RTT_L2_BLOCK_SIZE) <=
+	       (realm_ptr->par_base + realm_ptr->par_size);
+}
+
+/*
+ * @Test_Aim@ Measure the time and number of RMI calls taken to create a Realm
+ * and map its payload, and to destroy it. The test is skipped when the PAR
+ * holds no 2MB aligned block, as the payload is then only mapped with pages.
+ */
+test_result_t test_realm_perf_create(void)
+{
+	uint64_t create_ticks, destroy_ticks, ticks_per_mb;
+	unsigned long create_calls;
+	u_register_t retrmm;
+	bool ret;
+
+	if (get_armv9_2_feat_rme_support() == 0U) {
+		INFO("platform doesn't support RME\n");
+		return TEST_RESULT_SKIPPED;
+	}
+
+	retrmm = rmi_version();
+	if (retrmm == 0UL) {
+		INFO("Test case not supported for TRP as RMM\n");
+		return TEST_RESULT_SKIPPED;
+	}
+
+	host_rmi_reset_call_count();
+	create_ticks = syscounter_read();
+
+	if (!host_create_realm_payload(&realm, (u_register_t)REALM_IMAGE_BASE,
+			(u_register_t)PAGE_POOL_BASE,
+			(u_register_t)PAGE_POOL_MAX_SIZE, 1U)) {
+		return TEST_RESULT_FAIL;
+	}
+
+	create_ticks = syscounter_read() - create_ticks;
+	create_calls = host_rmi_get_total_call_count();
+
+	if (!realm_par_has_block(&realm)) {
+		tftf_testcase_printf("PAR 0x%lx-0x%lx holds no 2MB aligned "
+				     "block to map\n", realm.par_base,
+				     realm.par_base + realm.par_size);
+		return host_destroy_realm(&realm) ? TEST_RESULT_SKIPPED :
+						    TEST_RESULT_FAIL;
+	}
+
+	printf("Realm creation: %lu RMI calls, including\n", create_calls);
+	print_rmi_call_count("GRANULE_DELEGATE", RMI_GRANULE_DELEGATE);
+	print_rmi_call_count("DATA_CREATE", RMI_DATA_CREATE);
+	print_rmi_call_count("RTT_CREATE", RMI_RTT_CREATE);
+	print_rmi_call_count("RTT_INIT_RIPAS", RMI_RTT_INIT_RIPAS);
+	print_rmi_call_count("RTT_FOLD", RMI_RTT_FOLD);
+
+	host_rmi_reset_call_count();
+	destroy_ticks = syscounter_read();
+	ret = host_destroy_realm(&realm);
+	destroy_ticks = syscounter_read() - destroy_ticks;
+
+	if (!ret) {
+		return TEST_RESULT_FAIL;
+	}
+
+	ticks_per_mb = (create_ticks * REALM_PERF_MB) / REALM_MAX_LOAD_IMG_SIZE;
+
+	printf("Realm creation: %llu ns, %llu ticks per MB of payload\n",
+	       (unsigned long long)perf_ticks_to_ns(create_ticks),
+	       (unsigned long long)ticks_per_mb);
+	printf("Realm destruction: %llu ns, %lu RMI calls\n",
+	       (unsigned long long)perf_ticks_to_ns(destroy_ticks),
+	       host_rmi_get_total_call_count());
+
+	tftf_testcase_printf("create: %lu RMI calls, %llu ns, %llu ticks/MB\n",
+		create_calls,
+		(unsigned long long)perf_ticks_to_ns(create_ticks),
+		(unsigned long long)ticks_per_mb);
+
+	return TEST_RESULT_SUCCESS;
+}
+
+/* Number of REC entries measured on each CPU */
+#define REC_ENTER_ITERATIONS	1000U
+
+static struct realm perf_realms[MAX_REALM_COUNT];
+static unsigned int perf_realm_count;
+
+/* Latency of the REC entries of each CPU */
+static struct perf_stats rec_enter_stats[PLATFORM_CORE_COUNT];
+
+/*
+ * Each CPU enters its own REC: CPUs are spread round-robin across the Realms,
+ * so that the CPU at 'core_pos' uses REC 'core_pos / perf_realm_count' of
+ * Realm 'core_pos % perf_realm_count'.
+ */
+static unsigned int perf_rec_count(unsigned int realm_count)
+{
+	return MIN(div_round_up(PLATFORM_CORE_COUNT, realm_count),
+		   REALM_MAX_REC_COUNT);
+}
+
+static void perf_destroy_realms(void)
+{
+	for (unsigned int i = 0U; i < perf_realm_count; i++) {
+		(void)host_destroy_realm(&perf_realms[i]);
+	}
+	perf_realm_count = 0U;
+}
+
+/*
+ * Create 'realm_count' Realms, each with its own memory pool and shared region,
+ * and enter each of their RECs once, REC 0 first as it initialises the image.
+ */
+static bool perf_create_realms(unsigned int realm_count)
+{
+	unsigned int rec_count = perf_rec_count(realm_count);
+	struct realm *realm_ptr;
+
+	for (unsigned int i = 0U; i < realm_count; i++) {
+		realm_ptr = &perf_realms[i];
+
+		if (!host_create_realm_payload(realm_ptr,
+				(u_register_t)REALM_IMAGE_BASE,
+				(u_register_t)REALM_PAGE_POOL_BASE(i),
+				(u_register_t)REALM_PAGE_POOL_SIZE,
+				rec_count)) {
+			goto err_destroy_realms;
+		}
+		perf_realm_count++;
+
+		if (!host_create_shared_mem(realm_ptr,
+				REALM_NS_SHARED_MEM_BASE(i),
+				REALM_NS_SHARED_MEM_SIZE)) {
+			goto err_destroy_realms;
+		}
+
+		for (unsigned int j = 0U; j < rec_count; j++) {
+			if (!host_enter_realm_execute(realm_ptr, REALM_NOP_CMD,
+						      j)) {
+				goto err_destroy_realms;
+			}
+		}
+	}
+
+	return true;
+
+err_destroy_realms:
+	perf_destroy_realms();
+	return false;
+}
+
+/*
+ * Executed concurrently on all CPUs, each entering its own REC repeatedly.
+ */
+static test_result_t realm_perf_rec_enter(void)
+{
+	unsigned int core_pos = get_current_core_id();
+	struct perf_stats *stats = &rec_enter_stats[core_pos];
+	struct realm *realm_ptr = &perf_realms[core_pos % perf_realm_count];
+	unsigned int rec_num = core_pos / perf_realm_count;
+	uint64_t ticks;
+
+	perf_stats_init(stats);
+
+	/* No REC left for this CPU */
+	if (rec_num >= realm_ptr->rec_count) {
+		return TEST_RESULT_SUCCESS;
+	}
+
+	perf_throughput_start();
+	for (unsigned int i = 0U; i < REC_ENTER_ITERATIONS; i++) {
+		ticks = syscounter_read();
+		if (!host_enter_realm_execute(realm_ptr, REALM_NOP_CMD,
+					      rec_num)) {
+			return TEST_RESULT_FAIL;
+		}
+		perf_stats_add(stats, syscounter_read() - ticks);
+	}
+	perf_throughput_end(REC_ENTER_ITERATIONS);
+
+	return TEST_RESULT_SUCCESS;
+}
+
+/*
+ * @Test_Aim@ Measure the aggregate number of REC entries per second with all
+ * CPUs entering a different REC at the same time, as the RECs are spread over
+ * 1, 2, ... MAX_REALM_COUNT Realms. The slowdown of the average entry compared
+ * to a single CPU entering alone shows the contention on RMM locks.
+ */
+test_result_t test_realm_perf_rec_enter_scaling(void)
+{
+	unsigned int cpus_count = tftf_get_total_cpus_count();
+	struct perf_throughput tp;
+	struct perf_stats stats, single_stats;
+	test_result_t ret;
+	u_register_t retrmm;
+
+	if (get_armv9_2_feat_rme_support() == 0U) {
+		INFO("platform doesn't support RME\n");
+		return TEST_RESULT_SKIPPED;
+	}
+
+	retrmm = rmi_version();
+	if (retrmm == 0UL) {
+		INFO("Test case not supported for TRP as RMM\n");
+		return TEST_RESULT_SKIPPED;
+	}
+
+	for (unsigned int realm_count = 1U; realm_count <= MAX_REALM_COUNT;
+	     realm_count++) {
+		if (!perf_create_realms(realm_count)) {
+			return TEST_RESULT_FAIL;
+		}
+
+		/* Baseline, the lead CPU entering its REC alone */
+		ret = perf_run_on_cpus(1U, realm_perf_rec_enter);
+		if (ret != TEST_RESULT_SUCCESS) {
+			perf_destroy_realms();
+			return ret;
+		}
+		single_stats = rec_enter_stats[get_current_core_id()];
+
+		ret = perf_run_on_cpus(cpus_count, realm_perf_rec_enter);
+		if (ret != TEST_RESULT_SUCCESS) {
+			perf_destroy_realms();
+			return ret;
+		}
+
+		perf_throughput_collect(&tp);
+		perf_stats_init(&stats);
+
+		for (unsigned int i = 0U; i < PLATFORM_CORE_COUNT; i++) {
+			if (perf_throughput_has_cpu(i)) {
+				perf_stats_merge(&stats, &rec_enter_stats[i]);
+			}
+		}
+
+		perf_destroy_realms();
+
+		if (tp.events == 0ULL) {
+			ERROR("No REC was entered\n");
+			return TEST_RESULT_FAIL;
+		}
+
+		printf("%u Realms, %u RECs each: %llu enters/s\n", realm_count,
+		       perf_rec_count(realm_count),
+		       (unsigned long long)perf_throughput_rate(&tp));
+		perf_stats_print("  alone", &single_stats, false);
+		perf_stats_print("  all CPUs", &stats, false);
+
+		tftf_testcase_printf("%u Realms: %llu enters/s, avg %llu ns "
+			"(%llu ns alone)\n", realm_count,
+			(unsigned long long)perf_throughput_rate(&tp),
+			(unsigned long long)perf_ticks_to_ns(
+						perf_stats_avg(&stats)),
+			(unsigned long long)perf_ticks_to_ns(
+						perf_stats_avg(&single_stats)));
+	}
+
+	return TEST_RESULT_SUCCESS;
+}
+
+/* Number of exits of each kind in one Realm command, and number of commands */
+#define REC_EXIT_ITERATIONS	1000U
+#define REC_EXIT_ROUNDS		10U
+
+static struct rec_exit_stats exit_stats;
+
+static int rec_exit_timer_handler(void *data)
+{
+	return 0;
+}
+
+/*
+ * @Test_Aim@ Measure the round trip latency of REC entries, split by REC exit
+ * reason: host calls, IRQs, and data aborts of emulated MMIO reads. A timer is
+ * programmed before each Realm command so that the Realm also exits on an IRQ.
+ */
+test_result_t test_realm_perf_rec_exit_latency(void)
+{
+	static const struct {
+		const char *name;
+		unsigned int reason;
+	} exits[] = {
+		{ "Host call", RMI_EXIT_HOST_CALL },
+		{ "IRQ", RMI_EXIT_IRQ },
+		{ "Data abort", RMI_EXIT_SYNC },
+	};
+	struct perf_stats *stats;
+	u_register_t retrmm;
+	bool ret = true;
+
+	if (get_armv9_2_feat_rme_support() == 0U) {
+		INFO("platform doesn't support RME\n");
+		return TEST_RESULT_SKIPPED;
+	}
+
+	retrmm = rmi_version();
+	if (retrmm == 0UL) {
+		INFO("Test case not supported for TRP as RMM\n");
+		return TEST_RESULT_SKIPPED;
+	}
+
+	if (!host_create_realm_payload(&realm, (u_register_t)REALM_IMAGE_BASE,
+			(u_register_t)PAGE_POOL_BASE,
+			(u_register_t)PAGE_POOL_MAX_SIZE, 1U)) {
+		return TEST_RESULT_FAIL;
+	}
+	if (!host_create_shared_mem(&realm, NS_REALM_SHARED_MEM_BASE,
+			NS_REALM_SHARED_MEM_SIZE)) {
+		(void)host_destroy_realm(&realm);
+		return TEST_RESULT_FAIL;
+	}
+
+	/* Let the Realm boot before profiling its entries */
+	if (!host_enter_realm_execute(&realm, REALM_NOP_CMD, 0U)) {
+		(void)host_destroy_realm(&realm);
+		return TEST_RESULT_FAIL;
+	}
+
+	for (unsigned int i = 0U; i < ARRAY_SIZE(exit_stats.exit); i++) {
+		perf_stats_init(&exit_stats.exit[i]);
+	}
+	realm.exit_stats[0] = &exit_stats;
+
+	/* The page following the shared region is not mapped in the Realm */
+	realm_shared_data_set_host_val(&realm, 0U, HOST_ITERATIONS_INDEX,
+				       REC_EXIT_ITERATIONS);
+	realm_shared_data_set_host_val(&realm, 0U, HOST_MMIO_IPA_INDEX,
+				       realm.ipa_ns_buffer +
+				       realm.ns_buffer_size);
+
+	tftf_timer_register_handler(rec_exit_timer_handler);
+
+	for (unsigned int i = 0U; (i < REC_EXIT_ROUNDS) && ret; i++) {
+		tftf_program_timer(1U);
+		ret = host_enter_realm_execute(&realm, REALM_EXIT_LOOP_CMD,
+					       0U);
+		tftf_cancel_timer();
+	}
+
+	tftf_timer_unregister_handler();
+	realm.exit_stats[0] = NULL;
+
+	if (!host_destroy_realm(&realm) || !ret) {
+		return TEST_RESULT_FAIL;
+	}
+
+	for (unsigned int i = 0U; i < ARRAY_SIZE(exits); i++) {
+		stats = &exit_stats.exit[exits[i].reason];
+
+		perf_stats_print(exits[i].name, stats, true);
+		tftf_testcase_printf("%s: %llu exits, avg %llu ns, "
+			"p99 %llu ns\n", exits[i].name,
+			(unsigned long long)stats->count,
+			(unsigned long long)perf_ticks_to_ns(
+						perf_stats_avg(stats)),
+			(unsigned long long)perf_ticks_to_ns(
+					perf_stats_percentile(stats, 99U)));
+	}
+
+	if (exit_stats.exit[RMI_EXIT_HOST_CALL].count <
+	    ((uint64_t)REC_EXIT_ROUNDS * REC_EXIT_ITERATIONS)) {
+		ERROR("Missing host call exits\n");
+		return TEST_RESULT_FAIL;
+	}
+
+	return TEST_RESULT_SUCCESS;
+}
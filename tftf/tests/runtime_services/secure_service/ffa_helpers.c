@@ -345,6 +345,38 @@ struct ffa_value ffa_msg_wait(void)
 	return ffa_service_call(&args);
 }
 
+/* Send the partition message in the TX buffer of the caller. */
+struct ffa_value ffa_msg_send2(uint32_t flags)
+{
+	struct ffa_value args = {
+		.fid = FFA_MSG_SEND2,
+		.arg1 = FFA_PARAM_MBZ,
+		.arg2 = flags,
+		.arg3 = FFA_PARAM_MBZ,
+		.arg4 = FFA_PARAM_MBZ,
+		.arg5 = FFA_PARAM_MBZ,
+		.arg6 = FFA_PARAM_MBZ,
+		.arg7 = FFA_PARAM_MBZ
+	};
+
+	return ffa_service_call(&args);
+}
+
+/*
+ * Initialise the header of a partition message, with the payload following
+ * the header in the buffer.
+ */
+void ffa_rxtx_header_init(ffa_id_t sender, ffa_id_t receiver, uint32_t size,
+			  struct ffa_partition_rxtx_header *header)
+{
+	header->flags = 0;
+	header->reserved = 0;
+	header->offset = FFA_RXTX_HEADER_SIZE;
+	header->receiver = receiver;
+	header->sender = sender;
+	header->size = size;
+}
+
 struct ffa_value ffa_error(int32_t error_code)
 {
 	struct ffa_value args = {
@@ -611,3 +611,62 @@ bool ffa_partition_info_helper(struct mailbox_buffers *mb,
 	}
 	return result;
 }
+
+struct ffa_value send_indirect_message(ffa_id_t sender, ffa_id_t receiver,
+				       void *send, const void *payload,
+				       size_t payload_size,
+				       uint32_t send_flags)
+{
+	struct ffa_partition_rxtx_header *header =
+		(struct ffa_partition_rxtx_header *)send;
+
+	if (payload_size > FFA_MSG_PAYLOAD_MAX) {
+		ERROR("Indirect message payload too big (%u)\n",
+		      (unsigned int)payload_size);
+		return (struct ffa_value){
+			.fid = FFA_ERROR,
+			.arg2 = (uint32_t)FFA_ERROR_INVALID_PARAMETER
+		};
+	}
+
+	ffa_rxtx_header_init(sender, receiver, payload_size, header);
+	memcpy((uint8_t *)send + header->offset, payload, payload_size);
+
+	return ffa_msg_send2(send_flags);
+}
+
+bool receive_indirect_message(void *buffer, size_t buffer_size,
+			      const void *recv, ffa_id_t receiver,
+			      ffa_id_t *sender, size_t *size)
+{
+	const struct ffa_partition_rxtx_header *header =
+		(const struct ffa_partition_rxtx_header *)recv;
+	struct ffa_value ret;
+
+	if (header->receiver != receiver) {
+		ERROR("Indirect message for %x received by %x\n",
+		      header->receiver, receiver);
+		return false;
+	}
+
+	if ((header->size > buffer_size) ||
+	    (header->offset < FFA_RXTX_HEADER_SIZE) ||
+	    (header->size > (PAGE_SIZE - header->offset))) {
+		ERROR("Invalid indirect message (offset %u, size %u)\n",
+		      header->offset, header->size);
+		return false;
+	}
+
+	memcpy(buffer, (const uint8_t *)recv + header->offset, header->size);
+
+	*sender = header->sender;
+	*size = header->size;
+
+	ret = ffa_rx_release();
+	if (is_ffa_call_error(ret)) {
+		ERROR("Failed to release the RX buffer\n");
+		return false;
+	}
+
+	return true;
+}
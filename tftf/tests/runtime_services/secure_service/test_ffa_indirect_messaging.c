@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <debug.h>
+#include <smccc.h>
+
+#include <cactus_test_cmds.h>
+#include <ffa_endpoints.h>
+#include <ffa_svc.h>
+#include <platform.h>
+#include <spm_common.h>
+#include <test_helpers.h>
+
+static const struct ffa_uuid expected_sp_uuids[] = {
+		{PRIMARY_UUID}, {SECONDARY_UUID}, {TERTIARY_UUID}
+	};
+
+static const char msg[] = "FF-A indirect message from the NWd";
+
+/**
+ * Request SP 'receiver' to read the indirect message in its RX buffer, and
+ * check it matches the message sent by the NWd.
+ */
+static bool check_sp_read_indirect_message(ffa_id_t receiver,
+					   const void *payload, size_t size)
+{
+	struct ffa_value ret;
+
+	ret = cactus_indirect_msg_read_send_cmd(HYP_ID, receiver,
+						get_current_core_id());
+
+	if (!is_ffa_direct_response(ret) ||
+	    (cactus_get_response(ret) != CACTUS_SUCCESS)) {
+		ERROR("%x failed to read the indirect message\n", receiver);
+		return false;
+	}
+
+	if ((cactus_indirect_msg_sender(ret) != HYP_ID) ||
+	    (cactus_indirect_msg_size(ret) != size) ||
+	    (cactus_indirect_msg_checksum(ret) !=
+	     cactus_indirect_msg_payload_checksum(payload, size))) {
+		ERROR("Unexpected indirect message (sender %x, size %u)\n",
+		      cactus_indirect_msg_sender(ret),
+		      cactus_indirect_msg_size(ret));
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * Send an indirect message to an SP, and check the SP retrieves it from its RX
+ * buffer. While the message hasn't been read, the receiver's RX buffer is
+ * full and sending another message must fail with FFA_ERROR_BUSY.
+ */
+test_result_t test_ffa_indirect_message_sp(void)
+{
+	struct mailbox_buffers mb;
+	struct ffa_value ret;
+
+	CHECK_SPMC_TESTING_SETUP(1, 1, expected_sp_uuids);
+
+	GET_TFTF_MAILBOX(mb);
+
+	ret = send_indirect_message(HYP_ID, SP_ID(1), mb.send, msg,
+				    sizeof(msg), 0);
+	if (!is_expected_ffa_return(ret, FFA_SUCCESS_SMC32)) {
+		ERROR("Failed to send the indirect message\n");
+		return TEST_RESULT_FAIL;
+	}
+
+	ret = send_indirect_message(HYP_ID, SP_ID(1), mb.send, msg,
+				    sizeof(msg), 0);
+	if (!is_expected_ffa_error(ret, FFA_ERROR_BUSY)) {
+		ERROR("Expected FFA_ERROR_BUSY with the RX buffer full\n");
+		return TEST_RESULT_FAIL;
+	}
+
+	if (!check_sp_read_indirect_message(SP_ID(1), msg, sizeof(msg))) {
+		return TEST_RESULT_FAIL;
+	}
+
+	/* The RX buffer has been released, another message can be sent. */
+	ret = send_indirect_message(HYP_ID, SP_ID(1), mb.send, msg,
+				    sizeof(msg), 0);
+	if (!is_expected_ffa_return(ret, FFA_SUCCESS_SMC32)) {
+		ERROR("Failed to send the indirect message\n");
+		return TEST_RESULT_FAIL;
+	}
+
+	if (!check_sp_read_indirect_message(SP_ID(1), msg, sizeof(msg))) {
+		return TEST_RESULT_FAIL;
+	}
+
+	return TEST_RESULT_SUCCESS;
+}
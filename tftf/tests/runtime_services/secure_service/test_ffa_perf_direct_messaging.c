@@ -0,0 +1,412 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * This file contains benchmarks of the FF-A direct messaging interfaces. They
+ * measure the round trip latency of a direct request from the normal world to
+ * a Secure Partition and back, and the aggregate number of direct messages per
+ * second the SPMC can sustain as the number of cores issuing them grows.
+ * The results are only reported, these tests fail only if a message fails.
+ */
+
+#include <debug.h>
+#include <smccc.h>
+
+#include <arch_helpers.h>
+#include <cactus_test_cmds.h>
+#include <ffa_endpoints.h>
+#include <ffa_svc.h>
+#include <lib/events.h>
+#include <perf_helpers.h>
+#include <plat_topology.h>
+#include <platform.h>
+#include <power_management.h>
+#include <test_helpers.h>
+#include <utils_def.h>
+
+/* Number of round trips measured per partition and per CPU. */
+#define PERF_ITERATIONS		1000U
+
+/* Number of messages sent by each CPU in the throughput benchmark. */
+#define PERF_MC_ITERATIONS	2000U
+
+static const struct ffa_uuid expected_sp_uuids[] = {
+		{PRIMARY_UUID}, {SECONDARY_UUID}, {TERTIARY_UUID}
+	};
+
+static const struct ffa_uuid expected_ivy_uuids[] = {
+		{PRIMARY_UUID}, {IVY_UUID}
+	};
+
+static event_t cpu_booted[PLATFORM_CORE_COUNT];
+
+/* Latency of the messages to SP1 and SP2, for each vCPU. */
+static struct perf_stats vcpu_stats[PLATFORM_CORE_COUNT][2];
+
+/* Latency of the messages of each CPU in the throughput benchmark. */
+static struct perf_stats mc_stats[PLATFORM_CORE_COUNT];
+
+/*
+ * Send a direct request to 'dest' and check the response.
+ * Cactus partitions are sent CACTUS_ECHO_CMD and are expected to echo 'val'.
+ * Ivy replies with an empty direct response to any direct request.
+ */
+static bool perf_direct_req(ffa_id_t dest, bool smc64, bool echo,
+			    uint32_t val)
+{
+	struct ffa_value ret;
+
+	if (smc64) {
+		ret = cactus_echo_send_cmd(HYP_ID, dest, val);
+	} else {
+		ret = ffa_msg_send_direct_req32(HYP_ID, dest, CACTUS_ECHO_CMD,
+						val, 0, 0, 0);
+	}
+
+	if (!is_ffa_direct_response(ret)) {
+		return false;
+	}
+
+	if (echo && ((cactus_get_response(ret) != CACTUS_SUCCESS) ||
+		     ((uint32_t)cactus_echo_get_val(ret) != val))) {
+		ERROR("Echo to %x failed!\n", dest);
+		return false;
+	}
+
+	return true;
+}
+
+/*
+ * Measure 'iterations' direct request round trips to 'dest' from the calling
+ * CPU and account for them in 'stats'.
+ */
+static bool perf_measure_direct_req(ffa_id_t dest, bool smc64, bool echo,
+				    unsigned int iterations,
+				    struct perf_stats *stats)
+{
+	uint64_t ticks;
+
+	for (unsigned int i = 0U; i < iterations; i++) {
+		ticks = syscounter_read();
+		if (!perf_direct_req(dest, smc64, echo, ECHO_VAL1 + i)) {
+			return false;
+		}
+		ticks = syscounter_read() - ticks;
+
+		perf_stats_add(stats, ticks);
+	}
+
+	return true;
+}
+
+static test_result_t perf_direct_req_latency(ffa_id_t dest, bool smc64,
+					     bool echo, const char *name)
+{
+	struct perf_stats stats;
+
+	perf_stats_init(&stats);
+
+	if (!perf_measure_direct_req(dest, smc64, echo, PERF_ITERATIONS,
+				     &stats)) {
+		return TEST_RESULT_FAIL;
+	}
+
+	perf_stats_print(name, &stats, true);
+	tftf_testcase_printf("%s: avg %llu ns, p99 %llu ns\n", name,
+		(unsigned long long)perf_ticks_to_ns(perf_stats_avg(&stats)),
+		(unsigned long long)perf_ticks_to_ns(
+					perf_stats_percentile(&stats, 99U)));
+
+	return TEST_RESULT_SUCCESS;
+}
+
+/*
+ * Measure the latency of SMC64 direct requests to each of the Cactus S-EL1
+ * partitions, from the lead CPU.
+ */
+test_result_t test_ffa_perf_direct_msg_latency_smc64(void)
+{
+	test_result_t ret;
+
+	CHECK_SPMC_TESTING_SETUP(1, 0, expected_sp_uuids);
+
+	ret = perf_direct_req_latency(SP_ID(1), true, true, "SP1 SMC64");
+	if (ret != TEST_RESULT_SUCCESS) {
+		return ret;
+	}
+
+	ret = perf_direct_req_latency(SP_ID(2), true, true, "SP2 SMC64");
+	if (ret != TEST_RESULT_SUCCESS) {
+		return ret;
+	}
+
+	return perf_direct_req_latency(SP_ID(3), true, true, "SP3 SMC64");
+}
+
+/*
+ * Measure the latency of SMC32 direct requests to each of the Cactus S-EL1
+ * partitions, from the lead CPU.
+ */
+test_result_t test_ffa_perf_direct_msg_latency_smc32(void)
+{
+	test_result_t ret;
+
+	CHECK_SPMC_TESTING_SETUP(1, 0, expected_sp_uuids);
+
+	ret = perf_direct_req_latency(SP_ID(1), false, true, "SP1 SMC32");
+	if (ret != TEST_RESULT_SUCCESS) {
+		return ret;
+	}
+
+	ret = perf_direct_req_latency(SP_ID(2), false, true, "SP2 SMC32");
+	if (ret != TEST_RESULT_SUCCESS) {
+		return ret;
+	}
+
+	return perf_direct_req_latency(SP_ID(3), false, true, "SP3 SMC32");
+}
+
+/*
+ * Measure the latency of SMC32 direct requests to Ivy (S-EL0 partition) and
+ * to Cactus SP1 (S-EL1 partition), for comparison.
+ */
+test_result_t test_ffa_perf_direct_msg_latency_ivy(void)
+{
+	test_result_t ret;
+
+	CHECK_SPMC_TESTING_SETUP(1, 0, expected_ivy_uuids);
+
+	ret = perf_direct_req_latency(SP_ID(1), false, true, "Cactus SMC32");
+	if (ret != TEST_RESULT_SUCCESS) {
+		return ret;
+	}
+
+	return perf_direct_req_latency(SP_ID(4), false, false, "Ivy SMC32");
+}
+
+static test_result_t perf_vcpu_latency(void)
+{
+	unsigned int core_pos = get_current_core_id();
+
+	perf_stats_init(&vcpu_stats[core_pos][0]);
+	perf_stats_init(&vcpu_stats[core_pos][1]);
+
+	if (!perf_measure_direct_req(SP_ID(1), true, true, PERF_ITERATIONS,
+				     &vcpu_stats[core_pos][0])) {
+		return TEST_RESULT_FAIL;
+	}
+
+	if (!perf_measure_direct_req(SP_ID(2), true, true, PERF_ITERATIONS,
+				     &vcpu_stats[core_pos][1])) {
+		return TEST_RESULT_FAIL;
+	}
+
+	return TEST_RESULT_SUCCESS;
+}
+
+static test_result_t perf_vcpu_latency_on_handler(void)
+{
+	unsigned int core_pos = get_current_core_id();
+	test_result_t ret = TEST_RESULT_FAIL;
+
+	if (spm_core_sp_init(SP_ID(2))) {
+		ret = perf_vcpu_latency();
+	}
+
+	/* Tell the lead CPU that the calling CPU has completed the test */
+	tftf_send_event(&cpu_booted[core_pos]);
+
+	return ret;
+}
+
+/*
+ * Measure the latency distribution of direct requests to the MP partitions
+ * SP1 and SP2, from each CPU in turn, so each request targets the vCPU pinned
+ * to that CPU.
+ */
+test_result_t test_ffa_perf_direct_msg_latency_per_cpu(void)
+{
+	unsigned int cpu_node, core_pos;
+	struct perf_stats all_stats[2];
+	test_result_t ret;
+
+	CHECK_SPMC_TESTING_SETUP(1, 0, expected_sp_uuids);
+
+	for (unsigned int i = 0U; i < PLATFORM_CORE_COUNT; i++) {
+		perf_stats_init(&vcpu_stats[i][0]);
+		perf_stats_init(&vcpu_stats[i][1]);
+	}
+
+	ret = perf_vcpu_latency();
+	if (ret != TEST_RESULT_SUCCESS) {
+		return ret;
+	}
+
+	ret = spm_run_multi_core_test((uintptr_t)perf_vcpu_latency_on_handler,
+				      cpu_booted);
+	if (ret != TEST_RESULT_SUCCESS) {
+		return ret;
+	}
+
+	perf_stats_init(&all_stats[0]);
+	perf_stats_init(&all_stats[1]);
+
+	for_each_cpu(cpu_node) {
+		core_pos = platform_get_core_pos(
+				tftf_get_mpidr_from_node(cpu_node));
+
+		printf("CPU%u:\n", core_pos);
+		perf_stats_print("  SP1 vCPU", &vcpu_stats[core_pos][0], false);
+		perf_stats_print("  SP2 vCPU", &vcpu_stats[core_pos][1], false);
+
+		perf_stats_merge(&all_stats[0], &vcpu_stats[core_pos][0]);
+		perf_stats_merge(&all_stats[1], &vcpu_stats[core_pos][1]);
+	}
+
+	perf_stats_print("SP1 all vCPUs", &all_stats[0], true);
+	perf_stats_print("SP2 all vCPUs", &all_stats[1], true);
+
+	tftf_testcase_printf("SP1: avg %llu ns, max %llu ns\n",
+		(unsigned long long)perf_ticks_to_ns(
+					perf_stats_avg(&all_stats[0])),
+		(unsigned long long)perf_ticks_to_ns(all_stats[0].max));
+	tftf_testcase_printf("SP2: avg %llu ns, max %llu ns\n",
+		(unsigned long long)perf_ticks_to_ns(
+					perf_stats_avg(&all_stats[1])),
+		(unsigned long long)perf_ticks_to_ns(all_stats[1].max));
+
+	return TEST_RESULT_SUCCESS;
+}
+
+/*
+ * Executed concurrently on all participating CPUs. CPUs with an even core
+ * position target SP1 and the others SP2, so that the SPMC handles requests
+ * for different partitions at the same time.
+ */
+static test_result_t perf_direct_msg_throughput(void)
+{
+	unsigned int core_pos = get_current_core_id();
+	struct perf_stats *stats = &mc_stats[core_pos];
+	ffa_id_t dest = ((core_pos % 2U) == 0U) ? SP_ID(1) : SP_ID(2);
+
+	if (!spm_core_sp_init(dest)) {
+		return TEST_RESULT_FAIL;
+	}
+
+	perf_stats_init(stats);
+
+	perf_throughput_start();
+	if (!perf_measure_direct_req(dest, true, true, PERF_MC_ITERATIONS,
+				     stats)) {
+		return TEST_RESULT_FAIL;
+	}
+	perf_throughput_end(PERF_MC_ITERATIONS);
+
+	return TEST_RESULT_SUCCESS;
+}
+
+/*
+ * Measure the aggregate number of direct messages per second with 1, 2, 4, ...
+ * and finally all CPUs sending direct requests at the same time, to show how
+ * the SPMC scales with the number of cores.
+ */
+test_result_t test_ffa_perf_direct_msg_throughput(void)
+{
+	unsigned int cpus_count = tftf_get_total_cpus_count();
+	unsigned int cpu_count;
+	struct perf_throughput tp;
+	struct perf_stats stats;
+	test_result_t ret;
+
+	CHECK_SPMC_TESTING_SETUP(1, 0, expected_sp_uuids);
+
+	for_each_perf_cpu_count(cpu_count, 1U, cpus_count) {
+		ret = perf_run_on_cpus(cpu_count, perf_direct_msg_throughput);
+		if (ret != TEST_RESULT_SUCCESS) {
+			return ret;
+		}
+
+		perf_throughput_collect(&tp);
+		perf_stats_init(&stats);
+
+		for (unsigned int i = 0U; i < PLATFORM_CORE_COUNT; i++) {
+			if (perf_throughput_has_cpu(i)) {
+				perf_stats_merge(&stats, &mc_stats[i]);
+			}
+		}
+
+		if (tp.events != ((uint64_t)cpu_count * PERF_MC_ITERATIONS)) {
+			ERROR("Only %llu messages out of %llu were sent\n",
+			      (unsigned long long)tp.events,
+			      (unsigned long long)cpu_count *
+			      PERF_MC_ITERATIONS);
+			return TEST_RESULT_FAIL;
+		}
+
+		printf("%u CPUs: %llu msgs/s\n", cpu_count,
+		       (unsigned long long)perf_throughput_rate(&tp));
+		perf_stats_print("  latency", &stats, false);
+
+		tftf_testcase_printf("%u CPUs: %llu msgs/s, avg %llu ns\n",
+			cpu_count,
+			(unsigned long long)perf_throughput_rate(&tp),
+			(unsigned long long)perf_ticks_to_ns(
+						perf_stats_avg(&stats)));
+	}
+
+	return TEST_RESULT_SUCCESS;
+}
+
+/*
+ * Compare the round trip latency of a direct request to SP1 with the time the
+ * SP spends in the CACTUS_ECHO_CMD handler, as accounted by Cactus itself.
+ */
+test_result_t test_ffa_perf_cactus_cmd_handling(void)
+{
+	uint64_t count_before, ticks_before, count, ticks;
+	struct perf_stats stats;
+	struct ffa_value ret;
+
+	CHECK_SPMC_TESTING_SETUP(1, 0, expected_sp_uuids);
+
+	ret = cactus_get_cmd_stats_send_cmd(HYP_ID, SP_ID(1), CACTUS_ECHO_CMD);
+	if (!is_ffa_direct_response(ret) ||
+	    (cactus_get_response(ret) != CACTUS_SUCCESS)) {
+		return TEST_RESULT_FAIL;
+	}
+
+	count_before = cactus_get_cmd_stats_count(ret);
+	ticks_before = cactus_get_cmd_stats_ticks(ret);
+
+	perf_stats_init(&stats);
+
+	if (!perf_measure_direct_req(SP_ID(1), true, true, PERF_ITERATIONS,
+				     &stats)) {
+		return TEST_RESULT_FAIL;
+	}
+
+	ret = cactus_get_cmd_stats_send_cmd(HYP_ID, SP_ID(1), CACTUS_ECHO_CMD);
+	if (!is_ffa_direct_response(ret) ||
+	    (cactus_get_response(ret) != CACTUS_SUCCESS)) {
+		return TEST_RESULT_FAIL;
+	}
+
+	count = cactus_get_cmd_stats_count(ret) - count_before;
+	ticks = cactus_get_cmd_stats_ticks(ret) - ticks_before;
+
+	if (count != PERF_ITERATIONS) {
+		ERROR("SP1 handled %llu echo commands, expected %u\n",
+		      (unsigned long long)count, PERF_ITERATIONS);
+		return TEST_RESULT_FAIL;
+	}
+
+	perf_stats_print("SP1 round trip", &stats, false);
+	tftf_testcase_printf("Round trip avg %llu ns, SP handler avg %llu ns\n",
+		(unsigned long long)perf_ticks_to_ns(perf_stats_avg(&stats)),
+		(unsigned long long)perf_ticks_to_ns(ticks / count));
+
+	return TEST_RESULT_SUCCESS;
+}
@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * This file contains a benchmark of FF-A indirect messaging. It streams
+ * payloads of increasing size from the normal world to a Secure Partition
+ * through the RX/TX buffers, and reports the latency per message and the
+ * payload throughput, next to the latency of a direct message round trip for
+ * comparison.
+ */
+
+#include <debug.h>
+#include <smccc.h>
+
+#include <arch_helpers.h>
+#include <cactus_test_cmds.h>
+#include <ffa_endpoints.h>
+#include <ffa_svc.h>
+#include <perf_helpers.h>
+#include <platform.h>
+#include <spm_common.h>
+#include <test_helpers.h>
+#include <utils_def.h>
+
+/* Number of messages streamed for each payload size. */
+#define PERF_ITERATIONS		200U
+
+static const struct ffa_uuid expected_sp_uuids[] = {
+		{PRIMARY_UUID}, {SECONDARY_UUID}, {TERTIARY_UUID}
+	};
+
+/* Payload sizes streamed, up to the maximum a single message can carry. */
+static const size_t payload_sizes[] = {
+	16U, 64U, 256U, 1024U, 2048U, FFA_MSG_PAYLOAD_MAX
+};
+
+static uint8_t payload[FFA_MSG_PAYLOAD_MAX];
+
+/*
+ * Send one indirect message of 'size' bytes to SP1 and have it read back.
+ * The message is considered delivered once SP1 has copied it out of its RX
+ * buffer and released it, which is when the next message can be sent.
+ */
+static bool perf_indirect_msg(struct mailbox_buffers *mb, size_t size,
+			      uint32_t checksum)
+{
+	struct ffa_value ret;
+
+	ret = send_indirect_message(HYP_ID, SP_ID(1), mb->send, payload, size,
+				    0);
+	if (!is_expected_ffa_return(ret, FFA_SUCCESS_SMC32)) {
+		ERROR("Failed to send an indirect message of %u bytes\n",
+		      (unsigned int)size);
+		return false;
+	}
+
+	ret = cactus_indirect_msg_read_send_cmd(HYP_ID, SP_ID(1),
+						get_current_core_id());
+
+	if (!is_ffa_direct_response(ret) ||
+	    (cactus_get_response(ret) != CACTUS_SUCCESS) ||
+	    (cactus_indirect_msg_size(ret) != size) ||
+	    (cactus_indirect_msg_checksum(ret) != checksum)) {
+		ERROR("SP1 failed to read an indirect message of %u bytes\n",
+		      (unsigned int)size);
+		return false;
+	}
+
+	return true;
+}
+
+/*
+ * Stream PERF_ITERATIONS indirect messages to SP1 for each payload size, and
+ * report the per-message latency (send and read back) and the throughput in
+ * payload bytes per second.
+ */
+test_result_t test_ffa_perf_indirect_msg_streaming(void)
+{
+	struct mailbox_buffers mb;
+	struct perf_stats stats;
+	uint64_t ticks, rate;
+	uint32_t checksum;
+	size_t size;
+
+	CHECK_SPMC_TESTING_SETUP(1, 1, expected_sp_uuids);
+
+	GET_TFTF_MAILBOX(mb);
+
+	for (unsigned int i = 0U; i < ARRAY_SIZE(payload); i++) {
+		payload[i] = (uint8_t)(i * 7U);
+	}
+
+	/* Direct message round trip, as a baseline. */
+	perf_stats_init(&stats);
+
+	for (unsigned int i = 0U; i < PERF_ITERATIONS; i++) {
+		struct ffa_value ret;
+
+		ticks = syscounter_read();
+		ret = cactus_echo_send_cmd(HYP_ID, SP_ID(1), ECHO_VAL1);
+		ticks = syscounter_read() - ticks;
+
+		if (!is_ffa_direct_response(ret) ||
+		    (cactus_get_response(ret) != CACTUS_SUCCESS)) {
+			return TEST_RESULT_FAIL;
+		}
+
+		perf_stats_add(&stats, ticks);
+	}
+
+	perf_stats_print("direct message", &stats, false);
+	tftf_testcase_printf("direct: %llu ns\n",
+		(unsigned long long)perf_ticks_to_ns(perf_stats_avg(&stats)));
+
+	for (unsigned int s = 0U; s < ARRAY_SIZE(payload_sizes); s++) {
+		size = payload_sizes[s];
+		checksum = cactus_indirect_msg_payload_checksum(payload, size);
+
+		perf_stats_init(&stats);
+
+		for (unsigned int i = 0U; i < PERF_ITERATIONS; i++) {
+			ticks = syscounter_read();
+			if (!perf_indirect_msg(&mb, size, checksum)) {
+				return TEST_RESULT_FAIL;
+			}
+			ticks = syscounter_read() - ticks;
+
+			perf_stats_add(&stats, ticks);
+		}
+
+		/* Payload bytes per second. */
+		rate = perf_rate_per_sec(stats.count * size, stats.sum);
+
+		printf("%u bytes: %llu.%03llu MB/s, ", (unsigned int)size,
+		       (unsigned long long)(rate / 1000000ULL),
+		       (unsigned long long)((rate % 1000000ULL) / 1000ULL));
+		perf_stats_print("indirect message", &stats, false);
+
+		tftf_testcase_printf("%u B: %llu ns, %llu KB/s\n",
+			(unsigned int)size,
+			(unsigned long long)perf_ticks_to_ns(
+						perf_stats_avg(&stats)),
+			(unsigned long long)(rate / 1000ULL));
+	}
+
+	return TEST_RESULT_SUCCESS;
+}
@@ -0,0 +1,579 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * This file contains benchmarks of the FF-A notifications interfaces:
+ * - the latency from an SP setting a notification to the receiver having
+ *   retrieved it, split at the Schedule Receiver Interrupt (SRI) and at
+ *   FFA_NOTIFICATION_INFO_GET;
+ * - the cost of FFA_NOTIFICATION_INFO_GET as the number of endpoints and
+ *   vCPUs with pending notifications grows;
+ * - the throughput of per-vCPU notifications set/get from all cores at once.
+ */
+
+#include <debug.h>
+#include <irq.h>
+#include <smccc.h>
+
+#include <arch_helpers.h>
+#include <cactus_test_cmds.h>
+#include <ffa_endpoints.h>
+#include <ffa_svc.h>
+#include <events.h>
+#include <perf_helpers.h>
+#include <platform.h>
+#include <spm_common.h>
+#include <test_helpers.h>
+#include <utils_def.h>
+
+/* Number of notifications signalled in the latency benchmark. */
+#define PERF_ITERATIONS		500U
+
+/* Number of set/get pairs issued by each CPU in the throughput benchmark. */
+#define PERF_MC_ITERATIONS	500U
+
+/* Number of samples of FFA_NOTIFICATION_INFO_GET per configuration. */
+#define PERF_INFO_GET_SAMPLES	20U
+
+static const struct ffa_uuid expected_sp_uuids[] = {
+		{PRIMARY_UUID}, {SECONDARY_UUID}, {TERTIARY_UUID}
+};
+
+static event_t cpu_booted[PLATFORM_CORE_COUNT];
+
+/* Number of SRIs handled by each CPU, and time of the last one. */
+static volatile unsigned int sri_count[PLATFORM_CORE_COUNT];
+static volatile uint64_t sri_timestamp[PLATFORM_CORE_COUNT];
+
+/* Number of vCPUs with a pending notification in the info get benchmark. */
+static unsigned int pending_vcpus;
+
+/* Per-CPU state of the throughput benchmark. */
+static struct perf_mc_data {
+	struct perf_stats set_stats;
+	struct perf_stats get_stats;
+} mc_data[PLATFORM_CORE_COUNT];
+
+static int perf_sri_handler(void *data)
+{
+	unsigned int core_pos = get_current_core_id();
+
+	sri_timestamp[core_pos] = syscounter_read();
+	sri_count[core_pos]++;
+
+	return 0;
+}
+
+static void perf_sri_init(void)
+{
+	unsigned int core_pos = get_current_core_id();
+
+	sri_count[core_pos] = 0U;
+	tftf_irq_register_handler(FFA_SCHEDULE_RECEIVER_INTERRUPT_ID,
+				  perf_sri_handler);
+	tftf_irq_enable(FFA_SCHEDULE_RECEIVER_INTERRUPT_ID, 0xA);
+}
+
+static void perf_sri_deinit(void)
+{
+	tftf_irq_disable(FFA_SCHEDULE_RECEIVER_INTERRUPT_ID);
+	tftf_irq_unregister_handler(FFA_SCHEDULE_RECEIVER_INTERRUPT_ID);
+}
+
+static bool perf_sp_bind(ffa_id_t receiver, ffa_id_t sender,
+			 ffa_notification_bitmap_t notifications,
+			 uint32_t flags)
+{
+	struct ffa_value ret;
+
+	ret = cactus_notification_bind_send_cmd(HYP_ID, receiver, receiver,
+						sender, notifications, flags);
+
+	return is_expected_cactus_response(ret, CACTUS_SUCCESS, 0);
+}
+
+static bool perf_sp_unbind(ffa_id_t receiver, ffa_id_t sender,
+			   ffa_notification_bitmap_t notifications)
+{
+	struct ffa_value ret;
+
+	ret = cactus_notification_unbind_send_cmd(HYP_ID, receiver, receiver,
+						  sender, notifications);
+
+	return is_expected_cactus_response(ret, CACTUS_SUCCESS, 0);
+}
+
+/*
+ * Request SP 'receiver' to get its notifications on 'vcpu_id', from the
+ * bitmap selected by 'flags' (SPs or VMs), and check they match 'expected'.
+ */
+static bool perf_sp_get(ffa_id_t receiver, uint32_t vcpu_id, uint32_t flags,
+			ffa_notification_bitmap_t expected)
+{
+	ffa_notification_bitmap_t got;
+	struct ffa_value ret;
+
+	ret = cactus_notification_get_send_cmd(HYP_ID, receiver, receiver,
+					       vcpu_id, flags, false);
+
+	got = ((flags & FFA_NOTIFICATIONS_FLAG_BITMAP_SP) != 0U) ?
+		cactus_notifications_get_from_sp(ret) :
+		cactus_notifications_get_from_vm(ret);
+
+	if (!is_ffa_direct_response(ret) ||
+	    (cactus_get_response(ret) != CACTUS_SUCCESS) ||
+	    (got != expected)) {
+		ERROR("%x failed to get notifications %llx on vCPU %u\n",
+		      receiver, (unsigned long long)expected, vcpu_id);
+		return false;
+	}
+
+	return true;
+}
+
+/*
+ * Measure the latency of a notification from SP2 to SP1, from the request to
+ * SP2 to set it until SP1 has retrieved it. The stages are:
+ * - request to set the notification until the SRI is taken in the normal world
+ *   (the SRI is delayed until SP2 has sent its direct response);
+ * - SRI until FFA_NOTIFICATION_INFO_GET returned the receiver's ID;
+ * - FFA_NOTIFICATION_INFO_GET until the receiver has got the notification.
+ */
+test_result_t test_ffa_perf_notifications_signal_latency(void)
+{
+	const ffa_id_t sender = SP_ID(2);
+	const ffa_id_t receiver = SP_ID(1);
+	const ffa_notification_bitmap_t notification = FFA_NOTIFICATION(10);
+	unsigned int core_pos = get_current_core_id();
+	struct perf_stats set_sri, sri_info, info_get, total;
+	uint64_t start, info_done, got;
+	unsigned int sri_expected;
+	struct ffa_value ret;
+	test_result_t result = TEST_RESULT_SUCCESS;
+
+	CHECK_SPMC_TESTING_SETUP(1, 1, expected_sp_uuids);
+
+	perf_stats_init(&set_sri);
+	perf_stats_init(&sri_info);
+	perf_stats_init(&info_get);
+	perf_stats_init(&total);
+
+	if (!perf_sp_bind(receiver, sender, notification, 0)) {
+		return TEST_RESULT_FAIL;
+	}
+
+	perf_sri_init();
+
+	for (unsigned int i = 0U; i < PERF_ITERATIONS; i++) {
+		sri_expected = sri_count[core_pos] + 1U;
+
+		start = syscounter_read();
+
+		ret = cactus_notifications_set_send_cmd(HYP_ID, sender,
+					receiver, sender,
+					FFA_NOTIFICATIONS_FLAG_DELAY_SRI,
+					notification, 0);
+		if (!is_expected_cactus_response(ret, CACTUS_SUCCESS, 0)) {
+			result = TEST_RESULT_FAIL;
+			break;
+		}
+
+		if (sri_count[core_pos] != sri_expected) {
+			ERROR("Schedule Receiver Interrupt not handled\n");
+			result = TEST_RESULT_FAIL;
+			break;
+		}
+
+		ret = ffa_notification_info_get();
+		info_done = syscounter_read();
+
+		if (is_ffa_call_error(ret) ||
+		    ((ffa_id_t)ret.arg3 != receiver)) {
+			ERROR("Unexpected FFA_NOTIFICATION_INFO_GET return\n");
+			result = TEST_RESULT_FAIL;
+			break;
+		}
+
+		if (!perf_sp_get(receiver, 0, FFA_NOTIFICATIONS_FLAG_BITMAP_SP,
+				 notification)) {
+			result = TEST_RESULT_FAIL;
+			break;
+		}
+
+		got = syscounter_read();
+
+		perf_stats_add(&set_sri, sri_timestamp[core_pos] - start);
+		perf_stats_add(&sri_info, info_done - sri_timestamp[core_pos]);
+		perf_stats_add(&info_get, got - info_done);
+		perf_stats_add(&total, got - start);
+	}
+
+	perf_sri_deinit();
+
+	if (!perf_sp_unbind(receiver, sender, notification)) {
+		result = TEST_RESULT_FAIL;
+	}
+
+	if (result != TEST_RESULT_SUCCESS) {
+		return result;
+	}
+
+	perf_stats_print("set -> SRI", &set_sri, false);
+	perf_stats_print("SRI -> info get", &sri_info, false);
+	perf_stats_print("info get -> receiver got", &info_get, false);
+	perf_stats_print("set -> receiver got", &total, true);
+
+	tftf_testcase_printf("set->SRI %llu ns, set->got %llu ns (p99 %llu)\n",
+		(unsigned long long)perf_ticks_to_ns(perf_stats_avg(&set_sri)),
+		(unsigned long long)perf_ticks_to_ns(perf_stats_avg(&total)),
+		(unsigned long long)perf_ticks_to_ns(
+					perf_stats_percentile(&total, 99U)));
+
+	return TEST_RESULT_SUCCESS;
+}
+
+static bool perf_info_get_sample(struct perf_stats *stats)
+{
+	struct ffa_value ret;
+	uint64_t ticks;
+
+	ticks = syscounter_read();
+	ret = ffa_notification_info_get();
+	ticks = syscounter_read() - ticks;
+
+	if (is_ffa_call_error(ret)) {
+		return false;
+	}
+
+	perf_stats_add(stats, ticks);
+
+	return true;
+}
+
+/*
+ * Get the per-vCPU notification of VM1 on the calling CPU, if it has been set
+ * in the current round of the info get benchmark.
+ */
+static bool perf_vm_get_per_vcpu(void)
+{
+	unsigned int core_pos = get_current_core_id();
+	struct ffa_value ret;
+
+	if (core_pos >= pending_vcpus) {
+		return true;
+	}
+
+	ret = ffa_notification_get(VM_ID(1), core_pos,
+				   FFA_NOTIFICATIONS_FLAG_BITMAP_SP);
+
+	if (!is_expected_ffa_return(ret, FFA_SUCCESS_SMC32) ||
+	    (ffa_notifications_get_from_sp(ret) !=
+	     FFA_NOTIFICATION(core_pos))) {
+		ERROR("VM failed to get notification on vCPU %u\n", core_pos);
+		return false;
+	}
+
+	return true;
+}
+
+static test_result_t perf_vm_get_per_vcpu_on_handler(void)
+{
+	unsigned int core_pos = get_current_core_id();
+	test_result_t ret;
+
+	ret = perf_vm_get_per_vcpu() ? TEST_RESULT_SUCCESS : TEST_RESULT_FAIL;
+
+	/* Tell the lead CPU that the calling CPU has completed the test. */
+	tftf_send_event(&cpu_booted[core_pos]);
+
+	return ret;
+}
+
+/*
+ * Measure FFA_NOTIFICATION_INFO_GET as the number of pending endpoints grows
+ * (global notifications from VM1 to 1, 2 and 3 SPs), and as the number of
+ * vCPUs with pending notifications grows (per-vCPU notifications from SP2 to
+ * 1 .. PLATFORM_CORE_COUNT vCPUs of VM1).
+ */
+test_result_t test_ffa_perf_notifications_info_get(void)
+{
+	const ffa_id_t vm_id = VM_ID(1);
+	const ffa_id_t sps[] = { SP_ID(1), SP_ID(2), SP_ID(3) };
+	const ffa_notification_bitmap_t global = FFA_NOTIFICATION(20);
+	ffa_notification_bitmap_t per_vcpu = 0;
+	struct perf_stats stats;
+	struct ffa_value ret;
+	test_result_t result = TEST_RESULT_SUCCESS;
+	unsigned int i, j;
+
+	CHECK_SPMC_TESTING_SETUP(1, 1, expected_sp_uuids);
+
+	perf_sri_init();
+
+	/* Pending global notifications for a growing number of SPs. */
+	for (i = 0U; i < ARRAY_SIZE(sps); i++) {
+		if (!perf_sp_bind(sps[i], vm_id, global, 0)) {
+			result = TEST_RESULT_FAIL;
+			goto out_sri;
+		}
+	}
+
+	for (i = 1U; (i <= ARRAY_SIZE(sps)) && (result == TEST_RESULT_SUCCESS);
+	     i++) {
+		perf_stats_init(&stats);
+
+		for (unsigned int s = 0U; s < PERF_INFO_GET_SAMPLES; s++) {
+			for (j = 0U; j < i; j++) {
+				ret = ffa_notification_set(
+					vm_id, sps[j],
+					FFA_NOTIFICATIONS_FLAG_DELAY_SRI,
+					global);
+				if (!is_expected_ffa_return(ret,
+							FFA_SUCCESS_SMC32)) {
+					result = TEST_RESULT_FAIL;
+				}
+			}
+
+			if (!perf_info_get_sample(&stats)) {
+				result = TEST_RESULT_FAIL;
+			}
+
+			for (j = 0U; j < i; j++) {
+				if (!perf_sp_get(sps[j], 0,
+					FFA_NOTIFICATIONS_FLAG_BITMAP_VM,
+					global)) {
+					result = TEST_RESULT_FAIL;
+				}
+			}
+
+			if (result != TEST_RESULT_SUCCESS) {
+				break;
+			}
+		}
+
+		printf("%u pending SPs: ", i);
+		perf_stats_print("info get", &stats, false);
+		tftf_testcase_printf("%u SPs: info get %llu ns\n", i,
+			(unsigned long long)perf_ticks_to_ns(
+						perf_stats_avg(&stats)));
+	}
+
+	for (i = 0U; i < ARRAY_SIZE(sps); i++) {
+		if (!perf_sp_unbind(sps[i], vm_id, global)) {
+			result = TEST_RESULT_FAIL;
+		}
+	}
+
+	if (result != TEST_RESULT_SUCCESS) {
+		goto out_sri;
+	}
+
+	/* Pending per-vCPU notifications for a growing number of vCPUs. */
+	ret = ffa_notification_bitmap_create(vm_id, PLATFORM_CORE_COUNT);
+	if (is_ffa_call_error(ret)) {
+		result = TEST_RESULT_FAIL;
+		goto out_sri;
+	}
+
+	for (i = 0U; i < PLATFORM_CORE_COUNT; i++) {
+		per_vcpu |= FFA_NOTIFICATION(i);
+	}
+
+	ret = ffa_notification_bind(SP_ID(2), vm_id,
+				    FFA_NOTIFICATIONS_FLAG_PER_VCPU, per_vcpu);
+	if (is_ffa_call_error(ret)) {
+		result = TEST_RESULT_FAIL;
+		goto out_bitmap;
+	}
+
+	for (pending_vcpus = 1U; pending_vcpus <= PLATFORM_CORE_COUNT;
+	     pending_vcpus++) {
+		for (j = 0U; j < pending_vcpus; j++) {
+			uint32_t flags = FFA_NOTIFICATIONS_FLAG_DELAY_SRI |
+					 FFA_NOTIFICATIONS_FLAG_PER_VCPU  |
+					 FFA_NOTIFICATIONS_FLAGS_VCPU_ID(j);
+
+			ret = cactus_notifications_set_send_cmd(
+				HYP_ID, SP_ID(2), vm_id, SP_ID(2), flags,
+				FFA_NOTIFICATION(j), 0);
+			if (!is_expected_cactus_response(ret, CACTUS_SUCCESS,
+							 0)) {
+				result = TEST_RESULT_FAIL;
+				goto out_unbind;
+			}
+		}
+
+		/*
+		 * Once retrieved by FFA_NOTIFICATION_INFO_GET, notifications
+		 * are not reported again until set again. Only one sample per
+		 * configuration, as getting per-vCPU notifications requires
+		 * powering on all the CPUs.
+		 */
+		perf_stats_init(&stats);
+		if (!perf_info_get_sample(&stats)) {
+			result = TEST_RESULT_FAIL;
+			goto out_unbind;
+		}
+
+		printf("%u pending vCPUs: info get %llu ns\n", pending_vcpus,
+		       (unsigned long long)perf_ticks_to_ns(stats.sum));
+
+		if (!perf_vm_get_per_vcpu() ||
+		    (spm_run_multi_core_test(
+			(uintptr_t)perf_vm_get_per_vcpu_on_handler,
+			cpu_booted) != TEST_RESULT_SUCCESS)) {
+			result = TEST_RESULT_FAIL;
+			goto out_unbind;
+		}
+
+		if (pending_vcpus == PLATFORM_CORE_COUNT) {
+			tftf_testcase_printf("%u vCPUs: info get %llu ns\n",
+				pending_vcpus,
+				(unsigned long long)perf_ticks_to_ns(
+								stats.sum));
+		}
+	}
+
+out_unbind:
+	ret = ffa_notification_unbind(SP_ID(2), vm_id, per_vcpu);
+	if (is_ffa_call_error(ret)) {
+		result = TEST_RESULT_FAIL;
+	}
+
+out_bitmap:
+	ret = ffa_notification_bitmap_destroy(vm_id);
+	if (is_ffa_call_error(ret)) {
+		result = TEST_RESULT_FAIL;
+	}
+
+out_sri:
+	perf_sri_deinit();
+
+	return result;
+}
+
+/*
+ * Executed concurrently on all participating CPUs: VM1 signals a per-vCPU
+ * notification to the SP1 vCPU pinned to the calling CPU, which SP1 then
+ * retrieves.
+ */
+static test_result_t perf_notifications_throughput(void)
+{
+	unsigned int core_pos = get_current_core_id();
+	struct perf_mc_data *data = &mc_data[core_pos];
+	const ffa_notification_bitmap_t notification =
+						FFA_NOTIFICATION(core_pos);
+	const uint32_t flags = FFA_NOTIFICATIONS_FLAG_DELAY_SRI |
+			       FFA_NOTIFICATIONS_FLAG_PER_VCPU  |
+			       FFA_NOTIFICATIONS_FLAGS_VCPU_ID(core_pos);
+	test_result_t result = TEST_RESULT_SUCCESS;
+	struct ffa_value ret;
+	uint64_t ticks;
+
+	perf_stats_init(&data->set_stats);
+	perf_stats_init(&data->get_stats);
+
+	perf_throughput_start();
+
+	for (unsigned int i = 0U; i < PERF_MC_ITERATIONS; i++) {
+		ticks = syscounter_read();
+		ret = ffa_notification_set(VM_ID(1), SP_ID(1), flags,
+					   notification);
+		ticks = syscounter_read() - ticks;
+
+		if (!is_expected_ffa_return(ret, FFA_SUCCESS_SMC32)) {
+			result = TEST_RESULT_FAIL;
+			break;
+		}
+
+		perf_stats_add(&data->set_stats, ticks);
+
+		ticks = syscounter_read();
+		if (!perf_sp_get(SP_ID(1), core_pos,
+				 FFA_NOTIFICATIONS_FLAG_BITMAP_VM,
+				 notification)) {
+			result = TEST_RESULT_FAIL;
+			break;
+		}
+		ticks = syscounter_read() - ticks;
+
+		perf_stats_add(&data->get_stats, ticks);
+	}
+
+	if (result == TEST_RESULT_SUCCESS) {
+		perf_throughput_end(PERF_MC_ITERATIONS);
+	}
+
+	return result;
+}
+
+/*
+ * Measure the aggregate number of per-vCPU notification set/get pairs per
+ * second, with 1, 2, 4 ... and finally all CPUs signalling SP1 concurrently.
+ */
+test_result_t test_ffa_perf_notifications_throughput(void)
+{
+	unsigned int cpus_count = tftf_get_total_cpus_count();
+	unsigned int cpu_count;
+	ffa_notification_bitmap_t per_vcpu = 0;
+	struct perf_stats set_stats, get_stats;
+	struct perf_throughput tp;
+	test_result_t result = TEST_RESULT_SUCCESS;
+
+	CHECK_SPMC_TESTING_SETUP(1, 1, expected_sp_uuids);
+
+	for (unsigned int i = 0U; i < PLATFORM_CORE_COUNT; i++) {
+		per_vcpu |= FFA_NOTIFICATION(i);
+	}
+
+	if (!perf_sp_bind(SP_ID(1), VM_ID(1), per_vcpu,
+			  FFA_NOTIFICATIONS_FLAG_PER_VCPU)) {
+		return TEST_RESULT_FAIL;
+	}
+
+	for_each_perf_cpu_count(cpu_count, 1U, cpus_count) {
+		result = perf_run_on_cpus(cpu_count,
+					  perf_notifications_throughput);
+		if (result != TEST_RESULT_SUCCESS) {
+			break;
+		}
+
+		perf_throughput_collect(&tp);
+		perf_stats_init(&set_stats);
+		perf_stats_init(&get_stats);
+
+		for (unsigned int i = 0U; i < PLATFORM_CORE_COUNT; i++) {
+			if (!perf_throughput_has_cpu(i)) {
+				continue;
+			}
+
+			perf_stats_merge(&set_stats, &mc_data[i].set_stats);
+			perf_stats_merge(&get_stats, &mc_data[i].get_stats);
+		}
+
+		if (tp.events != ((uint64_t)cpu_count * PERF_MC_ITERATIONS)) {
+			result = TEST_RESULT_FAIL;
+			break;
+		}
+
+		printf("%u CPUs: %llu set/get per second\n", cpu_count,
+		       (unsigned long long)perf_throughput_rate(&tp));
+		perf_stats_print("  set", &set_stats, false);
+		perf_stats_print("  get", &get_stats, false);
+
+		tftf_testcase_printf("%u CPUs: %llu set/get/s, set %llu ns\n",
+			cpu_count,
+			(unsigned long long)perf_throughput_rate(&tp),
+			(unsigned long long)perf_ticks_to_ns(
+						perf_stats_avg(&set_stats)));
+	}
+
+	if (!perf_sp_unbind(SP_ID(1), VM_ID(1), per_vcpu)) {
+		result = TEST_RESULT_FAIL;
+	}
+
+	return result;
+}
@@ -1,14 +1,15 @@
 /*
- * Copyright (c) 2018, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
 #include <arch_helpers.h>
 #include <debug.h>
+#include <events.h>
 #include <plat_topology.h>
 #include <platform.h>
-#include <pmf.h>
+#include <pmf_helpers.h>
 #include <power_management.h>
 #include <psci.h>
 #include <smccc.h>
@@ -17,50 +18,19 @@
 #include <tftf_lib.h>
 #include <timer.h>
 
-#define TOTAL_IDS		6
-#define ENTER_PSCI		0
-#define EXIT_PSCI		1
-#define ENTER_HW_LOW_PWR	2
-#define EXIT_HW_LOW_PWR		3
-#define ENTER_CFLUSH		4
-#define EXIT_CFLUSH		5
-
-static spinlock_t cpu_count_lock;
-static volatile int cpu_count;
+static barrier_t cpus_barrier;
 static volatile int participating_cpu_count;
-static u_register_t timestamps[PLATFORM_CORE_COUNT][TOTAL_IDS];
+static u_register_t timestamps[PLATFORM_CORE_COUNT][PMF_RT_INSTR_TOTAL_IDS];
 static unsigned int target_pwrlvl;
 
-/* Helper function to wait for CPUs participating in the test. */
-static void wait_for_participating_cpus(void)
-{
-	assert(participating_cpu_count <= PLATFORM_CORE_COUNT);
-
-	spin_lock(&cpu_count_lock);
-	cpu_count++;
-	spin_unlock(&cpu_count_lock);
-
-	assert(cpu_count <= PLATFORM_CORE_COUNT);
-
-	while (cpu_count != participating_cpu_count)
-		continue;
-}
-
 /*
- * Perform an SMC call into TF-A to collect timestamp specified by `tid`
- * and pass it as a parameter back to the caller.
+ * Helper function to wait for CPUs participating in the test. In the serial
+ * tests, the CPUs run one at a time and do not wait for each other.
  */
-static u_register_t pmf_get_ts(u_register_t tid, u_register_t *v)
+static void wait_for_participating_cpus(void)
 {
-	smc_args args = { 0 };
-	smc_ret_values ret;
-
-	args.fid = PMF_SMC_GET_TIMESTAMP;
-	args.arg1 = tid;
-	args.arg2 = read_mpidr_el1();
-	ret = tftf_smc(&args);
-	*v = ret.ret1;
-	return ret.ret0;
+	if (participating_cpu_count > 1)
+		tftf_barrier_wait(&cpus_barrier);
 }
 
 static int cycles_to_ns(uint64_t cycles, uint64_t freq, uint64_t *ns)
@@ -85,14 +55,16 @@ static test_result_t check_pwr_down_ts(void)
 	u_register_t *ts;
 
 	ts = get_core_timestamps();
-	if (!(ts[ENTER_PSCI] <= ts[ENTER_HW_LOW_PWR] &&
-	    ts[ENTER_HW_LOW_PWR] <= ts[EXIT_HW_LOW_PWR] &&
-	    ts[EXIT_HW_LOW_PWR] <= ts[EXIT_PSCI])) {
+	if (!(ts[PMF_RT_INSTR_ENTER_PSCI] <=
+	      ts[PMF_RT_INSTR_ENTER_HW_LOW_PWR] &&
+	    ts[PMF_RT_INSTR_ENTER_HW_LOW_PWR] <=
+	      ts[PMF_RT_INSTR_EXIT_HW_LOW_PWR] &&
+	    ts[PMF_RT_INSTR_EXIT_HW_LOW_PWR] <= ts[PMF_RT_INSTR_EXIT_PSCI])) {
 		tftf_testcase_printf("PMF timestamps are not correctly ordered\n");
 		return TEST_RESULT_FAIL;
 	}
 
-	if (ts[ENTER_CFLUSH] > ts[EXIT_CFLUSH]) {
+	if (ts[PMF_RT_INSTR_ENTER_CFLUSH] > ts[PMF_RT_INSTR_EXIT_CFLUSH]) {
 		tftf_testcase_printf("PMF timestamps are not correctly ordered\n");
 		return TEST_RESULT_FAIL;
 	}
@@ -106,17 +78,12 @@ static test_result_t check_pwr_down_ts(void)
  */
 static test_result_t get_ts(void)
 {
-	u_register_t tid, *ts;
-	int i;
+	u_register_t *ts;
 
 	ts = get_core_timestamps();
-	for (i = 0; i < TOTAL_IDS; i++) {
-		tid = PMF_ARM_TIF_IMPL_ID << PMF_IMPL_ID_SHIFT;
-		tid |= PMF_RT_INSTR_SVC_ID << PMF_SVC_ID_SHIFT | i;
-		if (pmf_get_ts(tid, &ts[i]) != 0) {
-			ERROR("Failed to capture PMF timestamp\n");
-			return TEST_RESULT_FAIL;
-		}
+	if (pmf_rt_instr_get_ts(ts, PMF_RT_INSTR_TOTAL_IDS) != 0) {
+		ERROR("Failed to capture PMF timestamp\n");
+		return TEST_RESULT_FAIL;
 	}
 	return TEST_RESULT_SUCCESS;
 }
@@ -138,21 +105,24 @@ static int dump_suspend_stats(const char *func_name)
 		assert(pos < PLATFORM_CORE_COUNT);
 		ts = timestamps[pos];
 
-		cycles[0] = ts[ENTER_HW_LOW_PWR] - ts[ENTER_PSCI];
+		cycles[0] = ts[PMF_RT_INSTR_ENTER_HW_LOW_PWR] -
+			    ts[PMF_RT_INSTR_ENTER_PSCI];
 		ret = cycles_to_ns(cycles[0], freq, &period[0]);
 		if (ret < 0) {
 			ERROR("cycles_to_ns: out of range\n");
 			return TEST_RESULT_FAIL;
 		}
 
-		cycles[1] = ts[EXIT_PSCI] - ts[EXIT_HW_LOW_PWR];
+		cycles[1] = ts[PMF_RT_INSTR_EXIT_PSCI] -
+			    ts[PMF_RT_INSTR_EXIT_HW_LOW_PWR];
 		ret = cycles_to_ns(cycles[1], freq, &period[1]);
 		if (ret < 0) {
 			ERROR("cycles_to_ns: out of range\n");
 			return TEST_RESULT_FAIL;
 		}
 
-		cycles[2] = ts[EXIT_CFLUSH] - ts[ENTER_CFLUSH];
+		cycles[2] = ts[PMF_RT_INSTR_EXIT_CFLUSH] -
+			    ts[PMF_RT_INSTR_ENTER_CFLUSH];
 		ret = cycles_to_ns(cycles[2], freq, &period[2]);
 		if (ret < 0) {
 			ERROR("cycles_to_ns: out of range\n");
@@ -187,7 +157,8 @@ static int dump_psci_version_stats(const char *func_name)
 		assert(pos < PLATFORM_CORE_COUNT);
 		ts = timestamps[pos];
 
-		cycles = ts[EXIT_PSCI] - ts[ENTER_PSCI];
+		cycles = ts[PMF_RT_INSTR_EXIT_PSCI] -
+			 ts[PMF_RT_INSTR_ENTER_PSCI];
 		ret = cycles_to_ns(cycles, freq, &period);
 		if (ret < 0) {
 			ERROR("cycles_to_ns: out of range\n");
@@ -281,7 +252,7 @@ static test_result_t psci_version_entrypoint(void)
 
 	/* Check timestamp order. */
 	ts = get_core_timestamps();
-	if (ts[ENTER_PSCI] > ts[EXIT_PSCI]) {
+	if (ts[PMF_RT_INSTR_ENTER_PSCI] > ts[PMF_RT_INSTR_EXIT_PSCI]) {
 		tftf_testcase_printf("PMF timestamps are not correctly ordered\n");
 		return TEST_RESULT_FAIL;
 	}
@@ -289,16 +260,6 @@ static test_result_t psci_version_entrypoint(void)
 	return TEST_RESULT_SUCCESS;
 }
 
-/* Check if runtime instrumentation is enabled in TF. */
-static int is_rt_instr_supported(void)
-{
-	u_register_t tid, dummy;
-
-	tid = PMF_ARM_TIF_IMPL_ID << PMF_IMPL_ID_SHIFT;
-	tid |= PMF_RT_INSTR_SVC_ID << PMF_SVC_ID_SHIFT;
-	return !pmf_get_ts(tid, &dummy);
-}
-
 /*
  * This test powers on all on the non-lead cores and brings
  * them and the lead core to a common synchronization point.
@@ -310,13 +271,12 @@ static test_result_t test_rt_instr_susp_parallel(const char *func_name)
 	u_register_t lead_mpid, target_mpid;
 	int cpu_node, ret;
 
-	if (is_rt_instr_supported() == 0)
+	if (!pmf_rt_instr_is_supported())
 		return TEST_RESULT_SKIPPED;
 
 	lead_mpid = read_mpidr_el1() & MPID_MASK;
 	participating_cpu_count = tftf_get_total_cpus_count();
-	init_spinlock(&cpu_count_lock);
-	cpu_count = 0;
+	tftf_init_barrier(&cpus_barrier, INVALID_MPID);
 
 	/* Power on all the non-lead cores. */
 	for_each_cpu(cpu_node) {
@@ -343,12 +303,8 @@ static test_result_t test_rt_instr_susp_parallel(const char *func_name)
 		while (tftf_psci_affinity_info(target_mpid, MPIDR_AFFLVL0) !=
 		    PSCI_STATE_OFF)
 			continue;
-		cpu_count--;
 	}
 
-	cpu_count--;
-	assert(cpu_count == 0);
-
 	return dump_suspend_stats(func_name);
 }
 
@@ -365,13 +321,11 @@ static test_result_t test_rt_instr_susp_serial(const char *func_name)
 	u_register_t lead_mpid, target_mpid;
 	int cpu_node, ret;
 
-	if (is_rt_instr_supported() == 0)
+	if (!pmf_rt_instr_is_supported())
 		return TEST_RESULT_SKIPPED;
 
 	lead_mpid = read_mpidr_el1() & MPID_MASK;
 	participating_cpu_count = 1;
-	init_spinlock(&cpu_count_lock);
-	cpu_count = 0;
 
 	/* Suspend one core at a time. */
 	for_each_cpu(cpu_node) {
@@ -388,18 +342,12 @@ static test_result_t test_rt_instr_susp_serial(const char *func_name)
 		while (tftf_psci_affinity_info(target_mpid, MPIDR_AFFLVL0) !=
 		    PSCI_STATE_OFF)
 			continue;
-		cpu_count--;
 	}
 
-	assert(cpu_count == 0);
-
 	/* Suspend lead core as well. */
 	if (suspend_core_entrypoint() != TEST_RESULT_SUCCESS)
 		return TEST_RESULT_FAIL;
 
-	cpu_count--;
-	assert(cpu_count == 0);
-
 	return dump_suspend_stats(func_name);
 }
 
@@ -476,14 +424,12 @@ test_result_t test_rt_instr_cpu_off_serial(void)
 	u_register_t lead_mpid, target_mpid;
 	int cpu_node, ret;
 
-	if (is_rt_instr_supported() == 0)
+	if (!pmf_rt_instr_is_supported())
 		return TEST_RESULT_SKIPPED;
 
 	target_pwrlvl = PLAT_MAX_PWR_LEVEL;
 	lead_mpid = read_mpidr_el1() & MPID_MASK;
 	participating_cpu_count = 1;
-	init_spinlock(&cpu_count_lock);
-	cpu_count = 0;
 
 	/* Turn core on/off one at a time. */
 	for_each_cpu(cpu_node) {
@@ -500,18 +446,12 @@ test_result_t test_rt_instr_cpu_off_serial(void)
 		while (tftf_psci_affinity_info(target_mpid, MPIDR_AFFLVL0) !=
 		    PSCI_STATE_OFF)
 			continue;
-		cpu_count--;
 	}
 
-	assert(cpu_count == 0);
-
 	/* Suspend lead core as well. */
 	if (suspend_core_entrypoint() != TEST_RESULT_SUCCESS)
 		return TEST_RESULT_FAIL;
 
-	cpu_count--;
-	assert(cpu_count == 0);
-
 	/* Turn core on one at a time and collect timestamps. */
 	for_each_cpu(cpu_node) {
 		target_mpid = tftf_get_mpidr_from_node(cpu_node);
@@ -527,11 +467,8 @@ test_result_t test_rt_instr_cpu_off_serial(void)
 		while (tftf_psci_affinity_info(target_mpid, MPIDR_AFFLVL0) !=
 		    PSCI_STATE_OFF)
 			continue;
-		cpu_count--;
 	}
 
-	assert(cpu_count == 0);
-
 	return dump_suspend_stats(__func__);
 }
 
@@ -543,13 +480,12 @@ test_result_t test_rt_instr_psci_version_parallel(void)
 	u_register_t lead_mpid, target_mpid;
 	int cpu_node, ret;
 
-	if (is_rt_instr_supported() == 0)
+	if (!pmf_rt_instr_is_supported())
 		return TEST_RESULT_SKIPPED;
 
 	lead_mpid = read_mpidr_el1() & MPID_MASK;
 	participating_cpu_count = tftf_get_total_cpus_count();
-	init_spinlock(&cpu_count_lock);
-	cpu_count = 0;
+	tftf_init_barrier(&cpus_barrier, INVALID_MPID);
 
 	/* Power on all the non-lead cores. */
 	for_each_cpu(cpu_node) {
@@ -576,11 +512,7 @@ test_result_t test_rt_instr_psci_version_parallel(void)
 		while (tftf_psci_affinity_info(target_mpid, MPIDR_AFFLVL0) !=
 		    PSCI_STATE_OFF)
 			continue;
-		cpu_count--;
 	}
 
-	cpu_count--;
-	assert(cpu_count == 0);
-
 	return dump_psci_version_stats(__func__);
 }
@@ -0,0 +1,479 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <arch_helpers.h>
+#include <debug.h>
+#include <perf_helpers.h>
+#include <plat_topology.h>
+#include <platform.h>
+#include <pmf_helpers.h>
+#include <power_management.h>
+#include <psci.h>
+#include <tftf_lib.h>
+#include <timer.h>
+
+/* PMF runtime instrumentation timestamps used by this test */
+#define TOTAL_IDS		(PMF_RT_INSTR_EXIT_HW_LOW_PWR + 1)
+
+/* Suspends per power state and scenario */
+#define LATENCY_ITERATIONS	8U
+
+/* Whether the lead CPU is the last one running in its cluster */
+#define SCENARIO_LAST		0U
+#define SCENARIO_NON_LAST	1U
+#define SCENARIO_COUNT		2U
+
+/* Latencies of one power state in one scenario */
+struct latency_cell {
+	struct perf_stats entry;	/* PSCI entry to low power entry */
+	struct perf_stats exit;		/* Low power exit to PSCI exit */
+	struct perf_stats wakeup;	/* Low power exit to NS C code */
+	unsigned int invalid;		/* Suspends without valid timestamps */
+};
+
+/* Latencies of one CPU_ON in one scenario */
+struct cpu_on_cell {
+	struct perf_stats call;		/* CPU_ON call on the caller */
+	struct perf_stats powerup;	/* CPU_ON entry to low power exit */
+	struct perf_stats exit;		/* Low power exit to PSCI exit */
+	struct perf_stats wakeup;	/* Low power exit to NS C code */
+	unsigned int invalid;
+};
+
+static volatile unsigned int sibling_ready;
+static volatile unsigned int sibling_release;
+
+/* Timestamps taken by the CPU being powered on */
+static volatile uint64_t target_resume;
+static volatile u_register_t target_ts[TOTAL_IDS];
+static volatile int target_ret;
+
+/*
+ * Keep another CPU of a cluster running, so that the CPU measured is not the
+ * last one and the cluster stays powered up.
+ */
+static test_result_t sibling_entrypoint(void)
+{
+	sibling_ready = 1U;
+	dsbsy();
+
+	while (sibling_release == 0U) {
+		continue;
+	}
+
+	return TEST_RESULT_SUCCESS;
+}
+
+/* Return the MPIDR of another CPU of the cluster of 'mpid', or INVALID_MPID */
+static u_register_t find_sibling(u_register_t mpid)
+{
+	unsigned int cluster, cpu_node;
+	u_register_t sibling;
+
+	cluster = tftf_get_parent_node_from_mpidr(mpid, MPIDR_AFFLVL1);
+	if (cluster == PWR_DOMAIN_INIT) {
+		return INVALID_MPID;
+	}
+
+	for_each_cpu_in_power_domain(cpu_node, cluster) {
+		sibling = tftf_get_mpidr_from_node(cpu_node) & MPID_MASK;
+		if (sibling != mpid) {
+			return sibling;
+		}
+	}
+
+	return INVALID_MPID;
+}
+
+static int start_sibling(u_register_t sibling)
+{
+	int ret;
+
+	sibling_ready = 0U;
+	sibling_release = 0U;
+	dsbsy();
+
+	ret = tftf_cpu_on(sibling, (uintptr_t)sibling_entrypoint, 0);
+	if (ret != PSCI_E_SUCCESS) {
+		ERROR("CPU ON failed for 0x%llx\n", (unsigned long long)sibling);
+		return -1;
+	}
+
+	while (sibling_ready == 0U) {
+		continue;
+	}
+
+	return 0;
+}
+
+static void stop_sibling(u_register_t sibling)
+{
+	sibling_release = 1U;
+	dsbsy();
+
+	while (tftf_psci_affinity_info(sibling, MPIDR_AFFLVL0) !=
+	       PSCI_STATE_OFF) {
+		continue;
+	}
+}
+
+/*
+ * Suspend the calling CPU to 'power_state' and account for the latencies of
+ * the suspend in 'cell'. The timestamps must have been captured during this
+ * suspend and be ordered, else the sample is discarded: a suspend that EL3
+ * aborts early, for instance because of a pending interrupt, does not update
+ * the low power timestamps.
+ */
+static int measure_suspend(unsigned int power_state, struct latency_cell *cell)
+{
+	u_register_t ts[TOTAL_IDS];
+	uint64_t start, resume;
+	int ret;
+
+	start = read_cntpct_el0();
+	ret = tftf_program_timer_and_suspend(PLAT_SUSPEND_ENTRY_TIME,
+					     power_state, NULL, NULL);
+	resume = read_cntpct_el0();
+	tftf_cancel_timer();
+
+	if (ret != 0) {
+		ERROR("Failed to program timer or suspend CPU: 0x%x\n", ret);
+		return -1;
+	}
+
+	if (pmf_rt_instr_get_ts(ts, TOTAL_IDS) != 0) {
+		ERROR("Failed to capture PMF timestamp\n");
+		return -1;
+	}
+
+	if ((start > ts[PMF_RT_INSTR_ENTER_PSCI]) ||
+	    (ts[PMF_RT_INSTR_ENTER_PSCI] > ts[PMF_RT_INSTR_ENTER_HW_LOW_PWR]) ||
+	    (ts[PMF_RT_INSTR_ENTER_HW_LOW_PWR] >
+	     ts[PMF_RT_INSTR_EXIT_HW_LOW_PWR]) ||
+	    (ts[PMF_RT_INSTR_EXIT_HW_LOW_PWR] > ts[PMF_RT_INSTR_EXIT_PSCI]) ||
+	    (ts[PMF_RT_INSTR_EXIT_PSCI] > resume)) {
+		cell->invalid++;
+		return 0;
+	}
+
+	perf_stats_add(&cell->entry, ts[PMF_RT_INSTR_ENTER_HW_LOW_PWR] -
+				     ts[PMF_RT_INSTR_ENTER_PSCI]);
+	perf_stats_add(&cell->exit, ts[PMF_RT_INSTR_EXIT_PSCI] -
+				    ts[PMF_RT_INSTR_EXIT_HW_LOW_PWR]);
+	perf_stats_add(&cell->wakeup,
+		       resume - ts[PMF_RT_INSTR_EXIT_HW_LOW_PWR]);
+
+	return 0;
+}
+
+static void print_cell(const struct latency_cell *cell)
+{
+	if (cell->entry.count == 0U) {
+		printf(" | %10s %10s %10s", "-", "-", "-");
+		return;
+	}
+
+	printf(" | %10llu %10llu %10llu",
+	       (unsigned long long)perf_ticks_to_ns(perf_stats_avg(&cell->entry)),
+	       (unsigned long long)perf_ticks_to_ns(perf_stats_avg(&cell->exit)),
+	       (unsigned long long)perf_ticks_to_ns(
+			perf_stats_avg(&cell->wakeup)));
+}
+
+/*
+ * @Test_Aim@ Measure the CPU_SUSPEND latencies of every valid power state.
+ *
+ * All the composite power states of the platform are enumerated, at every
+ * power level. The lead CPU is suspended LATENCY_ITERATIONS times to each of
+ * them, first as the last CPU running in the system, then with another CPU of
+ * its cluster running. The PMF runtime instrumentation timestamps give, for
+ * each suspend:
+ * - the entry latency, from the PSCI entry to the low power state entry,
+ * - the exit latency, from the low power state exit to the PSCI exit,
+ * - the wakeup latency, from the low power state exit to the resumption of the
+ *   C code of the caller.
+ *
+ * The average latencies are printed as a matrix with one row per power state.
+ * A '-' stands for a scenario that could not be measured, for instance when
+ * the clusters have a single CPU.
+ */
+test_result_t test_rt_instr_susp_latency_matrix(void)
+{
+	unsigned int pstate_id_idx[PLAT_MAX_PWR_LEVEL + 1];
+	unsigned int pwrlvl, susp_type, state_id, power_state;
+	struct latency_cell cells[SCENARIO_COUNT];
+	u_register_t lead_mpid, sibling;
+	unsigned int invalid;
+	int ret = 0;
+
+	if (!pmf_rt_instr_is_supported()) {
+		return TEST_RESULT_SKIPPED;
+	}
+
+	lead_mpid = read_mpidr_el1() & MPID_MASK;
+	sibling = find_sibling(lead_mpid);
+
+	printf("CPU_SUSPEND latencies in ns, average of %u suspends\n",
+	       LATENCY_ITERATIONS);
+	printf("%5s %9s %10s | %32s | %32s\n", "", "", "",
+	       "last CPU of the cluster", "other CPU of the cluster on");
+	printf("%5s %9s %10s | %10s %10s %10s | %10s %10s %10s\n",
+	       "level", "type", "state ID", "entry", "exit", "wakeup",
+	       "entry", "exit", "wakeup");
+
+	INIT_PWR_LEVEL_INDEX(pstate_id_idx);
+
+	while (ret == 0) {
+		tftf_set_next_state_id_idx(PLAT_MAX_PWR_LEVEL, pstate_id_idx);
+		if (pstate_id_idx[0] == PWR_STATE_INIT_INDEX) {
+			break;
+		}
+
+		if (tftf_get_pstate_vars(&pwrlvl, &susp_type, &state_id,
+					 pstate_id_idx) != PSCI_E_SUCCESS) {
+			continue;
+		}
+
+		power_state = tftf_make_psci_pstate(pwrlvl, susp_type,
+						    state_id);
+
+		for (unsigned int s = 0U; s < SCENARIO_COUNT; s++) {
+			perf_stats_init(&cells[s].entry);
+			perf_stats_init(&cells[s].exit);
+			perf_stats_init(&cells[s].wakeup);
+			cells[s].invalid = 0U;
+		}
+
+		for (unsigned int i = 0U; (i < LATENCY_ITERATIONS) && (ret == 0);
+		     i++) {
+			ret = measure_suspend(power_state,
+					      &cells[SCENARIO_LAST]);
+		}
+
+		if ((sibling != INVALID_MPID) && (ret == 0)) {
+			ret = start_sibling(sibling);
+			for (unsigned int i = 0U;
+			     (i < LATENCY_ITERATIONS) && (ret == 0); i++) {
+				ret = measure_suspend(power_state,
+						      &cells[SCENARIO_NON_LAST]);
+			}
+			stop_sibling(sibling);
+		}
+
+		printf("%5u %9s 0x%08x", pwrlvl,
+		       (susp_type == PSTATE_TYPE_STANDBY) ? "standby" :
+		       "powerdown", state_id);
+		print_cell(&cells[SCENARIO_LAST]);
+		print_cell(&cells[SCENARIO_NON_LAST]);
+		invalid = cells[SCENARIO_LAST].invalid +
+			  cells[SCENARIO_NON_LAST].invalid;
+		if (invalid != 0U) {
+			printf(" (%u discarded)", invalid);
+		}
+		printf("\n");
+	}
+
+	return (ret == 0) ? TEST_RESULT_SUCCESS : TEST_RESULT_FAIL;
+}
+
+/* Record when the CPU reaches C code, then its PMF timestamps */
+static test_result_t cpu_on_entrypoint(void)
+{
+	u_register_t ts[TOTAL_IDS];
+
+	target_resume = read_cntpct_el0();
+	target_ret = pmf_rt_instr_get_ts(ts, TOTAL_IDS);
+
+	for (unsigned int i = 0U; i < TOTAL_IDS; i++) {
+		target_ts[i] = ts[i];
+	}
+	dsbsy();
+
+	return TEST_RESULT_SUCCESS;
+}
+
+/*
+ * Power on 'target' from the calling CPU and account for the latencies of the
+ * power up in 'cell'. Only the exit timestamps of the target are meaningful,
+ * its entry ones date back to when it was powered off.
+ */
+static int measure_cpu_on(u_register_t target, struct cpu_on_cell *cell)
+{
+	u_register_t ts[TOTAL_IDS];
+	uint64_t start;
+	int ret;
+
+	target_ret = -1;
+	dsbsy();
+
+	start = read_cntpct_el0();
+	ret = tftf_cpu_on(target, (uintptr_t)cpu_on_entrypoint, 0);
+	if (ret != PSCI_E_SUCCESS) {
+		ERROR("CPU ON failed for 0x%llx\n", (unsigned long long)target);
+		return -1;
+	}
+
+	/* Read the timestamps of the CPU_ON call before any other PSCI call */
+	if (pmf_rt_instr_get_ts(ts, TOTAL_IDS) != 0) {
+		ERROR("Failed to capture PMF timestamp\n");
+		return -1;
+	}
+
+	while (tftf_psci_affinity_info(target, MPIDR_AFFLVL0) !=
+	       PSCI_STATE_OFF) {
+		continue;
+	}
+
+	if (target_ret != 0) {
+		ERROR("Failed to capture PMF timestamp\n");
+		return -1;
+	}
+
+	if ((start > ts[PMF_RT_INSTR_ENTER_PSCI]) ||
+	    (ts[PMF_RT_INSTR_ENTER_PSCI] > ts[PMF_RT_INSTR_EXIT_PSCI]) ||
+	    (ts[PMF_RT_INSTR_ENTER_PSCI] >
+	     target_ts[PMF_RT_INSTR_EXIT_HW_LOW_PWR]) ||
+	    (target_ts[PMF_RT_INSTR_EXIT_HW_LOW_PWR] >
+	     target_ts[PMF_RT_INSTR_EXIT_PSCI]) ||
+	    (target_ts[PMF_RT_INSTR_EXIT_PSCI] > target_resume)) {
+		cell->invalid++;
+		return 0;
+	}
+
+	perf_stats_add(&cell->call, ts[PMF_RT_INSTR_EXIT_PSCI] -
+				    ts[PMF_RT_INSTR_ENTER_PSCI]);
+	perf_stats_add(&cell->powerup,
+		       target_ts[PMF_RT_INSTR_EXIT_HW_LOW_PWR] -
+		       ts[PMF_RT_INSTR_ENTER_PSCI]);
+	perf_stats_add(&cell->exit,
+		       target_ts[PMF_RT_INSTR_EXIT_PSCI] -
+		       target_ts[PMF_RT_INSTR_EXIT_HW_LOW_PWR]);
+	perf_stats_add(&cell->wakeup,
+		       target_resume - target_ts[PMF_RT_INSTR_EXIT_HW_LOW_PWR]);
+
+	return 0;
+}
+
+static void print_cpu_on_cell(const struct cpu_on_cell *cell)
+{
+	if (cell->call.count == 0U) {
+		printf(" | %9s %9s %9s %9s", "-", "-", "-", "-");
+		return;
+	}
+
+	printf(" | %9llu %9llu %9llu %9llu",
+	       (unsigned long long)perf_ticks_to_ns(perf_stats_avg(&cell->call)),
+	       (unsigned long long)perf_ticks_to_ns(
+			perf_stats_avg(&cell->powerup)),
+	       (unsigned long long)perf_ticks_to_ns(perf_stats_avg(&cell->exit)),
+	       (unsigned long long)perf_ticks_to_ns(
+			perf_stats_avg(&cell->wakeup)));
+}
+
+static void cpu_on_cell_init(struct cpu_on_cell *cell)
+{
+	perf_stats_init(&cell->call);
+	perf_stats_init(&cell->powerup);
+	perf_stats_init(&cell->exit);
+	perf_stats_init(&cell->wakeup);
+	cell->invalid = 0U;
+}
+
+/*
+ * @Test_Aim@ Measure the CPU_ON latencies of every CPU.
+ *
+ * Each CPU other than the lead CPU is powered on LATENCY_ITERATIONS times,
+ * first with its cluster powered off, then with another CPU of its cluster
+ * running. The cluster of the lead CPU is never powered off. The PMF runtime
+ * instrumentation timestamps give, for each power on:
+ * - the duration of the CPU_ON call on the lead CPU,
+ * - the power up latency, from the CPU_ON entry to the low power state exit of
+ *   the target CPU,
+ * - the exit latency, from the low power state exit to the PSCI exit,
+ * - the wakeup latency, from the low power state exit to the test entry point,
+ *   which includes the warm boot of the framework.
+ *
+ * The average latencies are printed as a matrix with one row per CPU.
+ */
+test_result_t test_rt_instr_cpu_on_latency_matrix(void)
+{
+	struct cpu_on_cell cells[SCENARIO_COUNT];
+	u_register_t lead_mpid, target, sibling;
+	unsigned int cpu_node, invalid;
+	bool lead_cluster;
+	int ret = 0;
+
+	if (!pmf_rt_instr_is_supported()) {
+		return TEST_RESULT_SKIPPED;
+	}
+
+	lead_mpid = read_mpidr_el1() & MPID_MASK;
+
+	printf("CPU_ON latencies in ns, average of %u power ups\n",
+	       LATENCY_ITERATIONS);
+	printf("%7s %7s | %39s | %39s\n", "", "", "cluster off",
+	       "other CPU of the cluster on");
+	printf("%7s %7s | %9s %9s %9s %9s | %9s %9s %9s %9s\n",
+	       "cluster", "cpu", "call", "power up", "exit", "wakeup",
+	       "call", "power up", "exit", "wakeup");
+
+	for_each_cpu(cpu_node) {
+		target = tftf_get_mpidr_from_node(cpu_node) & MPID_MASK;
+		if (target == lead_mpid) {
+			continue;
+		}
+
+		cpu_on_cell_init(&cells[SCENARIO_LAST]);
+		cpu_on_cell_init(&cells[SCENARIO_NON_LAST]);
+
+		lead_cluster = MPIDR_AFF_ID(target, 1) ==
+			       MPIDR_AFF_ID(lead_mpid, 1);
+
+		if (!lead_cluster) {
+			for (unsigned int i = 0U;
+			     (i < LATENCY_ITERATIONS) && (ret == 0); i++) {
+				ret = measure_cpu_on(target,
+						     &cells[SCENARIO_LAST]);
+			}
+		}
+
+		/* The lead CPU keeps its own cluster on */
+		sibling = lead_cluster ? INVALID_MPID : find_sibling(target);
+		if ((ret == 0) && (sibling != INVALID_MPID)) {
+			ret = start_sibling(sibling);
+		}
+
+		if (lead_cluster || (sibling != INVALID_MPID)) {
+			for (unsigned int i = 0U;
+			     (i < LATENCY_ITERATIONS) && (ret == 0); i++) {
+				ret = measure_cpu_on(target,
+						     &cells[SCENARIO_NON_LAST]);
+			}
+		}
+
+		if (sibling != INVALID_MPID) {
+			stop_sibling(sibling);
+		}
+
+		printf("%7llu %7llu",
+		       (unsigned long long)MPIDR_AFF_ID(target, 1),
+		       (unsigned long long)MPIDR_AFF_ID(target, 0));
+		print_cpu_on_cell(&cells[SCENARIO_LAST]);
+		print_cpu_on_cell(&cells[SCENARIO_NON_LAST]);
+		invalid = cells[SCENARIO_LAST].invalid +
+			  cells[SCENARIO_NON_LAST].invalid;
+		if (invalid != 0U) {
+			printf(" (%u discarded)", invalid);
+		}
+		printf("\n");
+
+		if (ret != 0) {
+			return TEST_RESULT_FAIL;
+		}
+	}
+
+	return TEST_RESULT_SUCCESS;
+}
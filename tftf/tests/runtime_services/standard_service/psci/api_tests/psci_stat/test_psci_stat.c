@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -13,13 +13,13 @@
 #include <events.h>
 #include <irq.h>
 #include <math_utils.h>
+#include <percpu.h>
 #include <plat_topology.h>
 #include <platform.h>
 #include <platform_def.h>
 #include <power_management.h>
 #include <psci.h>
 #include <sgi.h>
-#include <spinlock.h>
 #include <string.h>
 #include <test_helpers.h>
 #include <tftf_lib.h>
@@ -38,40 +38,16 @@ typedef struct psci_stat_data {
 CASSERT(PLAT_MAX_PWR_LEVEL <= 2, assert_maximum_defined_stat_array_size_exceeded);
 
 /*
- * The data structure holding stat information as queried by each CPU.
- * We don't worry about cache line thrashing.
+ * The data structure holding stat information as queried by each CPU. It is
+ * per-CPU so that CPUs updating their own stats do not share cache lines.
  */
-static psci_stat_data_t stat_data[PLATFORM_CORE_COUNT][PLAT_MAX_PWR_LEVEL + 1]
-						       [MAX_STAT_STATES];
+static DEFINE_PER_CPU(psci_stat_data_t[PLAT_MAX_PWR_LEVEL + 1][MAX_STAT_STATES],
+		      stat_data);
 
-/*
- * Synchronization event for stat tests. A 2-D event array is used to
- * signal every CPU by each CPU. This caters for the fact some
- * CPUs may have higher performance than others and will not
- * cause the synchronization to fail.
- */
-static event_t stat_sync[PLATFORM_CORE_COUNT][PLATFORM_CORE_COUNT];
-
-/* Global variables to synchronize participating CPUs on wake-up */
-static spinlock_t cpu_count_lock;
-static volatile int cpu_count;
+/* Synchronization point of the CPUs participating in the stat tests */
+static barrier_t stat_barrier;
 static volatile int participating_cpu_count;
 
-/* Helper function to wait for CPUs participating in the test */
-static void wait_for_participating_cpus(void)
-{
-	assert(participating_cpu_count <= PLATFORM_CORE_COUNT);
-
-	spin_lock(&cpu_count_lock);
-	cpu_count++;
-	spin_unlock(&cpu_count_lock);
-
-	assert(cpu_count <= PLATFORM_CORE_COUNT);
-
-	while (cpu_count != participating_cpu_count)
-		;
-}
-
 /* Helper function to detect support for PSCI STAT APIs in firmware */
 static int is_psci_stat_supported(void)
 {
@@ -121,7 +97,7 @@ static psci_stat_data_t *get_psci_stat_data(int cpu_idx,
 
 	/* Calculate the stat_idx */
 	stat_idx = get_stat_idx(pstateid_idx, pwrlvl);
-	return &stat_data[cpu_idx][pwrlvl][stat_idx];
+	return &per_cpu(stat_data, cpu_idx)[pwrlvl][stat_idx];
 }
 
 /*
@@ -351,7 +327,7 @@ static void populate_all_stats_all_lvls(void)
  *   `power state` helpers.
  *
  * 3. A synchronization point is created for all the CPUs taking part in the
- *    test using TFTF events. This is needed because low power states at higher
+ *    test using a TFTF barrier. This is needed because low power states at higher
  *    power domain levels (like cluster) can only be achieved if all the CPUs
  *    within the power domain request the same low power state at the (nearly)
  *    same time.
@@ -365,16 +341,8 @@ static test_result_t test_psci_stat(void)
 {
 	int ret;
 	unsigned int pstateid_idx[PLAT_MAX_PWR_LEVEL + 1];
-	unsigned int pwrlvl, state_id, power_state, susp_type, cpu_node;
+	unsigned int pwrlvl, state_id, power_state, susp_type;
 	u_register_t mpidr = read_mpidr_el1() & MPID_MASK;
-	int cpu_idx = platform_get_core_pos(mpidr);
-
-	/* Initialize the per-cpu synchronization event */
-	for_each_cpu(cpu_node) {
-		u_register_t target_mpid;
-		target_mpid = tftf_get_mpidr_from_node(cpu_node);
-		tftf_init_event(&stat_sync[platform_get_core_pos(target_mpid)][cpu_idx]);
-	}
 
 	INIT_PWR_LEVEL_INDEX(pstateid_idx);
 
@@ -396,27 +364,10 @@ static test_result_t test_psci_stat(void)
 		power_state = tftf_make_psci_pstate(pwrlvl, susp_type, state_id);
 
 		/*
-		 * Create a synchronization point. A 2-D event array is used to
-		 * signal every CPU by each CPU. This caters for the fact some
-		 * CPUs may have higher performance than others and will not
-		 * cause the sychronization to fail.
+		 * Create a synchronization point, so that all the CPUs request
+		 * the power state at (nearly) the same time.
 		 */
-		for_each_cpu(cpu_node) {
-			unsigned int target_idx;
-			target_idx = platform_get_core_pos(
-					tftf_get_mpidr_from_node(cpu_node));
-			tftf_send_event(&stat_sync[target_idx][cpu_idx]);
-			tftf_wait_for_event(&stat_sync[cpu_idx][target_idx]);
-		}
-
-		/*
-		 * Initialize the cpu_count to zero for synchronizing
-		 * participating CPUs.
-		 */
-		spin_lock(&cpu_count_lock);
-		if (cpu_count == participating_cpu_count)
-			cpu_count = 0;
-		spin_unlock(&cpu_count_lock);
+		tftf_barrier_wait(&stat_barrier);
 
 		ret = tftf_program_timer_and_suspend(PLAT_SUSPEND_ENTRY_TIME,
 						     power_state, NULL, NULL);
@@ -434,7 +385,7 @@ static test_result_t test_psci_stat(void)
 				(unsigned long long)mpidr,
 				pwrlvl, power_state);
 
-		wait_for_participating_cpus();
+		tftf_barrier_wait(&stat_barrier);
 
 		ret = validate_stat_result(pstateid_idx, pwrlvl);
 		if (ret)
@@ -527,7 +478,7 @@ test_result_t test_psci_stat_all_power_states(void)
 
 	/* Initialize participating CPU count */
 	participating_cpu_count = tftf_get_total_cpus_count();
-	init_spinlock(&cpu_count_lock);
+	tftf_init_barrier(&stat_barrier, INVALID_MPID);
 
 	for_each_cpu(cpu_node) {
 		target_mpid = tftf_get_mpidr_from_node(cpu_node);
@@ -573,7 +524,7 @@ test_result_t test_psci_stat_all_power_states(void)
  */
 static test_result_t update_stats_and_power_off(void)
 {
-	wait_for_participating_cpus();
+	tftf_barrier_wait(&stat_barrier);
 
 	populate_all_stats_all_lvls();
 	return TEST_RESULT_SUCCESS;
@@ -604,8 +555,6 @@ static test_result_t verify_powerdown_stats(void)
 
 	INIT_PWR_LEVEL_INDEX(stateid_idx);
 
-	wait_for_participating_cpus();
-
 	do {
 		tftf_set_next_state_id_idx(PLAT_MAX_PWR_LEVEL, stateid_idx);
 		if (stateid_idx[0] == PWR_STATE_INIT_INDEX)
@@ -659,6 +608,16 @@ static test_result_t verify_powerdown_stats(void)
 	return result;
 }
 
+/*
+ * Entry point of the secondary CPUs verifying their stats, all together.
+ */
+static test_result_t sync_and_verify_powerdown_stats(void)
+{
+	tftf_barrier_wait(&stat_barrier);
+
+	return verify_powerdown_stats();
+}
+
 /*
  * @Test_Aim@ Validate PSCI stats after calling CPU_OFF on each secondary core.
  * The test sequence is as follows:
@@ -690,8 +649,7 @@ test_result_t test_psci_stats_cpu_off(void)
 	 * Count it out of the participating CPUs pool.
 	 */
 	participating_cpu_count = tftf_get_total_cpus_count() - 1;
-	init_spinlock(&cpu_count_lock);
-	cpu_count = 0;
+	tftf_init_barrier(&stat_barrier, lead_mpid);
 
 	/* Turn on each secondary and update the stats. */
 	for_each_cpu(cpu_node) {
@@ -701,8 +659,8 @@ test_result_t test_psci_stats_cpu_off(void)
 			continue;
 
 		/*
-		 * cpu_count will be updated by the secondary CPUs when they
-		 * execute `update_stats_and_power_off` function.
+		 * The secondary CPUs wait for each other on `stat_barrier`
+		 * in the `update_stats_and_power_off` function.
 		 */
 		ret = tftf_cpu_on(target_mpid,
 				(uintptr_t) update_stats_and_power_off, 0);
@@ -727,7 +685,6 @@ test_result_t test_psci_stats_cpu_off(void)
 	}
 
 	assert(off_cpu_count == participating_cpu_count);
-	cpu_count = 0;
 
 	ret = tftf_psci_make_composite_state_id(MPIDR_AFFLVL0,
 					PSTATE_TYPE_STANDBY, &stateid);
@@ -758,7 +715,7 @@ test_result_t test_psci_stats_cpu_off(void)
 			continue;
 
 		ret = tftf_cpu_on(target_mpid,
-				(uintptr_t) verify_powerdown_stats, 0);
+				(uintptr_t) sync_and_verify_powerdown_stats, 0);
 		if (ret != PSCI_E_SUCCESS) {
 			ERROR("CPU ON failed for 0x%llx",
 					(unsigned long long)target_mpid);
@@ -811,8 +768,7 @@ test_result_t test_psci_stats_system_suspend(void)
 
 	/* Initialize participating CPU count. The lead CPU is excluded in the count */
 	participating_cpu_count = tftf_get_total_cpus_count() - 1;
-	init_spinlock(&cpu_count_lock);
-	cpu_count = 0;
+	tftf_init_barrier(&stat_barrier, lead_mpid);
 
 	/* Turn on each secondary and update the stats. */
 	for_each_cpu(cpu_node) {
@@ -822,8 +778,8 @@ test_result_t test_psci_stats_system_suspend(void)
 			continue;
 
 		/*
-		 * cpu_count will be updated by the secondary CPUs when they
-		 * execute `update_stats_and_power_off` function.
+		 * The secondary CPUs wait for each other on `stat_barrier`
+		 * in the `update_stats_and_power_off` function.
 		 */
 		ret = tftf_cpu_on(target_mpid,
 				(uintptr_t) update_stats_and_power_off, 0);
@@ -844,7 +800,6 @@ test_result_t test_psci_stats_system_suspend(void)
 	}
 
 	assert(off_cpu_count == participating_cpu_count);
-	cpu_count = 0;
 
 	/* Update the stats corresponding to the lead CPU as well */
 	populate_all_stats_all_lvls();
@@ -867,7 +822,7 @@ test_result_t test_psci_stats_system_suspend(void)
 			continue;
 
 		ret = tftf_cpu_on(target_mpid,
-				(uintptr_t) verify_powerdown_stats, 0);
+				(uintptr_t) sync_and_verify_powerdown_stats, 0);
 		if (ret != PSCI_E_SUCCESS)
 			return TEST_RESULT_FAIL;
 	}
@@ -882,9 +837,6 @@ test_result_t test_psci_stats_system_suspend(void)
 			;
 	}
 
-	/* Increment the participating CPU count to include the lead CPU as well */
-	participating_cpu_count++;
-
 	/* Verify the stats on the lead CPU as well */
 	return verify_powerdown_stats();
 }
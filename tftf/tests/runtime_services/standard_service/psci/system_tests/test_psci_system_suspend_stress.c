@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -35,46 +35,19 @@ static u_register_t baton_cpu;
 /* Synchronization event which will be waited on by all the non-baton CPUs */
 static event_t sync_event;
 
-/* Global variables to synchronize participating CPUs on wake-up */
-static spinlock_t cpu_count_lock;
-static volatile int cpu_count;
+/* Barrier between all the CPUs once they have entered the test function */
+static barrier_t entry_barrier;
 static volatile int participating_cpu_count;
 
+/* Set by the baton CPU once it has entered the test function */
+static volatile int baton_cpu_entered;
+
 /* Variable to store the system suspend power state and its statistics */
 static int system_susp_pwr_state;
 static u_register_t susp_count;
 
 static test_result_t do_sys_susp_on_off_stress(void);
 
-/*
- * Helper function to wait for participating CPUs participating to enter the
- * test function.
- */
-static void wait_for_cpus_to_enter_test(void)
-{
-	assert(participating_cpu_count <= PLATFORM_CORE_COUNT);
-	while (cpu_count != participating_cpu_count)
-		;
-}
-
-/* Helper function to increment the cpu_count */
-static void inc_cpu_count(void)
-{
-	spin_lock(&cpu_count_lock);
-	cpu_count++;
-	spin_unlock(&cpu_count_lock);
-	assert(cpu_count <= PLATFORM_CORE_COUNT);
-}
-
-/* Helper function to decrement the cpu_count */
-static void dec_cpu_count(void)
-{
-	spin_lock(&cpu_count_lock);
-	cpu_count--;
-	spin_unlock(&cpu_count_lock);
-	assert(cpu_count >= 0);
-}
-
 /* Helper function to turn ON all the CPUs in the platform */
 static int try_cpu_on_all(void)
 {
@@ -144,15 +117,15 @@ static test_result_t do_sys_susp_on_off_stress(void)
 	int psci_ret, off_cpu_count;
 	u_register_t current_cpu;
 
-	inc_cpu_count();
-
 	current_cpu = read_mpidr_el1() & MPID_MASK;
 	if (current_cpu != baton_cpu) {
+		tftf_barrier_wait(&entry_barrier);
 		tftf_wait_for_event(&sync_event);
-		dec_cpu_count();
 		return TEST_RESULT_SUCCESS;
 	}
 
+	baton_cpu_entered = 1;
+
 	INFO("System suspend test: Baton holder CPU = 0x%llx\n",
 			(unsigned long long) current_cpu);
 	if (try_cpu_on_all() == -1) {
@@ -160,7 +133,7 @@ static test_result_t do_sys_susp_on_off_stress(void)
 		return TEST_RESULT_FAIL;
 	}
 
-	wait_for_cpus_to_enter_test();
+	tftf_barrier_wait(&entry_barrier);
 
 	/* Turn off random number of cores 1 out of 3 times */
 	if (rand() % 3)
@@ -208,17 +181,16 @@ static test_result_t do_sys_susp_on_off_stress(void)
 	while (get_off_cpu_count() != (participating_cpu_count - 1))
 		;
 
-	dec_cpu_count();
-
 	if (iteration_count++ < MAX_TEST_ITERATIONS) {
 		/* Hand over the test execution the new baton CPU */
+		baton_cpu_entered = 0;
 		psci_ret = tftf_cpu_on(baton_cpu,
 				(uintptr_t) do_sys_susp_on_off_stress, 0);
 		if (psci_ret != PSCI_E_SUCCESS)
 			return TEST_RESULT_FAIL;
 
 		/* Wait for new baton CPU to enter test */
-		while (cpu_count == 0)
+		while (baton_cpu_entered == 0)
 			;
 	} else {
 		/*
@@ -259,11 +231,10 @@ test_result_t psci_sys_susp_on_off_stress_test(void)
 
 	INIT_PWR_LEVEL_INDEX(pstateid_idx);
 	tftf_init_event(&sync_event);
-	init_spinlock(&cpu_count_lock);
 
 	/* Initialize participating CPU count */
 	participating_cpu_count = tftf_get_total_cpus_count();
-	cpu_count = 0;
+	tftf_init_barrier(&entry_barrier, INVALID_MPID);
 
 	iteration_count = 0;
 
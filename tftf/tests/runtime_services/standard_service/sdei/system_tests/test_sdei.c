@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -29,23 +29,17 @@ static int bound_ev;
 /* true if the test is using a private interrupt source, false otherwise. */
 static int private_interrupt;
 
-static spinlock_t cpu_count_lock;
-static volatile int cpu_count;
+static barrier_t cpus_barrier;
 static volatile int participating_cpu_count;
 
-/* Helper function to wait for CPUs participating in the test. */
+/*
+ * Helper function to wait for CPUs participating in the test. In the serial
+ * test, the CPUs run one at a time and do not wait for each other.
+ */
 static void wait_for_participating_cpus(void)
 {
-	assert(participating_cpu_count <= PLATFORM_CORE_COUNT);
-
-	spin_lock(&cpu_count_lock);
-	cpu_count++;
-	spin_unlock(&cpu_count_lock);
-
-	assert(cpu_count <= PLATFORM_CORE_COUNT);
-
-	while (cpu_count != participating_cpu_count)
-		continue;
+	if (participating_cpu_count > 1)
+		tftf_barrier_wait(&cpus_barrier);
 }
 
 void sdei_trigger_event(void)
@@ -124,8 +118,6 @@ test_result_t test_sdei_event_serial(void)
 
 	lead_mpid = read_mpidr_el1() & MPID_MASK;
 	participating_cpu_count = 1;
-	init_spinlock(&cpu_count_lock);
-	cpu_count = 0;
 
 	ret = sdei_version();
 	if (ret != MAKE_SDEI_VERSION(1, 0, 0)) {
@@ -158,17 +150,11 @@ test_result_t test_sdei_event_serial(void)
 		while (tftf_psci_affinity_info(target_mpid, MPIDR_AFFLVL0) !=
 		    PSCI_STATE_OFF)
 			continue;
-		cpu_count--;
 	}
 
-	assert(cpu_count == 0);
-
 	if (sdei_event() != TEST_RESULT_SUCCESS)
 		goto err0;
 
-	cpu_count--;
-	assert(cpu_count == 0);
-
 	sdei_interrupt_release(bound_ev, &intr_ctx);
 	enable_irq();
 
@@ -192,8 +178,7 @@ test_result_t test_sdei_event_parallel(void)
 
 	lead_mpid = read_mpidr_el1() & MPID_MASK;
 	participating_cpu_count = tftf_get_total_cpus_count();
-	init_spinlock(&cpu_count_lock);
-	cpu_count = 0;
+	tftf_init_barrier(&cpus_barrier, INVALID_MPID);
 
 	ret = sdei_version();
 	if (ret != MAKE_SDEI_VERSION(1, 0, 0)) {
@@ -235,12 +220,8 @@ test_result_t test_sdei_event_parallel(void)
 		while (tftf_psci_affinity_info(target_mpid, MPIDR_AFFLVL0) !=
 			PSCI_STATE_OFF)
 			continue;
-		cpu_count--;
 	}
 
-	cpu_count--;
-	assert(cpu_count == 0);
-
 	sdei_interrupt_release(bound_ev, &intr_ctx);
 	enable_irq();
 
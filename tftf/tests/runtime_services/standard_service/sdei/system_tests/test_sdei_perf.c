@@ -0,0 +1,535 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <arch_helpers.h>
+#include <debug.h>
+#include <drivers/arm/arm_gic.h>
+#include <percpu.h>
+#include <perf_helpers.h>
+#include <plat_topology.h>
+#include <platform.h>
+#include <platform_def.h>
+#include <power_management.h>
+#include <sdei.h>
+#include <spinlock.h>
+#include <tftf_lib.h>
+#include <utils_def.h>
+
+/* Events signalled per latency measurement */
+#define SDEI_PERF_ITERATIONS		1000U
+
+/* Events signalled by each CPU in the throughput benchmarks */
+#define SDEI_PERF_MC_ITERATIONS		2000U
+
+/* Highest number of interrupts bound to events in the scaling benchmark */
+#define SDEI_PERF_MAX_BOUND		16U
+
+extern sdei_handler_t sdei_perf_entrypoint;
+extern sdei_handler_t sdei_perf_entrypoint_resume;
+
+/*
+ * State of a CPU. The handler fields are written by sdei_perf_handler() on the
+ * CPU event 0 is dispatched to, and polled by the CPU that signalled it.
+ */
+struct sdei_perf_cpu {
+	volatile uint64_t entry;	/* Handler entry timestamp */
+	volatile uint64_t exit;		/* Handler exit timestamp */
+	volatile uint64_t handled;	/* Events handled */
+};
+
+static DEFINE_PER_CPU(struct sdei_perf_cpu, sdei_perf_cpu);
+
+/* Latencies of event 0 signalled by a CPU to itself */
+struct sdei_perf_latency {
+	struct perf_stats dispatch;	/* Signal call to handler entry */
+	struct perf_stats complete;	/* Handler exit to interrupted context */
+	struct perf_stats round_trip;	/* Signal call to interrupted context */
+};
+
+/* Events other than event 0 dispatched, from an asserted bound interrupt */
+static volatile unsigned int stray_events;
+
+/* Target CPU of the single target throughput benchmark */
+static unsigned int target_core_pos;
+static u_register_t target_mpid;
+static unsigned int senders_count;
+static volatile unsigned int senders_done;
+static spinlock_t senders_lock;
+
+int sdei_perf_handler(int ev, uint64_t arg)
+{
+	struct sdei_perf_cpu *cpu = this_cpu_ptr(sdei_perf_cpu);
+	uint64_t entry = read_cntpct_el0();
+
+	if (ev != 0) {
+		stray_events++;
+		return 0;
+	}
+
+	cpu->entry = entry;
+	cpu->handled++;
+	cpu->exit = read_cntpct_el0();
+
+	return 0;
+}
+
+static bool is_sdei_supported(void)
+{
+	int64_t ret = sdei_version();
+
+	if (ret != MAKE_SDEI_VERSION(1, 0, 0)) {
+		tftf_testcase_printf("Unexpected SDEI version: 0x%llx\n",
+				     (unsigned long long)ret);
+		return false;
+	}
+
+	return true;
+}
+
+/* Register and enable event 0 on the calling CPU, then unmask the CPU */
+static int sdei_perf_setup(sdei_handler_t *ep)
+{
+	int64_t ret;
+
+	ret = sdei_event_register(0, ep, 0, SDEI_REGF_RM_PE, read_mpidr_el1());
+	if (ret < 0) {
+		ERROR("SDEI event register failed: 0x%llx\n",
+		      (unsigned long long)ret);
+		return -1;
+	}
+
+	ret = sdei_event_enable(0);
+	if (ret < 0) {
+		ERROR("SDEI event enable failed: 0x%llx\n",
+		      (unsigned long long)ret);
+		goto err0;
+	}
+
+	ret = sdei_pe_unmask();
+	if (ret < 0) {
+		ERROR("SDEI pe unmask failed: 0x%llx\n",
+		      (unsigned long long)ret);
+		goto err1;
+	}
+
+	return 0;
+
+err1:
+	sdei_event_disable(0);
+err0:
+	sdei_event_unregister(0);
+	return -1;
+}
+
+static void sdei_perf_teardown(void)
+{
+	sdei_pe_mask();
+	sdei_event_disable(0);
+	sdei_event_unregister(0);
+}
+
+/*
+ * Signal event 0 to 'mpid' and wait for a handler to have run on it, 'target'
+ * being the state of that CPU.
+ */
+static int sdei_perf_signal(u_register_t mpid,
+			    const struct sdei_perf_cpu *target)
+{
+	uint64_t handled = target->handled;
+	int64_t ret;
+
+	ret = sdei_event_signal(mpid);
+	if (ret < 0) {
+		ERROR("SDEI event signal failed: 0x%llx\n",
+		      (unsigned long long)ret);
+		return -1;
+	}
+
+	while (target->handled == handled) {
+		continue;
+	}
+
+	return 0;
+}
+
+static void latency_init(struct sdei_perf_latency *lat)
+{
+	perf_stats_init(&lat->dispatch);
+	perf_stats_init(&lat->complete);
+	perf_stats_init(&lat->round_trip);
+}
+
+/*
+ * Signal event 0 to the calling CPU SDEI_PERF_ITERATIONS times. The handler
+ * interrupts the CPU waiting for it, so the first timestamp taken after the
+ * wait is when the interrupted context was resumed.
+ */
+static int measure_signal_latency(struct sdei_perf_latency *lat)
+{
+	struct sdei_perf_cpu *cpu = this_cpu_ptr(sdei_perf_cpu);
+	u_register_t mpid = read_mpidr_el1() & MPID_MASK;
+	uint64_t start, end;
+
+	for (unsigned int i = 0U; i < SDEI_PERF_ITERATIONS; i++) {
+		start = read_cntpct_el0();
+		if (sdei_perf_signal(mpid, cpu) != 0) {
+			return -1;
+		}
+		end = read_cntpct_el0();
+
+		perf_stats_add(&lat->dispatch, cpu->entry - start);
+		perf_stats_add(&lat->complete, end - cpu->exit);
+		perf_stats_add(&lat->round_trip, end - start);
+	}
+
+	return 0;
+}
+
+/*
+ * @Test_Aim@ Measure the latencies of event 0 signalled by the lead CPU to
+ * itself: from the SDEI_EVENT_SIGNAL call to the handler entry, and from the
+ * handler exit back to the interrupted context, once with the handler ending
+ * with SDEI_EVENT_COMPLETE and once with SDEI_EVENT_COMPLETE_AND_RESUME.
+ */
+test_result_t test_sdei_perf_signal_latency(void)
+{
+	static const struct {
+		const char *name;
+		sdei_handler_t *ep;
+	} modes[] = {
+		{ "SDEI_EVENT_COMPLETE", sdei_perf_entrypoint },
+		{ "SDEI_EVENT_COMPLETE_AND_RESUME",
+		  sdei_perf_entrypoint_resume },
+	};
+	struct sdei_perf_latency lat;
+	int ret = 0;
+
+	if (!is_sdei_supported()) {
+		return TEST_RESULT_SKIPPED;
+	}
+
+	disable_irq();
+
+	for (unsigned int i = 0U; i < ARRAY_SIZE(modes); i++) {
+		latency_init(&lat);
+
+		ret = sdei_perf_setup(modes[i].ep);
+		if (ret != 0) {
+			break;
+		}
+
+		ret = measure_signal_latency(&lat);
+		sdei_perf_teardown();
+		if (ret != 0) {
+			break;
+		}
+
+		printf("Handler ending with %s\n", modes[i].name);
+		perf_stats_print("  signal to handler", &lat.dispatch, true);
+		perf_stats_print("  handler to resume", &lat.complete, true);
+		perf_stats_print("  round trip", &lat.round_trip, false);
+
+		tftf_testcase_printf("%s: signal to handler %llu ns, "
+			"handler to resume %llu ns\n", modes[i].name,
+			(unsigned long long)perf_ticks_to_ns(
+				perf_stats_avg(&lat.dispatch)),
+			(unsigned long long)perf_ticks_to_ns(
+				perf_stats_avg(&lat.complete)));
+	}
+
+	enable_irq();
+
+	return (ret == 0) ? TEST_RESULT_SUCCESS : TEST_RESULT_FAIL;
+}
+
+/*
+ * Bind the first SPI from '*intr' onwards that the framework does not use to
+ * an SDEI event. Return the event number, or a negative value once the EL3
+ * firmware cannot bind any more interrupts.
+ */
+static int64_t bind_unused_spi(unsigned int *intr,
+			       struct sdei_intr_ctx *intr_ctx)
+{
+	int64_t ev;
+
+	for (; *intr <= (MIN_SPI_ID + PLAT_MAX_SPI_OFFSET_ID); (*intr)++) {
+		if (arm_gic_intr_enabled(*intr) != 0U) {
+			continue;
+		}
+
+		/* Secure interrupts are denied, try the next one */
+		ev = sdei_interrupt_bind(*intr, intr_ctx);
+		if (ev >= 0) {
+			(*intr)++;
+			return ev;
+		}
+
+		if (ev == -SMC_ENOMEM) {
+			return ev;
+		}
+	}
+
+	return -SMC_ENOMEM;
+}
+
+/*
+ * @Test_Aim@ Measure how the dispatch latency of event 0 grows with the
+ * number of events registered. Before each measurement, one more unused SPI
+ * is bound to an SDEI event, which is registered and enabled on the lead CPU,
+ * until the EL3 firmware runs out of events to bind them to or
+ * SDEI_PERF_MAX_BOUND are bound. The bound interrupts are not expected to be
+ * asserted.
+ */
+test_result_t test_sdei_perf_registered_events(void)
+{
+	struct sdei_intr_ctx intr_ctx[SDEI_PERF_MAX_BOUND];
+	int bound_ev[SDEI_PERF_MAX_BOUND];
+	struct sdei_perf_latency lat;
+	unsigned int bound = 0U, intr = MIN_SPI_ID;
+	int64_t ev, err;
+	int ret;
+
+	if (!is_sdei_supported()) {
+		return TEST_RESULT_SKIPPED;
+	}
+
+	stray_events = 0U;
+	disable_irq();
+
+	ret = sdei_perf_setup(sdei_perf_entrypoint);
+	if (ret != 0) {
+		enable_irq();
+		return TEST_RESULT_FAIL;
+	}
+
+	printf("Signal to handler latency in ns, %u events per row\n",
+	       SDEI_PERF_ITERATIONS);
+	printf("%10s %10s %10s %10s\n", "registered", "avg", "p99", "max");
+
+	for (;;) {
+		latency_init(&lat);
+		ret = measure_signal_latency(&lat);
+		if (ret != 0) {
+			break;
+		}
+
+		printf("%10u %10llu %10llu %10llu\n", bound + 1U,
+		       (unsigned long long)perf_ticks_to_ns(
+				perf_stats_avg(&lat.dispatch)),
+		       (unsigned long long)perf_ticks_to_ns(
+				perf_stats_percentile(&lat.dispatch, 99U)),
+		       (unsigned long long)perf_ticks_to_ns(lat.dispatch.max));
+		tftf_testcase_printf("%u events registered: %llu ns\n",
+			bound + 1U,
+			(unsigned long long)perf_ticks_to_ns(
+				perf_stats_avg(&lat.dispatch)));
+
+		if (bound == SDEI_PERF_MAX_BOUND) {
+			break;
+		}
+
+		ev = bind_unused_spi(&intr, &intr_ctx[bound]);
+		if (ev < 0) {
+			break;
+		}
+
+		err = sdei_event_register(ev, sdei_perf_entrypoint, 0,
+					  SDEI_REGF_RM_PE, read_mpidr_el1());
+		if (err >= 0) {
+			err = sdei_event_enable(ev);
+			if (err < 0) {
+				sdei_event_unregister(ev);
+			}
+		}
+
+		if (err < 0) {
+			ERROR("SDEI event %lld setup failed: 0x%llx\n",
+			      (long long)ev, (unsigned long long)err);
+			sdei_interrupt_release(ev, &intr_ctx[bound]);
+			ret = -1;
+			break;
+		}
+
+		bound_ev[bound] = ev;
+		bound++;
+	}
+
+	sdei_perf_teardown();
+
+	for (unsigned int i = 0U; i < bound; i++) {
+		sdei_event_disable(bound_ev[i]);
+		sdei_event_unregister(bound_ev[i]);
+		sdei_interrupt_release(bound_ev[i], &intr_ctx[i]);
+	}
+
+	enable_irq();
+
+	if (stray_events != 0U) {
+		tftf_testcase_printf("%u events of bound interrupts were "
+				     "dispatched\n", stray_events);
+	}
+
+	return (ret == 0) ? TEST_RESULT_SUCCESS : TEST_RESULT_FAIL;
+}
+
+/* Executed concurrently by all participating CPUs, each signalling itself */
+static test_result_t sdei_perf_self_throughput(void)
+{
+	struct sdei_perf_cpu *cpu = this_cpu_ptr(sdei_perf_cpu);
+	u_register_t mpid = read_mpidr_el1() & MPID_MASK;
+	int ret = 0;
+
+	if (sdei_perf_setup(sdei_perf_entrypoint) != 0) {
+		return TEST_RESULT_FAIL;
+	}
+
+	cpu->handled = 0ULL;
+	perf_throughput_start();
+	for (unsigned int i = 0U;
+	     (i < SDEI_PERF_MC_ITERATIONS) && (ret == 0); i++) {
+		ret = sdei_perf_signal(mpid, cpu);
+	}
+	perf_throughput_end(cpu->handled);
+
+	sdei_perf_teardown();
+
+	return (ret == 0) ? TEST_RESULT_SUCCESS : TEST_RESULT_FAIL;
+}
+
+/*
+ * Executed concurrently by all participating CPUs. The target CPU, which has
+ * registered event 0 beforehand, handles the events that all the other CPUs
+ * signal to it until they are done.
+ */
+static test_result_t sdei_perf_single_target_throughput(void)
+{
+	struct sdei_perf_cpu *target = per_cpu_ptr(sdei_perf_cpu,
+						   target_core_pos);
+	int ret = 0;
+
+	if (this_cpu_ptr(sdei_perf_cpu) == target) {
+		perf_throughput_start();
+		while (senders_done != senders_count) {
+			continue;
+		}
+		perf_throughput_end(target->handled);
+
+		return TEST_RESULT_SUCCESS;
+	}
+
+	for (unsigned int i = 0U;
+	     (i < SDEI_PERF_MC_ITERATIONS) && (ret == 0); i++) {
+		ret = sdei_perf_signal(target_mpid, target);
+	}
+
+	spin_lock(&senders_lock);
+	senders_done++;
+	spin_unlock(&senders_lock);
+
+	return (ret == 0) ? TEST_RESULT_SUCCESS : TEST_RESULT_FAIL;
+}
+
+/*
+ * @Test_Aim@ Measure the sustained rate of SDEI events, in events per second,
+ * with 1, 2, 4, ... and finally all CPUs:
+ * - each signalling event 0 to itself, so every CPU handles its own private
+ *   event,
+ * - all signalling event 0 to the lead CPU, so they contend for a single event
+ *   handled on a single CPU, like a shared event. Signals sent while the event
+ *   is already pending are merged, which is reported as well.
+ * Shared events can only be raised by bound SPIs, which the Normal world
+ * cannot make pending, hence the second scenario models them.
+ */
+test_result_t test_sdei_perf_throughput(void)
+{
+	unsigned int cpus_count = tftf_get_total_cpus_count();
+	struct perf_throughput tp;
+	unsigned int cpu_count;
+	uint64_t signals;
+	test_result_t ret;
+
+	if (!is_sdei_supported()) {
+		return TEST_RESULT_SKIPPED;
+	}
+
+	disable_irq();
+
+	printf("Each CPU signalling itself, %u events per CPU\n",
+	       SDEI_PERF_MC_ITERATIONS);
+
+	for_each_perf_cpu_count(cpu_count, 1U, cpus_count) {
+		ret = perf_run_on_cpus(cpu_count, sdei_perf_self_throughput);
+		if (ret != TEST_RESULT_SUCCESS) {
+			goto out;
+		}
+
+		perf_throughput_collect(&tp);
+		if (tp.events !=
+		    ((uint64_t)cpu_count * SDEI_PERF_MC_ITERATIONS)) {
+			ERROR("Only %llu events out of %llu were handled\n",
+			      (unsigned long long)tp.events,
+			      (unsigned long long)cpu_count *
+			      SDEI_PERF_MC_ITERATIONS);
+			ret = TEST_RESULT_FAIL;
+			goto out;
+		}
+
+		printf("%u CPUs: %llu events/s, %llu events/s per CPU\n",
+		       cpu_count,
+		       (unsigned long long)perf_throughput_rate(&tp),
+		       (unsigned long long)perf_throughput_rate(&tp) /
+		       cpu_count);
+		tftf_testcase_printf("Private, %u CPUs: %llu events/s\n",
+			cpu_count,
+			(unsigned long long)perf_throughput_rate(&tp));
+	}
+
+	if (cpus_count < 2U) {
+		goto out;
+	}
+
+	printf("All CPUs signalling the lead CPU, %u events per CPU\n",
+	       SDEI_PERF_MC_ITERATIONS);
+
+	target_mpid = read_mpidr_el1() & MPID_MASK;
+	target_core_pos = platform_get_core_pos(target_mpid);
+	init_spinlock(&senders_lock);
+
+	for_each_perf_cpu_count(cpu_count, 2U, cpus_count) {
+		this_cpu_ptr(sdei_perf_cpu)->handled = 0ULL;
+		senders_count = cpu_count - 1U;
+		senders_done = 0U;
+
+		if (sdei_perf_setup(sdei_perf_entrypoint) != 0) {
+			ret = TEST_RESULT_FAIL;
+			goto out;
+		}
+
+		ret = perf_run_on_cpus(cpu_count,
+				       sdei_perf_single_target_throughput);
+		sdei_perf_teardown();
+		if (ret != TEST_RESULT_SUCCESS) {
+			goto out;
+		}
+
+		perf_throughput_collect(&tp);
+		signals = (uint64_t)senders_count * SDEI_PERF_MC_ITERATIONS;
+
+		printf("%u CPUs: %llu events/s, %llu of %llu signals merged\n",
+		       cpu_count,
+		       (unsigned long long)perf_throughput_rate(&tp),
+		       (unsigned long long)(signals - tp.events),
+		       (unsigned long long)signals);
+		tftf_testcase_printf("Single target, %u CPUs: %llu events/s\n",
+			cpu_count,
+			(unsigned long long)perf_throughput_rate(&tp));
+	}
+
+out:
+	enable_irq();
+
+	return ret;
+}
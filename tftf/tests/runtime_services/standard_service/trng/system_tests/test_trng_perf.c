@@ -0,0 +1,261 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <arch_helpers.h>
+#include <debug.h>
+#include <percpu.h>
+#include <perf_helpers.h>
+#include <plat_topology.h>
+#include <platform.h>
+#include <platform_def.h>
+#include <stdio.h>
+#include <tftf_lib.h>
+#include <trng.h>
+#include <trng_health.h>
+#include <utils_def.h>
+
+/* TRNG_RND calls per CPU and per request size */
+#define TRNG_PERF_ITERATIONS		256U
+
+/* TRNG_E_NO_ENTROPY returns tolerated per CPU and per request size */
+#define TRNG_PERF_MAX_RETRIES		(16U * TRNG_PERF_ITERATIONS)
+
+/*
+ * The TRNG ABI returns full entropy bits, which is 8 bits of min-entropy per
+ * 8-bit sample of the health tests.
+ */
+#define TRNG_PERF_MIN_ENTROPY		8U
+
+#define TRNG_PERF_REG_BITS		((unsigned int)sizeof(u_register_t) * 8U)
+
+struct trng_perf_cpu {
+	/* Results of a run */
+	struct perf_stats latency;
+	uint64_t no_entropy;
+
+	/* Health tests of the stream of this CPU, and its incomplete sample */
+	struct trng_health health;
+	uint8_t sample;
+	unsigned int sample_bits;
+};
+
+static DEFINE_PER_CPU(struct trng_perf_cpu, trng_perf_cpu);
+
+/* Bits requested by each TRNG_RND call of the current run */
+static unsigned int trng_perf_nbits;
+
+/* Append the 'nbits' low bits of 'val' to the stream of 'cpu'. */
+static void trng_perf_push(struct trng_perf_cpu *cpu, u_register_t val,
+			   unsigned int nbits)
+{
+	unsigned int take;
+
+	while (nbits > 0U) {
+		take = MIN(nbits, 8U - cpu->sample_bits);
+		cpu->sample |= (uint8_t)((val & ((1U << take) - 1U)) <<
+					 cpu->sample_bits);
+		cpu->sample_bits += take;
+		val >>= take;
+		nbits -= take;
+
+		if (cpu->sample_bits == 8U) {
+			(void)trng_health_feed(&cpu->health, &cpu->sample, 1U);
+			cpu->sample = 0U;
+			cpu->sample_bits = 0U;
+		}
+	}
+}
+
+/*
+ * Append the entropy returned by TRNG_RND to the stream of 'cpu'. The
+ * entropy is in the low 'nbits' bits of the concatenation of the returned
+ * registers, in order of significance X1:X2:X3 (W1:W2:W3 on AArch32).
+ */
+static void trng_perf_collect(struct trng_perf_cpu *cpu,
+			      const smc_ret_values *ret, unsigned int nbits)
+{
+	u_register_t regs[] = { ret->ret3, ret->ret2, ret->ret1 };
+	unsigned int n;
+
+	for (unsigned int i = 0U; (i < ARRAY_SIZE(regs)) && (nbits > 0U);
+	     i++) {
+		n = MIN(nbits, TRNG_PERF_REG_BITS);
+		trng_perf_push(cpu, regs[i], n);
+		nbits -= n;
+	}
+}
+
+/* Executed concurrently by all participating CPUs */
+static test_result_t trng_perf_cpu_run(void)
+{
+	struct trng_perf_cpu *cpu = this_cpu_ptr(trng_perf_cpu);
+	unsigned int nbits = trng_perf_nbits;
+	smc_ret_values ret;
+	uint64_t start, ticks, bits = 0ULL;
+
+	perf_stats_init(&cpu->latency);
+	cpu->no_entropy = 0ULL;
+
+	perf_throughput_start();
+
+	for (unsigned int i = 0U; i < TRNG_PERF_ITERATIONS; ) {
+		start = read_cntpct_el0();
+		ret = tftf_trng_rnd(nbits);
+		ticks = read_cntpct_el0() - start;
+
+		if ((int32_t)ret.ret0 == TRNG_E_NO_ENTROPY) {
+			cpu->no_entropy++;
+			if (cpu->no_entropy > TRNG_PERF_MAX_RETRIES) {
+				ERROR("TRNG out of entropy\n");
+				return TEST_RESULT_FAIL;
+			}
+			continue;
+		}
+
+		if ((int32_t)ret.ret0 != TRNG_E_SUCCESS) {
+			ERROR("TRNG_RND(%u) failed: %d\n", nbits,
+			      (int32_t)ret.ret0);
+			return TEST_RESULT_FAIL;
+		}
+
+		perf_stats_add(&cpu->latency, ticks);
+		trng_perf_collect(cpu, &ret, nbits);
+		bits += nbits;
+		i++;
+	}
+
+	perf_throughput_end(bits);
+
+	return TEST_RESULT_SUCCESS;
+}
+
+/*
+ * Merge the latencies of the CPUs of the last run into 'latency' and return
+ * their TRNG_E_NO_ENTROPY returns.
+ */
+static uint64_t collect_results(struct perf_stats *latency)
+{
+	const struct trng_perf_cpu *cpu;
+	uint64_t no_entropy = 0ULL;
+
+	perf_stats_init(latency);
+
+	for (unsigned int i = 0U; i < PLATFORM_CORE_COUNT; i++) {
+		if (!perf_throughput_has_cpu(i)) {
+			continue;
+		}
+
+		cpu = per_cpu_ptr(trng_perf_cpu, i);
+		perf_stats_merge(latency, &cpu->latency);
+		no_entropy += cpu->no_entropy;
+	}
+
+	return no_entropy;
+}
+
+/* Print the health test results of all CPUs, return false on a failure */
+static bool check_health(void)
+{
+	const struct trng_perf_cpu *cpu;
+	unsigned int rct_failures = 0U, apt_failures = 0U;
+	unsigned int rct_max = 0U, apt_max = 0U;
+	uint64_t samples = 0ULL;
+
+	for (unsigned int i = 0U; i < PLATFORM_CORE_COUNT; i++) {
+		cpu = per_cpu_ptr(trng_perf_cpu, i);
+		if (cpu->health.samples == 0ULL) {
+			continue;
+		}
+
+		samples += cpu->health.samples;
+		rct_failures += cpu->health.rct_failures;
+		apt_failures += cpu->health.apt_failures;
+		rct_max = MAX(rct_max, cpu->health.rct_max);
+		apt_max = MAX(apt_max, cpu->health.apt_max);
+	}
+
+	printf("Health tests: %llu samples, repetition count: %u failures, "
+	       "longest run %u, adaptive proportion: %u failures, highest "
+	       "count %u/%u\n", (unsigned long long)samples, rct_failures,
+	       rct_max, apt_failures, apt_max, TRNG_HEALTH_APT_WINDOW);
+
+	if ((rct_failures != 0U) || (apt_failures != 0U)) {
+		tftf_testcase_printf("Health tests failed: %u repetition "
+				     "count, %u adaptive proportion\n",
+				     rct_failures, apt_failures);
+		return false;
+	}
+
+	return true;
+}
+
+/*
+ * @Test_Aim@ Measure the TRNG entropy throughput and the TRNG_RND latency.
+ *
+ * TRNG_RND is called with request sizes from 1 to TRNG_MAX_BITS bits by 1,
+ * 2, 4, ... and all CPUs concurrently, and the aggregate bits/s, the
+ * TRNG_E_NO_ENTROPY returns and the call latency percentiles are printed for
+ * each combination. The entropy collected by each CPU goes through the
+ * SP 800-90B Repetition Count and Adaptive Proportion health tests, and the
+ * test fails if any of them does.
+ */
+test_result_t test_trng_perf_throughput(void)
+{
+	unsigned int cpus_count = tftf_get_total_cpus_count();
+	struct trng_perf_cpu *cpu;
+	struct perf_throughput tp;
+	struct perf_stats latency;
+	unsigned int cpu_count, nbits;
+	uint64_t no_entropy;
+	char name[32];
+	test_result_t ret;
+
+	if (tftf_trng_version() == TRNG_E_NOT_SUPPORTED) {
+		return TEST_RESULT_SKIPPED;
+	}
+
+	for (unsigned int i = 0U; i < PLATFORM_CORE_COUNT; i++) {
+		cpu = per_cpu_ptr(trng_perf_cpu, i);
+		trng_health_init(&cpu->health, TRNG_PERF_MIN_ENTROPY);
+		cpu->sample = 0U;
+		cpu->sample_bits = 0U;
+	}
+
+	for_each_perf_cpu_count(cpu_count, 1U, cpus_count) {
+		printf("%u CPUs, %u calls per CPU\n", cpu_count,
+		       TRNG_PERF_ITERATIONS);
+
+		for (nbits = 1U; ; nbits = MIN(nbits * 2U, TRNG_MAX_BITS)) {
+			trng_perf_nbits = nbits;
+
+			ret = perf_run_on_cpus(cpu_count, trng_perf_cpu_run);
+			if (ret != TEST_RESULT_SUCCESS) {
+				return ret;
+			}
+
+			perf_throughput_collect(&tp);
+			no_entropy = collect_results(&latency);
+
+			printf("  %u bits: %llu bits/s, %llu no entropy\n",
+			       nbits,
+			       (unsigned long long)perf_throughput_rate(&tp),
+			       (unsigned long long)no_entropy);
+			(void)snprintf(name, sizeof(name), "  %u bits latency",
+				       nbits);
+			perf_stats_print(name, &latency, false);
+
+			if (nbits == TRNG_MAX_BITS) {
+				break;
+			}
+		}
+
+		tftf_testcase_printf("%u CPUs, %u bits: %llu bits/s\n",
+			cpu_count, TRNG_MAX_BITS,
+			(unsigned long long)perf_throughput_rate(&tp));
+	}
+
+	return check_health() ? TEST_RESULT_SUCCESS : TEST_RESULT_FAIL;
+}
@@ -0,0 +1,21 @@
+#
+# Copyright (c) 2023, Arm Limited. All rights reserved.
+#
+# SPDX-License-Identifier: BSD-3-Clause
+#
+
+TESTS_SOURCES	+=							\
+	$(addprefix tftf/tests/runtime_services/secure_service/,	\
+		${ARCH}/ffa_arch_helpers.S				\
+		ffa_helpers.c						\
+		spm_common.c						\
+		test_ffa_perf_direct_messaging.c			\
+		test_ffa_perf_indirect_messaging.c			\
+		test_ffa_perf_notifications.c				\
+		test_ffa_setup_and_discovery.c				\
+	)
+
+TESTS_SOURCES	+=							\
+	$(addprefix tftf/tests/common/,					\
+		perf_helpers.c						\
+	)
@@ -1,5 +1,5 @@
 #
-# Copyright (c) 2022, Arm Limited. All rights reserved.
+# Copyright (c) 2022-2023, Arm Limited. All rights reserved.
 #
 # SPDX-License-Identifier: BSD-3-Clause
 #
@@ -20,4 +20,9 @@ TESTS_SOURCES	+=							\
 		ffa_helpers.c						\
 		spm_common.c						\
 		test_ffa_setup_and_discovery.c				\
-)
\ No newline at end of file
+)
+
+TESTS_SOURCES	+=							\
+	$(addprefix tftf/tests/common/,					\
+		perf_helpers.c						\
+	)
@@ -1,10 +1,18 @@
 #
-# Copyright (c) 2018-2019, Arm Limited. All rights reserved.
+# Copyright (c) 2018-2023, Arm Limited. All rights reserved.
 #
 # SPDX-License-Identifier: BSD-3-Clause
 #
 
 TESTS_SOURCES	+=	$(addprefix tftf/tests/performance_tests/,	\
 	smc_latencies.c							\
+	test_amu_psci_activity.c					\
+	test_psci_hotplug_perf.c					\
 	test_psci_latencies.c						\
+	test_psci_system_suspend_perf.c					\
+)
+
+TESTS_SOURCES	+=	$(addprefix tftf/tests/common/,			\
+	perf_helpers.c							\
+	pmf_helpers.c							\
 )
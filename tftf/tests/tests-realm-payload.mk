@@ -23,4 +23,9 @@ TESTS_SOURCES	+=							\
 TESTS_SOURCES	+=							\
 	$(addprefix lib/heap/,						\
 		page_alloc.c						\
-	)
\ No newline at end of file
+	)
+
+TESTS_SOURCES	+=							\
+	$(addprefix tftf/tests/common/,					\
+		perf_helpers.c						\
+	)
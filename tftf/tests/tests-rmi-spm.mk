@@ -1,5 +1,5 @@
 #
-# Copyright (c) 2021-2022, Arm Limited. All rights reserved.
+# Copyright (c) 2021-2023, Arm Limited. All rights reserved.
 #
 # SPDX-License-Identifier: BSD-3-Clause
 #
@@ -23,4 +23,9 @@ TESTS_SOURCES	+=							\
 TESTS_SOURCES	+=							\
 	$(addprefix lib/heap/,						\
 		page_alloc.c						\
-	)
\ No newline at end of file
+	)
+
+TESTS_SOURCES	+=							\
+	$(addprefix tftf/tests/common/,					\
+		perf_helpers.c						\
+	)
@@ -1,5 +1,5 @@
 #
-# Copyright (c) 2018, Arm Limited. All rights reserved.
+# Copyright (c) 2018-2023, Arm Limited. All rights reserved.
 #
 # SPDX-License-Identifier: BSD-3-Clause
 #
@@ -7,4 +7,11 @@
 TESTS_SOURCES	+=							\
 	$(addprefix tftf/tests/runtime_services/standard_service/pmf/api_tests/runtime_instr/, \
 		test_pmf_rt_instr.c					\
+		test_pmf_rt_latency_matrix.c				\
+	)
+
+TESTS_SOURCES	+=							\
+	$(addprefix tftf/tests/common/,					\
+		perf_helpers.c						\
+		pmf_helpers.c						\
 	)
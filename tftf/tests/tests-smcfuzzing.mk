@@ -12,6 +12,15 @@ SMC_FUZZ_INSTANCE_COUNT ?= 1
 SMC_FUZZ_SEEDS ?= $(shell python -c "from random import randint; seeds = [randint(0, 4294967295) for i in range($(SMC_FUZZ_INSTANCE_COUNT))];print(\",\".join(str(x) for x in seeds));")
 SMC_FUZZ_CALLS_PER_INSTANCE ?= 100
 
+# Number of extra instances mutated from the sequences that found new coverage
+SMC_FUZZ_MUTATIONS ?= 4
+
+# Replay the calls logged in NVM by a previous run instead of fuzzing
+SMC_FUZZ_REPLAY ?= 0
+
+# Fuzz on all the online CPUs at once, each with its own seed stream
+SMC_FUZZ_MULTI_CPU ?= 0
+
 # Validate SMC fuzzer parameters
 
 # Instance count must not be zero
@@ -34,10 +43,26 @@ endif
 $(eval $(call add_define,TFTF_DEFINES,SMC_FUZZ_SEEDS))
 $(eval $(call add_define,TFTF_DEFINES,SMC_FUZZ_INSTANCE_COUNT))
 $(eval $(call add_define,TFTF_DEFINES,SMC_FUZZ_CALLS_PER_INSTANCE))
+$(eval $(call add_define,TFTF_DEFINES,SMC_FUZZ_MUTATIONS))
+$(eval $(call add_define,TFTF_DEFINES,SMC_FUZZ_REPLAY))
+$(eval $(call add_define,TFTF_DEFINES,SMC_FUZZ_MULTI_CPU))
 
 TESTS_SOURCES	+=							\
 	$(addprefix smc_fuzz/src/,					\
+		fuzz_corpus.c						\
+		fuzz_errata_abi.c					\
+		fuzz_ffa.c						\
+		fuzz_psci.c						\
+		fuzz_sdei.c						\
+		fuzz_smccc.c						\
+		fuzz_trng.c						\
 		randsmcmod.c						\
-		smcmalloc.c						\
-		fifo3d.c						\
+		smcf_args.c						\
+	)								\
+	$(addprefix tftf/tests/runtime_services/secure_service/,	\
+		${ARCH}/ffa_arch_helpers.S				\
+		ffa_helpers.c						\
+	)								\
+	$(addprefix tftf/tests/common/,					\
+		perf_helpers.c						\
 	)
@@ -0,0 +1,212 @@
+#!/usr/bin/env python3
+
+#
+# Copyright (c) 2023, Arm Limited. All rights reserved.
+#
+# SPDX-License-Identifier: BSD-3-Clause
+#
+
+#
+# Generate the bias tree of the SMC fuzzer as constant C tables, so that the
+# fuzzer does not parse the device tree at run time.
+#
+# Arg1: DTB compiled from SMC_FUZZ_DTS.
+# Arg2: smc_fuzz/include/smcf_tree.h, for the list of known functions.
+# Arg3: Name of the header file to generate.
+#
+
+import re
+import struct
+import sys
+
+FDT_MAGIC = 0xd00dfeed
+FDT_BEGIN_NODE = 1
+FDT_END_NODE = 2
+FDT_PROP = 3
+FDT_NOP = 4
+FDT_END = 9
+
+# Values of the 'arguments' property of the leaves, see smcf_args.h
+ARGS_MODES = {
+    "valid": "SMCF_ARGS_VALID",
+    "boundary": "SMCF_ARGS_BOUNDARY",
+    "random": "SMCF_ARGS_RANDOM",
+    "mixed": "SMCF_ARGS_MIXED",
+}
+
+
+def fail(msg):
+    sys.stderr.write("generate_smcf_tree: error: %s\n" % msg)
+    sys.exit(1)
+
+
+def align4(pos):
+    return (pos + 3) & ~3
+
+
+def cstring(data, pos):
+    end = data.index(b"\0", pos)
+    return data[pos:end].decode("ascii"), end + 1
+
+
+def parse_dtb(data):
+    """Return the root node of the DTB as nested dictionaries."""
+    magic, _, off_struct, off_strings = struct.unpack(">IIII", data[:16])
+    if magic != FDT_MAGIC:
+        fail("not a device tree blob")
+
+    root = None
+    stack = []
+    pos = off_struct
+    while True:
+        token, = struct.unpack(">I", data[pos:pos + 4])
+        pos += 4
+        if token == FDT_BEGIN_NODE:
+            name, pos = cstring(data, pos)
+            pos = align4(pos)
+            node = {"name": name, "props": {}, "children": []}
+            if stack:
+                stack[-1]["children"].append(node)
+            else:
+                root = node
+            stack.append(node)
+        elif token == FDT_END_NODE:
+            stack.pop()
+        elif token == FDT_PROP:
+            length, nameoff = struct.unpack(">II", data[pos:pos + 8])
+            pos += 8
+            name, _ = cstring(data, off_strings + nameoff)
+            stack[-1]["props"][name] = data[pos:pos + length]
+            pos = align4(pos + length)
+        elif token == FDT_NOP:
+            continue
+        elif token == FDT_END:
+            return root
+        else:
+            fail("unexpected token %d" % token)
+
+
+def prop_string(node, name, default=None):
+    value = node["props"].get(name)
+    if value is None:
+        return default
+    return value.rstrip(b"\0").decode("ascii")
+
+
+def known_functions(header):
+    """Map the functionname of each known function to its enum value."""
+    with open(header) as f:
+        text = f.read()
+    return {name: "SMCF_" + ident
+            for ident, name in re.findall(r"X\((\w+),\s*(\w+)\)", text)}
+
+
+def alias_tables(biases):
+    """Integer alias method tables, exact for a draw in [0, sum(biases))."""
+    count = len(biases)
+    total = sum(biases)
+    scaled = [b * count for b in biases]
+    threshold = [total] * count
+    alias = list(range(count))
+    small = [i for i in range(count) if scaled[i] < total]
+    large = [i for i in range(count) if scaled[i] >= total]
+
+    while small and large:
+        less = small.pop()
+        more = large.pop()
+        threshold[less] = scaled[less]
+        alias[less] = more
+        scaled[more] -= total - scaled[less]
+        if scaled[more] < total:
+            small.append(more)
+        else:
+            large.append(more)
+
+    return threshold, alias
+
+
+def main():
+    if len(sys.argv) != 4:
+        fail("usage: %s <dtb> <smcf_tree.h> <output>" % sys.argv[0])
+
+    with open(sys.argv[1], "rb") as f:
+        root = parse_dtb(f.read())
+    funcs = known_functions(sys.argv[2])
+
+    nodes = []
+    entries = []
+
+    def add_node(node):
+        """Add the branch 'node' and its sub-tree, return its index."""
+        children = node["children"]
+        if not children:
+            fail("node %s has neither children nor functionname" %
+                 node["name"])
+
+        index = len(nodes)
+        nodes.append(None)
+        first = len(entries)
+        entries.extend([None] * len(children))
+
+        biases = []
+        for child in children:
+            if "bias" not in child["props"]:
+                fail("no bias for node %s" % child["name"])
+            biases.append(struct.unpack(">I", child["props"]["bias"])[0])
+
+        total = sum(biases)
+        if total == 0:
+            fail("all the biases of node %s are zero" % node["name"])
+        if len(children) > 0xffff or total > 0xffffffff:
+            fail("node %s is too large" % node["name"])
+
+        threshold, alias = alias_tables(biases)
+        for i, child in enumerate(children):
+            fname = prop_string(child, "functionname")
+            if fname is not None:
+                mode = ARGS_MODES.get(prop_string(child, "arguments", "mixed"))
+                if mode is None:
+                    fail("node %s: arguments must be one of %s" %
+                         (child["name"], ", ".join(sorted(ARGS_MODES))))
+                func = funcs.get(fname)
+                if func is None:
+                    sys.stderr.write("generate_smcf_tree: warning: "
+                                     "unknown function %s\n" % fname)
+                    func = "SMCF_FUNC_COUNT"
+                entries[first + i] = (threshold[i], alias[i],
+                                      "SMCF_TREE_LEAF", func, mode,
+                                      child["name"])
+            else:
+                entries[first + i] = (threshold[i], alias[i],
+                                      "%uU" % add_node(child),
+                                      "SMCF_FUNC_COUNT", "SMCF_ARGS_MIXED",
+                                      child["name"])
+
+        nodes[index] = (total, first, len(children), node["name"] or "/")
+        return index
+
+    add_node(root)
+    if len(nodes) > 0xffff or len(entries) > 0xffff:
+        fail("bias tree too large")
+
+    with open(sys.argv[3], "w") as out:
+        out.write("/* Generated by %s from %s, do not edit. */\n\n"
+                  % ("tools/generate_smcf_tree/generate_smcf_tree.py",
+                     sys.argv[1]))
+        out.write("#ifndef SMCF_BIAS_TREE_H\n#define SMCF_BIAS_TREE_H\n\n")
+        out.write("#include <smcf_tree.h>\n\n")
+        out.write("#define SMCF_TREE_ROOT\t0U\n\n")
+        out.write("static const struct smcf_tree_node smcf_tree_nodes[] = {\n")
+        for total, first, count, name in nodes:
+            out.write("\t{ %uU, %uU, %uU },\t/* %s */\n"
+                      % (total, first, count, name))
+        out.write("};\n\n")
+        out.write("static const struct smcf_tree_entry smcf_tree_entries[] = {\n")
+        for threshold, alias, child, func, mode, name in entries:
+            out.write("\t{ %uU, %uU, %s, %s, %s },\t/* %s */\n"
+                      % (threshold, alias, child, func, mode, name))
+        out.write("};\n\n#endif /* SMCF_BIAS_TREE_H */\n")
+
+
+if __name__ == "__main__":
+    main()